@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "engine/DeferredScans.h"
+
+#include "engine/simd_escape.h"
+#include "engine/TileScheduler.h"
+#include "ui/KeyboardHandler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace id::engine
+{
+
+// Rows handed to the tile scheduler between interruption checks.
+static constexpr int ROWS_PER_WORKER_PER_BAND{4};
+
+std::size_t DeferredScans::Scan::offset(const int row) const
+{
+    const int width{stop_col - start_col + 1};
+    const int col{row == first_row ? first_col : start_col};
+    return static_cast<std::size_t>(row - first_row) * width + (col - start_col);
+}
+
+void DeferredScans::record()
+{
+    clear();
+    m_mode = Mode::RECORD;
+}
+
+int DeferredScans::begin_image()
+{
+    m_grids.emplace_back();
+    m_image = static_cast<int>(m_grids.size()) - 1;
+    return m_image;
+}
+
+int DeferredScans::scans(const int image) const
+{
+    return static_cast<int>(
+        std::count_if(m_scans.begin(), m_scans.end(), [image](const Scan &scan) { return scan.image == image; }));
+}
+
+bool DeferredScans::compute()
+{
+    std::vector<std::pair<Scan *, int>> rows;
+    for (Scan &scan : m_scans)
+    {
+        for (int row = scan.first_row; row <= scan.last_row; ++row)
+        {
+            rows.emplace_back(&scan, row);
+        }
+    }
+
+    TileScheduler &scheduler{tile_scheduler()};
+    const int band_rows{static_cast<int>(scheduler.num_workers()) * ROWS_PER_WORKER_PER_BAND};
+    const int num_rows{static_cast<int>(rows.size())};
+    for (int first = 0; first < num_rows; first += band_rows)
+    {
+        if (ui::calc_interrupted())
+        {
+            clear();
+            return false;
+        }
+        scheduler.run(std::min(band_rows, num_rows - first),
+            [&](const int tile, unsigned)
+            {
+                const auto &[scan, row] = rows[first + tile];
+                const int col{row == scan->first_row ? scan->first_col : scan->start_col};
+                mandelbrot_orbit_row(
+                    scan->ctx, m_grids[scan->image], row, col, scan->stop_col, &scan->orbits[scan->offset(row)]);
+            });
+    }
+    m_computed = true;
+    return true;
+}
+
+void DeferredScans::replay(const int image)
+{
+    m_mode = Mode::REPLAY;
+    m_image = image;
+    m_next = static_cast<std::size_t>(
+        std::find_if(m_scans.begin(), m_scans.end(), [image](const Scan &scan) { return scan.image == image; }) -
+        m_scans.begin());
+}
+
+void DeferredScans::clear()
+{
+    m_mode = Mode::OFF;
+    m_image = -1;
+    m_scans.clear();
+    m_grids.clear();
+    m_next = 0;
+    m_computed = false;
+}
+
+void DeferredScans::defer(
+    const int first_row, const int first_col, const int last_row, const int start_col, const int stop_col)
+{
+    if (m_image < 0)
+    {
+        begin_image();
+    }
+    PixelGrid &grid{m_grids[m_image]};
+    if (grid.x0.empty())
+    {
+        grid = pixel_grid();
+    }
+    Scan scan{m_image, first_row, first_col, last_row, start_col, stop_col, mandelbrot_context(), {}};
+    scan.ctx.simd = use_simd_escape();
+    scan.orbits.resize(static_cast<std::size_t>(last_row - first_row + 1) * (stop_col - start_col + 1));
+    m_scans.push_back(std::move(scan));
+}
+
+const DeferredScans::Scan *DeferredScans::next(
+    const int first_row, const int first_col, const int last_row, const int start_col, const int stop_col)
+{
+    if (!m_computed || m_next >= m_scans.size() || m_scans[m_next].image != m_image)
+    {
+        return nullptr;
+    }
+    const Scan &scan{m_scans[m_next++]};
+    if (scan.first_row != first_row || scan.first_col != first_col || scan.last_row != last_row ||
+        scan.start_col != start_col || scan.stop_col != stop_col)
+    {
+        return nullptr;
+    }
+    return &scan;
+}
+
+DeferredScans &deferred_scans()
+{
+    static DeferredScans scans;
+    return scans;
+}
+
+} // namespace id::engine
@@ -11,18 +11,24 @@
 #include "engine/PertEngine.h"
 
 #include "engine/calcfrac.h"
+#include "engine/fractals.h"
 #include "engine/Potential.h"
+#include "engine/ReferenceOrbitCache.h"
 #include "engine/random_seed.h"
+#include "engine/TileScheduler.h"
 #include "engine/VideoInfo.h"
 #include "fractals/fractalp.h"
 #include "fractals/pickover_mandelbrot.h"
+#include "io/special_dirs.h"
 #include "math/biginit.h"
 #include "math/complex_fn.h"
 #include "misc/id.h"
 #include "ui/video.h"
 
 #include <algorithm>
+#include <climits>
 #include <cmath>
+#include <cstring>
 #include <stdexcept>
 
 using namespace id::fractals;
@@ -33,7 +39,17 @@ using namespace id::ui;
 namespace id::engine
 {
 
-BFComplex PertEngine::initialize_frame_bf(const double zoom_radius)
+// reference orbit value before iteration 0, where rebased orbits restart
+static const std::complex<double> REFERENCE_ORIGIN{};
+
+static constexpr int ROWS_PER_WORKER_PER_BAND{2};
+static constexpr std::size_t POINTS_PER_TILE{64};
+
+// cached pixel colors that are not plain color indices
+static constexpr int NOT_CALCULATED{INT_MIN};
+static constexpr int GLITCHED{INT_MIN + 1};
+
+BFComplex PertEngine::initialize_frame_bf(const FloatExp &zoom_radius)
 {
     reset_for_frame(zoom_radius);
     m_saved_stack = save_stack();
@@ -68,17 +84,79 @@ int PertEngine::calculate_pixel(const Point &pt)
         initialize_pixel_strategy();
     }
 
-    return calculate_point(pt, m_magnified_radius, m_window_radius);
+    return plot_point(pt, iterate_point(pt));
 }
 
 int PertEngine::calculate_pixel(const int col, const int row)
 {
-    return calculate_pixel(Point{col, g_screen_y_dots - 1 - row});
+    if (!m_frame_initialized)
+    {
+        initialize_pixel_strategy();
+    }
+
+    const Point pt{col, g_screen_y_dots - 1 - row};
+    if (m_pixel_colors.empty() || col < 0 || col >= g_screen_x_dots || row < 0 || row >= g_screen_y_dots)
+    {
+        return plot_point(pt, iterate_point(pt));
+    }
+
+    const std::size_t index{static_cast<std::size_t>(row) * g_screen_x_dots + col};
+    if (m_pixel_colors[index] == NOT_CALCULATED)
+    {
+        calculate_band(row);
+    }
+    if (m_pixel_colors[index] == NOT_CALCULATED) // outside the current work item
+    {
+        return plot_point(pt, iterate_point(pt));
+    }
+    if (m_pixel_colors[index] == GLITCHED)
+    {
+        g_color = get_color(col, row);
+        return g_color;
+    }
+    g_color = m_pixel_colors[index];
+    g_plot(col, row, g_color);
+    return g_color;
+}
+
+void PertEngine::calculate_pixels(const std::vector<Point> &points, const std::size_t begin, const std::size_t end)
+{
+    if (!m_frame_initialized)
+    {
+        initialize_pixel_strategy();
+    }
+
+    TileScheduler &scheduler{tile_scheduler()};
+    if (scheduler.num_workers() < 2)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            calculate_pixel(points[i]);
+        }
+        return;
+    }
+
+    std::vector<PointOrbit> orbits(end - begin);
+    const int num_tiles{static_cast<int>((orbits.size() + POINTS_PER_TILE - 1) / POINTS_PER_TILE)};
+    scheduler.run(num_tiles,
+        [&](const int tile, unsigned)
+        {
+            const std::size_t first{static_cast<std::size_t>(tile) * POINTS_PER_TILE};
+            const std::size_t last{std::min(first + POINTS_PER_TILE, orbits.size())};
+            for (std::size_t i = first; i < last; ++i)
+            {
+                orbits[i] = iterate_point(points[begin + i]);
+            }
+        });
+    for (std::size_t i = 0; i < orbits.size(); ++i)
+    {
+        plot_point(points[begin + i], orbits[i]);
+    }
 }
 
 bool PertEngine::retry_needed(const std::vector<Point> &points) const
 {
-    return m_calculate_glitches &&
+    return !m_rebase &&
         points.size() >
         static_cast<std::size_t>(g_screen_x_dots * g_screen_y_dots * (m_percent_glitch_tolerance / 100));
 }
@@ -94,6 +172,7 @@ bool PertEngine::select_retry_reference(const std::vector<Point> &points)
 
     const int index{static_cast<int>(random_unit() * points.size())};
     select_reference_point(points[index]);
+    std::fill(m_pixel_colors.begin(), m_pixel_colors.end(), NOT_CALCULATED);
     return true;
 }
 
@@ -102,6 +181,11 @@ void PertEngine::set_glitch_tolerance(const double tolerance)
     m_glitch_tolerance = tolerance;
 }
 
+void PertEngine::set_rebase(const bool rebase)
+{
+    m_rebase = rebase;
+}
+
 double PertEngine::glitch_tolerance_threshold(const std::complex<double> &value) const
 {
     return mag_squared(value * m_glitch_tolerance);
@@ -112,6 +196,16 @@ int PertEngine::reference_count() const
     return m_reference_points;
 }
 
+bool PertEngine::extended_deltas() const
+{
+    return m_extended_deltas;
+}
+
+int PertEngine::skipped_iterations() const
+{
+    return m_series.skip();
+}
+
 std::vector<Point> PertEngine::take_glitch_points()
 {
     std::vector<Point> points;
@@ -140,6 +234,8 @@ void PertEngine::cleanup()
         m_center_stack_saved = false;
     }
     m_glitch_points.clear();
+    m_pixel_colors.clear();
+    m_worker_glitch_points.clear();
     m_perturbation_tolerance_check.clear();
     m_xn.clear();
     m_c_bf = {};
@@ -159,10 +255,20 @@ void PertEngine::initialize_pixel_state()
 {
     m_reference_points = 0;
     m_glitch_point_count = 0L;
-    m_magnified_radius = m_zoom_radius;
+    m_series.reset();
+    m_magnified_radius = m_zoom_radius.to_double();
     m_window_radius = std::min(g_screen_x_dots, g_screen_y_dots);
 
     m_glitch_points.resize(g_screen_x_dots * g_screen_y_dots);
+    if (parallel_eligible())
+    {
+        m_pixel_colors.assign(static_cast<std::size_t>(g_screen_x_dots) * g_screen_y_dots, NOT_CALCULATED);
+        m_worker_glitch_points.resize(tile_scheduler().num_workers());
+    }
+    else
+    {
+        m_pixel_colors.clear();
+    }
     m_perturbation_tolerance_check.resize(g_max_iterations * 2);
     m_xn.resize(g_max_iterations + 1);
 
@@ -182,13 +288,14 @@ void PertEngine::allocate_working_values()
     }
 }
 
-void PertEngine::reset_for_frame(const double zoom_radius)
+void PertEngine::reset_for_frame(const FloatExp &zoom_radius)
 {
     if (!m_done)
     {
         cleanup();
     }
     m_zoom_radius = zoom_radius;
+    m_extended_deltas = zoom_radius < EXTENDED_DELTA_RADIUS;
     m_done = false;
     m_frame_initialized = false;
 }
@@ -210,6 +317,7 @@ bool PertEngine::select_center_reference()
         m_reference_coordinate = m_center;
     }
 
+    m_reference_delta = {};
     m_delta_real = 0;
     m_delta_imag = 0;
 
@@ -221,6 +329,8 @@ bool PertEngine::select_center_reference()
     {
         reference_zoom_point(m_reference_coordinate, g_max_iterations);
     }
+    find_reference_length();
+    compute_series_approximation();
     return true;
 }
 
@@ -228,23 +338,29 @@ void PertEngine::select_reference_point(const Point &pt)
 {
     m_reference_points++;
 
-    const double delta_real = m_magnified_radius * (2 * pt.get_x() - g_screen_x_dots) / m_window_radius;
-    const double delta_imag = -m_magnified_radius * (2 * pt.get_y() - g_screen_y_dots) / m_window_radius;
-
-    m_delta_real = delta_real;
-    m_delta_imag = delta_imag;
+    if (m_extended_deltas)
+    {
+        m_reference_delta = pixel_offset(pt);
+    }
+    else
+    {
+        m_reference_delta = {m_magnified_radius * (2 * pt.get_x() - g_screen_x_dots) / m_window_radius,
+            -m_magnified_radius * (2 * pt.get_y() - g_screen_y_dots) / m_window_radius};
+    }
+    m_delta_real = m_reference_delta.x.to_double();
+    m_delta_imag = m_reference_delta.y.to_double();
 
     if (g_bf_math != BFMathType::NONE)
     {
-        float_to_bf(m_tmp_bf, delta_real);
+        float_exp_to_bf(m_tmp_bf, m_reference_delta.x);
         add_bf(m_reference_coordinate_bf.x, m_c_bf.x, m_tmp_bf);
-        float_to_bf(m_tmp_bf, delta_imag);
+        float_exp_to_bf(m_tmp_bf, m_reference_delta.y);
         add_bf(m_reference_coordinate_bf.y, m_c_bf.y, m_tmp_bf);
     }
     else
     {
-        m_reference_coordinate.real(m_c.real() + delta_real);
-        m_reference_coordinate.imag(m_c.imag() + delta_imag);
+        m_reference_coordinate.real(m_c.real() + m_delta_real);
+        m_reference_coordinate.imag(m_c.imag() + m_delta_imag);
     }
 
     if (g_bf_math != BFMathType::NONE)
@@ -255,25 +371,46 @@ void PertEngine::select_reference_point(const Point &pt)
     {
         reference_zoom_point(m_reference_coordinate, g_max_iterations);
     }
+    find_reference_length();
+    compute_series_approximation();
+}
+
+void PertEngine::find_reference_length()
+{
+    m_reference_length = g_max_iterations;
+    for (int i = 0; i < g_max_iterations; ++i)
+    {
+        if (!(mag_squared(m_xn[i]) < g_magnitude_limit))
+        {
+            m_reference_length = i;
+            break;
+        }
+    }
 }
 
-int PertEngine::calculate_point(const Point &pt, const double magnified_radius, const int window_radius)
+PertEngine::PointOrbit PertEngine::iterate_point(const Point &pt) const
 {
+    if (m_extended_deltas)
+    {
+        return iterate_point_extended(pt);
+    }
+
     // Get the complex number at this pixel.
     // This calculates the number relative to the reference point, so we need to translate that to the center
     // when the reference point isn't in the center. That's why for the first reference,
     // m_calculated_real_delta and m_calculated_imaginary_delta are 0: it's calculating relative to the
     // center.
-    const double delta_real = magnified_radius * (2 * pt.get_x() - g_screen_x_dots) / window_radius - m_delta_real;
+    const double delta_real = m_magnified_radius * (2 * pt.get_x() - g_screen_x_dots) / m_window_radius - m_delta_real;
     const double delta_imaginary =
-        -magnified_radius * (2 * pt.get_y() - g_screen_y_dots) / window_radius - m_delta_imag;
+        -m_magnified_radius * (2 * pt.get_y() - g_screen_y_dots) / m_window_radius - m_delta_imag;
     const std::complex<double> delta_sub_0{delta_real, delta_imaginary};
-    std::complex<double> delta_sub_n{delta_real, delta_imaginary};
-    int iteration{};
-    bool glitched{};
-
-    double min_orbit{1e5}; // orbit value closest to origin
-    long min_index{};      // iteration of min_orbit
+    // Start past the iterations shared by every pixel near the reference.
+    std::complex<double> delta_sub_n{m_series.delta(delta_sub_0)};
+    PointOrbit orbit;
+    orbit.iteration = m_series.skip();
+    int &iteration{orbit.iteration};
+    int reference_iteration{iteration};
+    const std::complex<double> *reference{&m_xn[reference_iteration]};
     double magnitude;
     do
     {
@@ -282,275 +419,515 @@ int PertEngine::calculate_point(const Point &pt, const double magnified_radius,
             throw std::runtime_error("No perturbation point function defined for fractal type (" +
                 std::string{g_cur_fractal_specific->name} + ")");
         }
-        g_cur_fractal_specific->pert_pt(m_xn[iteration], delta_sub_n, delta_sub_0);
+        g_cur_fractal_specific->pert_pt(*reference, delta_sub_n, delta_sub_0);
         iteration++;
-        magnitude = mag_squared(m_xn[iteration] + delta_sub_n);
+        reference_iteration++;
+        orbit.w = m_xn[reference_iteration] + delta_sub_n;
+        magnitude = mag_squared(orbit.w);
 
         if (g_inside_method == ColorMethod::BOF60 || g_inside_method == ColorMethod::BOF61)
         {
-            if (magnitude < min_orbit)
+            if (magnitude < orbit.min_orbit)
             {
-                min_orbit = magnitude;
-                min_index = iteration + 1L;
+                orbit.min_orbit = magnitude;
+                orbit.min_index = iteration + 1L;
             }
         }
 
+        if (m_rebase)
+        {
+            // Zhuoran's rebasing: once the pixel's orbit is closer to zero than to the reference,
+            // or the reference has escaped, continue from the start of the reference orbit with
+            // the full value as the delta.  The reference before iteration 0 is zero.
+            if (magnitude < mag_squared(delta_sub_n) || reference_iteration == m_reference_length)
+            {
+                delta_sub_n = orbit.w;
+                reference_iteration = -1;
+            }
+        }
         // This is Pauldelbrot's glitch detection method. You can see it here:
         // http://www.fractalforums.com/announcements-and-news/pertubation-theory-glitches-improvement/. As
         // for why it looks so weird, it's because I've squared both sides of his equation and moved the
         // |ZsubN| to the other side to be precalculated. For more information, look at where the reference
-        // point is calculated. I also only want to store this point once.
-        if (m_calculate_glitches && !glitched && magnitude < m_perturbation_tolerance_check[iteration])
+        // point is calculated.
+        else if (magnitude < m_perturbation_tolerance_check[reference_iteration])
         {
-            m_glitch_points[m_glitch_point_count] = Point(pt.get_x(), pt.get_y(), iteration);
-            m_glitch_point_count++;
-            glitched = true;
+            orbit.glitched = true;
             break;
         }
+        reference = reference_iteration < 0 ? &REFERENCE_ORIGIN : &m_xn[reference_iteration];
     } while (magnitude < g_magnitude_limit && iteration < g_max_iterations);
 
-    if (!glitched)
+    return orbit;
+}
+
+PertEngine::PointOrbit PertEngine::iterate_point_extended(const Point &pt) const
+{
+    if (g_cur_fractal_specific->pert_pt_fe == nullptr)
+    {
+        throw std::runtime_error("No extended exponent perturbation point function defined for fractal type (" +
+            std::string{g_cur_fractal_specific->name} + ")");
+    }
+
+    // Same as iterate_point, with deltas that may be far below the range of a double.
+    const FloatExpComplex offset{pixel_offset(pt)};
+    const FloatExpComplex delta_sub_0{offset - m_reference_delta};
+    FloatExpComplex delta_sub_n{m_series.delta(delta_sub_0)};
+    PointOrbit orbit;
+    orbit.iteration = m_series.skip();
+    int &iteration{orbit.iteration};
+    int reference_iteration{iteration};
+    const std::complex<double> *reference{&m_xn[reference_iteration]};
+    double magnitude;
+    do
     {
-        int index;
-        const double rq_lim2{std::sqrt(g_magnitude_limit)};
-        const std::complex<double> w{m_xn[iteration] + delta_sub_n};
+        g_cur_fractal_specific->pert_pt_fe(*reference, delta_sub_n, delta_sub_0);
+        iteration++;
+        reference_iteration++;
+        const std::complex<double> &x{m_xn[reference_iteration]};
+        orbit.w = x + std::complex<double>{delta_sub_n.x.to_double(), delta_sub_n.y.to_double()};
+        magnitude = mag_squared(orbit.w);
 
-        if (g_biomorph >= 0)
+        if (g_inside_method == ColorMethod::BOF60 || g_inside_method == ColorMethod::BOF61)
         {
-            if (iteration == g_max_iterations)
+            if (magnitude < orbit.min_orbit)
             {
-                index = g_max_iterations;
+                orbit.min_orbit = magnitude;
+                orbit.min_index = iteration + 1L;
             }
-            else
+        }
+
+        if (m_rebase)
+        {
+            const FloatExpComplex z{delta_sub_n.x + x.real(), delta_sub_n.y + x.imag()};
+            if (mag_squared(z) < mag_squared(delta_sub_n) || reference_iteration == m_reference_length)
             {
-                if (std::abs(w.real()) < rq_lim2 || std::abs(w.imag()) < rq_lim2)
-                {
-                    index = g_biomorph;
-                }
-                else
-                {
-                    index = iteration % 256;
-                }
+                delta_sub_n = z;
+                reference_iteration = -1;
             }
         }
+        else if (magnitude < m_perturbation_tolerance_check[reference_iteration])
+        {
+            orbit.glitched = true;
+            break;
+        }
+        reference = reference_iteration < 0 ? &REFERENCE_ORIGIN : &m_xn[reference_iteration];
+    } while (magnitude < g_magnitude_limit && iteration < g_max_iterations);
+
+    return orbit;
+}
+
+int PertEngine::plot_point(const Point &pt, const PointOrbit &orbit)
+{
+    if (orbit.glitched)
+    {
+        add_glitch_point(pt, orbit.iteration);
+        g_color = get_color(pt.get_x(), g_screen_y_dots - 1 - pt.get_y());
+        return g_color;
+    }
+    g_color = color_index(orbit);
+    g_plot(pt.get_x(), g_screen_y_dots - 1 - pt.get_y(), g_color);
+    return g_color;
+}
+
+int PertEngine::color_index(const PointOrbit &orbit) const
+{
+    const int iteration{orbit.iteration};
+    const std::complex<double> &w{orbit.w};
+    int index;
+    const double rq_lim2{std::sqrt(g_magnitude_limit)};
+
+    if (g_biomorph >= 0)
+    {
+        if (iteration == g_max_iterations)
+        {
+            index = g_max_iterations;
+        }
         else
         {
-            switch (g_outside_method)
+            if (std::abs(w.real()) < rq_lim2 || std::abs(w.imag()) < rq_lim2)
             {
-            case ColorMethod::COLOR: // no filter
-                if (iteration == g_max_iterations)
-                {
-                    index = g_max_iterations;
-                }
-                else
-                {
-                    index = iteration % 256;
-                }
-                break;
+                index = g_biomorph;
+            }
+            else
+            {
+                index = iteration % 256;
+            }
+        }
+    }
+    else
+    {
+        switch (g_outside_method)
+        {
+        case ColorMethod::COLOR: // no filter
+            if (iteration == g_max_iterations)
+            {
+                index = g_max_iterations;
+            }
+            else
+            {
+                index = iteration % 256;
+            }
+            break;
 
-            case ColorMethod::ZMAG:
-                if (iteration == g_max_iterations)
-                {
-                    index = static_cast<int>((w.real() * w.real() + w.imag() + w.imag()) * (g_max_iterations >> 1) + 1);
-                }
-                else
-                {
-                    index = iteration % 256;
-                }
-                break;
+        case ColorMethod::ZMAG:
+            if (iteration == g_max_iterations)
+            {
+                index = static_cast<int>((w.real() * w.real() + w.imag() + w.imag()) * (g_max_iterations >> 1) + 1);
+            }
+            else
+            {
+                index = iteration % 256;
+            }
+            break;
 
-            case ColorMethod::REAL:
-                if (iteration == g_max_iterations)
-                {
-                    index = g_max_iterations;
-                }
-                else
-                {
-                    index = iteration + static_cast<long>(w.real()) + 7;
-                }
-                break;
+        case ColorMethod::REAL:
+            if (iteration == g_max_iterations)
+            {
+                index = g_max_iterations;
+            }
+            else
+            {
+                index = iteration + static_cast<long>(w.real()) + 7;
+            }
+            break;
+
+        case ColorMethod::IMAG:
+            if (iteration == g_max_iterations)
+            {
+                index = g_max_iterations;
+            }
+            else
+            {
+                index = iteration + static_cast<long>(w.imag()) + 7;
+            }
+            break;
+
+        case ColorMethod::MULT:
+            if (iteration == g_max_iterations)
+            {
+                index = g_max_iterations;
+            }
+            else if (w.imag())
+            {
+                index = static_cast<long>(static_cast<double>(iteration) * (w.real() / w.imag()));
+            }
+            else
+            {
+                index = iteration;
+            }
+            break;
+
+        case ColorMethod::SUM:
+            if (iteration == g_max_iterations)
+            {
+                index = g_max_iterations;
+            }
+            else
+            {
+                index = iteration + static_cast<long>(w.real() + w.imag());
+            }
+            break;
+
+        case ColorMethod::ATAN:
+            if (iteration == g_max_iterations)
+            {
+                index = g_max_iterations;
+            }
+            else
+            {
+                index = static_cast<long>(std::abs(atan2(w.imag(), w.real()) * 180.0 / PI));
+            }
+            break;
 
-            case ColorMethod::IMAG:
+        default:
+            if (g_potential.flag)
+            {
+                index = potential(mag_squared(w), iteration);
+            }
+            else // no filter
+            {
                 if (iteration == g_max_iterations)
                 {
                     index = g_max_iterations;
                 }
                 else
                 {
-                    index = iteration + static_cast<long>(w.imag()) + 7;
+                    index = iteration % 256;
                 }
-                break;
+            }
+            break;
+        }
 
-            case ColorMethod::MULT:
+        if (g_inside_method >= ColorMethod::COLOR) // no filter
+        {
+            if (iteration == g_max_iterations)
+            {
+                index = g_inside_color;
+            }
+            else
+            {
+                index = iteration % 256;
+            }
+        }
+        else
+        {
+            switch (g_inside_method)
+            {
+            case ColorMethod::ZMAG:
                 if (iteration == g_max_iterations)
                 {
-                    index = g_max_iterations;
-                }
-                else if (w.imag())
-                {
-                    index = static_cast<long>(static_cast<double>(iteration) * (w.real() / w.imag()));
-                }
-                else
-                {
-                    index = iteration;
+                    index = static_cast<int>(mag_squared(w) * (g_max_iterations >> 1) + 1);
                 }
                 break;
-
-            case ColorMethod::SUM:
+            case ColorMethod::BOF60:
                 if (iteration == g_max_iterations)
                 {
-                    index = g_max_iterations;
-                }
-                else
-                {
-                    index = iteration + static_cast<long>(w.real() + w.imag());
+                    index = static_cast<int>(std::sqrt(orbit.min_orbit) * 75.0);
                 }
                 break;
-
-            case ColorMethod::ATAN:
+            case ColorMethod::BOF61:
                 if (iteration == g_max_iterations)
                 {
-                    index = g_max_iterations;
-                }
-                else
-                {
-                    index = static_cast<long>(std::abs(atan2(w.imag(), w.real()) * 180.0 / PI));
+                    index = orbit.min_index;
                 }
                 break;
 
             default:
-                if (g_potential.flag)
-                {
-                    index = potential(mag_squared(w), iteration);
-                }
-                else // no filter
-                {
-                    if (iteration == g_max_iterations)
-                    {
-                        index = g_max_iterations;
-                    }
-                    else
-                    {
-                        index = iteration % 256;
-                    }
-                }
                 break;
             }
+        }
+    }
+    return index;
+}
+
+// Workers only read the reference orbit and the render settings, and record
+// glitched pixels in their own lists; colors are cached for plotting on the
+// calling thread as the traversal asks for them.
+void PertEngine::calculate_band(const int first_row)
+{
+    TileScheduler &scheduler{tile_scheduler()};
+    const int last_row{
+        std::min(first_row + static_cast<int>(scheduler.num_workers()) * ROWS_PER_WORKER_PER_BAND - 1, g_i_stop_pt.y)};
+    const int first_col{std::max(g_i_start_pt.x, 0)};
+    const int last_col{std::min(g_i_stop_pt.x, g_screen_x_dots - 1)};
+    for (std::vector<Point> &glitches : m_worker_glitch_points)
+    {
+        glitches.clear();
+    }
 
-            if (g_inside_method >= ColorMethod::COLOR) // no filter
+    scheduler.run(last_row - first_row + 1,
+        [&](const int tile, const unsigned worker)
+        {
+            const int row{first_row + tile};
+            int *colors{&m_pixel_colors[static_cast<std::size_t>(row) * g_screen_x_dots]};
+            for (int col = first_col; col <= last_col; ++col)
             {
-                if (iteration == g_max_iterations)
+                if (colors[col] != NOT_CALCULATED)
                 {
-                    index = g_inside_color;
+                    continue;
                 }
-                else
+                const Point pt{col, g_screen_y_dots - 1 - row};
+                const PointOrbit orbit{iterate_point(pt)};
+                if (orbit.glitched)
                 {
-                    index = iteration % 256;
+                    m_worker_glitch_points[worker].emplace_back(pt.get_x(), pt.get_y(), orbit.iteration);
+                    colors[col] = GLITCHED;
                 }
-            }
-            else
-            {
-                switch (g_inside_method)
+                else
                 {
-                case ColorMethod::ZMAG:
-                    if (iteration == g_max_iterations)
-                    {
-                        index = static_cast<int>(mag_squared(w) * (g_max_iterations >> 1) + 1);
-                    }
-                    break;
-                case ColorMethod::BOF60:
-                    if (iteration == g_max_iterations)
-                    {
-                        index = static_cast<int>(std::sqrt(min_orbit) * 75.0);
-                    }
-                    break;
-                case ColorMethod::BOF61:
-                    if (iteration == g_max_iterations)
-                    {
-                        index = min_index;
-                    }
-                    break;
-
-                default:
-                    break;
+                    colors[col] = color_index(orbit);
                 }
             }
+        });
+
+    for (const std::vector<Point> &glitches : m_worker_glitch_points)
+    {
+        for (const Point &pt : glitches)
+        {
+            add_glitch_point(pt, pt.get_iteration());
         }
-        g_color = index;
-        g_plot(pt.get_x(), g_screen_y_dots - 1 - pt.get_y(), g_color);
     }
-    else
+}
+
+// The potential coloring writes 16 bit results through the disk driver, so
+// it has to run on the calling thread.  Bands compute every pixel of their
+// rows, which only the 1 and 2 pass traversals go on to ask for; solid
+// guessing, boundary tracing and the rest skip pixels, so they stay serial.
+bool PertEngine::parallel_eligible()
+{
+    return tile_scheduler().num_workers() > 1 && !g_potential.flag &&
+        (g_std_calc_mode == CalcMode::ONE_PASS || g_std_calc_mode == CalcMode::TWO_PASS);
+}
+
+FloatExpComplex PertEngine::pixel_offset(const Point &pt) const
+{
+    return {m_zoom_radius * (static_cast<double>(2 * pt.get_x() - g_screen_x_dots) / m_window_radius),
+        -m_zoom_radius * (static_cast<double>(2 * pt.get_y() - g_screen_y_dots) / m_window_radius)};
+}
+
+void PertEngine::add_glitch_point(const Point &pt, const int iteration)
+{
+    m_glitch_points[m_glitch_point_count] = Point(pt.get_x(), pt.get_y(), iteration);
+    m_glitch_point_count++;
+}
+
+// The series only models z^2 + c, and the bof inside colorings need the
+// orbit minimum over every iteration, so other cases start at iteration 0.
+void PertEngine::compute_series_approximation()
+{
+    m_series.reset();
+    if (g_cur_fractal_specific->pert_pt != mandel_perturb || g_inside_method == ColorMethod::BOF60 ||
+        g_inside_method == ColorMethod::BOF61)
     {
-        g_color = get_color(pt.get_x(), g_screen_y_dots - 1 - pt.get_y());
+        return;
     }
-    return g_color;
+    m_series.compute(m_xn, g_max_iterations, reference_pixel_radius(), g_magnitude_limit);
+}
+
+// Largest distance from the current reference to a corner of the screen.
+FloatExp PertEngine::reference_pixel_radius() const
+{
+    FloatExp radius{};
+    for (const int x : {0, g_screen_x_dots})
+    {
+        for (const int y : {0, g_screen_y_dots})
+        {
+            radius = std::max(radius, sqrt(mag_squared(pixel_offset(Point{x, y}) - m_reference_delta)));
+        }
+    }
+    return radius;
 }
 
 void PertEngine::reference_zoom_point(const BFComplex &center, const int max_iteration)
 {
+    if (g_cur_fractal_specific->pert_ref_bf == nullptr)
+    {
+        throw std::runtime_error("No reference orbit function defined for fractal type (" +
+            std::string{g_cur_fractal_specific->name} + ")");
+    }
+
     BigStackSaver saved;
 
+    const int length{g_r_bf_length + 2};
     BFComplex z_bf;
-    z_bf.x = alloc_stack(g_r_bf_length + 2);
-    z_bf.y = alloc_stack(g_r_bf_length + 2);
-    BigFloat temp_real_bf = alloc_stack(g_r_bf_length + 2);
-    BigFloat temp_imag_bf = alloc_stack(g_r_bf_length + 2);
-    BigFloat tmp_bf = alloc_stack(g_r_bf_length + 2);
-
-    copy_bf(z_bf.x, center.x);
-    copy_bf(z_bf.y, center.y);
+    z_bf.x = alloc_stack(length);
+    z_bf.y = alloc_stack(length);
+
+    std::vector<unsigned char> center_bytes(center.x, center.x + length);
+    center_bytes.insert(center_bytes.end(), center.y, center.y + length);
+    const ReferenceOrbitKey key{orbit_key(g_r_bf_length, std::move(center_bytes))};
+    reference_orbit_cache().set_directory(io::g_temp_dir);
+    const std::shared_ptr<const ReferenceOrbit> cached{reference_orbit_cache().find(key)};
+    const int first{restore_reference_orbit(cached.get(), 2 * length, max_iteration)};
+    if (first > 0)
+    {
+        std::memcpy(z_bf.x, cached->next_z.data(), length);
+        std::memcpy(z_bf.y, cached->next_z.data() + length, length);
+    }
+    else
+    {
+        copy_bf(z_bf.x, center.x);
+        copy_bf(z_bf.y, center.y);
+    }
 
-    for (int i = 0; i <= max_iteration; i++)
+    for (int i = first; i <= max_iteration; i++)
     {
-        std::complex<double> c;
-        c.real(bf_to_float(z_bf.x));
-        c.imag(bf_to_float(z_bf.y));
+        const std::complex<double> c{
+            static_cast<double>(bf_to_float(z_bf.x)), static_cast<double>(bf_to_float(z_bf.y))};
 
         m_xn[i] = c;
-        // Norm is the squared version of abs and the perturbation tolerance is squared.
-        // The reason we are storing this into an array is that we need to check the magnitude against this
-        // value to see if the value is glitched. We are leaving it squared because otherwise we'd need to do
-        // a square root operation, which is expensive, so we'll just compare this to the squared magnitude.
-
-        float_to_bf(tmp_bf, m_glitch_tolerance);
-        mult_bf(temp_real_bf, z_bf.x, tmp_bf);
-        mult_bf(temp_imag_bf, z_bf.y, tmp_bf);
-        std::complex<double> tolerance;
-        tolerance.real(bf_to_float(temp_real_bf));
-        tolerance.imag(bf_to_float(temp_imag_bf));
-
-        m_perturbation_tolerance_check[i] = mag_squared(tolerance);
 
-        if (g_cur_fractal_specific->pert_ref_bf == nullptr)
-        {
-            throw std::runtime_error("No reference orbit function defined for fractal type (" +
-                std::string{g_cur_fractal_specific->name} + ")");
-        }
         g_cur_fractal_specific->pert_ref_bf(center, z_bf);
     }
+    if (first <= max_iteration)
+    {
+        std::vector<unsigned char> next_z(z_bf.x, z_bf.x + length);
+        next_z.insert(next_z.end(), z_bf.y, z_bf.y + length);
+        store_reference_orbit(key, std::move(next_z), max_iteration, true);
+    }
+    // The glitch tolerance only needs the precision of a double, so it is
+    // computed from the converted orbit value like the double reference.
+    fill_tolerance_check(max_iteration);
 }
 
 void PertEngine::reference_zoom_point(const std::complex<double> &center, const int max_iteration)
 {
-    std::complex<double> z = center;
+    if (g_cur_fractal_specific->pert_ref == nullptr)
+    {
+        throw std::runtime_error("No reference orbit function defined for fractal type (" +
+            std::string{g_cur_fractal_specific->name} + ")");
+    }
 
-    for (int i = 0; i <= max_iteration; i++)
+    const auto *center_bytes{reinterpret_cast<const unsigned char *>(&center)};
+    const ReferenceOrbitKey key{
+        orbit_key(0, std::vector<unsigned char>(center_bytes, center_bytes + sizeof(center)))};
+    const std::shared_ptr<const ReferenceOrbit> cached{reference_orbit_cache().find(key)};
+    const int first{restore_reference_orbit(cached.get(), sizeof(std::complex<double>), max_iteration)};
+    std::complex<double> z{center};
+    if (first > 0)
+    {
+        std::memcpy(&z, cached->next_z.data(), sizeof(z));
+    }
+
+    for (int i = first; i <= max_iteration; i++)
     {
         m_xn[i] = z;
+        g_cur_fractal_specific->pert_ref(center, z);
+    }
+    if (first <= max_iteration)
+    {
+        const auto *z_bytes{reinterpret_cast<const unsigned char *>(&z)};
+        // double precision orbits are cheap enough that they are only kept in memory
+        store_reference_orbit(key, std::vector<unsigned char>(z_bytes, z_bytes + sizeof(z)), max_iteration, false);
+    }
+    fill_tolerance_check(max_iteration);
+}
+
+// The orbit depends only on the fractal type, its parameters and the exact
+// reference coordinate; the iteration count is not part of the key so that
+// a cached orbit can be extended when maxiter is raised.
+ReferenceOrbitKey PertEngine::orbit_key(const int bf_length, std::vector<unsigned char> center)
+{
+    ReferenceOrbitKey key;
+    key.fractal_type = g_fractal_type;
+    key.bf_length = bf_length;
+    key.center = std::move(center);
+    key.params.push_back(g_c_exponent);
+    key.params.insert(key.params.end(), g_params, g_params + 4);
+    return key;
+}
 
-        // Norm is the squared version of abs and the perturbation tolerance is squared.
-        // The reason we are storing this into an array is that we need to check the magnitude against this
-        // value to see if the value is glitched. We are leaving it squared because otherwise we'd need to do
-        // a square root operation, which is expensive, so we'll just compare this to the squared magnitude.
+// Copies as much of a cached orbit as is needed into m_xn and returns the
+// first iteration that still has to be computed: 0 when there is no usable
+// orbit, max_iteration + 1 when the cached orbit is long enough.
+int PertEngine::restore_reference_orbit(
+    const ReferenceOrbit *orbit, const std::size_t z_size, const int max_iteration)
+{
+    if (orbit == nullptr || orbit->xn.empty() || orbit->next_z.size() != z_size)
+    {
+        return 0;
+    }
+    const int count{static_cast<int>(std::min(orbit->xn.size(), static_cast<std::size_t>(max_iteration) + 1))};
+    std::copy_n(orbit->xn.begin(), count, m_xn.begin());
+    return count;
+}
 
-        m_perturbation_tolerance_check[i] = glitch_tolerance_threshold(z);
+void PertEngine::store_reference_orbit(
+    const ReferenceOrbitKey &key, std::vector<unsigned char> next_z, const int max_iteration, const bool persist)
+{
+    reference_orbit_cache().store(key, ReferenceOrbit{{m_xn.begin(), m_xn.begin() + max_iteration + 1}, std::move(next_z)}, persist);
+}
 
-        if (g_cur_fractal_specific->pert_ref == nullptr)
-        {
-            throw std::runtime_error("No reference orbit function defined for fractal type (" +
-                std::string{g_cur_fractal_specific->name} + ")");
-        }
-        g_cur_fractal_specific->pert_ref(center, z);
+// Norm is the squared version of abs and the perturbation tolerance is squared.
+// The reason we are storing this into an array is that we need to check the magnitude against this
+// value to see if the value is glitched. We are leaving it squared because otherwise we'd need to do
+// a square root operation, which is expensive, so we'll just compare this to the squared magnitude.
+void PertEngine::fill_tolerance_check(const int max_iteration)
+{
+    for (int i = 0; i <= max_iteration; i++)
+    {
+        m_perturbation_tolerance_check[i] = glitch_tolerance_threshold(m_xn[i]);
     }
 }
 
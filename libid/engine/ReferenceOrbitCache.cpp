@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "engine/ReferenceOrbitCache.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace id::engine
+{
+
+namespace
+{
+
+constexpr char FILE_MAGIC[4]{'I', 'D', 'R', 'O'};
+constexpr std::uint32_t FILE_VERSION{1};
+constexpr const char *FILE_PREFIX{"id-orbit-"};
+constexpr const char *FILE_EXTENSION{".ref"};
+
+template <typename T>
+void append(std::vector<char> &bytes, const T &value)
+{
+    const char *begin{reinterpret_cast<const char *>(&value)};
+    bytes.insert(bytes.end(), begin, begin + sizeof(T));
+}
+
+template <typename T>
+void append_vector(std::vector<char> &bytes, const std::vector<T> &values)
+{
+    append(bytes, static_cast<std::uint64_t>(values.size()));
+    const char *begin{reinterpret_cast<const char *>(values.data())};
+    bytes.insert(bytes.end(), begin, begin + values.size() * sizeof(T));
+}
+
+std::vector<char> serialize(const ReferenceOrbitKey &key)
+{
+    std::vector<char> bytes;
+    append(bytes, static_cast<std::int32_t>(key.fractal_type));
+    append(bytes, static_cast<std::int32_t>(key.bf_length));
+    append_vector(bytes, key.center);
+    append_vector(bytes, key.params);
+    return bytes;
+}
+
+// FNV-1a, only used to name the cache files
+std::uint64_t hash(const std::vector<char> &bytes)
+{
+    std::uint64_t result{0xcbf29ce484222325ULL};
+    for (const char byte : bytes)
+    {
+        result ^= static_cast<unsigned char>(byte);
+        result *= 0x100000001b3ULL;
+    }
+    return result;
+}
+
+template <typename T>
+bool read(std::istream &in, T &value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+template <typename T>
+bool read_vector(std::istream &in, std::vector<T> &values)
+{
+    std::uint64_t size{};
+    if (!read(in, size) || size > (1ULL << 40) / sizeof(T))
+    {
+        return false;
+    }
+    values.resize(static_cast<std::size_t>(size));
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(T)));
+}
+
+} // namespace
+
+ReferenceOrbitCache::ReferenceOrbitCache(const std::size_t capacity) :
+    m_capacity(std::max<std::size_t>(capacity, 1))
+{
+}
+
+void ReferenceOrbitCache::set_directory(const fs::path &dir)
+{
+    m_directory = dir;
+}
+
+std::shared_ptr<const ReferenceOrbit> ReferenceOrbitCache::find(const ReferenceOrbitKey &key)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        if (it->key == key)
+        {
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            return m_entries.front().orbit;
+        }
+    }
+
+    std::shared_ptr<const ReferenceOrbit> orbit{load(key)};
+    if (orbit)
+    {
+        insert(key, orbit);
+    }
+    return orbit;
+}
+
+void ReferenceOrbitCache::store(const ReferenceOrbitKey &key, ReferenceOrbit orbit, const bool persist)
+{
+    auto shared{std::make_shared<const ReferenceOrbit>(std::move(orbit))};
+    if (persist)
+    {
+        save(key, *shared);
+    }
+    insert(key, std::move(shared));
+}
+
+void ReferenceOrbitCache::clear()
+{
+    m_entries.clear();
+}
+
+void ReferenceOrbitCache::insert(const ReferenceOrbitKey &key, std::shared_ptr<const ReferenceOrbit> orbit)
+{
+    m_entries.remove_if([&key](const Entry &entry) { return entry.key == key; });
+    m_entries.push_front(Entry{key, std::move(orbit)});
+    while (m_entries.size() > m_capacity)
+    {
+        m_entries.pop_back();
+    }
+}
+
+fs::path ReferenceOrbitCache::file_path(const ReferenceOrbitKey &key) const
+{
+    return m_directory / fmt::format("{}{:016x}{}", FILE_PREFIX, hash(serialize(key)), FILE_EXTENSION);
+}
+
+std::shared_ptr<const ReferenceOrbit> ReferenceOrbitCache::load(const ReferenceOrbitKey &key) const
+{
+    if (m_directory.empty())
+    {
+        return {};
+    }
+
+    std::ifstream in{file_path(key), std::ios::binary};
+    if (!in)
+    {
+        return {};
+    }
+    char magic[sizeof(FILE_MAGIC)]{};
+    std::uint32_t version{};
+    std::vector<char> stored_key;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0 ||
+        !read(in, version) || version != FILE_VERSION || !read_vector(in, stored_key) ||
+        stored_key != serialize(key))
+    {
+        return {};
+    }
+    auto orbit{std::make_shared<ReferenceOrbit>()};
+    if (!read_vector(in, orbit->xn) || !read_vector(in, orbit->next_z))
+    {
+        return {};
+    }
+    return orbit;
+}
+
+void ReferenceOrbitCache::save(const ReferenceOrbitKey &key, const ReferenceOrbit &orbit) const
+{
+    if (m_directory.empty())
+    {
+        return;
+    }
+
+    std::vector<char> header;
+    header.insert(header.end(), std::begin(FILE_MAGIC), std::end(FILE_MAGIC));
+    append(header, FILE_VERSION);
+    append_vector(header, serialize(key));
+
+    const fs::path path{file_path(key)};
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        std::vector<char> body;
+        append_vector(body, orbit.xn);
+        append_vector(body, orbit.next_z);
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+        if (out)
+        {
+            prune_files();
+            return;
+        }
+    }
+    // a partial file is worse than none
+    std::error_code ec;
+    fs::remove(path, ec);
+}
+
+// Keeps only the most recently written cache files.
+void ReferenceOrbitCache::prune_files() const
+{
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+    for (const fs::directory_entry &entry : fs::directory_iterator{m_directory, ec})
+    {
+        const std::string name{entry.path().filename().string()};
+        if (name.rfind(FILE_PREFIX, 0) == 0 && entry.path().extension() == FILE_EXTENSION)
+        {
+            files.emplace_back(entry.last_write_time(ec), entry.path());
+        }
+    }
+    if (files.size() <= MAX_FILES)
+    {
+        return;
+    }
+    std::sort(files.begin(), files.end(), [](const auto &lhs, const auto &rhs) { return lhs.first > rhs.first; });
+    for (std::size_t i = MAX_FILES; i < files.size(); ++i)
+    {
+        fs::remove(files[i].second, ec);
+    }
+}
+
+ReferenceOrbitCache &reference_orbit_cache()
+{
+    static ReferenceOrbitCache cache;
+    return cache;
+}
+
+} // namespace id::engine
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "engine/SeriesApproximation.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace id::math;
+
+namespace id::engine
+{
+
+static std::complex<double> to_double(const FloatExpComplex &value)
+{
+    return {value.x.to_double(), value.y.to_double()};
+}
+
+void SeriesApproximation::compute(const std::vector<std::complex<double>> &xn, const int max_iteration,
+    const FloatExp &radius, const double magnitude_limit)
+{
+    reset();
+    if (!(radius > 0.0) || !std::isfinite(radius.mantissa()))
+    {
+        return;
+    }
+
+    // delta_0 = dc, so A_0 = 1, B_0 = C_0 = 0; with dc = radius * u the
+    // scaled coefficients are A'_0 = radius, B'_0 = C'_0 = 0.
+    FloatExpComplex a{radius, 0.0};
+    FloatExpComplex b{};
+    FloatExpComplex c{};
+    const FloatExp tolerance_squared{TOLERANCE * TOLERANCE};
+
+    // delta_{n+1} = 2 X_n delta_n + delta_n^2 + dc
+    const int last{std::min(max_iteration - 1, static_cast<int>(xn.size()) - 1)};
+    for (int n = 0; n < last; ++n)
+    {
+        const FloatExpComplex two_x{2.0 * xn[n].real(), 2.0 * xn[n].imag()};
+        FloatExpComplex next_a{two_x * a};
+        next_a.x += radius;
+        const FloatExpComplex next_b{two_x * b + a * a};
+        const FloatExpComplex next_c{two_x * c + a * b * 2.0};
+        const FloatExp norm_a{mag_squared(next_a)};
+        const FloatExp norm_c{mag_squared(next_c)};
+        if (!std::isfinite(norm_a.mantissa()) || !std::isfinite(norm_c.mantissa()) ||
+            !std::isfinite(mag_squared(next_b).mantissa()) || !(norm_c <= tolerance_squared * norm_a) ||
+            !(std::norm(xn[n + 1]) < magnitude_limit))
+        {
+            break;
+        }
+        a = next_a;
+        b = next_b;
+        c = next_c;
+        m_skip = n + 1;
+    }
+
+    if (m_skip > 0)
+    {
+        m_a = a;
+        m_b = b;
+        m_c = c;
+        m_radius = radius;
+        m_a_double = to_double(a);
+        m_b_double = to_double(b);
+        m_c_double = to_double(c);
+        m_radius_double = radius.to_double();
+    }
+}
+
+void SeriesApproximation::reset()
+{
+    m_a = {};
+    m_b = {};
+    m_c = {};
+    m_radius = {};
+    m_a_double = {};
+    m_b_double = {};
+    m_c_double = {};
+    m_radius_double = 0.0;
+    m_skip = 0;
+}
+
+std::complex<double> SeriesApproximation::delta(const std::complex<double> &delta0) const
+{
+    if (m_skip == 0)
+    {
+        return delta0;
+    }
+    const std::complex<double> u{delta0 / m_radius_double};
+    return ((m_c_double * u + m_b_double) * u + m_a_double) * u;
+}
+
+FloatExpComplex SeriesApproximation::delta(const FloatExpComplex &delta0) const
+{
+    if (m_skip == 0)
+    {
+        return delta0;
+    }
+    const FloatExpComplex u{delta0.x / m_radius, delta0.y / m_radius};
+    return ((m_c * u + m_b) * u + m_a) * u;
+}
+
+} // namespace id::engine
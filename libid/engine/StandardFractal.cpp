@@ -293,6 +293,7 @@ StandardPassStatus StandardFractal::standard_pass_status() const
     StandardPassStatus status{m_standard_pass.status()};
     status.perturbation_active = m_perturbation_active;
     status.perturbation_reference_count = m_pert_engine.reference_count();
+    status.perturbation_skipped_iterations = m_pert_engine.skipped_iterations();
     return status;
 }
 
@@ -580,10 +581,8 @@ void StandardFractal::run_perturbation_glitch_retries()
 
     const std::size_t stop_index{
         std::min(m_perturbation_retry_index + PERTURBATION_RETRY_POINTS_PER_CHUNK, m_perturbation_retry_points.size())};
-    for (; m_perturbation_retry_index < stop_index; ++m_perturbation_retry_index)
-    {
-        m_pert_engine.calculate_pixel(m_perturbation_retry_points[m_perturbation_retry_index]);
-    }
+    m_pert_engine.calculate_pixels(m_perturbation_retry_points, m_perturbation_retry_index, stop_index);
+    m_perturbation_retry_index = stop_index;
 
     if (m_perturbation_retry_index < m_perturbation_retry_points.size())
     {
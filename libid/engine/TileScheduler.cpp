@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "engine/TileScheduler.h"
+
+#include <algorithm>
+
+namespace id::engine
+{
+
+TileScheduler::TileScheduler(unsigned num_workers)
+{
+    if (num_workers == 0)
+    {
+        num_workers = std::max(1U, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < num_workers; ++i)
+    {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    // worker 0 is the thread calling run()
+    for (unsigned i = 1; i < num_workers; ++i)
+    {
+        m_threads.emplace_back(&TileScheduler::worker_main, this, i);
+    }
+}
+
+TileScheduler::~TileScheduler()
+{
+    {
+        std::lock_guard guard{m_lock};
+        m_shutdown = true;
+    }
+    m_start.notify_all();
+    for (std::thread &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void TileScheduler::run(const int num_tiles, const TileFn &tile_fn)
+{
+    if (num_tiles <= 0)
+    {
+        return;
+    }
+
+    // Deal out contiguous runs of tiles so neighbouring tiles, which tend
+    // to have similar cost, start on the same worker.
+    const unsigned workers{num_workers()};
+    for (unsigned i = 0; i < workers; ++i)
+    {
+        const int begin{static_cast<int>(static_cast<long long>(num_tiles) * i / workers)};
+        const int end{static_cast<int>(static_cast<long long>(num_tiles) * (i + 1) / workers)};
+        std::lock_guard guard{m_queues[i]->lock};
+        for (int tile = begin; tile < end; ++tile)
+        {
+            m_queues[i]->tiles.push_back(tile);
+        }
+    }
+
+    {
+        std::lock_guard guard{m_lock};
+        m_tile_fn = &tile_fn;
+        m_error = nullptr;
+        m_busy = workers - 1;
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    work(0);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock guard{m_lock};
+        m_finished.wait(guard, [this] { return m_busy == 0; });
+        m_tile_fn = nullptr;
+        error = m_error;
+        m_error = nullptr;
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+bool TileScheduler::next_tile(const unsigned worker, int &tile)
+{
+    {
+        WorkQueue &own{*m_queues[worker]};
+        std::lock_guard guard{own.lock};
+        if (!own.tiles.empty())
+        {
+            tile = own.tiles.front();
+            own.tiles.pop_front();
+            return true;
+        }
+    }
+    const unsigned workers{num_workers()};
+    for (unsigned i = 1; i < workers; ++i)
+    {
+        WorkQueue &victim{*m_queues[(worker + i) % workers]};
+        std::lock_guard guard{victim.lock};
+        if (!victim.tiles.empty())
+        {
+            tile = victim.tiles.back();
+            victim.tiles.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TileScheduler::work(const unsigned worker)
+{
+    int tile{};
+    while (next_tile(worker, tile))
+    {
+        try
+        {
+            (*m_tile_fn)(tile, worker);
+        }
+        catch (...)
+        {
+            std::lock_guard guard{m_lock};
+            if (!m_error)
+            {
+                m_error = std::current_exception();
+            }
+        }
+    }
+}
+
+void TileScheduler::worker_main(const unsigned worker)
+{
+    unsigned long generation{};
+    while (true)
+    {
+        {
+            std::unique_lock guard{m_lock};
+            m_start.wait(guard, [&] { return m_shutdown || m_generation != generation; });
+            if (m_shutdown)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        work(worker);
+
+        bool last{};
+        {
+            std::lock_guard guard{m_lock};
+            last = --m_busy == 0;
+        }
+        if (last)
+        {
+            m_finished.notify_one();
+        }
+    }
+}
+
+TileScheduler &tile_scheduler()
+{
+    static TileScheduler s_scheduler;
+    return s_scheduler;
+}
+
+} // namespace id::engine
@@ -24,6 +24,7 @@
 #include "engine/fractals.h"
 #include "engine/ImageRegion.h"
 #include "engine/Inversion.h"
+#include "engine/iteration_buffer.h"
 #include "engine/log_map.h"
 #include "engine/LogicalScreen.h"
 #include "engine/one_or_two_pass.h"
@@ -39,6 +40,7 @@
 #include "engine/StandardFractal.h"
 #include "engine/sticky_orbits.h"
 #include "engine/tesseral.h"
+#include "engine/tiled_render.h"
 #include "engine/UserData.h"
 #include "engine/VideoInfo.h"
 #include "engine/wait_until.h"
@@ -53,6 +55,7 @@
 #include "io/encoder.h"
 #include "io/library.h"
 #include "io/save_timer.h"
+#include "io/tiled_gif.h"
 #include "io/update_save_name.h"
 #include "math/biginit.h"
 #include "math/fixed_pt.h"
@@ -359,7 +362,7 @@ void sym_fill_line(const int row, const int left, const int right, const Byte *s
 // The sym_put_line() routine is the symmetry-aware version of put_line().
 // It only works efficiently in the no symmetry or X_AXIS symmetry case,
 // otherwise it just writes the pixels one-by-one.
-static void sym_put_line(const int row, const int left, const int right, const Byte *str)
+void sym_put_line(const int row, const int left, const int right, const Byte *str)
 {
     const int length = right-left+1;
     write_span(row, left, right, str);
@@ -386,6 +389,13 @@ static void sym_put_line(const int row, const int left, const int right, const B
     }
 }
 
+// Rows plotted in scan order can go to the screen a span at a time with
+// sym_put_line() when g_plot is the plain or X-axis symmetry screen plot.
+bool plot_rows_by_span()
+{
+    return g_put_color == put_color_a && (g_plot == put_color_a || g_plot == sym_plot2);
+}
+
 static void show_dot_save_restore(
     int start_x, int stop_x, const int start_y, const int stop_y,
     const ShowDotDirection direction, const ShowDotAction action)
@@ -618,6 +628,8 @@ static void init_calc_fract()
         }
     }
 
+    start_iteration_buffer(resuming);
+
     init_misc(); // set up some variables in parser.c
     reset_wait_until();
 
@@ -648,100 +660,7 @@ static void init_calc_fract()
         g_first_saved_and = static_cast<long>(g_periodicity_next_saved_incr * 2 + 1);
     }
 
-    g_log_map_table.clear();
-    g_log_map_table_max_size = g_max_iterations;
-    g_log_map_calculate = false;
-    // below, 32767 is used as the allowed value for maximum iteration count for
-    // historical reasons.  TODO: increase this limit
-    if (g_log_map_flag
-        && ((g_max_iterations > 32767 && !(g_version <= 1920))
-            || g_log_map_fly_calculate == LogMapCalculate::ON_THE_FLY))
-    {
-        g_log_map_calculate = true; // calculate on the fly
-        setup_log_table();
-    }
-    else if (g_log_map_flag
-        && ((g_max_iterations > 32767 && g_version <= 1920)
-            || g_log_map_fly_calculate == LogMapCalculate::USE_LOG_TABLE))
-    {
-        g_log_map_table_max_size = 32767;
-        g_log_map_calculate = false; // use logtable
-    }
-    else if (!g_iteration_ranges.empty() && g_max_iterations >= 32767)
-    {
-        g_log_map_table_max_size = 32766;
-    }
-
-    if ((g_log_map_flag || !g_iteration_ranges.empty()) && !g_log_map_calculate)
-    {
-        bool resized = false;
-        try
-        {
-            g_log_map_table.resize(g_log_map_table_max_size + 1);
-            resized = true;
-        }
-        catch (const std::bad_alloc &)
-        {
-        }
-
-        if (!resized)
-        {
-            if (!g_iteration_ranges.empty() || g_log_map_fly_calculate == LogMapCalculate::USE_LOG_TABLE)
-            {
-                stop_msg("Insufficient memory for logmap/ranges with this maxiter");
-            }
-            else
-            {
-                stop_msg("Insufficient memory for logTable, using on-the-fly routine");
-                g_log_map_fly_calculate = LogMapCalculate::ON_THE_FLY;
-                g_log_map_calculate = true; // calculate on the fly
-                setup_log_table();
-            }
-        }
-        else if (!g_iteration_ranges.empty())
-        {
-            // Can't do ranges if MaxLTSize > 32767
-            int l = 0;
-            int k = 0;
-            int i = 0;
-            g_log_map_flag = 0; // ranges overrides logmap
-            while (i < static_cast<int>(g_iteration_ranges.size()))
-            {
-                int flip = 0;
-                int m = 0;
-                int altern = 32767;
-                int num_val = g_iteration_ranges[i++];
-                if (num_val < 0)
-                {
-                    altern = g_iteration_ranges[i++];    // sub-range iterations
-                    num_val = g_iteration_ranges[i++];
-                }
-                if (num_val > static_cast<int>(g_log_map_table_max_size) || i >= static_cast<int>(g_iteration_ranges.size()))
-                {
-                    num_val = static_cast<int>(g_log_map_table_max_size);
-                }
-                while (l <= num_val)
-                {
-                    g_log_map_table[l++] = static_cast<Byte>(k + flip);
-                    if (++m >= altern)
-                    {
-                        flip ^= 1;            // Alternate colors
-                        m = 0;
-                    }
-                }
-                ++k;
-                if (altern != 32767)
-                {
-                    ++k;
-                }
-            }
-        }
-        else
-        {
-            setup_log_table();
-        }
-    }
-
+    init_log_map();
     init_atan_colors();
 
     // ORBIT stuff
@@ -869,9 +788,31 @@ static void calc_non_standard_fractal()
     }
 }
 
+// In batch mode with tiledgif= the image is rendered at the requested size
+// straight into the save file, tile by tile, instead of onto the screen.
+static bool tiled_gif_requested()
+{
+    return g_init_batch != BatchMode::NONE && g_tiled_render.enabled();
+}
+
+static void calc_tiled_gif()
+{
+    g_dispatch.init_calc_type(*g_cur_fractal_specific);
+    g_calc_status = CalcStatus::IN_PROGRESS;
+    per_image();
+    std::filesystem::path name{g_save_filename};
+    if (!name.has_extension())
+    {
+        name.replace_extension(DEFAULT_FRACTAL_TYPE);
+    }
+    const std::filesystem::path path{get_checked_save_path(WriteFile::IMAGE, name)};
+    g_calc_status = write_tiled_gif(path) ? CalcStatus::COMPLETED : CalcStatus::NON_RESUMABLE;
+}
+
 static void finish_calc_fract()
 {
     g_calc_time += g_timer_interval;
+    stop_iteration_buffer(g_calc_status == CalcStatus::COMPLETED);
 
     if (!g_log_map_table.empty() && !g_log_map_calculate)
     {
@@ -893,7 +834,11 @@ static void finish_calc_fract()
 int calc_fract()
 {
     init_calc_fract();
-    if (static_calc_type_uses_lyapunov_renderer())
+    if (tiled_gif_requested())
+    {
+        calc_tiled_gif();
+    }
+    else if (static_calc_type_uses_lyapunov_renderer())
     {
         lyapunov_fractal();
     }
@@ -915,6 +860,103 @@ void init_atan_colors()
     g_atan_colors = g_version > 2002 ? g_colors : 180;
 }
 
+void init_log_map()
+{
+    g_log_map_table.clear();
+    g_log_map_table_max_size = g_max_iterations;
+    g_log_map_calculate = false;
+    // below, 32767 is used as the allowed value for maximum iteration count for
+    // historical reasons.  TODO: increase this limit
+    if (g_log_map_flag
+        && ((g_max_iterations > 32767 && !(g_version <= 1920))
+            || g_log_map_fly_calculate == LogMapCalculate::ON_THE_FLY))
+    {
+        g_log_map_calculate = true; // calculate on the fly
+        setup_log_table();
+    }
+    else if (g_log_map_flag
+        && ((g_max_iterations > 32767 && g_version <= 1920)
+            || g_log_map_fly_calculate == LogMapCalculate::USE_LOG_TABLE))
+    {
+        g_log_map_table_max_size = 32767;
+        g_log_map_calculate = false; // use logtable
+    }
+    else if (!g_iteration_ranges.empty() && g_max_iterations >= 32767)
+    {
+        g_log_map_table_max_size = 32766;
+    }
+
+    if ((g_log_map_flag || !g_iteration_ranges.empty()) && !g_log_map_calculate)
+    {
+        bool resized = false;
+        try
+        {
+            g_log_map_table.resize(g_log_map_table_max_size + 1);
+            resized = true;
+        }
+        catch (const std::bad_alloc &)
+        {
+        }
+
+        if (!resized)
+        {
+            if (!g_iteration_ranges.empty() || g_log_map_fly_calculate == LogMapCalculate::USE_LOG_TABLE)
+            {
+                stop_msg("Insufficient memory for logmap/ranges with this maxiter");
+            }
+            else
+            {
+                stop_msg("Insufficient memory for logTable, using on-the-fly routine");
+                g_log_map_fly_calculate = LogMapCalculate::ON_THE_FLY;
+                g_log_map_calculate = true; // calculate on the fly
+                setup_log_table();
+            }
+        }
+        else if (!g_iteration_ranges.empty())
+        {
+            // Can't do ranges if MaxLTSize > 32767
+            int l = 0;
+            int k = 0;
+            int i = 0;
+            g_log_map_flag = 0; // ranges overrides logmap
+            while (i < static_cast<int>(g_iteration_ranges.size()))
+            {
+                int flip = 0;
+                int m = 0;
+                int altern = 32767;
+                int num_val = g_iteration_ranges[i++];
+                if (num_val < 0)
+                {
+                    altern = g_iteration_ranges[i++];    // sub-range iterations
+                    num_val = g_iteration_ranges[i++];
+                }
+                if (num_val > static_cast<int>(g_log_map_table_max_size) || i >= static_cast<int>(g_iteration_ranges.size()))
+                {
+                    num_val = static_cast<int>(g_log_map_table_max_size);
+                }
+                while (l <= num_val)
+                {
+                    g_log_map_table[l++] = static_cast<Byte>(k + flip);
+                    if (++m >= altern)
+                    {
+                        flip ^= 1;            // Alternate colors
+                        m = 0;
+                    }
+                }
+                ++k;
+                if (altern != 32767)
+                {
+                    ++k;
+                }
+            }
+        }
+        else
+        {
+            setup_log_table();
+        }
+    }
+}
+
 // locate alternate math record
 int find_alternate_math(const FractalType type, const BFMathType math)
 {
@@ -1119,43 +1161,59 @@ int calc_mandelbrot_type()
     }
     if (mandelbrot_orbit() >= 0)
     {
-        if (g_potential.flag)
-        {
-            g_color_iter = potential(g_magnitude, g_real_color_iter);
-        }
-        if ((!g_log_map_table.empty() || g_log_map_calculate) // map color, but not if maxit & adjusted for inside,etc
-            && (g_real_color_iter < g_max_iterations
-                || (g_inside_method != ColorMethod::COLOR && g_color_iter == g_max_iterations)))
-        {
-            g_color_iter = log_table_calc(g_color_iter);
-        }
-        g_color = std::abs(g_color_iter);
-        if (g_color_iter >= g_colors)
+        return plot_mandelbrot_color();
+    }
+    g_color = static_cast<int>(g_color_iter);
+    return g_color;
+}
+
+// maps g_color_iter from mandelbrot_orbit() to g_color and plots it at g_col, g_row
+int plot_mandelbrot_color()
+{
+    g_color = mandelbrot_color(g_color_iter, g_real_color_iter, g_magnitude);
+    set_pixel_iteration(g_real_color_iter, g_new_z);
+    g_plot(g_col, g_row, g_color);
+    clear_pixel_iteration();
+    return g_color;
+}
+
+// maps color_iter from mandelbrot_orbit() to a color, adjusting color_iter
+// for potential and log map; unless 16 bit potential is stored, when
+// potential() writes to disk video at g_col, g_row, it reads only render
+// settings, so it can run on any thread
+int mandelbrot_color(long &color_iter, const long real_color_iter, const double magnitude)
+{
+    if (g_potential.flag)
+    {
+        color_iter = potential(magnitude, real_color_iter);
+    }
+    if ((!g_log_map_table.empty() || g_log_map_calculate) // map color, but not if maxit & adjusted for inside,etc
+        && (real_color_iter < g_max_iterations
+            || (g_inside_method != ColorMethod::COLOR && color_iter == g_max_iterations)))
+    {
+        color_iter = log_table_calc(color_iter);
+    }
+    int color = static_cast<int>(std::abs(color_iter));
+    if (color_iter >= g_colors)
+    {
+        // don't use color 0 unless from inside/outside
+        if (g_colors < 16)
         {
-            // don't use color 0 unless from inside/outside
-            if (g_colors < 16)
-            {
-                g_color = static_cast<int>(g_color_iter & g_and_color);
-            }
-            else
-            {
-                g_color = static_cast<int>((g_color_iter - 1) % g_and_color + 1);
-            }
+            color = static_cast<int>(color_iter & g_and_color);
         }
-        if (g_debug_flag != DebugFlags::FORCE_BOUNDARY_TRACE_ERROR)
+        else
         {
-            if (g_color == 0 && g_std_calc_mode == CalcMode::BOUNDARY_TRACE)
-            {
-                g_color = 1;
-            }
+            color = static_cast<int>((color_iter - 1) % g_and_color + 1);
         }
-        g_plot(g_col, g_row, g_color);
     }
-    else
+    if (g_debug_flag != DebugFlags::FORCE_BOUNDARY_TRACE_ERROR)
     {
-        g_color = static_cast<int>(g_color_iter);
+        if (color == 0 && g_std_calc_mode == CalcMode::BOUNDARY_TRACE)
+        {
+            color = 1;
+        }
     }
-    return g_color;
+    return color;
 }
 
 static void set_new_z_from_bignum()
@@ -1170,6 +1228,159 @@ static void set_new_z_from_bignum()
     }
 }
 
+// saves g_color_iter before the coloring methods adjust it
+void save_color_iter()
+{
+    g_real_color_iter = g_color_iter;           // save this before we start adjusting it
+    if (g_color_iter >= g_max_iterations)
+    {
+        g_old_color_iter = 0;         // check periodicity immediately next time
+    }
+    else
+    {
+        g_old_color_iter = g_color_iter + 10;    // check when past this + 10 next time
+        if (g_color_iter == 0)
+        {
+            g_color_iter = 1;         // needed to make same as calcmand
+        }
+    }
+}
+
+// outside methods for an escaped point, from the final g_new_z; fmod and
+// tdis color by the orbit's closest approach and total distance
+void outside_method_color(const double mem_value, const double total_dist)
+{
+    // Add 7 to overcome negative values on the MANDEL
+    if (g_outside_method == ColorMethod::REAL)
+    {
+        g_color_iter += static_cast<long>(g_new_z.x) + 7;
+    }
+    else if (g_outside_method == ColorMethod::IMAG)
+    {
+        g_color_iter += static_cast<long>(g_new_z.y) + 7;
+    }
+    else if (g_outside_method == ColorMethod::MULT  && g_new_z.y)
+    {
+        g_color_iter = static_cast<long>(static_cast<double>(g_color_iter) * (g_new_z.x / g_new_z.y));
+    }
+    else if (g_outside_method == ColorMethod::SUM)
+    {
+        g_color_iter += static_cast<long>(g_new_z.x + g_new_z.y);
+    }
+    else if (g_outside_method == ColorMethod::ATAN)
+    {
+        g_color_iter = static_cast<long>(std::abs(std::atan2(g_new_z.y, g_new_z.x) * g_atan_colors / PI));
+    }
+    else if (g_outside_method == ColorMethod::FMOD)
+    {
+        g_color_iter = static_cast<long>(mem_value * g_colors / g_close_proximity);
+    }
+    else if (g_outside_method == ColorMethod::TDIS)
+    {
+        g_color_iter = static_cast<long>(total_dist);
+    }
+
+    // eliminate negative colors & wrap arounds
+    if ((g_color_iter <= 0 || g_color_iter > g_max_iterations) && g_outside_method != ColorMethod::FMOD)
+    {
+        g_color_iter = g_version < 1961 ? 0 : 1;
+    }
+}
+
+// decomposition or biomorph, then the outside color or log map of an
+// escaped point
+void escaped_color(const bool attracted)
+{
+    if (g_decomp[0] > 0)
+    {
+        decomposition();
+    }
+    else if (g_biomorph != -1)
+    {
+        if (std::abs(g_new_z.x) < g_magnitude_limit2 || std::abs(g_new_z.y) < g_magnitude_limit2)
+        {
+            g_color_iter = g_biomorph;
+        }
+    }
+
+    if (g_outside_method >= ColorMethod::COLOR && !attracted) // merge escape-time stripes
+    {
+        g_color_iter = g_outside_color;
+    }
+    else if (!g_log_map_table.empty() || g_log_map_calculate)
+    {
+        g_color_iter = log_table_calc(g_color_iter);
+    }
+}
+
+// colors a point that reached maxit, unless its inside method needs the
+// orbit's statistics; then it returns false and leaves g_color_iter alone
+bool inside_color(const bool caught_a_cycle)
+{
+    if (g_periodicity_check < 0 && caught_a_cycle)
+    {
+        g_color_iter = 7;           // show periodicity
+        return true;
+    }
+    if (g_inside_method >= ColorMethod::COLOR)
+    {
+        g_color_iter = g_inside_color;              // set to specified color, ignore logpal
+        return true;
+    }
+    switch (g_inside_method)
+    {
+    case ColorMethod::STAR_TRAIL:
+    case ColorMethod::PERIOD:
+    case ColorMethod::EPS_CROSS:
+    case ColorMethod::FMODI:
+    case ColorMethod::BOF60:
+    case ColorMethod::BOF61:
+        return false;
+
+    case ColorMethod::ATANI:                        // "atan"
+        g_color_iter = static_cast<long>(std::abs(std::atan2(g_new_z.y, g_new_z.x) * g_atan_colors / PI));
+        break;
+
+    case ColorMethod::ZMAG:
+        g_color_iter = static_cast<long>((sqr(g_new_z.x) + sqr(g_new_z.y)) * (g_max_iterations >> 1) + 1);
+        break;
+
+    default:                                        // inside == -1
+        g_color_iter = g_max_iterations;
+        break;
+    }
+    if (!g_log_map_table.empty() || g_log_map_calculate)
+    {
+        g_color_iter = log_table_calc(g_color_iter);
+    }
+    return true;
+}
+
+// maps the adjusted g_color_iter to g_color
+void color_from_color_iter()
+{
+    g_color = std::abs(g_color_iter);
+    if (g_color_iter >= g_colors)
+    {
+        // don't use color 0 unless from inside/outside
+        if (g_colors < 16)
+        {
+            g_color = static_cast<int>(g_color_iter & g_and_color);
+        }
+        else
+        {
+            g_color = static_cast<int>((g_color_iter - 1) % g_and_color + 1);
+        }
+    }
+    if (g_debug_flag != DebugFlags::FORCE_BOUNDARY_TRACE_ERROR)
+    {
+        if (g_color <= 0 && g_std_calc_mode == CalcMode::BOUNDARY_TRACE)
+        {
+            g_color = 1;
+        }
+    }
+}
+
 // per pixel 1/2/b/g, called with g_row & g_col set
 int standard_fractal_type()
 {
@@ -1672,19 +1883,7 @@ int StandardFractal::calculate_standard_pixel(const bool yield_to_ui)
         return -1;
     }
 
-    g_real_color_iter = g_color_iter;           // save this before we start adjusting it
-    if (g_color_iter >= g_max_iterations)
-    {
-        g_old_color_iter = 0;         // check periodicity immediately next time
-    }
-    else
-    {
-        g_old_color_iter = g_color_iter + 10;    // check when past this + 10 next time
-        if (g_color_iter == 0)
-        {
-            g_color_iter = 1;         // needed to make same as calcmand
-        }
-    }
+    save_color_iter();
 
     if (g_potential.flag)
     {
@@ -1715,41 +1914,7 @@ int StandardFractal::calculate_standard_pixel(const bool yield_to_ui)
     if (g_outside_method < ColorMethod::ITER)
     {
         set_new_z_from_bignum();
-        // Add 7 to overcome negative values on the MANDEL
-        if (g_outside_method == ColorMethod::REAL)
-        {
-            g_color_iter += static_cast<long>(g_new_z.x) + 7;
-        }
-        else if (g_outside_method == ColorMethod::IMAG)
-        {
-            g_color_iter += static_cast<long>(g_new_z.y) + 7;
-        }
-        else if (g_outside_method == ColorMethod::MULT  && g_new_z.y)
-        {
-            g_color_iter = static_cast<long>(static_cast<double>(g_color_iter) * (g_new_z.x / g_new_z.y));
-        }
-        else if (g_outside_method == ColorMethod::SUM)
-        {
-            g_color_iter += static_cast<long>(g_new_z.x + g_new_z.y);
-        }
-        else if (g_outside_method == ColorMethod::ATAN)
-        {
-            g_color_iter = static_cast<long>(std::abs(std::atan2(g_new_z.y, g_new_z.x) * g_atan_colors / PI));
-        }
-        else if (g_outside_method == ColorMethod::FMOD)
-        {
-            g_color_iter = static_cast<long>(m_mem_value * g_colors / g_close_proximity);
-        }
-        else if (g_outside_method == ColorMethod::TDIS)
-        {
-            g_color_iter = static_cast<long>(m_total_dist);
-        }
-
-        // eliminate negative colors & wrap arounds
-        if ((g_color_iter <= 0 || g_color_iter > g_max_iterations) && g_outside_method != ColorMethod::FMOD)
-        {
-            g_color_iter = g_version < 1961 ? 0 : 1;
-        }
+        outside_method_color(m_mem_value, m_total_dist);
     }
 
     if (g_distance_estimator)
@@ -1803,38 +1968,11 @@ int StandardFractal::calculate_standard_pixel(const bool yield_to_ui)
         // use pixel's "regular" color
     }
 
-    if (g_decomp[0] > 0)
-    {
-        decomposition();
-    }
-    else if (g_biomorph != -1)
-    {
-        if (std::abs(g_new_z.x) < g_magnitude_limit2 || std::abs(g_new_z.y) < g_magnitude_limit2)
-        {
-            g_color_iter = g_biomorph;
-        }
-    }
-
-    if (g_outside_method >= ColorMethod::COLOR && !m_attracted) // merge escape-time stripes
-    {
-        g_color_iter = g_outside_color;
-    }
-    else if (!g_log_map_table.empty() || g_log_map_calculate)
-    {
-        g_color_iter = log_table_calc(g_color_iter);
-    }
+    escaped_color(m_attracted);
     goto plot_pixel;
 
 plot_inside: // we're "inside"
-    if (g_periodicity_check < 0 && m_caught_a_cycle)
-    {
-        g_color_iter = 7;           // show periodicity
-    }
-    else if (g_inside_method >= ColorMethod::COLOR)
-    {
-        g_color_iter = g_inside_color;              // set to specified color, ignore logpal
-    }
-    else
+    if (!inside_color(m_caught_a_cycle))
     {
         if (g_inside_method == ColorMethod::STAR_TRAIL)
         {
@@ -1884,10 +2022,6 @@ plot_inside: // we're "inside"
         {
             g_color_iter = static_cast<long>(m_mem_value * g_colors / g_close_proximity);
         }
-        else if (g_inside_method == ColorMethod::ATANI)            // "atan"
-        {
-            g_color_iter = static_cast<long>(std::abs(std::atan2(g_new_z.y, g_new_z.x) * g_atan_colors / PI));
-        }
         else if (g_inside_method == ColorMethod::BOF60)
         {
             g_color_iter = static_cast<long>(std::sqrt(m_min_orbit) * 75);
@@ -1896,14 +2030,6 @@ plot_inside: // we're "inside"
         {
             g_color_iter = m_min_index;
         }
-        else if (g_inside_method == ColorMethod::ZMAG)
-        {
-            g_color_iter = static_cast<long>((sqr(g_new_z.x) + sqr(g_new_z.y)) * (g_max_iterations >> 1) + 1);
-        }
-        else   // inside == -1
-        {
-            g_color_iter = g_max_iterations;
-        }
         if (!g_log_map_table.empty() || g_log_map_calculate)
         {
             g_color_iter = log_table_calc(g_color_iter);
@@ -1911,28 +2037,10 @@ plot_inside: // we're "inside"
     }
 
 plot_pixel:
-
-    g_color = std::abs(g_color_iter);
-    if (g_color_iter >= g_colors)
-    {
-        // don't use color 0 unless from inside/outside
-        if (g_colors < 16)
-        {
-            g_color = static_cast<int>(g_color_iter & g_and_color);
-        }
-        else
-        {
-            g_color = static_cast<int>((g_color_iter - 1) % g_and_color + 1);
-        }
-    }
-    if (g_debug_flag != DebugFlags::FORCE_BOUNDARY_TRACE_ERROR)
-    {
-        if (g_color <= 0 && g_std_calc_mode == CalcMode::BOUNDARY_TRACE)
-        {
-            g_color = 1;
-        }
-    }
+    color_from_color_iter();
+    set_pixel_iteration(g_real_color_iter, g_new_z);
     g_plot(g_col, g_row, g_color);
+    clear_pixel_iteration();
 
     g_max_iterations = m_save_max_it;
     clear_standard_pixel();
@@ -9,6 +9,8 @@
 
 #include "engine/calcfrac.h"
 #include "engine/fractals.h"
+#include "engine/pixel_grid.h"
+#include "engine/simd_escape.h"
 #include "fractals/fractype.h"
 #include "misc/id.h"
 
@@ -16,6 +18,7 @@
 #include <cmath>
 
 using namespace id::fractals;
+using namespace id::math;
 
 namespace id::engine
 {
@@ -30,7 +33,32 @@ void calc_mandelbrot_init()
     g_old_color_iter = 0;
 }
 
-long mandelbrot_orbit()
+MandelbrotContext mandelbrot_context()
+{
+    MandelbrotContext ctx;
+    ctx.param_z1 = g_param_z1;
+    ctx.magnitude_limit = g_magnitude_limit;
+    ctx.close_enough = g_close_enough;
+    ctx.max_iterations = g_max_iterations;
+    ctx.first_saved_and = g_first_saved_and;
+    ctx.next_saved_incr = g_periodicity_next_saved_incr;
+    ctx.periodicity_check = g_periodicity_check;
+    ctx.julia = g_fractal_type == FractalType::JULIA;
+    ctx.outside_method = g_outside_method;
+    ctx.outside_color = g_outside_color;
+    ctx.atan_colors = g_atan_colors;
+    ctx.inside_color = s_inside_color;
+    ctx.periodicity_color = s_periodicity_color;
+    return ctx;
+}
+
+long mandelbrot_orbit(const DComplex &init, const bool reset_periodicity, MandelbrotOrbit &orbit)
+{
+    return mandelbrot_orbit(mandelbrot_context(), init, reset_periodicity, orbit);
+}
+
+long mandelbrot_orbit(
+    const MandelbrotContext &ctx, const DComplex &init, const bool reset_periodicity, MandelbrotOrbit &orbit)
 {
     double x;
     double y;
@@ -40,43 +68,42 @@ long mandelbrot_orbit()
     double c_x;
     double c_y;
 
-    if (g_periodicity_check == 0)
+    if (ctx.periodicity_check == 0)
     {
-        g_old_color_iter = 0;      // don't check periodicity
+        orbit.old_color_iter = 0;  // don't check periodicity
     }
-    else if (g_reset_periodicity)
+    else if (reset_periodicity)
     {
-        g_old_color_iter = g_max_iterations - 255;
+        orbit.old_color_iter = ctx.max_iterations - 255;
     }
 
-    const long tmp_fsd = g_max_iterations - g_first_saved_and;
+    const long tmp_fsd = ctx.max_iterations - ctx.first_saved_and;
     // this defeats checking periodicity immediately
     // but matches the code in standard_fractal()
-    g_old_color_iter = std::min(g_old_color_iter, tmp_fsd);
+    orbit.old_color_iter = std::min(orbit.old_color_iter, tmp_fsd);
 
     // initparms
     double saved_x = 0;
     double saved_y = 0;
-    g_orbit_save_flag = false;
-    long saved_and = g_first_saved_and;
+    long saved_and = ctx.first_saved_and;
     int saved_incr = 1;             // start checking the very first time
 
-    long cx = g_max_iterations;
-    if (g_fractal_type != FractalType::JULIA)
+    long cx = ctx.max_iterations;
+    if (!ctx.julia)
     {
         // Mandelbrot_87
-        c_x = g_init.x;
-        c_y = g_init.y;
-        x = g_param_z1.x+c_x;
-        y = g_param_z1.y+c_y;
+        c_x = init.x;
+        c_y = init.y;
+        x = ctx.param_z1.x+c_x;
+        y = ctx.param_z1.y+c_y;
     }
     else
     {
         // dojulia_87
-        c_x = g_param_z1.x;
-        c_y = g_param_z1.y;
-        x = g_init.x;
-        y = g_init.y;
+        c_x = ctx.param_z1.x;
+        c_y = ctx.param_z1.y;
+        x = init.x;
+        y = init.y;
         x2 = x*x;
         y2 = y*y;
         xy = x*y;
@@ -95,17 +122,18 @@ long mandelbrot_orbit()
         x2 = x*x;
         y2 = y*y;
         xy = x*y;
-        g_magnitude = x2+y2;
+        orbit.magnitude = x2+y2;
 
-        if (g_magnitude >= g_magnitude_limit)
+        if (orbit.magnitude >= ctx.magnitude_limit)
         {
-            goto over_bailout_87;
+            mandelbrot_orbit_escaped(ctx, cx, x, y, orbit);
+            return orbit.color_iter;
         }
 
         // no_save_new_xy_87
-        if (cx < g_old_color_iter)  // check periodicity
+        if (cx < orbit.old_color_iter)  // check periodicity
         {
-            if ((g_max_iterations - cx & saved_and) == 0)
+            if ((ctx.max_iterations - cx & saved_and) == 0)
             {
                 saved_x = x;
                 saved_y = y;
@@ -113,93 +141,148 @@ long mandelbrot_orbit()
                 if (saved_incr == 0)
                 {
                     saved_and = (saved_and << 1) + 1;
-                    saved_incr = g_periodicity_next_saved_incr;
+                    saved_incr = ctx.next_saved_incr;
                 }
             }
             else
             {
-                if (std::abs(saved_x-x) < g_close_enough && std::abs(saved_y-y) < g_close_enough)
+                if (std::abs(saved_x-x) < ctx.close_enough && std::abs(saved_y-y) < ctx.close_enough)
                 {
-                    //          oldcoloriter = 65535;
-                    g_old_color_iter = g_max_iterations;
-                    g_real_color_iter = g_max_iterations;
-                    g_keyboard_check_interval = g_keyboard_check_interval -(g_max_iterations-cx);
-                    g_color_iter = s_periodicity_color;
-                    goto pop_stack;
+                    mandelbrot_orbit_periodic(ctx, cx, orbit);
+                    return orbit.color_iter;
                 }
             }
         }
     } // while (--cx > 0)
 
-    // reached maxit
-    // check periodicity immediately next time, remember we count down from maxit
-    g_old_color_iter = g_max_iterations;
-    g_keyboard_check_interval -= g_max_iterations;
-    g_real_color_iter = g_max_iterations;
-    g_color_iter = s_inside_color;
-
-pop_stack:
-    return g_color_iter;
+    mandelbrot_orbit_inside(ctx, orbit);
+    return orbit.color_iter;
+}
 
-over_bailout_87:
-    if (g_outside_method <= ColorMethod::REAL)
-    {
-        g_new_z.x = x;
-        g_new_z.y = y;
-    }
+void mandelbrot_orbit_escaped(const MandelbrotContext &ctx, const long cx, const double x, const double y, MandelbrotOrbit &orbit)
+{
+    orbit.new_z.x = x;
+    orbit.new_z.y = y;
     if (cx-10 > 0)
     {
-        g_old_color_iter = cx-10;
+        orbit.old_color_iter = cx-10;
     }
     else
     {
-        g_old_color_iter = 0;
+        orbit.old_color_iter = 0;
     }
-    g_real_color_iter = g_max_iterations-cx;
-    g_color_iter = g_real_color_iter;
-    if (g_color_iter == 0)
+    orbit.real_color_iter = ctx.max_iterations-cx;
+    orbit.color_iter = orbit.real_color_iter;
+    if (orbit.color_iter == 0)
     {
-        g_color_iter = 1;
+        orbit.color_iter = 1;
     }
-    g_keyboard_check_interval -= g_real_color_iter;
-    if (g_outside_method == ColorMethod::ITER)
+    orbit.iterations = orbit.real_color_iter;
+    if (ctx.outside_method == ColorMethod::ITER)
     {
     }
-    else if (g_outside_method > ColorMethod::REAL)
+    else if (ctx.outside_method > ColorMethod::REAL)
     {
-        g_color_iter = g_outside_color;
+        orbit.color_iter = ctx.outside_color;
     }
     else
     {
         // special_outside
-        if (g_outside_method == ColorMethod::REAL)
+        if (ctx.outside_method == ColorMethod::REAL)
         {
-            g_color_iter += static_cast<long>(g_new_z.x) + 7;
+            orbit.color_iter += static_cast<long>(orbit.new_z.x) + 7;
         }
-        else if (g_outside_method == ColorMethod::IMAG)
+        else if (ctx.outside_method == ColorMethod::IMAG)
         {
-            g_color_iter += static_cast<long>(g_new_z.y) + 7;
+            orbit.color_iter += static_cast<long>(orbit.new_z.y) + 7;
         }
-        else if (g_outside_method == ColorMethod::MULT && g_new_z.y != 0.0)
+        else if (ctx.outside_method == ColorMethod::MULT && orbit.new_z.y != 0.0)
         {
-            g_color_iter = static_cast<long>(static_cast<double>(g_color_iter) * (g_new_z.x / g_new_z.y));
+            orbit.color_iter =
+                static_cast<long>(static_cast<double>(orbit.color_iter) * (orbit.new_z.x / orbit.new_z.y));
         }
-        else if (g_outside_method == ColorMethod::SUM)
+        else if (ctx.outside_method == ColorMethod::SUM)
         {
-            g_color_iter += static_cast<long>(g_new_z.x + g_new_z.y);
+            orbit.color_iter += static_cast<long>(orbit.new_z.x + orbit.new_z.y);
         }
-        else if (g_outside_method == ColorMethod::ATAN)
+        else if (ctx.outside_method == ColorMethod::ATAN)
         {
-            g_color_iter = static_cast<long>(std::abs(std::atan2(g_new_z.y, g_new_z.x) * g_atan_colors / PI));
+            orbit.color_iter =
+                static_cast<long>(std::abs(std::atan2(orbit.new_z.y, orbit.new_z.x) * ctx.atan_colors / PI));
         }
         // check_color
-        if ((g_color_iter <= 0 || g_color_iter > g_max_iterations) && g_outside_method != ColorMethod::FMOD)
+        if ((orbit.color_iter <= 0 || orbit.color_iter > ctx.max_iterations) && ctx.outside_method != ColorMethod::FMOD)
         {
-            g_color_iter = 1;
+            orbit.color_iter = 1;
         }
     }
+}
+
+void mandelbrot_orbit_periodic(const MandelbrotContext &ctx, const long cx, MandelbrotOrbit &orbit)
+{
+    //          oldcoloriter = 65535;
+    orbit.old_color_iter = ctx.max_iterations;
+    orbit.real_color_iter = ctx.max_iterations;
+    orbit.iterations = ctx.max_iterations-cx;
+    orbit.color_iter = ctx.periodicity_color;
+}
+
+void mandelbrot_orbit_inside(const MandelbrotContext &ctx, MandelbrotOrbit &orbit)
+{
+    // reached maxit
+    // check periodicity immediately next time, remember we count down from maxit
+    orbit.old_color_iter = ctx.max_iterations;
+    orbit.iterations = ctx.max_iterations;
+    orbit.real_color_iter = ctx.max_iterations;
+    orbit.color_iter = ctx.inside_color;
+}
+
+long mandelbrot_orbit()
+{
+    MandelbrotOrbit orbit;
+    orbit.new_z = g_new_z;
+    orbit.magnitude = g_magnitude;
+    orbit.color_iter = g_color_iter;
+    orbit.real_color_iter = g_real_color_iter;
+    orbit.old_color_iter = g_old_color_iter;
+    g_orbit_save_flag = false;
+
+    mandelbrot_orbit(g_init, g_reset_periodicity, orbit);
+
+    g_new_z = orbit.new_z;
+    g_magnitude = orbit.magnitude;
+    g_color_iter = orbit.color_iter;
+    g_real_color_iter = orbit.real_color_iter;
+    g_old_color_iter = orbit.old_color_iter;
+    g_keyboard_check_interval -= orbit.iterations;
+    return g_color_iter;
+}
+
+void mandelbrot_orbit_row(const int row, const int first_col, const int last_col, MandelbrotOrbit *orbits)
+{
+    MandelbrotContext ctx{mandelbrot_context()};
+    ctx.simd = use_simd_escape();
+    mandelbrot_orbit_row(ctx, pixel_grid(), row, first_col, last_col, orbits);
+}
+
+void mandelbrot_orbit_row(const MandelbrotContext &ctx, const PixelGrid &grid, const int row, const int first_col,
+    const int last_col, MandelbrotOrbit *orbits)
+{
+    if (ctx.simd)
+    {
+        simd_escape_row(ctx, grid, row, first_col, last_col, orbits);
+        return;
+    }
 
-    goto pop_stack;
+    // each row starts with fresh periodicity checking, as in the one pass scan
+    MandelbrotOrbit orbit;
+    bool reset_periodicity{true};
+    for (int col = first_col; col <= last_col; ++col)
+    {
+        mandelbrot_orbit(ctx, {grid.dx(col, row), grid.dy(col, row)}, reset_periodicity, orbit);
+        reset_periodicity = false;
+        *orbits++ = orbit;
+    }
 }
 
 } // namespace id::engine
@@ -18,6 +18,7 @@
 #include "engine/get_prec_big_float.h"
 #include "engine/ImageRegion.h"
 #include "engine/Inversion.h"
+#include "engine/iteration_buffer.h"
 #include "engine/load_params.h"
 #include "engine/log_map.h"
 #include "engine/LogicalScreen.h"
@@ -26,12 +27,14 @@
 #include "engine/Potential.h"
 #include "engine/random_seed.h"
 #include "engine/show_dot.h"
+#include "engine/simd_escape.h"
 #include "engine/soi.h"
 #include "engine/solid_guess.h"
 #include "engine/sound.h"
 #include "engine/spindac.h"
 #include "engine/sticky_orbits.h"
 #include "engine/text_color.h"
+#include "engine/tiled_render.h"
 #include "engine/trig_fns.h"
 #include "engine/UserData.h"
 #include "engine/video_mode.h"
@@ -54,6 +57,7 @@
 #include "io/file_item.h"
 #include "io/gifview.h"
 #include "io/has_ext.h"
+#include "io/iteration_data.h"
 #include "io/library.h"
 #include "io/loadfile.h"
 #include "io/loadmap.h"
@@ -487,8 +491,12 @@ static void init_vars_restart() // <ins> key init
     g_dither_flag = false;                             // no dithering
     g_ask_video = true;                                // turn on video-prompt flag
     g_overwrite_file = false;                          // don't overwrite
+    g_simd_mode = SimdMode::AUTO;                      // use SIMD kernels when eligible
     g_sound_flag = SOUNDFLAG_SPEAKER | SOUNDFLAG_BEEP; // sound is on to PC speaker
     g_init_batch = BatchMode::NONE;                    // not in batch mode
+    g_tiled_render = TiledRenderSize{};                // render batch images on the screen
+    g_iteration_data_filename.clear();                 // no iteration data file
+    g_keep_iterations = false;                         // recalculate to change coloring
     g_check_cur_dir = false;                           // flag to check current dire for files
     g_save_time_interval = 0;                          // no auto-save
     g_init_mode = -1;                                  // no initial video mode
@@ -542,6 +550,7 @@ static void init_vars_fractal()
     g_user.biomorph_value = -1;                          // turn off biomorph flag
     g_user.perturbation = PerturbationMode::AUTO;        // automatic perturbation selection
     g_user.perturbation_tolerance = DEFAULT_PERTURBATION_TOLERANCE;
+    g_user.perturbation_glitch = PerturbationGlitch::REBASE; // rebase onto one reference orbit
     g_outside_method = ColorMethod::ITER;                // outside color = iteration
     g_outside_color = -1;                                // outside color = -1 (not used)
     g_max_iterations = INITIAL_MAX_ITERATIONS;           // initial max iter
@@ -621,6 +630,7 @@ static void init_vars_fractal()
     g_julibrot_depth = 8;                                   //
     g_new_orbit_type = FractalType::JULIA;                  //
     g_julibrot_z_dots = 128;                                //
+    g_julibrot_coarse_step = 1;                             // iterate every depth sample
     init_vars3d();                                          //
     g_base_hertz = 440;                                     // basic hertz rate
     g_fm_volume = 63;                                       // full volume on soundcard o/p
@@ -2347,6 +2357,17 @@ static CmdArgFlags cmd_is_mand(const Command &cmd)
     return CmdArgFlags::FRACTAL_PARAM;
 }
 
+// iterdata=<filename>
+static CmdArgFlags cmd_iteration_data(const Command &cmd)
+{
+    if (cmd.value.empty() || cmd.value.size() > ID_FILE_MAX_PATH - 1)
+    {
+        return cmd.bad_arg();
+    }
+    g_iteration_data_filename = std::string{cmd.value};
+    return CmdArgFlags::NONE;
+}
+
 // julibrot3d=?/?/?/?
 static CmdArgFlags cmd_julibrot3d(const Command &cmd)
 {
@@ -2381,6 +2402,18 @@ static CmdArgFlags cmd_julibrot3d(const Command &cmd)
     return CmdArgFlags::FRACTAL_PARAM;
 }
 
+// julibrotcoarse=?
+static CmdArgFlags cmd_julibrot_coarse(const Command &cmd)
+{
+    if (cmd.total_params != 1 || cmd.num_int_params != 1 || cmd.int_vals[0] < 1 ||
+        cmd.int_vals[0] > JULIBROT_MAX_COARSE_STEP)
+    {
+        return cmd.bad_arg();
+    }
+    g_julibrot_coarse_step = cmd.int_vals[0];
+    return CmdArgFlags::FRACTAL_PARAM;
+}
+
 // julibroteyes=?
 static CmdArgFlags cmd_julibrot_eyes(const Command &cmd)
 {
@@ -2970,6 +3003,24 @@ static CmdArgFlags cmd_perturbation_tolerance(const Command &cmd)
     return CmdArgFlags::FRACTAL_PARAM;
 }
 
+// perturbation-glitch=rebase|retry
+static CmdArgFlags cmd_perturbation_glitch(const Command &cmd)
+{
+    if (cmd.value == "rebase")
+    {
+        g_user.perturbation_glitch = PerturbationGlitch::REBASE;
+    }
+    else if (cmd.value == "retry")
+    {
+        g_user.perturbation_glitch = PerturbationGlitch::RETRY;
+    }
+    else
+    {
+        return cmd.bad_arg();
+    }
+    return CmdArgFlags::FRACTAL_PARAM;
+}
+
 // periodicity=?
 static CmdArgFlags cmd_periodicity(const Command &cmd)
 {
@@ -3154,7 +3205,9 @@ constexpr RayTraceFormatValue RAYTRACE_FORMATS[]{
     {"mtv", RayTraceFormat::MTV},            //
     {"rayshade", RayTraceFormat::RAYSHADE},  //
     {"acrospin", RayTraceFormat::ACROSPIN},  //
-    {"dxf", RayTraceFormat::DXF}             //
+    {"dxf", RayTraceFormat::DXF},            //
+    {"ply", RayTraceFormat::PLY},            //
+    {"stl", RayTraceFormat::STL}             //
 };
 
 } // namespace
@@ -3173,7 +3226,7 @@ static CmdArgFlags cmd_ray(const Command &cmd)
             }
         }
     }
-    else if (cmd.num_val < 0 || cmd.num_val > 7)
+    else if (cmd.num_val < 0 || cmd.num_val > static_cast<int>(RayTraceFormat::STL))
     {
         return cmd.bad_arg();
     }
@@ -3184,6 +3237,17 @@ static CmdArgFlags cmd_ray(const Command &cmd)
     return CmdArgFlags::PARAM_3D;
 }
 
+// recolor=yes|no
+static CmdArgFlags cmd_recolor(const Command &cmd)
+{
+    if (cmd.yes_no_val[0] < 0)
+    {
+        return cmd.bad_arg();
+    }
+    g_keep_iterations = cmd.yes_no_val[0] != 0;
+    return CmdArgFlags::NONE;
+}
+
 static CmdArgFlags cmd_record_colors(const Command &cmd)
 {
     if (cmd.char_val[0] != 'y' && cmd.char_val[0] != 'c' && cmd.char_val[0] != 'a')
@@ -3494,6 +3558,28 @@ static CmdArgFlags cmd_show_orbit(const Command &cmd)
     return CmdArgFlags::NONE;
 }
 
+// simd=auto|off|force
+static CmdArgFlags cmd_simd(const Command &cmd)
+{
+    if (cmd.value == "auto")
+    {
+        g_simd_mode = SimdMode::AUTO;
+    }
+    else if (cmd.value == "off")
+    {
+        g_simd_mode = SimdMode::OFF;
+    }
+    else if (cmd.value == "force")
+    {
+        g_simd_mode = SimdMode::FORCE;
+    }
+    else
+    {
+        return cmd.bad_arg();
+    }
+    return CmdArgFlags::NONE;
+}
+
 // smoothing=?
 static CmdArgFlags cmd_smoothing(const Command &cmd)
 {
@@ -3742,6 +3828,20 @@ static CmdArgFlags cmd_text_colors(const Command &cmd)
     return CmdArgFlags::NONE;
 }
 
+// tiledgif=<width>/<height>[/<tile size>]
+static CmdArgFlags cmd_tiled_gif(const Command &cmd)
+{
+    if (cmd.total_params < 2 || cmd.total_params > 3 || cmd.num_int_params != cmd.total_params ||
+        cmd.int_vals[0] < 2 || cmd.int_vals[1] < 2 || (cmd.total_params == 3 && cmd.int_vals[2] < 1))
+    {
+        return cmd.bad_arg();
+    }
+    g_tiled_render.width = cmd.int_vals[0];
+    g_tiled_render.height = cmd.int_vals[1];
+    g_tiled_render.tile_size = cmd.total_params == 3 ? cmd.int_vals[2] : TiledRenderSize{}.tile_size;
+    return CmdArgFlags::NONE;
+}
+
 // tplus no longer used, validate value and gobble argument
 static CmdArgFlags cmd_tplus(const Command &cmd)
 {
@@ -4000,7 +4100,7 @@ static CmdArgFlags cmd_xy_shift(const Command &cmd)
 }
 
 // Keep this sorted by parameter name for binary search to work correctly.
-static std::array<CommandHandler, 162> s_commands{
+static std::array<CommandHandler, 168> s_commands{
     CommandHandler{"3d", cmd_3d},                           //
     CommandHandler{"3dmode", cmd_3d_mode},                  //
     CommandHandler{"ambient", cmd_ambient},                 //
@@ -4059,8 +4159,10 @@ static std::array<CommandHandler, 162> s_commands{
     CommandHandler{"interocular", cmd_interocular},         //
     CommandHandler{"invert", cmd_invert},                   //
     CommandHandler{"ismand", cmd_is_mand},                  //
+    CommandHandler{"iterdata", cmd_iteration_data},         //
     CommandHandler{"iterincr", cmd_deprecated},             //
     CommandHandler{"julibrot3d", cmd_julibrot3d},          //
+    CommandHandler{"julibrotcoarse", cmd_julibrot_coarse},  //
     CommandHandler{"julibroteyes", cmd_julibrot_eyes},      //
     CommandHandler{"julibrotfromto", cmd_julibrot_from_to}, //
     CommandHandler{"latitude", cmd_latitude},               //
@@ -4101,6 +4203,7 @@ static std::array<CommandHandler, 162> s_commands{
     CommandHandler{"periodicity", cmd_periodicity},         //
     CommandHandler{"perspective", cmd_perspective},         //
     CommandHandler{"perturbation", cmd_perturbation},       //
+    CommandHandler{"perturbation-glitch", cmd_perturbation_glitch},       //
     CommandHandler{"perturbation-tolerance", cmd_perturbation_tolerance}, //
     CommandHandler{"pixelzoom", cmd_pixel_zoom},            //
     CommandHandler{"plotstyle", cmd_deprecated},            // deprecated print parameters
@@ -4117,6 +4220,7 @@ static std::array<CommandHandler, 162> s_commands{
     CommandHandler{"ray", cmd_ray},                         //
     CommandHandler{"rds", cmd_rds},                         //
     CommandHandler{"rds-texture", cmd_rds_texture},         //
+    CommandHandler{"recolor", cmd_recolor},                 //
     CommandHandler{"recordcolors", cmd_record_colors},      //
     CommandHandler{"release", cmd_release},                 //
     CommandHandler{"reset", cmd_reset},                     //
@@ -4133,6 +4237,7 @@ static std::array<CommandHandler, 162> s_commands{
     CommandHandler{"showbox", cmd_show_box},                //
     CommandHandler{"showdot", cmd_show_dot},                //
     CommandHandler{"showorbit", cmd_show_orbit},            //
+    CommandHandler{"simd", cmd_simd},                       //
     CommandHandler{"smoothing", cmd_smoothing},             //
     CommandHandler{"sound", cmd_sound},                     //
     CommandHandler{"sphere", cmd_sphere},                   //
@@ -4144,6 +4249,7 @@ static std::array<CommandHandler, 162> s_commands{
     CommandHandler{"targa_overlay", cmd_targa_overlay},     //
     CommandHandler{"tempdir", cmd_temp_dir},                //
     CommandHandler{"textcolors", cmd_text_colors},          //
+    CommandHandler{"tiledgif", cmd_tiled_gif},              //
     CommandHandler{"title", cmd_deprecated},                // deprecated print parameters
     CommandHandler{"tplus", cmd_tplus},                     //
     CommandHandler{"translate", cmd_deprecated},            // deprecated print parameters
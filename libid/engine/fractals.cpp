@@ -238,20 +238,35 @@ void mandel_ref_pt_bf(const BFComplex &center, BFComplex &z)
     add_bf(z.y, real_imag, center.y);
 }
 
-void mandel_perturb(
-    const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0)
+// Shared by the double and extended exponent deltas; T is the delta component type.
+template <typename T>
+static void mandel_perturb(const std::complex<double> &ref, T &delta_real, T &delta_imag, const T &a0, const T &b0)
 {
     const double r{ref.real()};
     const double i{ref.imag()};
-    const double a{delta_n.real()};
-    const double b{delta_n.imag()};
-    const double a0{delta0.real()};
-    const double b0{delta0.imag()};
-
-    const double dnr{(2 * r + a) * a - (2 * i + b) * b + a0};
-    const double dni{2 * ((r + a) * b + i * a) + b0};
-    delta_n.imag(dni);
-    delta_n.real(dnr);
+    const T a{delta_real};
+    const T b{delta_imag};
+
+    const T dnr{(2 * r + a) * a - (2 * i + b) * b + a0};
+    const T dni{2 * ((r + a) * b + i * a) + b0};
+    delta_imag = dni;
+    delta_real = dnr;
+}
+
+void mandel_perturb(
+    const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0)
+{
+    double real{delta_n.real()};
+    double imag{delta_n.imag()};
+    mandel_perturb(ref, real, imag, delta0.real(), delta0.imag());
+    delta_n.imag(imag);
+    delta_n.real(real);
+}
+
+void mandel_perturb_fe(
+    const std::complex<double> &ref, FloatExpComplex &delta_n, const FloatExpComplex &delta0)
+{
+    mandel_perturb(ref, delta_n.x, delta_n.y, delta0.x, delta0.y);
 }
 
 int julia_per_pixel()
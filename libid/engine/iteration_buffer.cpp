@@ -0,0 +1,440 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+// Keeps the iteration count and final z of each pixel as it is plotted,
+// so that coloring changes can redraw the image without iterating.
+//
+// The buffer is filled by a g_put_color wrapper that stores the pixel the
+// engine just computed at every position it is plotted, so symmetry needs
+// no special handling.  Pixels that are filled in rather than computed,
+// by solid guessing, boundary tracing or the mirrored rows of symmetry,
+// are plotted without one; they take the iterations of a computed
+// neighbor of the same color when the image is recolored, which is how
+// their color was guessed in the first place.
+//
+#include "engine/iteration_buffer.h"
+
+#include "engine/calc_frac_init.h"
+#include "engine/calcfrac.h"
+#include "engine/log_map.h"
+#include "engine/LogicalScreen.h"
+#include "engine/Potential.h"
+#include "engine/spindac.h"
+#include "engine/UserData.h"
+#include "engine/VideoInfo.h"
+#include "math/big.h"
+#include "misc/debug_flags.h"
+#include "misc/id.h"
+#include "misc/version.h"
+#include "ui/evolve.h"
+#include "ui/video.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace id::math;
+using namespace id::misc;
+using namespace id::ui;
+
+namespace id::engine
+{
+
+bool g_keep_iterations{};
+
+namespace
+{
+
+struct PixelIteration
+{
+    long real_color_iter{-1}; // -1 when the pixel wasn't computed
+    float z_x{};
+    float z_y{};
+};
+
+} // namespace
+
+static std::vector<PixelIteration> s_pixels;
+static int s_width{};
+static int s_height{};
+static bool s_keeping{};
+static bool s_complete{};        // describes the screen with s_screen_hash
+static std::uint64_t s_screen_hash{};
+static int s_biomorph{};         // biomorph of the computed image, for its bailout
+static PixelIteration s_pending; // the pixel being plotted
+static void (*s_put_color)(int x, int y, int color){};
+
+static void keep_put_color(const int x, const int y, const int color)
+{
+    if (x >= 0 && x < s_width && y >= 0 && y < s_height)
+    {
+        s_pixels[static_cast<std::size_t>(y) * s_width + x] = s_pending;
+    }
+    s_put_color(x, y, color);
+}
+
+// Columns of the logical screen that are on the physical screen.
+static int visible_width()
+{
+    return std::max(0, std::min(g_logical_screen.x_dots, g_screen_x_dots - g_logical_screen.x_offset));
+}
+
+static void read_screen(std::vector<Byte> &colors)
+{
+    colors.assign(static_cast<std::size_t>(s_width) * s_height, Byte{});
+    if (const int width{visible_width()}; width > 0)
+    {
+        for (int y = 0; y < s_height; ++y)
+        {
+            read_span(y, 0, width - 1, &colors[static_cast<std::size_t>(y) * s_width]);
+        }
+    }
+}
+
+// FNV-1a, to notice anything drawn over the image after it was kept.
+static std::uint64_t screen_hash(const std::vector<Byte> &colors)
+{
+    std::uint64_t hash{0xcbf29ce484222325ULL};
+    for (const Byte color : colors)
+    {
+        hash = (hash ^ color) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void start_iteration_buffer(const bool resuming)
+{
+    s_complete = false;
+    if (!g_keep_iterations)
+    {
+        free_iteration_buffer();
+        return;
+    }
+    const std::size_t size{static_cast<std::size_t>(g_logical_screen.x_dots) * g_logical_screen.y_dots};
+    if (!resuming || s_width != g_logical_screen.x_dots || s_height != g_logical_screen.y_dots)
+    {
+        try
+        {
+            s_pixels.assign(size, PixelIteration{});
+        }
+        catch (const std::bad_alloc &)
+        {
+            free_iteration_buffer();
+            return;
+        }
+        s_width = g_logical_screen.x_dots;
+        s_height = g_logical_screen.y_dots;
+    }
+    s_biomorph = g_biomorph;
+    s_pending = PixelIteration{};
+    s_put_color = g_put_color;
+    g_put_color = keep_put_color;
+    s_keeping = true;
+}
+
+void stop_iteration_buffer(const bool completed)
+{
+    if (!s_keeping)
+    {
+        return;
+    }
+    if (g_put_color == keep_put_color)
+    {
+        g_put_color = s_put_color;
+    }
+    if (g_plot == keep_put_color)
+    {
+        g_plot = g_put_color;
+    }
+    s_keeping = false;
+    s_pending = PixelIteration{};
+    s_complete = completed;
+    if (completed)
+    {
+        std::vector<Byte> colors;
+        read_screen(colors);
+        s_screen_hash = screen_hash(colors);
+    }
+}
+
+void free_iteration_buffer()
+{
+    stop_iteration_buffer(false);
+    s_pixels.clear();
+    s_pixels.shrink_to_fit();
+    s_width = 0;
+    s_height = 0;
+    s_complete = false;
+}
+
+void set_pixel_iteration(const long real_color_iter, const DComplex &z)
+{
+    s_pending = PixelIteration{real_color_iter, static_cast<float>(z.x), static_cast<float>(z.y)};
+}
+
+void clear_pixel_iteration()
+{
+    s_pending = PixelIteration{};
+}
+
+const char *recolor_ineligible_reason()
+{
+    if (!g_keep_iterations)
+    {
+        return "recolor=no";
+    }
+    if (!s_complete || s_width != g_logical_screen.x_dots || s_height != g_logical_screen.y_dots ||
+        g_calc_status != CalcStatus::COMPLETED)
+    {
+        return "no iterations kept for this image";
+    }
+    if (g_evolving != EvolutionModeFlags::NONE)
+    {
+        return "evolver";
+    }
+    if (g_true_color)
+    {
+        return "truecolor";
+    }
+    if (g_bf_math != BFMathType::NONE)
+    {
+        return "arbitrary precision";
+    }
+    if (g_potential.flag)
+    {
+        return "continuous potential";
+    }
+    if (g_distance_estimator != 0)
+    {
+        return "distance estimator";
+    }
+    if (g_decomp[0] > 0)
+    {
+        return "decomposition";
+    }
+    if (g_periodicity_check < 0)
+    {
+        return "periodicity coloring";
+    }
+    if (g_attractor.enabled || g_attractor.count > 0)
+    {
+        return "finite attractors";
+    }
+    if (g_inside_method < ColorMethod::COLOR && g_inside_method != ColorMethod::ITER)
+    {
+        return "inside coloring needs the orbit";
+    }
+    if (g_outside_method < ColorMethod::ATAN)
+    {
+        return "outside coloring needs the orbit";
+    }
+    if (g_log_map_flag != 0 && g_colors < 16)
+    {
+        return "logmap needs 16 colors";
+    }
+    if ((g_user.biomorph_value == -1) != (s_biomorph == -1) && g_user.bailout_value == 0)
+    {
+        return "biomorph changes the bailout";
+    }
+    return nullptr;
+}
+
+// Gives each pixel that wasn't computed the iterations of a neighbor of
+// the same color, first from the left and above, then from the right and
+// below; returns false when a pixel has no such neighbor.
+static bool fill_guessed_pixels(const std::vector<Byte> &colors)
+{
+    const auto fill = [&](const std::size_t i, const std::size_t neighbor)
+    {
+        if (colors[neighbor] == colors[i] && s_pixels[neighbor].real_color_iter >= 0)
+        {
+            s_pixels[i] = s_pixels[neighbor];
+        }
+    };
+    for (int y = 0; y < s_height; ++y)
+    {
+        for (int x = 0; x < s_width; ++x)
+        {
+            const std::size_t i{static_cast<std::size_t>(y) * s_width + x};
+            if (s_pixels[i].real_color_iter < 0 && x > 0)
+            {
+                fill(i, i - 1);
+            }
+            if (s_pixels[i].real_color_iter < 0 && y > 0)
+            {
+                fill(i, i - s_width);
+            }
+        }
+    }
+    bool filled{true};
+    for (int y = s_height - 1; y >= 0; --y)
+    {
+        for (int x = s_width - 1; x >= 0; --x)
+        {
+            const std::size_t i{static_cast<std::size_t>(y) * s_width + x};
+            if (s_pixels[i].real_color_iter < 0 && x < s_width - 1)
+            {
+                fill(i, i + 1);
+            }
+            if (s_pixels[i].real_color_iter < 0 && y < s_height - 1)
+            {
+                fill(i, i + s_width);
+            }
+            filled = filled && s_pixels[i].real_color_iter >= 0;
+        }
+    }
+    return filled;
+}
+
+long iteration_buffer_auto_log_map()
+{
+    // the same edges auto_log_map() computes
+    const int x_stop{s_width - 1};
+    const int y_stop{s_height - 1};
+    long min_color{g_max_iterations};
+    const auto visit = [&](const int x, const int y)
+    { min_color = std::min(min_color, s_pixels[static_cast<std::size_t>(y) * s_width + x].real_color_iter); };
+    for (int x = 0; x < x_stop; ++x)
+    {
+        visit(x, 0);
+        visit(x, y_stop);
+    }
+    for (int y = 0; y < y_stop; ++y)
+    {
+        visit(0, y);
+        visit(x_stop, y);
+    }
+    return min_color;
+}
+
+// The color standard_fractal_type() gives a pixel with these iterations,
+// for the coloring options recolor_ineligible_reason() accepts.
+static Byte recolor_pixel(const PixelIteration &pixel)
+{
+    const bool log_map{!g_log_map_table.empty() || g_log_map_calculate};
+    long color_iter{pixel.real_color_iter};
+    if (color_iter >= g_max_iterations)
+    {
+        if (g_inside_method >= ColorMethod::COLOR)
+        {
+            color_iter = g_inside_color;
+        }
+        else
+        {
+            color_iter = g_max_iterations;
+            if (log_map)
+            {
+                color_iter = log_table_calc(color_iter);
+            }
+        }
+    }
+    else
+    {
+        if (color_iter == 0)
+        {
+            color_iter = 1;
+        }
+        const double z_x{pixel.z_x};
+        const double z_y{pixel.z_y};
+        if (g_outside_method < ColorMethod::ITER)
+        {
+            if (g_outside_method == ColorMethod::REAL)
+            {
+                color_iter += static_cast<long>(z_x) + 7;
+            }
+            else if (g_outside_method == ColorMethod::IMAG)
+            {
+                color_iter += static_cast<long>(z_y) + 7;
+            }
+            else if (g_outside_method == ColorMethod::MULT && z_y != 0.0)
+            {
+                color_iter = static_cast<long>(static_cast<double>(color_iter) * (z_x / z_y));
+            }
+            else if (g_outside_method == ColorMethod::SUM)
+            {
+                color_iter += static_cast<long>(z_x + z_y);
+            }
+            else if (g_outside_method == ColorMethod::ATAN)
+            {
+                color_iter = static_cast<long>(std::abs(std::atan2(z_y, z_x) * g_atan_colors / PI));
+            }
+            if (color_iter <= 0 || color_iter > g_max_iterations)
+            {
+                color_iter = g_version < 1961 ? 0 : 1;
+            }
+        }
+        if (g_biomorph != -1 && (std::abs(z_x) < g_magnitude_limit2 || std::abs(z_y) < g_magnitude_limit2))
+        {
+            color_iter = g_biomorph;
+        }
+        if (g_outside_method >= ColorMethod::COLOR)
+        {
+            color_iter = g_outside_color;
+        }
+        else if (log_map)
+        {
+            color_iter = log_table_calc(color_iter);
+        }
+    }
+
+    int color{static_cast<int>(std::abs(color_iter))};
+    if (color_iter >= g_colors)
+    {
+        // don't use color 0 unless from inside/outside
+        if (g_colors < 16)
+        {
+            color = static_cast<int>(color_iter & g_and_color);
+        }
+        else
+        {
+            color = static_cast<int>((color_iter - 1) % g_and_color + 1);
+        }
+    }
+    if (g_debug_flag != DebugFlags::FORCE_BOUNDARY_TRACE_ERROR)
+    {
+        if (color <= 0 && g_std_calc_mode == CalcMode::BOUNDARY_TRACE)
+        {
+            color = 1;
+        }
+    }
+    return static_cast<Byte>(color);
+}
+
+bool recolor_image()
+{
+    std::vector<Byte> colors;
+    read_screen(colors);
+    if (screen_hash(colors) != s_screen_hash || !fill_guessed_pixels(colors))
+    {
+        s_complete = false;
+        return false;
+    }
+
+    g_biomorph = g_user.biomorph_value;
+    init_atan_colors();
+    init_log_map();
+    if (std::abs(g_log_map_flag) == 2 || (g_log_map_flag && g_log_map_auto_calculate))
+    {
+        g_log_map_flag = iteration_buffer_auto_log_map() * (g_log_map_flag / std::abs(g_log_map_flag));
+        setup_log_table();
+    }
+    std::transform(s_pixels.begin(), s_pixels.end(), colors.begin(), recolor_pixel);
+    if (!g_log_map_table.empty() && !g_log_map_calculate)
+    {
+        g_log_map_table.clear();
+    }
+
+    if (const int width{visible_width()}; width > 0)
+    {
+        for (int y = 0; y < s_height; ++y)
+        {
+            write_span(y, 0, width - 1, &colors[static_cast<std::size_t>(y) * s_width]);
+        }
+    }
+    s_screen_hash = screen_hash(colors);
+    return true;
+}
+
+} // namespace id::engine
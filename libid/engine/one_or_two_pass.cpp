@@ -3,20 +3,83 @@
 #include "engine/one_or_two_pass.h"
 
 #include "engine/calcfrac.h"
+#include "engine/calmanfp.h"
+#include "engine/DeferredScans.h"
+#include "engine/Inversion.h"
+#include "engine/pixel_grid.h"
 #include "engine/resume.h"
+#include "engine/simd_escape.h"
+#include "engine/simd_formula.h"
 #include "engine/StandardFractal.h"
+#include "engine/TileScheduler.h"
 #include "engine/work_list.h"
 #include "fractals/fractalp.h"
 #include "fractals/lyapunov.h"
 #include "ui/KeyboardHandler.h"
+#include "ui/stop_msg.h"
 #include "ui/video.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 using namespace id::ui;
 using namespace id::fractals;
 
 namespace id::engine
 {
 
+// Rows handed to the tile scheduler between interruption checks.
+static constexpr int ROWS_PER_WORKER_PER_BAND{4};
+
+namespace
+{
+
+// Collects the colors of a row plotted in scan order and writes each run
+// of them to the screen with sym_put_line() instead of a pixel at a time.
+class RowSpan
+{
+public:
+    explicit RowSpan(const int width) :
+        m_colors(width)
+    {
+    }
+
+    void start(const int row, const int col)
+    {
+        m_row = row;
+        m_left = col;
+        m_count = 0;
+    }
+    void add(const int color)
+    {
+        m_colors[m_count++] = static_cast<Byte>(color & g_and_color);
+    }
+    // The next pixel isn't plotted.
+    void skip()
+    {
+        flush();
+        ++m_left;
+    }
+    void flush()
+    {
+        if (m_count > 0)
+        {
+            sym_put_line(m_row, m_left, m_left + m_count - 1, m_colors.data());
+            m_left += m_count;
+            m_count = 0;
+        }
+    }
+
+private:
+    std::vector<Byte> m_colors;
+    int m_row{};
+    int m_left{};
+    int m_count{};
+};
+
+} // namespace
+
 bool OnePass::iterate()
 {
     return run() != -1;
@@ -90,6 +153,32 @@ int OneOrTwoPass::standard_calc(const int pass_num, const CalcMode calc_mode)
         m_row = g_begin_pt.y;
         m_col = g_begin_pt.x;
         m_standard_calc_active = true;
+        if (g_simd_mode == SimdMode::FORCE)
+        {
+            if (g_fractal_type == FractalType::FORMULA)
+            {
+                if (const char *reason = simd_formula_ineligible_reason(); reason != nullptr)
+                {
+                    stop_msg(std::string{"simd=force: SIMD formula kernel unavailable: "} + reason);
+                }
+            }
+            else if (const char *reason = simd_escape_ineligible_reason(); reason != nullptr)
+            {
+                stop_msg(std::string{"simd=force: SIMD escape-time kernel unavailable: "} + reason);
+            }
+        }
+    }
+    if (tiled_calc_eligible(calc_mode))
+    {
+        return tiled_calc();
+    }
+    if (calc_mode == CalcMode::ONE_PASS && !g_quick_calc && use_simd_formula())
+    {
+        return simd_formula_calc();
+    }
+    if (calc_mode == CalcMode::ONE_PASS && !g_quick_calc && use_lyapunov_rows())
+    {
+        return lyapunov_calc();
     }
     g_row = m_row;
     g_col = m_col;
@@ -167,6 +256,241 @@ int OneOrTwoPass::standard_calc(const int pass_num, const CalcMode calc_mode)
     return 0;
 }
 
+// The optimized Mandelbrot/Julia orbit only reads render constants and
+// restarts periodicity checking at the start of every row, so rows can be
+// computed concurrently and plotted afterwards in scan order with results
+// identical to the serial scan.  With a single worker the row scan is
+// still worthwhile when the SIMD lane kernel can compute each row.
+bool OneOrTwoPass::tiled_calc_eligible(const CalcMode calc_mode)
+{
+    return calc_mode == CalcMode::ONE_PASS             //
+        && g_dispatch.calc_type() == calc_mandelbrot_type //
+        && g_inversion.invert == 0                     //
+        && !g_quick_calc                               //
+        && (tile_scheduler().num_workers() > 1 || use_simd_escape());
+}
+
+int OneOrTwoPass::tiled_calc()
+{
+    // the evolver computes the scans of all its sub images together
+    DeferredScans &deferred{deferred_scans()};
+    if (deferred.mode() == DeferredScans::Mode::RECORD)
+    {
+        deferred.defer(m_row, m_col, g_i_stop_pt.y, g_i_start_pt.x, g_i_stop_pt.x);
+        m_row = g_i_stop_pt.y + 1;
+        m_col = g_i_start_pt.x;
+        g_row = m_row;
+        g_col = m_col;
+        m_standard_calc_active = false;
+        return 0;
+    }
+    const DeferredScans::Scan *replayed{deferred.mode() == DeferredScans::Mode::REPLAY
+            ? deferred.next(m_row, m_col, g_i_stop_pt.y, g_i_start_pt.x, g_i_stop_pt.x)
+            : nullptr};
+
+    TileScheduler &scheduler{tile_scheduler()};
+    const int band_rows{static_cast<int>(scheduler.num_workers()) * ROWS_PER_WORKER_PER_BAND};
+    const int width{g_i_stop_pt.x - g_i_start_pt.x + 1};
+    std::vector<MandelbrotOrbit> orbits(replayed != nullptr ? 0 : static_cast<std::size_t>(band_rows) * width);
+    const bool by_span{plot_rows_by_span()};
+    RowSpan span{by_span ? width : 0};
+
+    while (m_row <= g_i_stop_pt.y)
+    {
+        if (calc_interrupted())
+        {
+            g_row = m_row;
+            g_col = m_col;
+            m_resume_row = m_row;
+            m_resume_col = m_col;
+            return -1;
+        }
+
+        const int first_row{m_row};
+        const int first_col{m_col};
+        const int last_row{std::min(first_row + band_rows - 1, g_i_stop_pt.y)};
+        auto row_start = [&](const int row) { return row == first_row ? first_col : g_i_start_pt.x; };
+        auto row_orbits = [&](const int row)
+        { return &orbits[static_cast<std::size_t>(row - first_row) * width + (row_start(row) - g_i_start_pt.x)]; };
+
+        if (replayed == nullptr)
+        {
+            MandelbrotContext ctx{mandelbrot_context()};
+            ctx.simd = use_simd_escape();
+            const PixelGrid &grid{pixel_grid()};
+            scheduler.run(last_row - first_row + 1,
+                [&](const int tile, unsigned)
+                {
+                    const int row{first_row + tile};
+                    mandelbrot_orbit_row(ctx, grid, row, row_start(row), g_i_stop_pt.x, row_orbits(row));
+                });
+        }
+
+        for (int row = first_row; row <= last_row; ++row)
+        {
+            g_current_row = row;
+            const MandelbrotOrbit *orbit{replayed != nullptr ? replayed->row(row) : row_orbits(row)};
+            span.start(row, row_start(row));
+            for (int col = row_start(row); col <= g_i_stop_pt.x; ++col, ++orbit)
+            {
+                g_row = row;
+                g_col = col;
+                g_new_z = orbit->new_z;
+                g_magnitude = orbit->magnitude;
+                g_color_iter = orbit->color_iter;
+                g_real_color_iter = orbit->real_color_iter;
+                g_old_color_iter = orbit->old_color_iter;
+                if (g_color_iter < 0)
+                {
+                    g_color = static_cast<int>(g_color_iter);
+                    if (by_span)
+                    {
+                        span.skip();
+                    }
+                }
+                else if (by_span)
+                {
+                    g_color = mandelbrot_color(g_color_iter, g_real_color_iter, g_magnitude);
+                    span.add(g_color);
+                }
+                else
+                {
+                    plot_mandelbrot_color();
+                }
+            }
+            span.flush();
+        }
+        g_resuming = false;
+        g_reset_periodicity = false;
+        m_row = last_row + 1;
+        m_col = g_i_start_pt.x;
+    }
+    g_row = m_row;
+    g_col = m_col;
+    m_standard_calc_active = false;
+    return 0;
+}
+
+// Formula pixels are computed a row at a time by the formula lane kernel
+// and plotted in scan order.  The kernel calls back into the interpreter
+// for some functions, which share global state, so rows are computed one
+// after another on this thread.
+int OneOrTwoPass::simd_formula_calc()
+{
+    const int width{g_i_stop_pt.x - g_i_start_pt.x + 1};
+    std::vector<FormulaPixel> pixels(width);
+    const bool by_span{plot_rows_by_span()};
+    RowSpan span{by_span ? width : 0};
+
+    while (m_row <= g_i_stop_pt.y)
+    {
+        if (calc_interrupted())
+        {
+            g_row = m_row;
+            g_col = m_col;
+            m_resume_row = m_row;
+            m_resume_col = m_col;
+            return -1;
+        }
+
+        g_current_row = m_row;
+        simd_formula_row(m_row, m_col, g_i_stop_pt.x, pixels.data());
+        const FormulaPixel *pixel{pixels.data()};
+        span.start(m_row, m_col);
+        for (int col = m_col; col <= g_i_stop_pt.x; ++col, ++pixel)
+        {
+            g_row = m_row;
+            g_col = col;
+            if (by_span)
+            {
+                span.add(formula_pixel_color(*pixel));
+            }
+            else
+            {
+                plot_formula_pixel(*pixel);
+            }
+        }
+        span.flush();
+        g_resuming = false;
+        g_reset_periodicity = false;
+        ++m_row;
+        m_col = g_i_start_pt.x;
+    }
+    g_row = m_row;
+    g_col = m_col;
+    m_standard_calc_active = false;
+    return 0;
+}
+
+// With a fixed population seed every Lyapunov pixel starts from the same
+// population, so bands of rows are computed concurrently by the reentrant
+// kernel and plotted afterwards in scan order.
+int OneOrTwoPass::lyapunov_calc()
+{
+    TileScheduler &scheduler{tile_scheduler()};
+    const int band_rows{static_cast<int>(scheduler.num_workers()) * ROWS_PER_WORKER_PER_BAND};
+    const int width{g_i_stop_pt.x - g_i_start_pt.x + 1};
+    std::vector<int> colors(static_cast<std::size_t>(band_rows) * width);
+    const bool by_span{plot_rows_by_span()};
+    RowSpan span{by_span ? width : 0};
+    const LyapunovContext ctx{lyapunov_context()};
+    const PixelGrid &grid{pixel_grid()};
+
+    while (m_row <= g_i_stop_pt.y)
+    {
+        if (calc_interrupted())
+        {
+            g_row = m_row;
+            g_col = m_col;
+            m_resume_row = m_row;
+            m_resume_col = m_col;
+            return -1;
+        }
+
+        const int first_row{m_row};
+        const int first_col{m_col};
+        const int last_row{std::min(first_row + band_rows - 1, g_i_stop_pt.y)};
+        auto row_start = [&](const int row) { return row == first_row ? first_col : g_i_start_pt.x; };
+        auto row_colors = [&](const int row)
+        { return &colors[static_cast<std::size_t>(row - first_row) * width + (row_start(row) - g_i_start_pt.x)]; };
+        scheduler.run(last_row - first_row + 1,
+            [&](const int tile, unsigned)
+            {
+                const int row{first_row + tile};
+                lyapunov_row(ctx, grid, row, row_start(row), g_i_stop_pt.x, row_colors(row));
+            });
+
+        for (int row = first_row; row <= last_row; ++row)
+        {
+            g_current_row = row;
+            const int *color{row_colors(row)};
+            span.start(row, row_start(row));
+            for (int col = row_start(row); col <= g_i_stop_pt.x; ++col, ++color)
+            {
+                g_row = row;
+                g_col = col;
+                g_color = *color;
+                if (by_span)
+                {
+                    span.add(g_color);
+                }
+                else
+                {
+                    g_plot(g_col, g_row, g_color);
+                }
+            }
+            span.flush();
+        }
+        g_resuming = false;
+        m_row = last_row + 1;
+        m_col = g_i_start_pt.x;
+    }
+    g_row = m_row;
+    g_col = m_col;
+    m_standard_calc_active = false;
+    return 0;
+}
+
 int OneOrTwoPass::stop_row_for_resume() const
 {
     int stop_row = g_stop_pt.y;
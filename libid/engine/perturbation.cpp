@@ -22,6 +22,7 @@ namespace id::engine
 void StandardFractal::start_perturbation_frame()
 {
     m_pert_engine.set_glitch_tolerance(g_user.perturbation_tolerance);
+    m_pert_engine.set_rebase(g_user.perturbation_glitch == PerturbationGlitch::REBASE);
 
     if (fractals::g_fractal_type == fractals::FractalType::MANDEL_Z_POWER)
     {
@@ -29,17 +30,17 @@ void StandardFractal::start_perturbation_frame()
         g_c_exponent = std::clamp(g_c_exponent, 2, MAX_POWER);
     }
 
-    double mandel_width{}; // width of display
     double x_mag_factor{};
     double rotation{};
     double skew{};
     if (g_bf_math != BFMathType::NONE)
     {
+        FloatExp mandel_width; // width of display, kept beyond the range of a double
         {
             BigStackSaver saved;
             BigFloat tmp_bf{alloc_stack(g_bf_length + 2)};
             sub_bf(tmp_bf, g_bf_y_max, g_bf_y_min);
-            mandel_width = bf_to_float(tmp_bf);
+            mandel_width = bf_to_float_exp(tmp_bf);
         }
 
         BFComplex center_bf{m_pert_engine.initialize_frame_bf(mandel_width / 2.0)};
@@ -54,7 +55,7 @@ void StandardFractal::start_perturbation_frame()
         LDouble magnification_ld;
         cvt_center_mag(center.x, center.y, magnification_ld, x_mag_factor, rotation, skew);
         center.y = -center.y;
-        mandel_width = g_image_region.height();
+        const double mandel_width{g_image_region.height()}; // width of display
         m_pert_engine.initialize_frame({center.x, center.y}, mandel_width / 2.0);
         m_pert_engine.initialize_pixel_strategy();
     }
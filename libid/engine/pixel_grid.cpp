@@ -14,10 +14,7 @@ namespace id::engine
 // otherwise the floating point grid is set; never both at once
 // note that lx1 & ly1 values can overflow into sign bit; since
 // they're used only to add to lx0/ly0, 2s comp straightens it out
-static std::vector<double> s_grid_x0;            // floating pt equivs
-static std::vector<double> s_grid_y0;
-static std::vector<double> s_grid_x1;
-static std::vector<double> s_grid_y1;
+static PixelGrid s_grid;            // floating pt equivs
 
 /*
  * The following functions calculate the real and imaginary complex
@@ -39,50 +36,66 @@ static std::vector<double> s_grid_y1;
  * be maintained.
  */
 
+const PixelGrid &pixel_grid()
+{
+    return s_grid;
+}
+
 // Real component, grid lookup version - requires dx0/dx1 arrays
 double dx_pixel()
 {
-    return s_grid_x0[g_col]+s_grid_x1[g_row];
+    return s_grid.x0[g_col]+s_grid.x1[g_row];
 }
 
 // Imaginary component, grid lookup version - requires dy0/dy1 arrays
 double dy_pixel()
 {
-    return s_grid_y0[g_row]+s_grid_y1[g_col];
+    return s_grid.y0[g_row]+s_grid.y1[g_col];
+}
+
+// Reentrant versions for row kernels that do not set g_col/g_row
+double dx_pixel(const int col, const int row)
+{
+    return s_grid.dx(col, row);
+}
+
+double dy_pixel(const int col, const int row)
+{
+    return s_grid.dy(col, row);
 }
 
 void alloc_pixel_grid()
 {
     free_pixel_grid();
-    s_grid_x0.resize(g_logical_screen.x_dots);
-    s_grid_y1.resize(g_logical_screen.x_dots);
-    s_grid_y0.resize(g_logical_screen.y_dots);
-    s_grid_x1.resize(g_logical_screen.y_dots);
+    s_grid.x0.resize(g_logical_screen.x_dots);
+    s_grid.y1.resize(g_logical_screen.x_dots);
+    s_grid.y0.resize(g_logical_screen.y_dots);
+    s_grid.x1.resize(g_logical_screen.y_dots);
 }
 
 void free_pixel_grid()
 {
-    s_grid_x0.clear();
-    s_grid_y0.clear();
-    s_grid_x1.clear();
-    s_grid_y1.clear();
+    s_grid.x0.clear();
+    s_grid.y0.clear();
+    s_grid.x1.clear();
+    s_grid.y1.clear();
 }
 
 void fill_pixel_grid()
 {
-    s_grid_x0[0] = g_image_region.m_min.x; // fill up the x, y grids
-    s_grid_y0[0] = g_image_region.m_max.y;
-    s_grid_y1[0] = 0;
-    s_grid_x1[0] = 0;
+    s_grid.x0[0] = g_image_region.m_min.x; // fill up the x, y grids
+    s_grid.y0[0] = g_image_region.m_max.y;
+    s_grid.y1[0] = 0;
+    s_grid.x1[0] = 0;
     for (int i = 1; i < g_logical_screen.x_dots; i++)
     {
-        s_grid_x0[i] = s_grid_x0[0] + i * static_cast<double>(g_delta_x);
-        s_grid_y1[i] = s_grid_y1[0] - i * static_cast<double>(g_delta_y2);
+        s_grid.x0[i] = s_grid.x0[0] + i * static_cast<double>(g_delta_x);
+        s_grid.y1[i] = s_grid.y1[0] - i * static_cast<double>(g_delta_y2);
     }
     for (int i = 1; i < g_logical_screen.y_dots; i++)
     {
-        s_grid_y0[i] = s_grid_y0[0] - i * static_cast<double>(g_delta_y);
-        s_grid_x1[i] = s_grid_x1[0] + i * static_cast<double>(g_delta_x2);
+        s_grid.y0[i] = s_grid.y0[0] - i * static_cast<double>(g_delta_y);
+        s_grid.x1[i] = s_grid.x1[0] + i * static_cast<double>(g_delta_x2);
     }
 }
 
@@ -0,0 +1,377 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+// Lane kernel for the optimized Mandelbrot/Julia calculator.
+//
+// Pixels of a row are iterated SIMD_ESCAPE_LANES at a time with the state
+// of each pixel held in structure-of-arrays lanes.  The per-iteration
+// arithmetic and periodicity bookkeeping are branch free so the compiler
+// vectorizes them; a lane that finishes is retired through the same
+// outcome functions as mandelbrot_orbit() and refilled with the next pixel.
+//
+// mandelbrot_orbit() carries the periodicity threshold from one pixel to
+// the next.  A lane starting before its left neighbor has finished uses
+// the most recently retired threshold as a guess.  The guesses are then
+// verified in scan order and any pixel whose result could depend on the
+// difference is recomputed with the scalar kernel, so the row matches the
+// scalar scan exactly.
+//
+#include "engine/simd_escape.h"
+
+#include "engine/bailout_formula.h"
+#include "engine/calcfrac.h"
+#include "engine/fractals.h"
+#include "engine/Inversion.h"
+#include "engine/pixel_grid.h"
+#include "fractals/fractalp.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace id::fractals;
+using namespace id::math;
+
+namespace id::engine
+{
+
+SimdMode g_simd_mode{SimdMode::AUTO};
+
+namespace
+{
+
+constexpr int LANES{SIMD_ESCAPE_LANES};
+constexpr long IDLE_COUNT{std::numeric_limits<long>::max() / 2};
+
+// lane status values, kept as long so the status loop stays one element type
+constexpr long RUNNING{0};
+constexpr long ESCAPED{1};
+constexpr long PERIODIC{2};
+constexpr long INSIDE{3};
+
+template <typename T>
+using LaneArray = std::array<T, LANES>;
+
+class RowKernel
+{
+public:
+    RowKernel(const MandelbrotContext &ctx, const PixelGrid &grid, int row, int first_col, int last_col,
+        MandelbrotOrbit *orbits);
+
+    void run();
+
+private:
+    long threshold_after(int pixel) const;
+    long guess_threshold(int pixel) const;
+    void load(int lane);
+    void retire(int lane);
+    void verify();
+
+    const MandelbrotContext &m_ctx;
+    const PixelGrid &m_grid;
+    const int m_row;
+    const int m_first_col;
+    const int m_count;
+    MandelbrotOrbit *const m_orbits;
+    const long m_max_iterations{m_ctx.max_iterations};
+    const long m_threshold_cap{m_ctx.max_iterations - m_ctx.first_saved_and};
+    const double m_limit{m_ctx.magnitude_limit};
+    const double m_close_enough{m_ctx.close_enough};
+    const long m_first_saved_and{m_ctx.first_saved_and};
+    const long m_next_saved_incr{m_ctx.next_saved_incr};
+    const bool m_julia{m_ctx.julia};
+
+    std::vector<long> m_thresholds;
+    std::vector<bool> m_done;
+    int m_next_pixel{};
+    int m_active{};
+    long m_last_threshold{};
+
+    alignas(64) LaneArray<double> m_x{};
+    alignas(64) LaneArray<double> m_y{};
+    alignas(64) LaneArray<double> m_x2{};
+    alignas(64) LaneArray<double> m_y2{};
+    alignas(64) LaneArray<double> m_xy{};
+    alignas(64) LaneArray<double> m_cx{};
+    alignas(64) LaneArray<double> m_cy{};
+    alignas(64) LaneArray<double> m_mag{};
+    alignas(64) LaneArray<double> m_saved_x{};
+    alignas(64) LaneArray<double> m_saved_y{};
+    alignas(64) LaneArray<long> m_iter_count{};  // cx of mandelbrot_orbit()
+    alignas(64) LaneArray<long> m_check_below{}; // periodicity checked while cx < this
+    alignas(64) LaneArray<long> m_saved_and{};
+    alignas(64) LaneArray<long> m_saved_incr{};
+    alignas(64) LaneArray<long> m_status{};
+    LaneArray<int> m_pixel{};
+};
+
+RowKernel::RowKernel(const MandelbrotContext &ctx, const PixelGrid &grid, const int row, const int first_col,
+    const int last_col, MandelbrotOrbit *orbits) :
+    m_ctx(ctx),
+    m_grid(grid),
+    m_row(row),
+    m_first_col(first_col),
+    m_count(last_col - first_col + 1),
+    m_orbits(orbits),
+    m_thresholds(m_count),
+    m_done(m_count)
+{
+}
+
+// Periodicity threshold mandelbrot_orbit() uses for the pixel following
+// the given pixel, or for the first pixel of the row when pixel < 0.
+long RowKernel::threshold_after(const int pixel) const
+{
+    if (m_ctx.periodicity_check == 0)
+    {
+        return 0;
+    }
+    const long old_color_iter{pixel < 0 ? m_max_iterations - 255 : m_orbits[pixel].old_color_iter};
+    return std::min(old_color_iter, m_threshold_cap);
+}
+
+long RowKernel::guess_threshold(const int pixel) const
+{
+    if (pixel == 0 || m_done[pixel - 1])
+    {
+        return threshold_after(pixel - 1);
+    }
+    return m_last_threshold;
+}
+
+void RowKernel::load(const int lane)
+{
+    if (m_next_pixel >= m_count)
+    {
+        // idle lane: iterates harmlessly at the origin and never finishes
+        m_pixel[lane] = -1;
+        m_x[lane] = 0.0;
+        m_y[lane] = 0.0;
+        m_x2[lane] = 0.0;
+        m_y2[lane] = 0.0;
+        m_xy[lane] = 0.0;
+        m_cx[lane] = 0.0;
+        m_cy[lane] = 0.0;
+        m_iter_count[lane] = IDLE_COUNT;
+        m_check_below[lane] = 0;
+        return;
+    }
+
+    const int pixel{m_next_pixel++};
+    const int col{m_first_col + pixel};
+    const double init_x{m_grid.dx(col, m_row)};
+    const double init_y{m_grid.dy(col, m_row)};
+    double x;
+    double y;
+    if (!m_julia)
+    {
+        m_cx[lane] = init_x;
+        m_cy[lane] = init_y;
+        x = m_ctx.param_z1.x + init_x;
+        y = m_ctx.param_z1.y + init_y;
+    }
+    else
+    {
+        m_cx[lane] = m_ctx.param_z1.x;
+        m_cy[lane] = m_ctx.param_z1.y;
+        const double x2{init_x * init_x};
+        const double y2{init_y * init_y};
+        const double xy{init_x * init_y};
+        x = x2 - y2 + m_ctx.param_z1.x;
+        y = 2 * xy + m_ctx.param_z1.y;
+    }
+    m_x[lane] = x;
+    m_y[lane] = y;
+    m_x2[lane] = x * x;
+    m_y2[lane] = y * y;
+    m_xy[lane] = x * y;
+    m_saved_x[lane] = 0.0;
+    m_saved_y[lane] = 0.0;
+    m_saved_and[lane] = m_first_saved_and;
+    m_saved_incr[lane] = 1;
+    m_thresholds[pixel] = guess_threshold(pixel);
+    m_check_below[lane] = m_thresholds[pixel];
+    m_pixel[lane] = pixel;
+    ++m_active;
+
+    // while (--cx > 0)
+    m_iter_count[lane] = m_max_iterations - 1;
+    if (m_iter_count[lane] <= 0)
+    {
+        m_status[lane] = INSIDE;
+        retire(lane);
+    }
+}
+
+void RowKernel::retire(const int lane)
+{
+    const int pixel{m_pixel[lane]};
+    MandelbrotOrbit &orbit{m_orbits[pixel]};
+    orbit = {};
+    orbit.magnitude = m_mag[lane];
+    switch (m_status[lane])
+    {
+    case ESCAPED:
+        mandelbrot_orbit_escaped(m_ctx, m_iter_count[lane], m_x[lane], m_y[lane], orbit);
+        break;
+
+    case PERIODIC:
+        mandelbrot_orbit_periodic(m_ctx, m_iter_count[lane], orbit);
+        break;
+
+    default:
+        mandelbrot_orbit_inside(m_ctx, orbit);
+        break;
+    }
+    m_done[pixel] = true;
+    m_last_threshold = threshold_after(pixel);
+    --m_active;
+    load(lane);
+}
+
+void RowKernel::run()
+{
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        load(lane);
+    }
+
+    while (m_active > 0)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            const double x{m_x2[lane] - m_y2[lane] + m_cx[lane]};
+            const double y{2 * m_xy[lane] + m_cy[lane]};
+            m_x[lane] = x;
+            m_y[lane] = y;
+            m_x2[lane] = x * x;
+            m_y2[lane] = y * y;
+            m_xy[lane] = x * y;
+            m_mag[lane] = m_x2[lane] + m_y2[lane];
+        }
+
+        long finished{};
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            const long cx{m_iter_count[lane]};
+            const bool escaped{m_mag[lane] >= m_limit};
+            const bool check{cx < m_check_below[lane]};
+            const bool save{check && ((m_max_iterations - cx) & m_saved_and[lane]) == 0};
+            const bool periodic{check && !save && std::abs(m_saved_x[lane] - m_x[lane]) < m_close_enough &&
+                std::abs(m_saved_y[lane] - m_y[lane]) < m_close_enough};
+            m_saved_x[lane] = save ? m_x[lane] : m_saved_x[lane];
+            m_saved_y[lane] = save ? m_y[lane] : m_saved_y[lane];
+            const long saved_incr{m_saved_incr[lane] - (save ? 1 : 0)};
+            const bool lengthen{save && saved_incr == 0};
+            m_saved_and[lane] = lengthen ? (m_saved_and[lane] << 1) + 1 : m_saved_and[lane];
+            m_saved_incr[lane] = lengthen ? m_next_saved_incr : saved_incr;
+            const long status{escaped ? ESCAPED : periodic ? PERIODIC : cx - 1 <= 0 ? INSIDE : RUNNING};
+            // finished lanes keep their cx for retire()
+            m_iter_count[lane] = status == RUNNING ? cx - 1 : cx;
+            m_status[lane] = status;
+            finished |= status;
+        }
+
+        if (finished != RUNNING)
+        {
+            for (int lane = 0; lane < LANES; ++lane)
+            {
+                if (m_status[lane] != RUNNING)
+                {
+                    retire(lane);
+                }
+            }
+        }
+    }
+
+    verify();
+}
+
+// A guessed threshold is harmless when the pixel escaped before periodicity
+// checking would have started under either threshold; otherwise the pixel
+// is recomputed with the threshold the scalar scan would have used.
+void RowKernel::verify()
+{
+    for (int pixel = 1; pixel < m_count; ++pixel)
+    {
+        const long actual{threshold_after(pixel - 1)};
+        const long guessed{m_thresholds[pixel]};
+        if (actual == guessed)
+        {
+            continue;
+        }
+        const MandelbrotOrbit &orbit{m_orbits[pixel]};
+        if (orbit.real_color_iter < m_max_iterations)
+        {
+            const long exit_cx{m_max_iterations - orbit.real_color_iter};
+            if (exit_cx + 1 >= std::max(actual, guessed))
+            {
+                continue;
+            }
+        }
+        MandelbrotOrbit scalar;
+        scalar.old_color_iter = m_orbits[pixel - 1].old_color_iter;
+        const int col{m_first_col + pixel};
+        mandelbrot_orbit(m_ctx, {m_grid.dx(col, m_row), m_grid.dy(col, m_row)}, false, scalar);
+        m_orbits[pixel] = scalar;
+    }
+}
+
+} // namespace
+
+const char *simd_escape_ineligible_reason()
+{
+    if (g_simd_mode == SimdMode::OFF)
+    {
+        return "simd=off";
+    }
+    if (g_dispatch.calc_type() != calc_mandelbrot_type)
+    {
+        return "not the optimized Mandelbrot/Julia calculator";
+    }
+    if (g_std_calc_mode != CalcMode::ONE_PASS)
+    {
+        return "passes is not 1";
+    }
+    if (g_inversion.invert != 0)
+    {
+        return "inversion";
+    }
+    if (g_bailout_test != Bailout::MOD)
+    {
+        return "bailout test is not mod";
+    }
+    if (g_inside_method < ColorMethod::ITER)
+    {
+        return "unsupported inside coloring";
+    }
+    if (g_outside_method < ColorMethod::ATAN)
+    {
+        return "unsupported outside coloring";
+    }
+    return nullptr;
+}
+
+bool use_simd_escape()
+{
+    return simd_escape_ineligible_reason() == nullptr;
+}
+
+void simd_escape_row(const int row, const int first_col, const int last_col, MandelbrotOrbit *orbits)
+{
+    simd_escape_row(mandelbrot_context(), pixel_grid(), row, first_col, last_col, orbits);
+}
+
+void simd_escape_row(const MandelbrotContext &ctx, const PixelGrid &grid, const int row, const int first_col,
+    const int last_col, MandelbrotOrbit *orbits)
+{
+    if (last_col < first_col)
+    {
+        return;
+    }
+    RowKernel kernel{ctx, grid, row, first_col, last_col, orbits};
+    kernel.run();
+}
+
+} // namespace id::engine
@@ -0,0 +1,408 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+// Lane kernel for formula fractals.
+//
+// Pixels of a row run FORMULA_LANES at a time through FormulaLanes, the
+// lane form of the formula's register program.  Around it each lane keeps
+// the per pixel state of the standard fractal loop: the iteration count,
+// the bailout and overflow tests and periodicity checking.  A lane that
+// finishes records its outcome and is refilled with the next pixel.
+//
+// The standard loop carries the periodicity threshold from one pixel to
+// the next.  As in the Mandelbrot lane kernel, a lane starting before its
+// left neighbor has finished guesses the threshold, the guesses are
+// verified in scan order and a pixel whose result could depend on the
+// difference is computed again with the right threshold.
+//
+#include "engine/simd_formula.h"
+
+#include "engine/calc_frac_init.h"
+#include "engine/calcfrac.h"
+#include "engine/Inversion.h"
+#include "engine/iteration_buffer.h"
+#include "engine/pixel_grid.h"
+#include "engine/Potential.h"
+#include "engine/simd_escape.h"
+#include "fractals/formula.h"
+#include "fractals/FormulaLanes.h"
+#include "fractals/fractalp.h"
+#include "fractals/fractype.h"
+#include "math/big.h"
+#include "misc/id.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+
+namespace id::engine
+{
+
+namespace
+{
+
+constexpr int LANES{FORMULA_LANES};
+constexpr long RESET_THRESHOLD{255};
+constexpr long NO_PERIODICITY{2147483647L};
+
+template <typename T>
+using LaneArray = std::array<T, LANES>;
+
+class RowKernel
+{
+public:
+    RowKernel(int row, int first_col, int last_col, FormulaPixel *pixels);
+
+    void run();
+
+private:
+    long threshold_after(int pixel) const;
+    long guess_threshold(int pixel) const;
+    void compute(int first_pixel, int last_pixel, long forced_threshold);
+    void load(int lane);
+    void finish(int lane, bool new_z_set);
+    void check_periodicity(int lane);
+    void verify();
+
+    const int m_row;
+    const int m_first_col;
+    const int m_count;
+    FormulaPixel *const m_pixels;
+    const long m_max_iterations{g_max_iterations};
+    const double m_close_enough{g_close_enough};
+    const long m_first_saved_and{g_first_saved_and};
+    const int m_next_saved_incr{g_periodicity_next_saved_incr};
+    const DComplex m_init_saved{g_use_init_orbit == InitOrbitMode::VALUE ? g_init_orbit : DComplex{}};
+    const bool m_no_periodicity{g_periodicity_check == 0 || g_inside_method == ColorMethod::ZMAG};
+
+    FormulaLanes m_lanes{g_formula_vm, g_formula};
+    std::vector<bool> m_done;
+    int m_next_pixel{};
+    int m_last_pixel{};
+    long m_forced_threshold{-1};
+    long m_last_threshold{};
+
+    LaneArray<int> m_pixel{};
+    LaneArray<bool> m_running{};
+    LaneArray<long> m_color_iter{};
+    LaneArray<long> m_saved_and{};
+    LaneArray<int> m_saved_incr{};
+    LaneArray<DComplex> m_saved{};
+};
+
+RowKernel::RowKernel(const int row, const int first_col, const int last_col, FormulaPixel *pixels) :
+    m_row(row),
+    m_first_col(first_col),
+    m_count(last_col - first_col + 1),
+    m_pixels(pixels),
+    m_done(m_count)
+{
+}
+
+// Periodicity threshold the standard loop uses for the pixel following
+// the given pixel, or for the first pixel of the row when pixel < 0.
+long RowKernel::threshold_after(const int pixel) const
+{
+    if (m_no_periodicity)
+    {
+        return NO_PERIODICITY;
+    }
+    long old_color_iter{RESET_THRESHOLD};
+    if (pixel >= 0)
+    {
+        const long color_iter{m_pixels[pixel].color_iter};
+        old_color_iter = color_iter >= m_max_iterations ? 0 : color_iter + 10;
+    }
+    return std::max(old_color_iter, m_first_saved_and);
+}
+
+long RowKernel::guess_threshold(const int pixel) const
+{
+    if (m_forced_threshold >= 0)
+    {
+        return m_forced_threshold;
+    }
+    if (pixel == 0 || m_done[pixel - 1])
+    {
+        return threshold_after(pixel - 1);
+    }
+    return m_last_threshold;
+}
+
+void RowKernel::load(const int lane)
+{
+    if (m_next_pixel > m_last_pixel)
+    {
+        m_pixel[lane] = -1;
+        m_running[lane] = false;
+        return;
+    }
+
+    const int pixel{m_next_pixel++};
+    const int col{m_first_col + pixel};
+    m_lanes.start(lane, {dx_pixel(col, m_row), dy_pixel(col, m_row)}, col, m_row);
+    m_pixels[pixel] = FormulaPixel{};
+    m_pixels[pixel].threshold = guess_threshold(pixel);
+    m_pixel[lane] = pixel;
+    m_running[lane] = true;
+    m_color_iter[lane] = 0;
+    m_saved_and[lane] = m_first_saved_and;
+    m_saved_incr[lane] = 1;
+    m_saved[lane] = m_init_saved;
+}
+
+void RowKernel::finish(const int lane, const bool new_z_set)
+{
+    const int pixel{m_pixel[lane]};
+    FormulaPixel &result{m_pixels[pixel]};
+    result.color_iter = m_color_iter[lane];
+    result.new_z_set = new_z_set;
+    if (new_z_set)
+    {
+        result.new_z = m_lanes.z(lane);
+    }
+    m_done[pixel] = true;
+    m_last_threshold = threshold_after(pixel);
+    m_running[lane] = false;
+}
+
+void RowKernel::check_periodicity(const int lane)
+{
+    const long color_iter{m_color_iter[lane]};
+    if (color_iter <= m_pixels[m_pixel[lane]].threshold)
+    {
+        return;
+    }
+    const DComplex z{m_lanes.z(lane)};
+    if ((color_iter & m_saved_and[lane]) == 0)
+    {
+        m_saved[lane] = z;
+        if (--m_saved_incr[lane] == 0)
+        {
+            m_saved_and[lane] = (m_saved_and[lane] << 1) + 1;
+            m_saved_incr[lane] = m_next_saved_incr;
+        }
+    }
+    else if (std::abs(m_saved[lane].x - z.x) < m_close_enough && std::abs(m_saved[lane].y - z.y) < m_close_enough)
+    {
+        m_pixels[m_pixel[lane]].caught_cycle = true;
+        m_color_iter[lane] = m_max_iterations - 1;
+    }
+}
+
+// Computes pixels [first_pixel, last_pixel], guessing thresholds unless
+// forced_threshold is given.
+void RowKernel::compute(const int first_pixel, const int last_pixel, const long forced_threshold)
+{
+    m_next_pixel = first_pixel;
+    m_last_pixel = last_pixel;
+    m_forced_threshold = forced_threshold;
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        load(lane);
+    }
+
+    while (std::find(m_running.begin(), m_running.end(), true) != m_running.end())
+    {
+        FormulaLanes::Mask iterate{};
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (!m_running[lane])
+            {
+                continue;
+            }
+            if (++m_color_iter[lane] >= m_max_iterations)
+            {
+                finish(lane, true);
+            }
+            else if (m_lanes.overflow(lane))
+            {
+                // formula_orbit() bails out without touching z, which is
+                // only set when a previous iteration ran
+                finish(lane, m_color_iter[lane] > 1);
+            }
+            else
+            {
+                iterate[lane] = true;
+            }
+        }
+
+        m_lanes.orbit(iterate);
+
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (!iterate[lane])
+            {
+                continue;
+            }
+            if (m_lanes.bailout(lane))
+            {
+                finish(lane, true);
+            }
+            else
+            {
+                check_periodicity(lane);
+            }
+        }
+
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (!m_running[lane])
+            {
+                load(lane);
+            }
+        }
+    }
+}
+
+void RowKernel::run()
+{
+    compute(0, m_count - 1, -1);
+    verify();
+}
+
+// A guessed threshold is harmless when the orbit ended before periodicity
+// checking would have started under either threshold; otherwise the pixel
+// is computed again with the threshold the standard loop would have used.
+void RowKernel::verify()
+{
+    for (int pixel = 1; pixel < m_count; ++pixel)
+    {
+        const long actual{threshold_after(pixel - 1)};
+        const long guessed{m_pixels[pixel].threshold};
+        if (actual == guessed || m_pixels[pixel].color_iter - 1 <= std::min(actual, guessed))
+        {
+            continue;
+        }
+        compute(pixel, pixel, actual);
+    }
+}
+
+} // namespace
+
+const char *simd_formula_ineligible_reason()
+{
+    if (g_simd_mode == SimdMode::OFF)
+    {
+        return "simd=off";
+    }
+    if (g_fractal_type != FractalType::FORMULA)
+    {
+        return "not a formula fractal";
+    }
+    if (g_dispatch.calc_type() != standard_fractal_type || g_dispatch.orbit_calc() != formula_orbit ||
+        g_dispatch.per_pixel() != formula_per_pixel)
+    {
+        return "not the standard formula calculator";
+    }
+    if (!use_formula_vm())
+    {
+        return "formula runs on the interpreter";
+    }
+    if (const char *reason = FormulaLanes::ineligible_reason(g_formula_vm, g_formula); reason != nullptr)
+    {
+        return reason;
+    }
+    if (g_std_calc_mode != CalcMode::ONE_PASS)
+    {
+        return "passes is not 1";
+    }
+    if (g_inversion.invert != 0)
+    {
+        return "inversion";
+    }
+    if (g_bf_math != BFMathType::NONE)
+    {
+        return "arbitrary precision";
+    }
+    if (g_max_iterations < 2)
+    {
+        return "maxiter is less than 2";
+    }
+    if (g_potential.flag)
+    {
+        return "potential";
+    }
+    if (g_distance_estimator)
+    {
+        return "distance estimator";
+    }
+    if (g_attractor.count > 0)
+    {
+        return "finite attractor";
+    }
+    if (g_decomp[0] > 0)
+    {
+        return "decomposition";
+    }
+    if (g_show_orbit)
+    {
+        return "orbit display";
+    }
+    if (g_inside_method < ColorMethod::ITER && g_inside_method != ColorMethod::ZMAG &&
+        g_inside_method != ColorMethod::ATANI)
+    {
+        return "unsupported inside coloring";
+    }
+    if (g_outside_method < ColorMethod::ATAN)
+    {
+        return "unsupported outside coloring";
+    }
+    return nullptr;
+}
+
+bool use_simd_formula()
+{
+    return simd_formula_ineligible_reason() == nullptr;
+}
+
+void simd_formula_row(const int row, const int first_col, const int last_col, FormulaPixel *pixels)
+{
+    if (last_col < first_col)
+    {
+        return;
+    }
+    RowKernel kernel{row, first_col, last_col, pixels};
+    kernel.run();
+}
+
+// The adjustments of StandardFractal::calculate_standard_pixel() that
+// apply to the settings simd_formula_ineligible_reason() accepts.
+int plot_formula_pixel(const FormulaPixel &pixel)
+{
+    formula_pixel_color(pixel);
+    set_pixel_iteration(g_real_color_iter, g_new_z);
+    g_plot(g_col, g_row, g_color);
+    clear_pixel_iteration();
+    return g_color;
+}
+
+int formula_pixel_color(const FormulaPixel &pixel)
+{
+    if (pixel.new_z_set)
+    {
+        g_new_z = pixel.new_z;
+    }
+    g_color_iter = pixel.color_iter;
+    save_color_iter();
+    if (g_color_iter >= g_max_iterations)
+    {
+        inside_color(pixel.caught_cycle);
+    }
+    else
+    {
+        if (g_outside_method < ColorMethod::ITER)
+        {
+            outside_method_color(0.0, 0.0);
+        }
+        escaped_color(false);
+    }
+    color_from_color_iter();
+    return g_color;
+}
+
+} // namespace id::engine
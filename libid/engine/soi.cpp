@@ -13,17 +13,22 @@
  */
 #include "engine/soi.h"
 
+#include "engine/bailout_formula.h"
 #include "engine/calcfrac.h"
 #include "engine/fractals.h"
 #include "engine/ImageRegion.h"
 #include "engine/LogicalScreen.h"
+#include "engine/TileScheduler.h"
 #include "fractals/fractalp.h"
+#include "math/cmplx.h"
 #include "misc/Driver.h"
 #include "misc/stack_avail.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iterator>
+#include <vector>
 
 using namespace id::fractals;
 using namespace id::math;
@@ -43,11 +48,6 @@ int g_max_rhombus_depth{};
 int g_soi_min_stack_available{};
 int g_soi_min_stack{2200}; // and this much stack to not crash when <tab> is pressed
 
-static DComplex z_sqr(const DComplex z)
-{
-    return { z.x*z.x, z.y*z.y };
-}
-
 /* compute coefficients of Newton polynomial (b0,..,b2) from
    (x0,w0),..,(x2,w2). */
 static void interpolate(const double x0, const double x1, const double x2, //
@@ -67,8 +67,8 @@ static double evaluate(const double x0, const double x1, //
     return (b2*(t - x1) + b1)*(t - x0) + b0;
 }
 
-static long iteration(const double cr, const double ci, //
-    const double re, const double im,                   //
+static long engine_iteration(const double cr, const double ci, //
+    const double re, const double im,                          //
     long start)
 {
     g_old_z.x = re;
@@ -89,22 +89,6 @@ static long iteration(const double cr, const double ci, //
     return start;
 }
 
-static void put_hor_line(const int x1, const int y1, const int x2, const int color)
-{
-    for (int x = x1; x <= x2; x++)
-    {
-        g_plot(x, y1, color);
-    }
-}
-
-static void put_box(const int x1, int y1, const int x2, const int y2, const int color)
-{
-    for (; y1 <= y2; y1++)
-    {
-        put_hor_line(x1, y1, x2, color);
-    }
-}
-
 /* maximum side length beyond which we start regular scanning instead of
    subdividing */
 enum
@@ -129,224 +113,419 @@ static inline double interpolate(const double x0, const double x1, const double
     return (((w2 - w1)/(x2 - x1) - b)/(x2 - x0)*(t - x1) + b)*(t - x0) + w0;
 }
 
+namespace
+{
+
+constexpr int KEY_POINTS{9};
+constexpr int TEST_POINTS{4};
+// Orbits iterated together: the key points, then the test points, then
+// padding lanes that stay at the origin.
+constexpr int ORBIT_LANES{16};
+constexpr int TEST_LANE{KEY_POINTS};
+
+// Rows of a scan computed by one task.
+constexpr int SCAN_BAND_ROWS{8};
+// Rhombi are split off into tasks deep enough to make about this many per
+// worker, but never deeper than MAX_SPLIT_DEPTH.
+constexpr int TASKS_PER_WORKER{4};
+constexpr int MAX_SPLIT_DEPTH{5};
+
+// Render constants read by the reentrant rhombus code.
+struct SOIContext
+{
+    long max_iterations{};
+    double magnitude_limit{};
+    Bailout bailout_test{};
+    double t_width{};
+    bool engine_orbit{}; // scan with orbit_calc() through the engine globals
+};
+
+struct Rhombus
+{
+    double c_re1{};
+    double c_re2{};
+    double c_im1{};
+    double c_im2{};
+    int x1{};
+    int x2{};
+    int y1{};
+    int y2{};
+    DComplex zi[KEY_POINTS]{};
+    long iter{};
+};
+
+// Key and test point orbits in structure-of-arrays lanes, so one step of
+// all of them vectorizes.
+struct Orbits
+{
+    alignas(64) std::array<double, ORBIT_LANES> re{};
+    alignas(64) std::array<double, ORBIT_LANES> im{};
+    alignas(64) std::array<double, ORBIT_LANES> re_sqr{};
+    alignas(64) std::array<double, ORBIT_LANES> im_sqr{};
+    alignas(64) std::array<double, ORBIT_LANES> c_re{};
+    alignas(64) std::array<double, ORBIT_LANES> c_im{};
+
+    // Iterates z^2 + c once in every lane; true if any orbit escaped.
+    bool step()
+    {
+        int escaped{};
+        for (int i = 0; i < ORBIT_LANES; ++i)
+        {
+            im[i] = (im[i] + im[i]) * re[i] + c_im[i];
+            re[i] = re_sqr[i] - im_sqr[i] + c_re[i];
+            re_sqr[i] = re[i] * re[i];
+            im_sqr[i] = im[i] * im[i];
+            escaped |= re_sqr[i] + im_sqr[i] > 16.0 ? 1 : 0;
+        }
+        return escaped != 0;
+    }
+};
+
+// Work split off the top of the recursion.  Every task fills the pixels
+// [x1, x2) of rows [first_row, last_row) of its rhombus.
+struct SOITask
+{
+    enum class Kind
+    {
+        RHOMBUS,
+        SCAN,
+        BOX
+    };
+
+    Kind kind{};
+    Rhombus rhombus;
+    int depth{}; // recursion depth of the rhombus' parent
+    int first_row{};
+    int last_row{};
+    double first_im{}; // first_row's imaginary coordinate, as summed by the scan
+};
+
+class RhombusWalk
+{
+public:
+    // Plots directly, checking the keyboard and the stack as it goes.
+    explicit RhombusWalk(const SOIContext &ctx) :
+        m_ctx(ctx),
+        m_main(true)
+    {
+    }
+    // Writes colors to a buffer without touching the driver or the engine
+    // globals, so any thread can run it.
+    RhombusWalk(const SOIContext &ctx, Byte *colors, const int stride, const int depth) :
+        m_ctx(ctx),
+        m_colors(colors),
+        m_stride(stride),
+        m_depth(depth)
+    {
+    }
+
+    // Hands rhombi at the given depth, and the scans and boxes above it, to
+    // tasks instead of computing them.
+    void split(const int depth, std::vector<SOITask> *tasks)
+    {
+        m_split_depth = depth;
+        m_tasks = tasks;
+    }
+
+    bool rhombus(const Rhombus &r);
+    bool run(const SOITask &task);
+
+private:
+    bool rhombus_aux(const Rhombus &r);
+    bool scan(const Rhombus &r);
+    bool scan(const Rhombus &r, int first_row, int last_row, double first_im);
+    long iteration(double cr, double ci, double re, double im, long start) const;
+    bool bailed_out(double re, double im, double re_sqr, double im_sqr) const;
+    void plot(int x, int y, int color);
+    void put_hor_line(int x1, int y1, int x2, int color);
+    void put_box(const Rhombus &r, int color);
+
+    const SOIContext &m_ctx;
+    Byte *m_colors{};
+    int m_stride{};
+    bool m_main{};
+    int m_depth{-1};
+    int m_split_depth{-1};
+    std::vector<SOITask> *m_tasks{};
+};
+
+} // namespace
+
+bool RhombusWalk::bailed_out(const double re, const double im, const double re_sqr, const double im_sqr) const
+{
+    const double limit{m_ctx.magnitude_limit};
+    switch (m_ctx.bailout_test)
+    {
+    case Bailout::MOD:
+        return re_sqr + im_sqr >= limit;
+    case Bailout::REAL:
+        return re_sqr >= limit;
+    case Bailout::IMAG:
+        return im_sqr >= limit;
+    case Bailout::OR:
+        return re_sqr >= limit || im_sqr >= limit;
+    case Bailout::AND:
+        return re_sqr >= limit && im_sqr >= limit;
+    case Bailout::MANH:
+    {
+        const double manh_mag{std::abs(re) + std::abs(im)};
+        return manh_mag * manh_mag >= limit;
+    }
+    case Bailout::MANR:
+        return (re + im) * (re + im) >= limit;
+    }
+    return true;
+}
+
+// Same as engine_iteration() with the Mandelbrot orbit, but held in locals.
+long RhombusWalk::iteration(const double cr, const double ci, //
+    const double re, const double im,                          //
+    long start) const
+{
+    if (m_ctx.engine_orbit)
+    {
+        return engine_iteration(cr, ci, re, im, start);
+    }
+    double x{re};
+    double y{im};
+    double x_sqr{x * x};
+    double y_sqr{y * y};
+    while (true)
+    {
+        const double new_x{x_sqr - y_sqr + cr};
+        const double new_y{2.0 * x * y + ci};
+        x_sqr = new_x * new_x;
+        y_sqr = new_y * new_y;
+        if (bailed_out(new_x, new_y, x_sqr, y_sqr) || start >= m_ctx.max_iterations)
+        {
+            break;
+        }
+        x = new_x;
+        y = new_y;
+        start++;
+    }
+    if (start >= m_ctx.max_iterations)
+    {
+        start = BASIN_COLOR;
+    }
+    return start;
+}
+
+void RhombusWalk::plot(const int x, const int y, const int color)
+{
+    if (m_colors == nullptr)
+    {
+        g_plot(x, y, color);
+    }
+    else
+    {
+        m_colors[static_cast<std::size_t>(y) * m_stride + x] = static_cast<Byte>(color);
+    }
+}
+
+void RhombusWalk::put_hor_line(const int x1, const int y1, const int x2, const int color)
+{
+    for (int x = x1; x <= x2; x++)
+    {
+        plot(x, y1, color);
+    }
+}
+
+void RhombusWalk::put_box(const Rhombus &r, const int color)
+{
+    if (m_tasks != nullptr)
+    {
+        SOITask task{SOITask::Kind::BOX, r, m_depth};
+        task.first_row = r.y1;
+        task.last_row = r.y2;
+        m_tasks->push_back(task);
+        return;
+    }
+    if (m_colors != nullptr)
+    {
+        // the plotted box overlaps the rhombi to the right and below, which
+        // are computed later and paint over it; keep to this one's pixels
+        for (int y = r.y1; y < r.y2; y++)
+        {
+            put_hor_line(r.x1, y, r.x2 - 1, color);
+        }
+        return;
+    }
+    for (int y = r.y1; y <= r.y2; y++)
+    {
+        put_hor_line(r.x1, y, r.x2, color);
+    }
+}
+
 // SOICompute - Perform simultaneous orbit iteration for a given rectangle
 //
 // Input: c_re1..c_im2 : values defining the four corners of the rectangle
 //        x1..y2     : corresponding pixel values
-//    m_zi[0..8].x,im  : intermediate iterated values of the key points (key values)
+//    zi[0..8].x,im    : intermediate iterated values of the key points (key values)
 //
 // (c_re1,c_im1)                                    (c_re2,c_im1)
-// (m_zi[0].x,m_zi[0].y)   (m_zi[4].x,m_zi[4].y)  (m_zi[1].x,m_zi[1].y)
+// (zi[0].x,zi[0].y)   (zi[4].x,zi[4].y)  (zi[1].x,zi[1].y)
 //     +--------------------------+--------------------+
 //     |                          |                    |
 //     |                          |                    |
-// (m_zi[5].x,m_zi[5].y)   (m_zi[8].x,m_zi[8].y)  (m_zi[6].x,m_zi[6].y)
+// (zi[5].x,zi[5].y)   (zi[8].x,zi[8].y)  (zi[6].x,zi[6].y)
 //     |                          |                    |
 //     |                          |                    |
 //     +--------------------------+--------------------+
-// (m_zi[2].x,m_zi[2].y)   (m_zi[7].x,m_zi[7].y)  (m_zi[3].x,m_zi[3].y)
+// (zi[2].x,zi[2].y)   (zi[7].x,zi[7].y)  (zi[3].x,zi[3].y)
 // (c_re1,c_im2)                                    (c_re2,c_im2)
 //
 // iter       : current number of iterations
 
-bool SOI::rhombus2(const double cre1, const double cre2, const double cim1, const double cim2, //
-    const int x1, const int x2, const int y1, const int y2,                                    //
-    const double zre1, const double zim1, const double zre2, const double zim2,                //
-    const double zre3, const double zim3, const double zre4, const double zim4,                //
-    const double zre5, const double zim5, const double zre6, const double zim6,                //
-    const double zre7, const double zim7, const double zre8, const double zim8,                //
-    const double zre9, const double zim9,                                                      //
-    const long iter)
+bool RhombusWalk::rhombus(const Rhombus &r)
 {
-    m_zi[0].x = zre1;
-    m_zi[0].y = zim1;
-    m_zi[1].x = zre2;
-    m_zi[1].y = zim2;
-    m_zi[2].x = zre3;
-    m_zi[2].y = zim3;
-    m_zi[3].x = zre4;
-    m_zi[3].y = zim4;
-    m_zi[4].x = zre5;
-    m_zi[4].y = zim5;
-    m_zi[5].x = zre6;
-    m_zi[5].y = zim6;
-    m_zi[6].x = zre7;
-    m_zi[6].y = zim7;
-    m_zi[7].x = zre8;
-    m_zi[7].y = zim8;
-    m_zi[8].x = zre9;
-    m_zi[8].y = zim9;
-    return rhombus(cre1, cre2, cim1, cim2, x1, x2, y1, y2, iter);
+    if (m_tasks != nullptr && m_depth + 1 == m_split_depth)
+    {
+        SOITask task{SOITask::Kind::RHOMBUS, r, m_depth};
+        task.first_row = r.y1;
+        task.last_row = r.y2;
+        m_tasks->push_back(task);
+        return false;
+    }
+    ++m_depth;
+    const bool result = rhombus_aux(r);
+    --m_depth;
+    return result;
 }
 
-bool SOI::rhombus2(const double cre1, const double cre2, const double cim1, const double cim2, //
-    const int x1, const int x2, const int y1, const int y2,                                    //
-    const DComplex z1, const DComplex z2,                                            //
-    const DComplex z3, const DComplex z4,                                            //
-    const double zre5, const double zim5, const double zre6, const double zim6,                //
-    const double zre7, const double zim7, const double zre8, const double zim8,                //
-    const double zre9, const double zim9,                                                      //
-    const long iter)
+bool RhombusWalk::run(const SOITask &task)
 {
-    return rhombus2(cre1, cre2, cim1, cim2,                                                    //
-        x1, x2, y1, y2,                                                                        //
-        z1.x, z1.y, z2.x, z2.y,                                                            //
-        z3.x, z3.y, z4.x, z4.y,                                                            //
-        zre5, zim5, zre6, zim6,                                                                //
-        zre7, zim7, zre8, zim8,                                                                //
-        zre9, zim9,                                                                            //
-        iter);
+    switch (task.kind)
+    {
+    case SOITask::Kind::RHOMBUS:
+        return rhombus(task.rhombus);
+    case SOITask::Kind::SCAN:
+        return scan(task.rhombus, task.first_row, task.last_row, task.first_im);
+    case SOITask::Kind::BOX:
+        put_box(task.rhombus, 0);
+        return false;
+    }
+    return false;
 }
 
-void SOI::soi_orbit(DComplex &z, DComplex &rq, const double cr, const double ci, bool &esc)
+bool RhombusWalk::scan(const Rhombus &r)
 {
-    z.y = (z.y + z.y) * z.x + ci;
-    z.x = rq.x - rq.y + cr;
-    rq.x = z.x * z.x;
-    rq.y = z.y * z.y;
-    esc = rq.x + rq.y > 16.0;
+    if (m_tasks == nullptr)
+    {
+        return scan(r, r.y1, r.y2, r.c_im1);
+    }
+    // split the rows into bands, each starting from the running sum the
+    // whole scan would have reached
+    const double step_y = (r.c_im2 - r.c_im1) / (r.y2 - r.y1);
+    double im{r.c_im1};
+    for (int y = r.y1; y < r.y2; y += SCAN_BAND_ROWS)
+    {
+        SOITask task{SOITask::Kind::SCAN, r, m_depth};
+        task.first_row = y;
+        task.last_row = std::min(y + SCAN_BAND_ROWS, r.y2);
+        task.first_im = im;
+        m_tasks->push_back(task);
+        for (int row = task.first_row; row < task.last_row; ++row)
+        {
+            im += step_y;
+        }
+    }
+    return false;
 }
 
-bool SOI::rhombus_aux(const double c_re1, const double c_re2, const double c_im1, const double c_im2, //
-    const int x1, const int x2, const int y1, const int y2, long iter)
+// finish up the image by scanning rows [first_row, last_row) of the rectangle
+bool RhombusWalk::scan(const Rhombus &r, const int first_row, const int last_row, const double first_im)
 {
-    // The following variables do not need their values saved
-    // used in scanning
+    const double c_re1 = r.c_re1;
+    const double c_re2 = r.c_re2;
+    const double c_im1 = r.c_im1;
+    const double c_im2 = r.c_im2;
+    const int x1 = r.x1;
+    const int x2 = r.x2;
+    const DComplex *zi = r.zi;
+    const long iter = r.iter;
+    const double mid_r = (c_re1 + c_re2) / 2;
+    const double mid_i = (c_im1 + c_im2) / 2;
+
     long save_color{};
     long color{};
     long help_color{};
     int x{};
-    int y{};
     int z{};
     int save_x{};
-
-    // number of iterations before SOI iteration cycle
-    long before{};
-    int avail{};
-
-    // the variables below need to have local copies for recursive calls
-    // center of rectangle
-    const double mid_r = (c_re1 + c_re2) / 2;
-    const double mid_i = (c_im1 + c_im2)/2;
-
-    DComplex s[9];
-
-    bool status{};
-    avail = stack_avail();
-    g_soi_min_stack_available = std::min(avail, g_soi_min_stack_available);
-    g_max_rhombus_depth = std::max(m_rhombus_depth, g_max_rhombus_depth);
-    g_rhombus_stack[m_rhombus_depth] = avail;
-
-    if (driver_key_pressed())
-    {
-        return true;
-    }
-    if (iter > g_max_iterations)
-    {
-        put_box(x1, y1, x2, y2, 0);
-        return false;
-    }
-
-    if (y2 - y1 <= SCAN || avail < g_soi_min_stack)
+    DComplex b1[3];
+    DComplex b2[3];
+    DComplex b3[3];
+
+    interpolate(c_re1, mid_r, c_re2, zi[0].x, zi[4].x, zi[1].x, b1[0].x, b1[1].x, b1[2].x);
+    interpolate(c_re1, mid_r, c_re2, zi[5].x, zi[8].x, zi[6].x, b2[0].x, b2[1].x, b2[2].x);
+    interpolate(c_re1, mid_r, c_re2, zi[2].x, zi[7].x, zi[3].x, b3[0].x, b3[1].x, b3[2].x);
+
+    interpolate(c_im1, mid_i, c_im2, zi[0].y, zi[5].y, zi[2].y, b1[0].y, b1[1].y, b1[2].y);
+    interpolate(c_im1, mid_i, c_im2, zi[4].y, zi[8].y, zi[7].y, b2[0].y, b2[1].y, b2[2].y);
+    interpolate(c_im1, mid_i, c_im2, zi[1].y, zi[6].y, zi[3].y, b3[0].y, b3[1].y, b3[2].y);
+
+    DComplex step;
+    step.x = (c_re2 - c_re1) / (x2 - x1);
+    step.y = (c_im2 - c_im1) / (r.y2 - r.y1);
+    const double interleave_step = INTERLEAVE * step.x;
+
+    /* compute the value of the interpolation polynomial at (x,y)
+       during scanning. Here, key values do not change, so we can precompute
+       coefficients in one direction and simply evaluate the polynomial
+       during scanning. */
+    const auto get_scan_real{[&](const double re, const double im)
+        {
+            return interpolate(c_im1, mid_i, c_im2,
+                evaluate(c_re1, mid_r, b1[0].x, b1[1].x, b1[2].x, re),
+                evaluate(c_re1, mid_r, b2[0].x, b2[1].x, b2[2].x, re),
+                evaluate(c_re1, mid_r, b3[0].x, b3[1].x, b3[2].x, re), im);
+        }};
+    const auto get_scan_imag{[&](const double re, const double im)
+        {
+            return interpolate(c_re1, mid_r, c_re2,
+                evaluate(c_im1, mid_i, b1[0].y, b1[1].y, b1[2].y, im),
+                evaluate(c_im1, mid_i, b2[0].y, b2[1].y, b2[2].y, im),
+                evaluate(c_im1, mid_i, b3[0].y, b3[1].y, b3[2].y, im), re);
+        }};
+    DComplex pos;
+    DComplex scan_z;
+    double help_real;
+    pos.y = first_im;
+    for (int y = first_row; y < last_row; y++, pos.y += step.y)
     {
-        // finish up the image by scanning the rectangle
-scan:
-        interpolate(c_re1, mid_r, c_re2, m_zi[0].x, m_zi[4].x, m_zi[1].x, m_b1[0].x, m_b1[1].x, m_b1[2].x);
-        interpolate(c_re1, mid_r, c_re2, m_zi[5].x, m_zi[8].x, m_zi[6].x, m_b2[0].x, m_b2[1].x, m_b2[2].x);
-        interpolate(c_re1, mid_r, c_re2, m_zi[2].x, m_zi[7].x, m_zi[3].x, m_b3[0].x, m_b3[1].x, m_b3[2].x);
-
-        interpolate(c_im1, mid_i, c_im2, m_zi[0].y, m_zi[5].y, m_zi[2].y, m_b1[0].y, m_b1[1].y, m_b1[2].y);
-        interpolate(c_im1, mid_i, c_im2, m_zi[4].y, m_zi[8].y, m_zi[7].y, m_b2[0].y, m_b2[1].y, m_b2[2].y);
-        interpolate(c_im1, mid_i, c_im2, m_zi[1].y, m_zi[6].y, m_zi[3].y, m_b3[0].y, m_b3[1].y, m_b3[2].y);
-
-        m_step.x = (c_re2 - c_re1) / (x2 - x1);
-        m_step.y = (c_im2 - c_im1) / (y2 - y1);
-        m_interleave_step = INTERLEAVE * m_step.x;
-
-        /* compute the value of the interpolation polynomial at (x,y)
-           during scanning. Here, key values do not change, so we can precompute
-           coefficients in one direction and simply evaluate the polynomial
-           during scanning. */
-        const auto get_scan_real{[=](const double re, const double im)
-            {
-                return interpolate(c_im1, mid_i, c_im2,
-                    evaluate(c_re1, mid_r, m_b1[0].x, m_b1[1].x, m_b1[2].x, re),
-                    evaluate(c_re1, mid_r, m_b2[0].x, m_b2[1].x, m_b2[2].x, re),
-                    evaluate(c_re1, mid_r, m_b3[0].x, m_b3[1].x, m_b3[2].x, re), im);
-            }};
-        const auto get_scan_imag{[=](const double re, const double im)
-            {
-                return interpolate(c_re1, mid_r, c_re2,
-                    evaluate(c_im1, mid_i, m_b1[0].y, m_b1[1].y, m_b1[2].y, im),
-                    evaluate(c_im1, mid_i, m_b2[0].y, m_b2[1].y, m_b2[2].y, im),
-                    evaluate(c_im1, mid_i, m_b3[0].y, m_b3[1].y, m_b3[2].y, im), re);
-            }};
-        for (y = y1, m_z.y = c_im1; y < y2; y++, m_z.y += m_step.y)
+        if (m_main && driver_key_pressed())
         {
-            if (driver_key_pressed())
-            {
-                return true;
-            }
-            m_scan_z.x = get_scan_real(c_re1, m_z.y);
-            m_scan_z.y = get_scan_imag(c_re1, m_z.y);
-            save_color = iteration(c_re1, m_z.y, m_scan_z.x, m_scan_z.y, iter);
-            if (save_color < 0)
+            return true;
+        }
+        scan_z.x = get_scan_real(c_re1, pos.y);
+        scan_z.y = get_scan_imag(c_re1, pos.y);
+        save_color = iteration(c_re1, pos.y, scan_z.x, scan_z.y, iter);
+        if (save_color < 0)
+        {
+            return true;
+        }
+        save_x = x1;
+        for (x = x1 + INTERLEAVE, pos.x = c_re1 + interleave_step; x < x2; x += INTERLEAVE, pos.x += interleave_step)
+        {
+            scan_z.x = get_scan_real(pos.x, pos.y);
+            scan_z.y = get_scan_imag(pos.x, pos.y);
+
+            color = iteration(pos.x, pos.y, scan_z.x, scan_z.y, iter);
+            if (color < 0)
             {
                 return true;
             }
-            save_x = x1;
-            for (x = x1 + INTERLEAVE, m_z.x = c_re1 + m_interleave_step; x < x2;
-                x += INTERLEAVE, m_z.x += m_interleave_step)
+            if (color == save_color)
             {
-                m_scan_z.x = get_scan_real(m_z.x, m_z.y);
-                m_scan_z.y = get_scan_imag(m_z.x, m_z.y);
-
-                color = iteration(m_z.x, m_z.y, m_scan_z.x, m_scan_z.y, iter);
-                if (color < 0)
-                {
-                    return true;
-                }
-                if (color == save_color)
-                {
-                    continue;
-                }
-
-                for (z = x - 1, m_help_real = m_z.x - m_step.x; z > x - INTERLEAVE;
-                    z--, m_help_real -= m_step.x)
-                {
-                    m_scan_z.x = get_scan_real(m_help_real, m_z.y);
-                    m_scan_z.y = get_scan_imag(m_help_real, m_z.y);
-                    help_color = iteration(m_help_real, m_z.y, m_scan_z.x, m_scan_z.y, iter);
-                    if (help_color < 0)
-                    {
-                        return true;
-                    }
-                    if (help_color == save_color)
-                    {
-                        break;
-                    }
-                    g_plot(z, y, static_cast<int>(help_color & 255));
-                }
-
-                if (save_x < z)
-                {
-                    put_hor_line(save_x, y, z, static_cast<int>(save_color & 255));
-                }
-                else
-                {
-                    g_plot(save_x, y, static_cast<int>(save_color & 255));
-                }
-
-                save_x = x;
-                save_color = color;
+                continue;
             }
 
-            for (z = x2 - 1, m_help_real = c_re2 - m_step.x; z > save_x;
-                z--, m_help_real -= m_step.x)
+            for (z = x - 1, help_real = pos.x - step.x; z > x - INTERLEAVE; z--, help_real -= step.x)
             {
-                m_scan_z.x = get_scan_real(m_help_real, m_z.y);
-                m_scan_z.y = get_scan_imag(m_help_real, m_z.y);
-                help_color = iteration(m_help_real, m_z.y, m_scan_z.x, m_scan_z.y, iter);
+                scan_z.x = get_scan_real(help_real, pos.y);
+                scan_z.y = get_scan_imag(help_real, pos.y);
+                help_color = iteration(help_real, pos.y, scan_z.x, scan_z.y, iter);
                 if (help_color < 0)
                 {
                     return true;
@@ -355,8 +534,7 @@ scan:
                 {
                     break;
                 }
-
-                g_plot(z, y, static_cast<int>(help_color & 255));
+                plot(z, y, static_cast<int>(help_color & 255));
             }
 
             if (save_x < z)
@@ -365,154 +543,153 @@ scan:
             }
             else
             {
-                g_plot(save_x, y, static_cast<int>(save_color & 255));
+                plot(save_x, y, static_cast<int>(save_color & 255));
             }
+
+            save_x = x;
+            save_color = color;
         }
 
+        for (z = x2 - 1, help_real = c_re2 - step.x; z > save_x; z--, help_real -= step.x)
+        {
+            scan_z.x = get_scan_real(help_real, pos.y);
+            scan_z.y = get_scan_imag(help_real, pos.y);
+            help_color = iteration(help_real, pos.y, scan_z.x, scan_z.y, iter);
+            if (help_color < 0)
+            {
+                return true;
+            }
+            if (help_color == save_color)
+            {
+                break;
+            }
+
+            plot(z, y, static_cast<int>(help_color & 255));
+        }
+
+        if (save_x < z)
+        {
+            put_hor_line(save_x, y, z, static_cast<int>(save_color & 255));
+        }
+        else
+        {
+            plot(save_x, y, static_cast<int>(save_color & 255));
+        }
+    }
+
+    return false;
+}
+
+bool RhombusWalk::rhombus_aux(const Rhombus &r)
+{
+    const double c_re1 = r.c_re1;
+    const double c_re2 = r.c_re2;
+    const double c_im1 = r.c_im1;
+    const double c_im2 = r.c_im2;
+    const int x1 = r.x1;
+    const int x2 = r.x2;
+    const int y1 = r.y1;
+    const int y2 = r.y2;
+    long iter = r.iter;
+
+    // center of rectangle
+    const double mid_r = (c_re1 + c_re2) / 2;
+    const double mid_i = (c_im1 + c_im2) / 2;
+
+    bool low_stack{};
+    if (m_main)
+    {
+        const int avail = stack_avail();
+        g_soi_min_stack_available = std::min(avail, g_soi_min_stack_available);
+        g_max_rhombus_depth = std::max(m_depth, g_max_rhombus_depth);
+        if (m_depth < static_cast<int>(std::size(g_rhombus_stack)))
+        {
+            g_rhombus_stack[m_depth] = avail;
+        }
+        low_stack = avail < g_soi_min_stack;
+
+        if (driver_key_pressed())
+        {
+            return true;
+        }
+    }
+    if (iter > m_ctx.max_iterations)
+    {
+        put_box(r, 0);
         return false;
     }
 
-    std::transform(std::begin(m_zi), std::end(m_zi), std::begin(m_rq), z_sqr);
+    if (y2 - y1 <= SCAN || low_stack)
+    {
+        return scan(r);
+    }
+
+    Orbits orbits;
+    const double key_re[KEY_POINTS]{c_re1, c_re2, c_re1, c_re2, mid_r, c_re1, c_re2, mid_r, mid_r};
+    const double key_im[KEY_POINTS]{c_im1, c_im1, c_im2, c_im2, c_im1, mid_i, mid_i, c_im2, mid_i};
+    for (int i = 0; i < KEY_POINTS; ++i)
+    {
+        orbits.re[i] = r.zi[i].x;
+        orbits.im[i] = r.zi[i].y;
+        orbits.c_re[i] = key_re[i];
+        orbits.c_im[i] = key_im[i];
+    }
 
-    m_corner[0].x = 0.75 * c_re1 + 0.25 * c_re2;
-    m_corner[0].y = 0.75 * c_im1 + 0.25 * c_im2;
-    m_corner[1].x = 0.25 * c_re1 + 0.75 * c_re2;
-    m_corner[1].y = 0.25 * c_im1 + 0.75 * c_im2;
+    DComplex corner[2];
+    corner[0].x = 0.75 * c_re1 + 0.25 * c_re2;
+    corner[0].y = 0.75 * c_im1 + 0.25 * c_im2;
+    corner[1].x = 0.25 * c_re1 + 0.75 * c_re2;
+    corner[1].y = 0.25 * c_im1 + 0.75 * c_im2;
 
     // compute the value of the interpolation polynomial at (x,y)
-    const auto get_real{[=](const double re, const double im)
+    const auto get_real{[&](const double re, const double im)
         {
+            const std::array<double, ORBIT_LANES> &zr{orbits.re};
             return interpolate(c_im1, mid_i, c_im2,
-                interpolate(c_re1, mid_r, c_re2, m_zi[0].x, m_zi[4].x, m_zi[1].x, re),
-                interpolate(c_re1, mid_r, c_re2, m_zi[5].x, m_zi[8].x, m_zi[6].x, re),
-                interpolate(c_re1, mid_r, c_re2, m_zi[2].x, m_zi[7].x, m_zi[3].x, re), im);
+                interpolate(c_re1, mid_r, c_re2, zr[0], zr[4], zr[1], re),
+                interpolate(c_re1, mid_r, c_re2, zr[5], zr[8], zr[6], re),
+                interpolate(c_re1, mid_r, c_re2, zr[2], zr[7], zr[3], re), im);
         }};
-    const auto get_imag{[=](const double re, const double im)
+    const auto get_imag{[&](const double re, const double im)
         {
+            const std::array<double, ORBIT_LANES> &zi{orbits.im};
             return interpolate(c_re1, mid_r, c_re2,
-                interpolate(c_im1, mid_i, c_im2, m_zi[0].y, m_zi[5].y, m_zi[2].y, im),
-                interpolate(c_im1, mid_i, c_im2, m_zi[4].y, m_zi[8].y, m_zi[7].y, im),
-                interpolate(c_im1, mid_i, c_im2, m_zi[1].y, m_zi[6].y, m_zi[3].y, im), re);
+                interpolate(c_im1, mid_i, c_im2, zi[0], zi[5], zi[2], im),
+                interpolate(c_im1, mid_i, c_im2, zi[4], zi[8], zi[7], im),
+                interpolate(c_im1, mid_i, c_im2, zi[1], zi[6], zi[3], im), re);
         }};
-    m_tz[0].x = get_real(m_corner[0].x, m_corner[0].y);
-    m_tz[0].y = get_imag(m_corner[0].x, m_corner[0].y);
-
-    m_tz[1].x = get_real(m_corner[1].x, m_corner[0].y);
-    m_tz[1].y = get_imag(m_corner[1].x, m_corner[0].y);
-
-    m_tz[2].x = get_real(m_corner[0].x, m_corner[1].y);
-    m_tz[2].y = get_imag(m_corner[0].x, m_corner[1].y);
-
-    m_tz[3].x = get_real(m_corner[1].x, m_corner[1].y);
-    m_tz[3].y = get_imag(m_corner[1].x, m_corner[1].y);
-
-    std::transform(std::begin(m_tz), std::end(m_tz), std::begin(m_tq), z_sqr);
+    // test points between the key points
+    const double test_re[TEST_POINTS]{corner[0].x, corner[1].x, corner[0].x, corner[1].x};
+    const double test_im[TEST_POINTS]{corner[0].y, corner[0].y, corner[1].y, corner[1].y};
+    for (int i = 0; i < TEST_POINTS; ++i)
+    {
+        const double re = get_real(test_re[i], test_im[i]);
+        const double im = get_imag(test_re[i], test_im[i]);
+        orbits.re[TEST_LANE + i] = re;
+        orbits.im[TEST_LANE + i] = im;
+        orbits.c_re[TEST_LANE + i] = test_re[i];
+        orbits.c_im[TEST_LANE + i] = test_im[i];
+    }
+    for (int i = 0; i < ORBIT_LANES; ++i)
+    {
+        orbits.re_sqr[i] = orbits.re[i] * orbits.re[i];
+        orbits.im_sqr[i] = orbits.im[i] * orbits.im[i];
+    }
 
-    before = iter;
+    const long before = iter;
+    DComplex s[KEY_POINTS];
 
     while (true)
     {
-        std::copy(std::begin(m_zi), std::end(m_zi), std::begin(s));
-
-        // iterate key values
-        soi_orbit(m_zi[0], m_rq[0], c_re1, c_im1, m_esc[0]);
-        /*
-              zim1=(zim1+zim1)*zre1+c_im1;
-              zre1=rq1-iq1+c_re1;
-              rq1=zre1*zre1;
-              iq1=zim1*zim1;
-        */
-        soi_orbit(m_zi[1], m_rq[1], c_re2, c_im1, m_esc[1]);
-        /*
-              zim2=(zim2+zim2)*zre2+c_im1;
-              zre2=rq2-iq2+c_re2;
-              rq2=zre2*zre2;
-              iq2=zim2*zim2;
-        */
-        soi_orbit(m_zi[2], m_rq[2], c_re1, c_im2, m_esc[2]);
-        /*
-              zim3=(zim3+zim3)*zre3+c_im2;
-              zre3=rq3-iq3+c_re1;
-              rq3=zre3*zre3;
-              iq3=zim3*zim3;
-        */
-        soi_orbit(m_zi[3], m_rq[3], c_re2, c_im2, m_esc[3]);
-        /*
-              zim4=(zim4+zim4)*zre4+c_im2;
-              zre4=rq4-iq4+c_re2;
-              rq4=zre4*zre4;
-              iq4=zim4*zim4;
-        */
-        soi_orbit(m_zi[4], m_rq[4], mid_r, c_im1, m_esc[4]);
-        /*
-              zim5=(zim5+zim5)*zre5+c_im1;
-              zre5=rq5-iq5+mid_r;
-              rq5=zre5*zre5;
-              iq5=zim5*zim5;
-        */
-        soi_orbit(m_zi[5], m_rq[5], c_re1, mid_i, m_esc[5]);
-        /*
-              zim6=(zim6+zim6)*zre6+mid_i;
-              zre6=rq6-iq6+c_re1;
-              rq6=zre6*zre6;
-              iq6=zim6*zim6;
-        */
-        soi_orbit(m_zi[6], m_rq[6], c_re2, mid_i, m_esc[6]);
-        /*
-              zim7=(zim7+zim7)*zre7+mid_i;
-              zre7=rq7-iq7+c_re2;
-              rq7=zre7*zre7;
-              iq7=zim7*zim7;
-        */
-        soi_orbit(m_zi[7], m_rq[7], mid_r, c_im2, m_esc[7]);
-        /*
-              zim8=(zim8+zim8)*zre8+c_im2;
-              zre8=rq8-iq8+mid_r;
-              rq8=zre8*zre8;
-              iq8=zim8*zim8;
-        */
-        soi_orbit(m_zi[8], m_rq[8], mid_r, mid_i, m_esc[8]);
-        /*
-              zim9=(zim9+zim9)*zre9+mid_i;
-              zre9=rq9-iq9+mid_r;
-              rq9=zre9*zre9;
-              iq9=zim9*zim9;
-        */
-        // iterate test point
-        soi_orbit(m_tz[0], m_tq[0], m_corner[0].x, m_corner[0].y, m_t_esc[0]);
-        /*
-              tzi1=(tzi1+tzi1)*tzr1+ci1;
-              tzr1=trq1-tiq1+cr1;
-              trq1=tzr1*tzr1;
-              tiq1=tzi1*tzi1;
-        */
-
-        soi_orbit(m_tz[1], m_tq[1], m_corner[1].x, m_corner[0].y, m_t_esc[1]);
-        /*
-              tzi2=(tzi2+tzi2)*tzr2+ci1;
-              tzr2=trq2-tiq2+cr2;
-              trq2=tzr2*tzr2;
-              tiq2=tzi2*tzi2;
-        */
-        soi_orbit(m_tz[2], m_tq[2], m_corner[0].x, m_corner[1].y, m_t_esc[2]);
-        /*
-              tzi3=(tzi3+tzi3)*tzr3+ci2;
-              tzr3=trq3-tiq3+cr1;
-              trq3=tzr3*tzr3;
-              tiq3=tzi3*tzi3;
-        */
-        soi_orbit(m_tz[3], m_tq[3], m_corner[1].x, m_corner[1].y, m_t_esc[3]);
-        /*
-              tzi4=(tzi4+tzi4)*tzr4+ci2;
-              tzr4=trq4-tiq4+cr2;
-              trq4=tzr4*tzr4;
-              tiq4=tzi4*tzi4;
-        */
-        iter++;
+        for (int i = 0; i < KEY_POINTS; ++i)
+        {
+            s[i] = {orbits.re[i], orbits.im[i]};
+        }
 
-        // if one of the iterated values bails out, subdivide
-        if (std::find(std::begin(m_esc), std::end(m_esc), true) != std::end(m_esc) ||
-            std::find(std::begin(m_t_esc), std::end(m_t_esc), true) != std::end(m_t_esc))
+        // iterate key values and test points; if one of them bails out, subdivide
+        const bool escaped = orbits.step();
+        iter++;
+        if (escaped)
         {
             break;
         }
@@ -520,74 +697,32 @@ scan:
         /* if maximum number of iterations is reached, the whole rectangle
         can be assumed part of M. This is of course best case behavior
         of SOI, we seldom get there */
-        if (iter > g_max_iterations)
+        if (iter > m_ctx.max_iterations)
         {
-            put_box(x1, y1, x2, y2, 0);
+            put_box(r, 0);
             return false;
         }
 
         /* now for all test points, check whether they exceed the
         allowed tolerance. if so, subdivide */
-        m_limit.x = get_real(m_corner[0].x, m_corner[0].y);
-        m_limit.x =
-            m_tz[0].x == 0.0 ? m_limit.x == 0.0 ? 1.0 : 1000.0 : m_limit.x / m_tz[0].x;
-        if (std::abs(1.0 - m_limit.x) > m_t_width)
+        bool within{true};
+        for (int i = 0; i < TEST_POINTS && within; ++i)
         {
-            break;
-        }
-
-        m_limit.y = get_imag(m_corner[0].x, m_corner[0].y);
-        m_limit.y =
-            m_tz[0].y == 0.0 ? m_limit.y == 0.0 ? 1.0 : 1000.0 : m_limit.y / m_tz[0].y;
-        if (std::abs(1.0 - m_limit.y) > m_t_width)
-        {
-            break;
-        }
-
-        m_limit.x = get_real(m_corner[1].x, m_corner[0].y);
-        m_limit.x =
-            m_tz[1].x == 0.0 ? m_limit.x == 0.0 ? 1.0 : 1000.0 : m_limit.x / m_tz[1].x;
-        if (std::abs(1.0 - m_limit.x) > m_t_width)
-        {
-            break;
-        }
-
-        m_limit.y = get_imag(m_corner[1].x, m_corner[0].y);
-        m_limit.y =
-            m_tz[1].y == 0.0 ? m_limit.y == 0.0 ? 1.0 : 1000.0 : m_limit.y / m_tz[1].y;
-        if (std::abs(1.0 - m_limit.y) > m_t_width)
-        {
-            break;
-        }
-
-        m_limit.x = get_real(m_corner[0].x, m_corner[1].y);
-        m_limit.x =
-            m_tz[2].x == 0.0 ? m_limit.x == 0.0 ? 1.0 : 1000.0 : m_limit.x / m_tz[2].x;
-        if (std::abs(1.0 - m_limit.x) > m_t_width)
-        {
-            break;
-        }
-
-        m_limit.y = get_imag(m_corner[0].x, m_corner[1].y);
-        m_limit.y =
-            m_tz[2].y == 0.0 ? m_limit.y == 0.0 ? 1.0 : 1000.0 : m_limit.y / m_tz[2].y;
-        if (std::abs(1.0 - m_limit.y) > m_t_width)
-        {
-            break;
-        }
+            const double tz_re = orbits.re[TEST_LANE + i];
+            const double tz_im = orbits.im[TEST_LANE + i];
+            double limit = get_real(test_re[i], test_im[i]);
+            limit = tz_re == 0.0 ? limit == 0.0 ? 1.0 : 1000.0 : limit / tz_re;
+            if (std::abs(1.0 - limit) > m_ctx.t_width)
+            {
+                within = false;
+                break;
+            }
 
-        m_limit.x = get_real(m_corner[1].x, m_corner[1].y);
-        m_limit.x =
-            m_tz[3].x == 0.0 ? m_limit.x == 0.0 ? 1.0 : 1000.0 : m_limit.x / m_tz[3].x;
-        if (std::abs(1.0 - m_limit.x) > m_t_width)
-        {
-            break;
+            limit = get_imag(test_re[i], test_im[i]);
+            limit = tz_im == 0.0 ? limit == 0.0 ? 1.0 : 1000.0 : limit / tz_im;
+            within = std::abs(1.0 - limit) <= m_ctx.t_width;
         }
-
-        m_limit.y = get_imag(m_corner[1].x, m_corner[1].y);
-        m_limit.y =
-            m_tz[3].y == 0.0 ? m_limit.y == 0.0 ? 1.0 : 1000.0 : m_limit.y / m_tz[3].y;
-        if (std::abs(1.0 - m_limit.y) > m_t_width)
+        if (!within)
         {
             break;
         }
@@ -598,118 +733,202 @@ scan:
     // this is a little heuristic I tried to improve performance.
     if (iter - before < 10)
     {
-        std::copy(std::begin(s), std::end(s), std::begin(m_zi));
-        goto scan;
+        Rhombus scanned{r};
+        std::copy(std::begin(s), std::end(s), std::begin(scanned.zi));
+        scanned.iter = iter;
+        return scan(scanned);
     }
 
     // compute key values for subsequent rectangles
 
-    const double re10 = interpolate(c_re1, mid_r, c_re2, s[0].x, s[4].x, s[1].x, m_corner[0].x);
-    const double im10 = interpolate(c_re1, mid_r, c_re2, s[0].y, s[4].y, s[1].y, m_corner[0].x);
+    const double re10 = interpolate(c_re1, mid_r, c_re2, s[0].x, s[4].x, s[1].x, corner[0].x);
+    const double im10 = interpolate(c_re1, mid_r, c_re2, s[0].y, s[4].y, s[1].y, corner[0].x);
 
-    const double re11 = interpolate(c_re1, mid_r, c_re2, s[0].x, s[4].x, s[1].x, m_corner[1].x);
-    const double im11 = interpolate(c_re1, mid_r, c_re2, s[0].y, s[4].y, s[1].y, m_corner[1].x);
+    const double re11 = interpolate(c_re1, mid_r, c_re2, s[0].x, s[4].x, s[1].x, corner[1].x);
+    const double im11 = interpolate(c_re1, mid_r, c_re2, s[0].y, s[4].y, s[1].y, corner[1].x);
 
-    const double re20 = interpolate(c_re1, mid_r, c_re2, s[2].x, s[7].x, s[3].x, m_corner[0].x);
-    const double im20 = interpolate(c_re1, mid_r, c_re2, s[2].y, s[7].y, s[3].y, m_corner[0].x);
+    const double re20 = interpolate(c_re1, mid_r, c_re2, s[2].x, s[7].x, s[3].x, corner[0].x);
+    const double im20 = interpolate(c_re1, mid_r, c_re2, s[2].y, s[7].y, s[3].y, corner[0].x);
 
-    const double re21 = interpolate(c_re1, mid_r, c_re2, s[2].x, s[7].x, s[3].x, m_corner[1].x);
-    const double im21 = interpolate(c_re1, mid_r, c_re2, s[2].y, s[7].y, s[3].y, m_corner[1].x);
+    const double re21 = interpolate(c_re1, mid_r, c_re2, s[2].x, s[7].x, s[3].x, corner[1].x);
+    const double im21 = interpolate(c_re1, mid_r, c_re2, s[2].y, s[7].y, s[3].y, corner[1].x);
 
-    const double re15 = interpolate(c_re1, mid_r, c_re2, s[5].x, s[8].x, s[6].x, m_corner[0].x);
-    const double im15 = interpolate(c_re1, mid_r, c_re2, s[5].y, s[8].y, s[6].y, m_corner[0].x);
+    const double re15 = interpolate(c_re1, mid_r, c_re2, s[5].x, s[8].x, s[6].x, corner[0].x);
+    const double im15 = interpolate(c_re1, mid_r, c_re2, s[5].y, s[8].y, s[6].y, corner[0].x);
 
-    const double re16 = interpolate(c_re1, mid_r, c_re2, s[5].x, s[8].x, s[6].x, m_corner[1].x);
-    const double im16 = interpolate(c_re1, mid_r, c_re2, s[5].y, s[8].y, s[6].y, m_corner[1].x);
+    const double re16 = interpolate(c_re1, mid_r, c_re2, s[5].x, s[8].x, s[6].x, corner[1].x);
+    const double im16 = interpolate(c_re1, mid_r, c_re2, s[5].y, s[8].y, s[6].y, corner[1].x);
 
-    const double re12 = interpolate(c_im1, mid_i, c_im2, s[0].x, s[5].x, s[2].x, m_corner[0].y);
-    const double im12 = interpolate(c_im1, mid_i, c_im2, s[0].y, s[5].y, s[2].y, m_corner[0].y);
+    const double re12 = interpolate(c_im1, mid_i, c_im2, s[0].x, s[5].x, s[2].x, corner[0].y);
+    const double im12 = interpolate(c_im1, mid_i, c_im2, s[0].y, s[5].y, s[2].y, corner[0].y);
 
-    const double re14 = interpolate(c_im1, mid_i, c_im2, s[1].x, s[6].x, s[3].x, m_corner[0].y);
-    const double im14 = interpolate(c_im1, mid_i, c_im2, s[1].y, s[6].y, s[3].y, m_corner[0].y);
+    const double re14 = interpolate(c_im1, mid_i, c_im2, s[1].x, s[6].x, s[3].x, corner[0].y);
+    const double im14 = interpolate(c_im1, mid_i, c_im2, s[1].y, s[6].y, s[3].y, corner[0].y);
 
-    const double re17 = interpolate(c_im1, mid_i, c_im2, s[0].x, s[5].x, s[2].x, m_corner[1].y);
-    const double im17 = interpolate(c_im1, mid_i, c_im2, s[0].y, s[5].y, s[2].y, m_corner[1].y);
+    const double re17 = interpolate(c_im1, mid_i, c_im2, s[0].x, s[5].x, s[2].x, corner[1].y);
+    const double im17 = interpolate(c_im1, mid_i, c_im2, s[0].y, s[5].y, s[2].y, corner[1].y);
 
-    const double re19 = interpolate(c_im1, mid_i, c_im2, s[1].x, s[6].x, s[3].x, m_corner[1].y);
-    const double im19 = interpolate(c_im1, mid_i, c_im2, s[1].y, s[6].y, s[3].y, m_corner[1].y);
+    const double re19 = interpolate(c_im1, mid_i, c_im2, s[1].x, s[6].x, s[3].x, corner[1].y);
+    const double im19 = interpolate(c_im1, mid_i, c_im2, s[1].y, s[6].y, s[3].y, corner[1].y);
 
-    const double re13 = interpolate(c_im1, mid_i, c_im2, s[4].x, s[8].x, s[7].x, m_corner[0].y);
-    const double im13 = interpolate(c_im1, mid_i, c_im2, s[4].y, s[8].y, s[7].y, m_corner[0].y);
+    const double re13 = interpolate(c_im1, mid_i, c_im2, s[4].x, s[8].x, s[7].x, corner[0].y);
+    const double im13 = interpolate(c_im1, mid_i, c_im2, s[4].y, s[8].y, s[7].y, corner[0].y);
 
-    const double re18 = interpolate(c_im1, mid_i, c_im2, s[4].x, s[8].x, s[7].x, m_corner[1].y);
-    const double im18 = interpolate(c_im1, mid_i, c_im2, s[4].y, s[8].y, s[7].y, m_corner[1].y);
+    const double re18 = interpolate(c_im1, mid_i, c_im2, s[4].x, s[8].x, s[7].x, corner[1].y);
+    const double im18 = interpolate(c_im1, mid_i, c_im2, s[4].y, s[8].y, s[7].y, corner[1].y);
 
     // compute the value of the interpolation polynomial at (x,y)
     // from saved values before interpolation failed to stay within tolerance
-    const auto get_saved_real{[=](const double re, const double im)
+    const auto get_saved_real{[&](const double re, const double im)
         {
             return interpolate(c_im1, mid_i, c_im2, interpolate(c_re1, mid_r, c_re2, s[0].x, s[4].x, s[1].x, re),
                 interpolate(c_re1, mid_r, c_re2, s[5].x, s[8].x, s[6].x, re),
                 interpolate(c_re1, mid_r, c_re2, s[2].x, s[7].x, s[3].x, re), im);
         }};
-    const auto get_saved_imag{[=](const double re, const double im)
+    const auto get_saved_imag{[&](const double re, const double im)
         {
             return interpolate(c_re1, mid_r, c_re2, interpolate(c_im1, mid_i, c_im2, s[0].y, s[5].y, s[2].y, im),
                 interpolate(c_im1, mid_i, c_im2, s[4].y, s[8].y, s[7].y, im),
                 interpolate(c_im1, mid_i, c_im2, s[1].y, s[6].y, s[3].y, im), re);
         }};
-    const double re91 = get_saved_real(m_corner[0].x, m_corner[0].y);
-    const double im91 = get_saved_imag(m_corner[0].x, m_corner[0].y);
-    const double re92 = get_saved_real(m_corner[1].x, m_corner[0].y);
-    const double im92 = get_saved_imag(m_corner[1].x, m_corner[0].y);
-    const double re93 = get_saved_real(m_corner[0].x, m_corner[1].y);
-    const double im93 = get_saved_imag(m_corner[0].x, m_corner[1].y);
-    const double re94 = get_saved_real(m_corner[1].x, m_corner[1].y);
-    const double im94 = get_saved_imag(m_corner[1].x, m_corner[1].y);
-
-    status = rhombus2(c_re1, mid_r,                      //
-        c_im1, mid_i,                                    //
-        x1, (x1 + x2) >> 1, y1, (y1 + y2) >> 1,          //
-        s[0], s[4], s[5], s[8],                          //
-        re10, im10, re12, im12,                          //
-        re13, im13, re15, im15,                          //
-        re91, im91,                                      //
-        iter);
-    status = rhombus2(mid_r, c_re2,                      //
-                 c_im1, mid_i,                           //
-                 (x1 + x2) >> 1, x2, y1, (y1 + y2) >> 1, //
-                 s[4], s[1], s[8], s[6],                 //
-                 re11, im11, re13, im13,                 //
-                 re14, im14, re16, im16,                 //
-                 re92, im92,                             //
-                 iter) &&
+    const double re91 = get_saved_real(corner[0].x, corner[0].y);
+    const double im91 = get_saved_imag(corner[0].x, corner[0].y);
+    const double re92 = get_saved_real(corner[1].x, corner[0].y);
+    const double im92 = get_saved_imag(corner[1].x, corner[0].y);
+    const double re93 = get_saved_real(corner[0].x, corner[1].y);
+    const double im93 = get_saved_imag(corner[0].x, corner[1].y);
+    const double re94 = get_saved_real(corner[1].x, corner[1].y);
+    const double im94 = get_saved_imag(corner[1].x, corner[1].y);
+
+    const int mid_x = (x1 + x2) >> 1;
+    const int mid_y = (y1 + y2) >> 1;
+    bool status = rhombus({c_re1, mid_r, c_im1, mid_i, //
+        x1, mid_x, y1, mid_y,                          //
+        {s[0], s[4], s[5], s[8],                       //
+            {re10, im10}, {re12, im12},                //
+            {re13, im13}, {re15, im15},                //
+            {re91, im91}},                             //
+        iter});
+    status = rhombus({mid_r, c_re2, c_im1, mid_i,      //
+                 mid_x, x2, y1, mid_y,                 //
+                 {s[4], s[1], s[8], s[6],              //
+                     {re11, im11}, {re13, im13},       //
+                     {re14, im14}, {re16, im16},       //
+                     {re92, im92}},                    //
+                 iter}) &&
         status;
-    status = rhombus2(c_re1, mid_r,                      //
-                 mid_i, c_im2,                           //
-                 x1, (x1 + x2) >> 1, (y1 + y2) >> 1, y2, //
-                 s[5], s[8], s[2], s[7],                 //
-                 re15, im15, re17, im17,                 //
-                 re18, im18, re20, im20,                 //
-                 re93, im93,                             //
-                 iter) &&
+    status = rhombus({c_re1, mid_r, mid_i, c_im2,      //
+                 x1, mid_x, mid_y, y2,                 //
+                 {s[5], s[8], s[2], s[7],              //
+                     {re15, im15}, {re17, im17},       //
+                     {re18, im18}, {re20, im20},       //
+                     {re93, im93}},                    //
+                 iter}) &&
         status;
-    status = rhombus2(mid_r, c_re2,                      //
-                 mid_i, c_im2,                           //
-                 (x1 + x2) >> 1, x2, (y1 + y2) >> 1, y2, //
-                 s[8], s[6], s[7], s[3],                 //
-                 re16, im16, re18, im18,                 //
-                 re19, im19, re21, im21,                 //
-                 re94, im94,                             //
-                 iter) &&
+    status = rhombus({mid_r, c_re2, mid_i, c_im2,      //
+                 mid_x, x2, mid_y, y2,                 //
+                 {s[8], s[6], s[7], s[3],              //
+                     {re16, im16}, {re18, im18},       //
+                     {re19, im19}, {re21, im21},       //
+                     {re94, im94}},                    //
+                 iter}) &&
         status;
 
     return status;
 }
 
-bool SOI::rhombus(const double c_re1, const double c_re2, const double c_im1, const double c_im2, //
-    const int x1, const int x2, const int y1, const int y2,                                       //
-    const long iter)
+static SOIContext soi_context(const double t_width)
 {
-    ++m_rhombus_depth;
-    const bool result = rhombus_aux(c_re1, c_re2, c_im1, c_im2, x1, x2, y1, y2, iter);
-    --m_rhombus_depth;
-    return result;
+    SOIContext ctx;
+    ctx.max_iterations = g_max_iterations;
+    ctx.magnitude_limit = g_magnitude_limit;
+    ctx.bailout_test = g_bailout_test;
+    ctx.t_width = t_width;
+    ctx.engine_orbit = g_bf_math != BFMathType::NONE || g_dispatch.orbit_calc() != julia_orbit;
+    return ctx;
+}
+
+static void plot_task(const SOITask &task, const std::vector<Byte> &colors, std::vector<Byte> &span)
+{
+    const int width{g_logical_screen.x_dots};
+    const int left{task.rhombus.x1};
+    const int right{std::min(task.rhombus.x2, width) - 1};
+    const int last_row{std::min(task.last_row, g_logical_screen.y_dots)};
+    const bool by_span{plot_rows_by_span()};
+    for (int y = task.first_row; y < last_row && left <= right; ++y)
+    {
+        const Byte *row{&colors[static_cast<std::size_t>(y) * width]};
+        if (by_span)
+        {
+            span.clear();
+            for (int x = left; x <= right; ++x)
+            {
+                span.push_back(static_cast<Byte>(row[x] & g_and_color));
+            }
+            sym_put_line(y, left, right, span.data());
+        }
+        else
+        {
+            for (int x = left; x <= right; ++x)
+            {
+                g_plot(x, y, row[x]);
+            }
+        }
+    }
+}
+
+// The top of the recursion runs here until the rhombi are small enough to
+// hand out; scans and boxes found on the way are split into row bands.
+// The tasks then run on the tile scheduler a batch at a time, each walking
+// its own subtree into a shared color buffer, and the main thread plots
+// the finished tasks and checks the keyboard between batches.  The tasks
+// fill disjoint pixels, so the image is the same as the serial walk's.
+static void calculate_tasks(const SOIContext &ctx, const Rhombus &root)
+{
+    TileScheduler &scheduler{tile_scheduler()};
+    const int num_workers{static_cast<int>(scheduler.num_workers())};
+    int split_depth{1};
+    while (split_depth < MAX_SPLIT_DEPTH && 1 << 2 * split_depth < TASKS_PER_WORKER * num_workers)
+    {
+        ++split_depth;
+    }
+
+    std::vector<SOITask> tasks;
+    RhombusWalk planner{ctx};
+    planner.split(split_depth, &tasks);
+    if (planner.rhombus(root))
+    {
+        return;
+    }
+
+    const int width{g_logical_screen.x_dots};
+    std::vector<Byte> colors(static_cast<std::size_t>(width) * g_logical_screen.y_dots);
+    std::vector<Byte> span;
+    const std::size_t batch_size{static_cast<std::size_t>(num_workers) * TASKS_PER_WORKER};
+    for (std::size_t first = 0; first < tasks.size(); first += batch_size)
+    {
+        if (driver_key_pressed())
+        {
+            return;
+        }
+        const std::size_t count{std::min(batch_size, tasks.size() - first)};
+        scheduler.run(static_cast<int>(count),
+            [&](const int tile, unsigned)
+            {
+                const SOITask &task{tasks[first + tile]};
+                RhombusWalk walk{ctx, colors.data(), width, task.depth};
+                walk.run(task);
+            });
+        for (std::size_t i = first; i < first + count; ++i)
+        {
+            plot_task(tasks[i], colors, span);
+        }
+    }
+}
+
+bool use_soi_tasks()
+{
+    return g_bf_math == BFMathType::NONE && g_dispatch.orbit_calc() == julia_orbit;
 }
 
 void SOI::calculate()
@@ -721,7 +940,6 @@ void SOI::calculate()
     double yy_min_l;
     double yy_max_l;
     g_soi_min_stack_available = 30000;
-    m_rhombus_depth = -1;
     g_max_rhombus_depth = 0;
     if (g_bf_math != BFMathType::NONE)
     {
@@ -737,24 +955,28 @@ void SOI::calculate()
         xx_max_l = g_image_region.m_max.x;
         yy_max_l = g_image_region.m_max.y;
     }
-    m_t_width = TOLERANCE / (g_logical_screen.x_dots - 1);
-    const double step_x = (xx_max_l - xx_min_l) / g_logical_screen.x_dots;
-    const double step_y = (yy_min_l - yy_max_l) / g_logical_screen.y_dots;
-    m_equal = step_x < step_y ? step_x : step_y;
+    const SOIContext ctx{soi_context(TOLERANCE / (g_logical_screen.x_dots - 1))};
 
-    rhombus2(xx_min_l, xx_max_l,                                //
+    const Rhombus root{xx_min_l, xx_max_l,                      //
         yy_max_l, yy_min_l,                                     //
         0, g_logical_screen.x_dots, 0, g_logical_screen.y_dots, //
-        xx_min_l, yy_max_l,                                     //
-        xx_max_l, yy_max_l,                                     //
-        xx_min_l, yy_min_l,                                     //
-        xx_max_l, yy_min_l,                                     //
-        (xx_max_l + xx_min_l) / 2, yy_max_l,                    //
-        xx_min_l, (yy_max_l + yy_min_l) / 2,                    //
-        xx_max_l, (yy_max_l + yy_min_l) / 2,                    //
-        (xx_max_l + xx_min_l) / 2, yy_min_l,                    //
-        (xx_min_l + xx_max_l) / 2, (yy_max_l + yy_min_l) / 2,   //
-        1);
+        {{xx_min_l, yy_max_l},                                  //
+            {xx_max_l, yy_max_l},                               //
+            {xx_min_l, yy_min_l},                               //
+            {xx_max_l, yy_min_l},                               //
+            {(xx_max_l + xx_min_l) / 2, yy_max_l},              //
+            {xx_min_l, (yy_max_l + yy_min_l) / 2},              //
+            {xx_max_l, (yy_max_l + yy_min_l) / 2},              //
+            {(xx_max_l + xx_min_l) / 2, yy_min_l},              //
+            {(xx_min_l + xx_max_l) / 2, (yy_max_l + yy_min_l) / 2}}, //
+        1};
+    if (use_soi_tasks())
+    {
+        calculate_tasks(ctx, root);
+        return;
+    }
+    RhombusWalk walk{ctx};
+    walk.rhombus(root);
 }
 
 bool SOI::iterate()
@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+// Renders images larger than the screen as a stream of tiles.
+//
+// Each tile has its own pixel grid, laid out as fill_pixel_grid() lays out
+// the screen's grid but with step sizes for the full image.  A band of
+// tiles is computed on the tile scheduler, each worker computing a whole
+// tile a row at a time, and then the band is handed to the sink in raster
+// order before the next band starts, so memory use depends only on the
+// tile size and the number of workers.
+//
+#include "engine/tiled_render.h"
+
+#include "engine/calcfrac.h"
+#include "engine/calmanfp.h"
+#include "engine/fractals.h"
+#include "engine/ImageRegion.h"
+#include "engine/Inversion.h"
+#include "engine/pixel_grid.h"
+#include "engine/Potential.h"
+#include "engine/simd_escape.h"
+#include "engine/TileScheduler.h"
+#include "fractals/fractalp.h"
+#include "math/big.h"
+#include "ui/KeyboardHandler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+
+using namespace id::fractals;
+using namespace id::math;
+
+namespace id::engine
+{
+
+TiledRenderSize g_tiled_render;
+
+// Tiles handed to the tile scheduler between interruption checks.
+static constexpr int TILES_PER_WORKER_PER_BAND{2};
+
+namespace
+{
+
+// Step sizes between pixels of the full image, as calc_frac_init()
+// computes them for the screen.
+struct ImageDeltas
+{
+    double x{};
+    double y{};
+    double x2{};
+    double y2{};
+};
+
+} // namespace
+
+static ImageDeltas image_deltas(const TiledRenderSize &size)
+{
+    const LDouble x_size_dots{static_cast<LDouble>(size.width - 1)};
+    const LDouble y_size_dots{static_cast<LDouble>(size.height - 1)};
+    const DComplex size3{g_image_region.size3()};
+    return ImageDeltas{
+        static_cast<double>(static_cast<LDouble>(g_image_region.m_max.x - g_image_region.m_3rd.x) / x_size_dots),
+        static_cast<double>(static_cast<LDouble>(g_image_region.m_max.y - g_image_region.m_3rd.y) / y_size_dots),
+        static_cast<double>(static_cast<LDouble>(size3.x) / y_size_dots),
+        static_cast<double>(static_cast<LDouble>(size3.y) / x_size_dots)};
+}
+
+// min(max(delx,delx2),max(dely,dely2)), as for g_delta_min
+static double delta_min(const ImageDeltas &deltas)
+{
+    double result{std::max(std::abs(deltas.x), std::abs(deltas.x2))};
+    if (std::abs(deltas.y) > std::abs(deltas.y2))
+    {
+        result = std::min(std::abs(deltas.y), result);
+    }
+    else if (std::abs(deltas.y2) < result)
+    {
+        result = std::abs(deltas.y2);
+    }
+    return result;
+}
+
+static PixelGrid tile_pixel_grid(const ImageDeltas &deltas, const RenderedTile &tile)
+{
+    PixelGrid grid;
+    grid.x0.resize(tile.width);
+    grid.y1.resize(tile.width);
+    grid.y0.resize(tile.height);
+    grid.x1.resize(tile.height);
+    for (int i = 0; i < tile.width; ++i)
+    {
+        const int col{tile.left + i};
+        grid.x0[i] = g_image_region.m_min.x + col * deltas.x;
+        grid.y1[i] = 0.0 - col * deltas.y2;
+    }
+    for (int i = 0; i < tile.height; ++i)
+    {
+        const int row{tile.top + i};
+        grid.y0[i] = g_image_region.m_max.y - row * deltas.y;
+        grid.x1[i] = 0.0 + row * deltas.x2;
+    }
+    return grid;
+}
+
+static Byte tile_color(MandelbrotOrbit &orbit)
+{
+    if (orbit.color_iter < 0)
+    {
+        return 0;
+    }
+    return static_cast<Byte>(mandelbrot_color(orbit.color_iter, orbit.real_color_iter, orbit.magnitude));
+}
+
+static IterationSample iteration_sample(const MandelbrotOrbit &orbit, const long max_iterations)
+{
+    IterationSample sample{
+        static_cast<std::uint32_t>(orbit.real_color_iter), static_cast<float>(orbit.real_color_iter)};
+    if (orbit.real_color_iter < max_iterations && orbit.magnitude > 1.0)
+    {
+        // n + 1 - log2(log |z|)
+        sample.smooth = static_cast<float>(
+            static_cast<double>(orbit.real_color_iter) + 1.0 - std::log2(0.5 * std::log(orbit.magnitude)));
+        sample.z_real = static_cast<float>(orbit.new_z.x);
+        sample.z_imag = static_cast<float>(orbit.new_z.y);
+    }
+    return sample;
+}
+
+static void render_tile(const MandelbrotContext &ctx, const ImageDeltas &deltas, const TiledRenderSize &size,
+    const int index, const bool keep_samples, RenderedTile &tile)
+{
+    const int tiles_across{(size.width + size.tile_size - 1) / size.tile_size};
+    tile.left = index % tiles_across * size.tile_size;
+    tile.top = index / tiles_across * size.tile_size;
+    tile.width = std::min(size.tile_size, size.width - tile.left);
+    tile.height = std::min(size.tile_size, size.height - tile.top);
+    tile.pixels.resize(static_cast<std::size_t>(tile.width) * tile.height);
+    tile.samples.resize(keep_samples ? tile.pixels.size() : 0);
+
+    const PixelGrid grid{tile_pixel_grid(deltas, tile)};
+    std::vector<MandelbrotOrbit> orbits(tile.width);
+    Byte *pixel{tile.pixels.data()};
+    IterationSample *sample{tile.samples.data()};
+    for (int row = 0; row < tile.height; ++row)
+    {
+        mandelbrot_orbit_row(ctx, grid, row, 0, tile.width - 1, orbits.data());
+        for (MandelbrotOrbit &orbit : orbits)
+        {
+            if (keep_samples)
+            {
+                *sample++ = iteration_sample(orbit, ctx.max_iterations);
+            }
+            *pixel++ = tile_color(orbit);
+        }
+    }
+}
+
+const char *tiled_render_ineligible_reason()
+{
+    if (g_dispatch.calc_type() != calc_mandelbrot_type)
+    {
+        return "not the optimized Mandelbrot/Julia calculator";
+    }
+    if (g_bf_math != BFMathType::NONE)
+    {
+        return "arbitrary precision";
+    }
+    if (g_inversion.invert != 0)
+    {
+        return "inversion";
+    }
+    if (g_potential.flag && g_potential.store_16bit)
+    {
+        // potential() writes the 16 bit half to disk video at g_col, g_row
+        return "16 bit continuous potential";
+    }
+    return nullptr;
+}
+
+bool tiled_render(const TiledRenderSize &size, const TileSink &sink, const bool keep_samples)
+{
+    const ImageDeltas deltas{image_deltas(size)};
+    MandelbrotContext ctx{mandelbrot_context()};
+    ctx.close_enough = delta_min(deltas) * std::pow(2.0, -static_cast<double>(std::abs(g_periodicity_check)));
+    ctx.simd = use_simd_escape();
+
+    const int tiles_across{(size.width + size.tile_size - 1) / size.tile_size};
+    const int tiles_down{(size.height + size.tile_size - 1) / size.tile_size};
+    const int num_tiles{tiles_across * tiles_down};
+    TileScheduler &scheduler{tile_scheduler()};
+    const int band_tiles{static_cast<int>(scheduler.num_workers()) * TILES_PER_WORKER_PER_BAND};
+    std::vector<RenderedTile> tiles(std::min(band_tiles, num_tiles));
+    for (int first = 0; first < num_tiles; first += band_tiles)
+    {
+        if (ui::calc_interrupted())
+        {
+            return false;
+        }
+        const int count{std::min(band_tiles, num_tiles - first)};
+        scheduler.run(count,
+            [&](const int tile, unsigned) { render_tile(ctx, deltas, size, first + tile, keep_samples, tiles[tile]); });
+        for (int i = 0; i < count; ++i)
+        {
+            if (!sink(tiles[i]))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace id::engine
@@ -7,15 +7,22 @@
 #include "engine/fractals.h"
 #include "engine/ImageRegion.h"
 #include "engine/resume.h"
+#include "engine/TileScheduler.h"
 #include "engine/VideoInfo.h"
+#include "fractals/bif_may.h"
 #include "fractals/fractalp.h"
+#include "fractals/ifs_walkers.h"
+#include "fractals/interpreter.h"
 #include "fractals/population.h"
 #include "math/arg.h"
 #include "math/fixed_pt.h"
+#include "math/fpu087.h"
 #include "misc/id.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <vector>
 
 using namespace id::engine;
@@ -33,6 +40,284 @@ enum
 
 constexpr double SEED{0.66}; // starting value for population
 
+namespace
+{
+
+constexpr int LANES{BIFURCATION_LANES};
+using LaneArray = std::array<double, LANES>;
+
+// lane groups per worker between keyboard checks
+constexpr int BAND_GROUPS{4};
+
+// the stages of calculate_column()
+enum class ColumnStage
+{
+    FILTER,
+    HALF_TIME_CHECK,
+    HALF_TIME_FILTER,
+    PLOT,
+    DONE
+};
+
+// The bookkeeping calculate_column() does between orbit steps for one column.
+struct Column
+{
+    ColumnStage stage{ColumnStage::DONE};
+    unsigned long counter{};
+    BifurcationPeriod period;
+    int *hits{};
+};
+
+void real_abs(const DComplex &arg, DComplex &out)
+{
+    out.x = std::abs(arg.x);
+    out.y = std::abs(arg.y);
+}
+
+struct TrigKernel
+{
+    void (*stack_fn)();
+    BifurcationTrig trig;
+};
+
+// cosxx only differs from cos in the sign of the imaginary part
+const std::array<TrigKernel, 10> TRIG_KERNELS{{
+    {d_stk_sin, cmplx_sin},    //
+    {d_stk_cos, cmplx_cos},    //
+    {d_stk_cosxx, cmplx_cos},  //
+    {d_stk_sinh, cmplx_sinh},  //
+    {d_stk_cosh, cmplx_cosh},  //
+    {d_stk_exp, cmplx_exp},    //
+    {d_stk_log, cmplx_log},    //
+    {d_stk_sqr, cmplx_sqr},    //
+    {d_stk_abs, real_abs},     //
+    {stk_ident, nullptr},      //
+}};
+
+const TrigKernel *find_trig_kernel()
+{
+    const auto it{std::find_if(TRIG_KERNELS.begin(), TRIG_KERNELS.end(),
+        [](const TrigKernel &kernel) { return kernel.stack_fn == g_d_trig0; })};
+    return it == TRIG_KERNELS.end() ? nullptr : &*it;
+}
+
+bool find_map(BifurcationMap &map)
+{
+    const OrbitCalc orbit{g_dispatch.orbit_calc()};
+    if (orbit == bifurc_verhulst_trig_orbit)
+    {
+        map = BifurcationMap::VERHULST;
+    }
+    else if (orbit == bifurc_lambda_trig_orbit)
+    {
+        map = BifurcationMap::LAMBDA;
+    }
+    else if (orbit == bifurc_add_trig_pi_orbit)
+    {
+        map = BifurcationMap::ADD_TRIG_PI;
+    }
+    else if (orbit == bifurc_set_trig_pi_orbit)
+    {
+        map = BifurcationMap::SET_TRIG_PI;
+    }
+    else if (orbit == bifurc_stewart_trig_orbit)
+    {
+        map = BifurcationMap::STEWART;
+    }
+    else if (orbit == bifurc_may_orbit)
+    {
+        map = BifurcationMap::MAY;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// Starts a stage; stages without any steps pass straight on to the next,
+// as the loops of calculate_column() do.
+void enter(const BifurcationContext &ctx, Column &column, const ColumnStage stage)
+{
+    const unsigned long max_iterations{static_cast<unsigned long>(ctx.max_iterations)};
+    const double delta_y{static_cast<double>(ctx.delta_y)};
+    column.stage = stage;
+    column.counter = 0;
+    switch (stage)
+    {
+    case ColumnStage::FILTER:
+        if (ctx.filter_cycles == 0)
+        {
+            enter(ctx, column, ctx.half_time_check ? ColumnStage::HALF_TIME_CHECK : ColumnStage::PLOT);
+        }
+        break;
+
+    case ColumnStage::HALF_TIME_CHECK:
+        column.period.init(delta_y);
+        if (max_iterations == 0)
+        {
+            enter(ctx, column, ColumnStage::HALF_TIME_FILTER);
+        }
+        break;
+
+    case ColumnStage::HALF_TIME_FILTER:
+        if (ctx.filter_cycles == 0)
+        {
+            enter(ctx, column, ColumnStage::PLOT);
+        }
+        break;
+
+    case ColumnStage::PLOT:
+        if (ctx.periodicity_check)
+        {
+            column.period.init(delta_y);
+        }
+        if (max_iterations == 0)
+        {
+            column.stage = ColumnStage::DONE;
+        }
+        break;
+
+    case ColumnStage::DONE:
+        break;
+    }
+}
+
+// Accounts for one orbit step of a column that is not done.
+void advance(const BifurcationContext &ctx, Column &column, const double population)
+{
+    if (population_exceeded(population))
+    {
+        column.stage = ColumnStage::DONE;
+        return;
+    }
+
+    const unsigned long max_iterations{static_cast<unsigned long>(ctx.max_iterations)};
+    switch (column.stage)
+    {
+    case ColumnStage::FILTER:
+        if (++column.counter >= ctx.filter_cycles)
+        {
+            enter(ctx, column, ctx.half_time_check ? ColumnStage::HALF_TIME_CHECK : ColumnStage::PLOT);
+        }
+        break;
+
+    case ColumnStage::HALF_TIME_CHECK:
+        if (ctx.periodicity_check && column.period.periodic(static_cast<long>(column.counter), population))
+        {
+            // periodic, so the second filter is not needed
+            enter(ctx, column, ColumnStage::PLOT);
+        }
+        else if (++column.counter >= max_iterations)
+        {
+            enter(ctx, column, ColumnStage::HALF_TIME_FILTER);
+        }
+        break;
+
+    case ColumnStage::HALF_TIME_FILTER:
+        if (++column.counter >= ctx.filter_cycles)
+        {
+            enter(ctx, column, ColumnStage::PLOT);
+        }
+        break;
+
+    case ColumnStage::PLOT:
+    {
+        const unsigned int pixel_row = ctx.stop_row - static_cast<int>((population - ctx.init_y) / ctx.delta_y);
+        const bool visible{pixel_row <= static_cast<unsigned int>(ctx.stop_row)};
+        if (visible)
+        {
+            ++column.hits[pixel_row];
+        }
+        if (ctx.periodicity_check && column.period.periodic(static_cast<long>(column.counter), population))
+        {
+            if (visible)
+            {
+                --column.hits[pixel_row];
+            }
+            column.stage = ColumnStage::DONE;
+        }
+        else if (++column.counter >= max_iterations)
+        {
+            column.stage = ColumnStage::DONE;
+        }
+        break;
+    }
+
+    case ColumnStage::DONE:
+        break;
+    }
+}
+
+// One orbit step of every lane; the same arithmetic as the orbit functions.
+void step(const BifurcationContext &ctx, const LaneArray &rate, LaneArray &population)
+{
+    alignas(64) LaneArray fn;
+    const bool times_pi{ctx.map == BifurcationMap::ADD_TRIG_PI || ctx.map == BifurcationMap::SET_TRIG_PI};
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        fn[lane] = ctx.map == BifurcationMap::MAY ? 1.0 + population[lane]
+            : times_pi                            ? population[lane] * PI
+                                                  : population[lane];
+    }
+    if (ctx.trig != nullptr && ctx.map != BifurcationMap::MAY)
+    {
+        for (double &value : fn)
+        {
+            DComplex out;
+            ctx.trig(DComplex{value, 0.0}, out);
+            value = out.x;
+        }
+    }
+
+    switch (ctx.map)
+    {
+    case BifurcationMap::VERHULST:
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            population[lane] += rate[lane] * fn[lane] * (1 - fn[lane]);
+        }
+        break;
+
+    case BifurcationMap::LAMBDA:
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            population[lane] = rate[lane] * fn[lane] * (1 - fn[lane]);
+        }
+        break;
+
+    case BifurcationMap::ADD_TRIG_PI:
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            population[lane] += rate[lane] * fn[lane];
+        }
+        break;
+
+    case BifurcationMap::SET_TRIG_PI:
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            population[lane] = rate[lane] * fn[lane];
+        }
+        break;
+
+    case BifurcationMap::STEWART:
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            population[lane] = rate[lane] * fn[lane] * fn[lane] - 1.0;
+        }
+        break;
+
+    case BifurcationMap::MAY:
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            population[lane] = rate[lane] * population[lane] * std::pow(fn[lane], -ctx.may_beta);
+        }
+        break;
+    }
+}
+
+} // namespace
+
 //*********** standalone engine for "bifurcation" types **************
 
 //*************************************************************
@@ -98,15 +383,12 @@ Bifurcation::Bifurcation()
         }
     }
 
-    m_filter_cycles = g_param_z1.x <= 0 ? DEFAULT_FILTER : static_cast<long>(g_param_z1.x);
-    m_half_time_check = false;
-    if (g_periodicity_check && static_cast<unsigned long>(g_max_iterations) < m_filter_cycles)
-    {
-        m_filter_cycles = (m_filter_cycles - g_max_iterations + 1) / 2;
-        m_half_time_check = true;
-    }
-
-    g_init.y = static_cast<double>(g_image_region.m_max.y - g_i_stop_pt.y * g_delta_y); // bottom pixels
+    m_ctx = bifurcation_context();
+    m_filter_cycles = m_ctx.filter_cycles;
+    m_half_time_check = m_ctx.half_time_check;
+    g_init.y = m_ctx.init_y;
+    m_use_columns = use_bifurcation_columns();
+    m_log_density = bifurcation_log_density();
 }
 
 void Bifurcation::suspend()
@@ -120,32 +402,76 @@ bool Bifurcation::iterate()
 {
     if (m_x <= g_i_stop_pt.x)
     {
-        calculate_column(static_cast<double>(g_image_region.m_min.x + m_x * g_delta_x));
-
-        for (int y = g_i_stop_pt.y; y >= 0; y--) // should be iystop & >=0
+        if (m_use_columns)
         {
-            int color = m_verhulst[y];
-            if (color && m_mono)
-            {
-                color = g_inside_color;
-            }
-            else if (!color && m_mono)
-            {
-                color = m_outside_x;
-            }
-            else if (color >= g_colors)
-            {
-                color = g_colors - 1;
-            }
-            m_verhulst[y] = 0;
-            g_plot(m_x, y, color); // was row-1, but that's not right?
+            return iterate_columns();
         }
+
+        calculate_column(static_cast<double>(g_image_region.m_min.x + m_x * g_delta_x));
+        plot_column(m_x, m_verhulst.data());
         ++m_x;
         return true;
     }
     return false;
 }
 
+// Computes a band of columns on the tile scheduler, a lane group per task.
+bool Bifurcation::iterate_columns()
+{
+    TileScheduler &scheduler{tile_scheduler()};
+    const int band{std::min(g_i_stop_pt.x + 1 - m_x, static_cast<int>(scheduler.num_workers()) * BAND_GROUPS * LANES)};
+    const int rows{g_i_stop_pt.y + 1};
+    m_rates.resize(band);
+    m_columns.resize(static_cast<std::size_t>(band) * rows);
+    for (int i = 0; i < band; ++i)
+    {
+        m_rates[i] = static_cast<double>(g_image_region.m_min.x + (m_x + i) * g_delta_x);
+    }
+
+    scheduler.run((band + LANES - 1) / LANES,
+        [&](const int group, unsigned)
+        {
+            const int first{group * LANES};
+            bifurcation_columns(m_ctx, &m_rates[first], std::min(LANES, band - first),
+                &m_columns[static_cast<std::size_t>(first) * rows]);
+        });
+
+    for (int i = 0; i < band; ++i)
+    {
+        plot_column(m_x + i, &m_columns[static_cast<std::size_t>(i) * rows]);
+    }
+    m_x += band;
+    return true;
+}
+
+void Bifurcation::plot_column(const int x, int *counts)
+{
+    for (int y = g_i_stop_pt.y; y >= 0; y--) // should be iystop & >=0
+    {
+        int color = counts[y];
+        if (color && m_mono)
+        {
+            color = g_inside_color;
+        }
+        else if (!color && m_mono)
+        {
+            color = m_outside_x;
+        }
+        else if (m_log_density)
+        {
+            // a column plots at most maxiter points
+            color = ifs_density_color(static_cast<std::uint32_t>(color),
+                static_cast<std::uint32_t>(std::max(g_max_iterations, 1L)), g_colors);
+        }
+        else if (color >= g_colors)
+        {
+            color = g_colors - 1;
+        }
+        counts[y] = 0;
+        g_plot(x, y, color); // was row-1, but that's not right?
+    }
+}
+
 const std::vector<int> &Bifurcation::calculate_column(const double rate)
 {
     std::fill(m_verhulst.begin(), m_verhulst.end(), 0);
@@ -221,20 +547,30 @@ const std::vector<int> &Bifurcation::calculate_column(const double rate)
 }
 
 void BifurcationPeriod::init()
+{
+    init(static_cast<double>(g_delta_y));
+}
+
+void BifurcationPeriod::init(const double delta_y)
 {
     saved_inc = 1;
     saved_and = 1;
     saved_pop = -1.0;
-    close_enough = static_cast<double>(g_delta_y) / 8.0;
+    close_enough = delta_y / 8.0;
+}
+
+bool BifurcationPeriod::periodic(const long time)
+{
+    return periodic(time, g_population);
 }
 
 // Bifurcation Population Periodicity Check
 // Returns : true if periodicity found, else false
-bool BifurcationPeriod::periodic(const long time)
+bool BifurcationPeriod::periodic(const long time, const double population)
 {
     if ((time & saved_and) == 0)      // time to save a new value
     {
-        saved_pop = g_population;
+        saved_pop = population;
         if (--saved_inc == 0)
         {
             saved_and = (saved_and << 1) + 1;
@@ -243,7 +579,7 @@ bool BifurcationPeriod::periodic(const long time)
     }
     else                         // check against an old save
     {
-        if (std::abs(saved_pop - g_population) <= close_enough)
+        if (std::abs(saved_pop - population) <= close_enough)
         {
             return true;
         }
@@ -251,6 +587,77 @@ bool BifurcationPeriod::periodic(const long time)
     return false;
 }
 
+bool bifurcation_log_density()
+{
+    // bifmay has beta before the coloring parameter
+    return g_params[g_fractal_type == FractalType::BIF_MAY ? 3 : 2] != 0.0;
+}
+
+BifurcationContext bifurcation_context()
+{
+    BifurcationContext ctx;
+    find_map(ctx.map);
+    if (const TrigKernel *kernel = find_trig_kernel())
+    {
+        ctx.trig = kernel->trig;
+    }
+    ctx.may_beta = bifurc_may_beta();
+    ctx.seed = g_param_z1.y == 0 ? SEED : g_param_z1.y;
+    ctx.filter_cycles = g_param_z1.x <= 0 ? DEFAULT_FILTER : static_cast<long>(g_param_z1.x);
+    ctx.periodicity_check = g_periodicity_check != 0;
+    if (g_periodicity_check && static_cast<unsigned long>(g_max_iterations) < ctx.filter_cycles)
+    {
+        ctx.filter_cycles = (ctx.filter_cycles - g_max_iterations + 1) / 2;
+        ctx.half_time_check = true;
+    }
+    ctx.max_iterations = g_max_iterations;
+    ctx.stop_row = g_i_stop_pt.y;
+    ctx.init_y = static_cast<double>(g_image_region.m_max.y - g_i_stop_pt.y * g_delta_y); // bottom pixels
+    ctx.delta_y = g_delta_y;
+    return ctx;
+}
+
+bool use_bifurcation_columns()
+{
+    BifurcationMap map;
+    if (!find_map(map))
+    {
+        return false;
+    }
+    return map == BifurcationMap::MAY || find_trig_kernel() != nullptr;
+}
+
+void bifurcation_columns(const BifurcationContext &ctx, const double *rates, const int count, int *hits)
+{
+    const int rows{ctx.stop_row + 1};
+    std::fill(hits, hits + static_cast<std::size_t>(count) * rows, 0);
+    for (int first = 0; first < count; first += LANES)
+    {
+        alignas(64) LaneArray rate{};
+        alignas(64) LaneArray population{};
+        std::array<Column, LANES> columns{};
+        for (int lane = 0; lane < LANES && first + lane < count; ++lane)
+        {
+            rate[lane] = rates[first + lane];
+            population[lane] = ctx.seed;
+            columns[lane].hits = hits + static_cast<std::size_t>(first + lane) * rows;
+            enter(ctx, columns[lane], ColumnStage::FILTER);
+        }
+        while (std::any_of(columns.begin(), columns.end(),
+            [](const Column &column) { return column.stage != ColumnStage::DONE; }))
+        {
+            step(ctx, rate, population);
+            for (int lane = 0; lane < LANES; ++lane)
+            {
+                if (columns[lane].stage != ColumnStage::DONE)
+                {
+                    advance(ctx, columns[lane], population[lane]);
+                }
+            }
+        }
+    }
+}
+
 int bifurc_verhulst_trig_orbit()
 {
     //  Population = Pop + Rate * fn(Pop) * (1 - fn(Pop))
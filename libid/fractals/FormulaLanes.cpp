@@ -0,0 +1,572 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "fractals/FormulaLanes.h"
+
+#include "fractals/interpreter.h"
+#include "math/arg.h"
+#include "math/fixed_pt.h"
+#include "math/fpu087.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <map>
+
+using namespace id::math;
+
+namespace id::fractals
+{
+
+namespace
+{
+
+using Op = FormulaVM::Op;
+using Mask = FormulaLanes::Mask;
+
+constexpr int DONE{std::numeric_limits<int>::max()};
+
+// per pixel inputs set by formula_per_pixel()
+constexpr int PIXEL_VAR{0};
+constexpr int Z_VAR{3};
+constexpr int LAST_SQR_VAR{4};
+constexpr int WHITE_SQUARE_VAR{9};
+constexpr int SCREEN_PIXEL_VAR{10};
+
+bool is_jump(const Op op)
+{
+    return op == Op::JUMP || op == Op::JUMP_IF_FALSE || op == Op::JUMP_IF_TRUE;
+}
+
+// sqr selected as fn1..fn4 sets LastSqr, as the SQR operation does
+bool sets_last_sqr(const Op op, const FunctionPtr fn)
+{
+    return op == Op::SQR || (fn == d_stk_fn1 && g_d_trig0 == d_stk_sqr) ||
+        (fn == d_stk_fn2 && g_d_trig1 == d_stk_sqr) || (fn == d_stk_fn3 && g_d_trig2 == d_stk_sqr) ||
+        (fn == d_stk_fn4 && g_d_trig3 == d_stk_sqr);
+}
+
+template <typename F>
+void unary(LaneComplex &out, const LaneComplex &a, const Mask &active, F f)
+{
+    for (int lane = 0; lane < FORMULA_LANES; ++lane)
+    {
+        double x;
+        double y;
+        f(a.x[lane], a.y[lane], x, y);
+        out.x[lane] = active[lane] ? x : out.x[lane];
+        out.y[lane] = active[lane] ? y : out.y[lane];
+    }
+}
+
+template <typename F>
+void binary(LaneComplex &out, const LaneComplex &a, const LaneComplex &b, const Mask &active, F f)
+{
+    for (int lane = 0; lane < FORMULA_LANES; ++lane)
+    {
+        double x;
+        double y;
+        f(a.x[lane], a.y[lane], b.x[lane], b.y[lane], x, y);
+        out.x[lane] = active[lane] ? x : out.x[lane];
+        out.y[lane] = active[lane] ? y : out.y[lane];
+    }
+}
+
+// Comparisons and logic only look at the real parts.
+template <typename F>
+void compare(LaneComplex &out, const LaneComplex &a, const LaneComplex &b, const Mask &active, F f)
+{
+    for (int lane = 0; lane < FORMULA_LANES; ++lane)
+    {
+        const double x{static_cast<double>(f(a.x[lane], b.x[lane]))};
+        out.x[lane] = active[lane] ? x : out.x[lane];
+        out.y[lane] = active[lane] ? 0.0 : out.y[lane];
+    }
+}
+
+template <typename F>
+void per_lane(LaneComplex &out, const LaneComplex &a, const Mask &active, F f)
+{
+    for (int lane = 0; lane < FORMULA_LANES; ++lane)
+    {
+        if (active[lane])
+        {
+            DComplex result;
+            f(DComplex{a.x[lane], a.y[lane]}, result);
+            out.x[lane] = result.x;
+            out.y[lane] = result.y;
+        }
+    }
+}
+
+} // namespace
+
+FormulaLanes::Program FormulaLanes::translate(const FormulaVM &vm, const CompiledFormula &formula)
+{
+    Program program;
+    std::map<const DComplex *, int> values;
+    auto value = [&](const DComplex *location)
+    {
+        if (location == nullptr)
+        {
+            return -1;
+        }
+        const auto [it, inserted]{values.emplace(location, static_cast<int>(program.locations.size()))};
+        if (inserted)
+        {
+            program.locations.push_back(location);
+        }
+        return it->second;
+    };
+
+    for (const FormulaVM::Instruction &in : vm.code())
+    {
+        program.code.push_back(Instruction{in.op, value(in.dst), value(in.a), value(in.b), in.target, in.fn});
+    }
+    program.orbit_start = vm.orbit_start();
+    program.result = value(vm.result());
+    program.last_sqr = value(vm.last_sqr());
+    program.z = value(&formula.vars[Z_VAR].a.d);
+    program.pixel = value(&formula.vars[PIXEL_VAR].a.d);
+    program.white_square = value(&formula.vars[WHITE_SQUARE_VAR].a.d);
+    program.screen_pixel = value(&formula.vars[SCREEN_PIXEL_VAR].a.d);
+    return program;
+}
+
+const char *FormulaLanes::ineligible_reason(const FormulaVM &vm, const CompiledFormula &formula)
+{
+    if (!vm.compiled() || formula.vars.size() <= SCREEN_PIXEL_VAR)
+    {
+        return "formula is not compiled";
+    }
+    if (formula.uses_rand)
+    {
+        return "formula uses rand";
+    }
+    const Program program{translate(vm, formula)};
+    const int size{static_cast<int>(program.code.size())};
+    const std::size_t num_values{program.locations.size()};
+    std::vector<bool> written(num_values);
+    for (int pc = 0; pc < size; ++pc)
+    {
+        const Instruction &in{program.code[pc]};
+        if (in.fn == d_stk_srand)
+        {
+            return "formula uses srand";
+        }
+        if (is_jump(in.op) && in.target <= pc)
+        {
+            return "formula jumps backward";
+        }
+        if (in.dst >= 0)
+        {
+            written[in.dst] = true;
+        }
+        if (sets_last_sqr(in.op, in.fn))
+        {
+            written[program.last_sqr] = true;
+        }
+    }
+
+    // Values read before they are written when a pixel starts carry over
+    // from the previous pixel, which lanes can't reproduce.
+    std::vector<std::vector<bool>> live_in(size, std::vector<bool>(num_values));
+    bool changed{true};
+    while (changed)
+    {
+        changed = false;
+        for (int pc = size - 1; pc >= 0; --pc)
+        {
+            const Instruction &in{program.code[pc]};
+            std::vector<bool> live(num_values);
+            auto merge = [&](const int succ)
+            {
+                for (std::size_t i = 0; i < num_values; ++i)
+                {
+                    live[i] = live[i] || live_in[succ][i];
+                }
+            };
+            if (in.op == Op::END)
+            {
+                merge(program.orbit_start);
+            }
+            else if (in.op == Op::JUMP)
+            {
+                merge(in.target);
+            }
+            else
+            {
+                merge(pc + 1);
+                if (is_jump(in.op))
+                {
+                    merge(in.target);
+                }
+            }
+            if (in.dst >= 0)
+            {
+                live[in.dst] = false;
+            }
+            if (sets_last_sqr(in.op, in.fn))
+            {
+                live[program.last_sqr] = false;
+            }
+            for (const int use : {in.a, in.b})
+            {
+                if (use >= 0)
+                {
+                    live[use] = true;
+                }
+            }
+            if (live != live_in[pc])
+            {
+                live_in[pc] = std::move(live);
+                changed = true;
+            }
+        }
+    }
+    for (std::size_t i = 0; i < num_values; ++i)
+    {
+        const int index{static_cast<int>(i)};
+        const bool per_pixel{
+            index == program.pixel || index == program.white_square || index == program.screen_pixel};
+        if (size > 0 && live_in[0][i] && written[i] && !per_pixel)
+        {
+            return "formula reads values left by the previous pixel";
+        }
+    }
+    return nullptr;
+}
+
+FormulaLanes::FormulaLanes(const FormulaVM &vm, const CompiledFormula &formula) :
+    m_program(translate(vm, formula)),
+    m_values(m_program.locations.size())
+{
+    for (std::size_t i = 0; i < m_values.size(); ++i)
+    {
+        m_values[i].x.fill(m_program.locations[i]->x);
+        m_values[i].y.fill(m_program.locations[i]->y);
+    }
+}
+
+void FormulaLanes::set(const int value, const int lane, const DComplex &z)
+{
+    if (value >= 0)
+    {
+        m_values[value].x[lane] = z.x;
+        m_values[value].y[lane] = z.y;
+    }
+}
+
+void FormulaLanes::start(const int lane, const DComplex &pixel, const int col, const int row)
+{
+    set(m_program.screen_pixel, lane, {static_cast<double>(col), static_cast<double>(row)});
+    set(m_program.white_square, lane, {((row + col) & 1) != 0 ? 1.0 : 0.0, 0.0});
+    set(m_program.pixel, lane, pixel);
+    m_overflow[lane] = false;
+    Mask lanes{};
+    lanes[lane] = true;
+    run(0, lanes);
+}
+
+void FormulaLanes::orbit(const Mask &lanes)
+{
+    run(m_program.orbit_start, lanes);
+}
+
+// Lanes wait at their own program counter; the lowest one runs next.
+void FormulaLanes::run(const int pc, const Mask &lanes)
+{
+    for (int lane = 0; lane < FORMULA_LANES; ++lane)
+    {
+        m_pc[lane] = lanes[lane] ? pc : DONE;
+    }
+    for (;;)
+    {
+        const int next{*std::min_element(m_pc.begin(), m_pc.end())};
+        if (next == DONE)
+        {
+            return;
+        }
+        const Instruction &in{m_program.code[next]};
+        Mask active;
+        for (int lane = 0; lane < FORMULA_LANES; ++lane)
+        {
+            active[lane] = m_pc[lane] == next;
+        }
+        switch (in.op)
+        {
+        case Op::END:
+            for (int lane = 0; lane < FORMULA_LANES; ++lane)
+            {
+                m_pc[lane] = active[lane] ? DONE : m_pc[lane];
+            }
+            break;
+        case Op::JUMP:
+            for (int lane = 0; lane < FORMULA_LANES; ++lane)
+            {
+                m_pc[lane] = active[lane] ? in.target : m_pc[lane];
+            }
+            break;
+        case Op::JUMP_IF_FALSE:
+        case Op::JUMP_IF_TRUE:
+        {
+            const LaneComplex &condition{m_values[in.a]};
+            const bool jump_when{in.op == Op::JUMP_IF_TRUE};
+            for (int lane = 0; lane < FORMULA_LANES; ++lane)
+            {
+                const bool jump{(condition.x[lane] != 0.0) == jump_when};
+                m_pc[lane] = active[lane] ? (jump ? in.target : next + 1) : m_pc[lane];
+            }
+            break;
+        }
+        default:
+            execute(in, active);
+            for (int lane = 0; lane < FORMULA_LANES; ++lane)
+            {
+                m_pc[lane] = active[lane] ? next + 1 : m_pc[lane];
+            }
+            break;
+        }
+    }
+}
+
+// Each case computes exactly what the same FormulaVM operation computes.
+void FormulaLanes::execute(const Instruction &in, const Mask &active)
+{
+    LaneComplex &out{m_values[in.dst]};
+    const LaneComplex &a{m_values[in.a]};
+    const LaneComplex &b{m_values[in.b >= 0 ? in.b : in.a]};
+    switch (in.op)
+    {
+    case Op::MOVE:
+        unary(out, a, active,
+            [](const double ax, const double ay, double &x, double &y)
+            {
+                x = ax;
+                y = ay;
+            });
+        break;
+    case Op::ADD:
+        binary(out, a, b, active,
+            [](const double ax, const double ay, const double bx, const double by, double &x, double &y)
+            {
+                x = ax + bx;
+                y = ay + by;
+            });
+        break;
+    case Op::SUB:
+        binary(out, a, b, active,
+            [](const double ax, const double ay, const double bx, const double by, double &x, double &y)
+            {
+                x = ax - bx;
+                y = ay - by;
+            });
+        break;
+    case Op::MUL:
+        binary(out, a, b, active,
+            [](const double ax, const double ay, const double bx, const double by, double &x, double &y)
+            {
+                const bool b_real{by == 0.0};
+                const bool a_real{ay == 0.0};
+                x = b_real || a_real ? ax * bx : ax * bx - ay * by;
+                y = b_real ? ay * bx : a_real ? ax * by : ax * by + ay * bx;
+            });
+        break;
+    case Op::DIV:
+    {
+        // fpu_cmplx_div()
+        for (int lane = 0; lane < FORMULA_LANES; ++lane)
+        {
+            const double ax{a.x[lane]};
+            const double ay{a.y[lane]};
+            const double bx{b.x[lane]};
+            const double by{b.y[lane]};
+            const double mod{bx * bx + by * by};
+            const bool overflow{mod == 0.0 || std::abs(mod) <= DBL_MIN};
+            const double y_x_mod{bx / mod};
+            const double y_y_mod{-by / mod};
+            double x{by == 0.0 ? ax / bx : ax * y_x_mod - ay * y_y_mod};
+            double y{by == 0.0 ? ay / bx : ax * y_y_mod + ay * y_x_mod};
+            x = overflow ? ID_INFINITY : x;
+            y = overflow ? ID_INFINITY : y;
+            out.x[lane] = active[lane] ? x : out.x[lane];
+            out.y[lane] = active[lane] ? y : out.y[lane];
+            m_overflow[lane] = m_overflow[lane] || (active[lane] && overflow);
+        }
+        break;
+    }
+    case Op::NEG:
+        unary(out, a, active,
+            [](const double ax, const double ay, double &x, double &y)
+            {
+                x = -ax;
+                y = -ay;
+            });
+        break;
+    case Op::REAL:
+        unary(out, a, active,
+            [](const double ax, double, double &x, double &y)
+            {
+                x = ax;
+                y = 0.0;
+            });
+        break;
+    case Op::IMAG:
+        unary(out, a, active,
+            [](double, const double ay, double &x, double &y)
+            {
+                x = ay;
+                y = 0.0;
+            });
+        break;
+    case Op::CONJ:
+        unary(out, a, active,
+            [](const double ax, const double ay, double &x, double &y)
+            {
+                x = ax;
+                y = -ay;
+            });
+        break;
+    case Op::FLIP:
+        unary(out, a, active,
+            [](const double ax, const double ay, double &x, double &y)
+            {
+                x = ay;
+                y = ax;
+            });
+        break;
+    case Op::ABS:
+        unary(out, a, active,
+            [](const double ax, const double ay, double &x, double &y)
+            {
+                x = std::abs(ax);
+                y = std::abs(ay);
+            });
+        break;
+    case Op::MOD:
+        unary(out, a, active,
+            [](const double ax, const double ay, double &x, double &y)
+            {
+                x = ax * ax + ay * ay;
+                y = 0.0;
+            });
+        break;
+    case Op::CABS:
+        unary(out, a, active,
+            [](const double ax, const double ay, double &x, double &y)
+            {
+                x = std::sqrt(sqr(ax) + sqr(ay));
+                y = 0.0;
+            });
+        break;
+    case Op::SQR:
+    {
+        LaneComplex &last_sqr{m_values[m_program.last_sqr]};
+        for (int lane = 0; lane < FORMULA_LANES; ++lane)
+        {
+            const double zx{a.x[lane]};
+            const double zy{a.y[lane]};
+            const double sqr_x{zx * zx};
+            const double sqr_y{zy * zy};
+            const double x{sqr_x - sqr_y};
+            const double y{zx * zy * 2.0};
+            last_sqr.x[lane] = active[lane] ? sqr_x + sqr_y : last_sqr.x[lane];
+            last_sqr.y[lane] = active[lane] ? 0.0 : last_sqr.y[lane];
+            out.x[lane] = active[lane] ? x : out.x[lane];
+            out.y[lane] = active[lane] ? y : out.y[lane];
+        }
+        break;
+    }
+    case Op::SIN:
+        per_lane(out, a, active, cmplx_sin);
+        break;
+    case Op::COS:
+        per_lane(out, a, active, cmplx_cos);
+        break;
+    case Op::SINH:
+        per_lane(out, a, active, cmplx_sinh);
+        break;
+    case Op::COSH:
+        per_lane(out, a, active, cmplx_cosh);
+        break;
+    case Op::LT:
+        compare(out, a, b, active, [](const double lhs, const double rhs) { return lhs < rhs; });
+        break;
+    case Op::GT:
+        compare(out, a, b, active, [](const double lhs, const double rhs) { return lhs > rhs; });
+        break;
+    case Op::LTE:
+        compare(out, a, b, active, [](const double lhs, const double rhs) { return lhs <= rhs; });
+        break;
+    case Op::GTE:
+        compare(out, a, b, active, [](const double lhs, const double rhs) { return lhs >= rhs; });
+        break;
+    case Op::EQ:
+        compare(out, a, b, active, [](const double lhs, const double rhs) { return lhs == rhs; });
+        break;
+    case Op::NE:
+        compare(out, a, b, active, [](const double lhs, const double rhs) { return lhs != rhs; });
+        break;
+    case Op::AND:
+        compare(out, a, b, active, [](const double lhs, const double rhs) { return lhs != 0.0 && rhs != 0.0; });
+        break;
+    case Op::OR:
+        compare(out, a, b, active, [](const double lhs, const double rhs) { return lhs != 0.0 || rhs != 0.0; });
+        break;
+    case Op::CALL1:
+    case Op::CALL2:
+        call(in, active);
+        break;
+    default:
+        break;
+    }
+}
+
+// The interpreter's functions work on its stack, one value at a time, and
+// sqr, as fn1..fn4, writes the interpreter's LastSqr.
+void FormulaLanes::call(const Instruction &in, const Mask &active)
+{
+    LaneComplex &out{m_values[in.dst]};
+    const LaneComplex &a{m_values[in.a]};
+    LaneComplex &last_sqr{m_values[m_program.last_sqr]};
+    DComplex &interpreter_last_sqr{g_formula.vars[LAST_SQR_VAR].a.d};
+    Arg *const saved_arg1{g_arg1};
+    Arg *const saved_arg2{g_arg2};
+    const bool saved_overflow{g_overflow};
+    const DComplex saved_last_sqr{interpreter_last_sqr};
+    for (int lane = 0; lane < FORMULA_LANES; ++lane)
+    {
+        if (!active[lane])
+        {
+            continue;
+        }
+        std::array<Arg, 2> args{};
+        if (in.op == Op::CALL1)
+        {
+            args[1].d = {a.x[lane], a.y[lane]};
+        }
+        else
+        {
+            const LaneComplex &b{m_values[in.b]};
+            args[0].d = {a.x[lane], a.y[lane]};
+            args[1].d = {b.x[lane], b.y[lane]};
+        }
+        g_arg2 = &args[0];
+        g_arg1 = &args[1];
+        g_overflow = false;
+        interpreter_last_sqr = {last_sqr.x[lane], last_sqr.y[lane]};
+        in.fn();
+        const DComplex &result{in.op == Op::CALL1 ? args[1].d : args[0].d};
+        out.x[lane] = result.x;
+        out.y[lane] = result.y;
+        last_sqr.x[lane] = interpreter_last_sqr.x;
+        last_sqr.y[lane] = interpreter_last_sqr.y;
+        m_overflow[lane] = m_overflow[lane] || g_overflow;
+    }
+    g_arg1 = saved_arg1;
+    g_arg2 = saved_arg2;
+    g_overflow = saved_overflow;
+    interpreter_last_sqr = saved_last_sqr;
+}
+
+} // namespace id::fractals
@@ -0,0 +1,996 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "fractals/FormulaVM.h"
+
+#include "fractals/interpreter.h"
+#include "math/arg.h"
+#include "math/fpu087.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace id::math;
+
+namespace id::fractals
+{
+
+FormulaVM g_formula_vm;
+
+namespace
+{
+
+constexpr int STACK_SIZE{20}; // size of the interpreter stack
+constexpr int RESULT_REGISTER{STACK_SIZE};
+constexpr int LAST_SQR_VAR{4};
+
+// Operations without side effects, which can be folded on constants and
+// removed when their result is unused.
+bool is_pure(const FormulaVM::Op op)
+{
+    using Op = FormulaVM::Op;
+    switch (op)
+    {
+    case Op::MOVE:
+    case Op::ADD:
+    case Op::SUB:
+    case Op::MUL:
+    case Op::NEG:
+    case Op::REAL:
+    case Op::IMAG:
+    case Op::CONJ:
+    case Op::FLIP:
+    case Op::ABS:
+    case Op::MOD:
+    case Op::CABS:
+    case Op::SIN:
+    case Op::COS:
+    case Op::SINH:
+    case Op::COSH:
+    case Op::LT:
+    case Op::GT:
+    case Op::LTE:
+    case Op::GTE:
+    case Op::EQ:
+    case Op::NE:
+    case Op::AND:
+    case Op::OR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Each case computes exactly what the corresponding stack operation in
+// the interpreter computes, so that both produce identical images.
+inline void execute(const FormulaVM::Instruction &in, DComplex &last_sqr, Arg *call_args)
+{
+    using Op = FormulaVM::Op;
+    const DComplex &a{*in.a};
+    DComplex &out{*in.dst};
+    switch (in.op)
+    {
+    case Op::MOVE:
+        out = a;
+        break;
+    case Op::ADD:
+        out = {a.x + in.b->x, a.y + in.b->y};
+        break;
+    case Op::SUB:
+        out = {a.x - in.b->x, a.y - in.b->y};
+        break;
+    case Op::MUL:
+    {
+        const DComplex &b{*in.b};
+        double tx;
+        double ty;
+        if (b.y == 0.0)
+        {
+            tx = a.x * b.x;
+            ty = a.y * b.x;
+        }
+        else if (a.y == 0.0)
+        {
+            tx = a.x * b.x;
+            ty = a.x * b.y;
+        }
+        else
+        {
+            tx = a.x * b.x - a.y * b.y;
+            ty = a.x * b.y + a.y * b.x;
+        }
+        out = {tx, ty};
+        break;
+    }
+    case Op::DIV:
+        fpu_cmplx_div(a, *in.b, out);
+        break;
+    case Op::NEG:
+        out = {-a.x, -a.y};
+        break;
+    case Op::REAL:
+        out = {a.x, 0.0};
+        break;
+    case Op::IMAG:
+        out = {a.y, 0.0};
+        break;
+    case Op::CONJ:
+        out = {a.x, -a.y};
+        break;
+    case Op::FLIP:
+        out = {a.y, a.x};
+        break;
+    case Op::ABS:
+        out = {std::abs(a.x), std::abs(a.y)};
+        break;
+    case Op::MOD:
+        out = {a.x * a.x + a.y * a.y, 0.0};
+        break;
+    case Op::CABS:
+        out = {std::sqrt(sqr(a.x) + sqr(a.y)), 0.0};
+        break;
+    case Op::SQR:
+    {
+        const DComplex z{a};
+        last_sqr.x = z.x * z.x;
+        last_sqr.y = z.y * z.y;
+        out = {last_sqr.x - last_sqr.y, z.x * z.y * 2.0};
+        last_sqr.x += last_sqr.y;
+        last_sqr.y = 0;
+        break;
+    }
+    case Op::SIN:
+    {
+        DComplex result;
+        cmplx_sin(a, result);
+        out = result;
+        break;
+    }
+    case Op::COS:
+    {
+        DComplex result;
+        cmplx_cos(a, result);
+        out = result;
+        break;
+    }
+    case Op::SINH:
+    {
+        DComplex result;
+        cmplx_sinh(a, result);
+        out = result;
+        break;
+    }
+    case Op::COSH:
+    {
+        DComplex result;
+        cmplx_cosh(a, result);
+        out = result;
+        break;
+    }
+    case Op::LT:
+        out = {static_cast<double>(a.x < in.b->x), 0.0};
+        break;
+    case Op::GT:
+        out = {static_cast<double>(a.x > in.b->x), 0.0};
+        break;
+    case Op::LTE:
+        out = {static_cast<double>(a.x <= in.b->x), 0.0};
+        break;
+    case Op::GTE:
+        out = {static_cast<double>(a.x >= in.b->x), 0.0};
+        break;
+    case Op::EQ:
+        out = {static_cast<double>(a.x == in.b->x), 0.0};
+        break;
+    case Op::NE:
+        out = {static_cast<double>(a.x != in.b->x), 0.0};
+        break;
+    case Op::AND:
+        out = {static_cast<double>(a.x != 0.0 && in.b->x != 0.0), 0.0};
+        break;
+    case Op::OR:
+        out = {static_cast<double>(a.x != 0.0 || in.b->x != 0.0), 0.0};
+        break;
+    case Op::CALL1:
+        call_args[1].d = a;
+        g_arg2 = &call_args[0];
+        g_arg1 = &call_args[1];
+        in.fn();
+        out = call_args[1].d;
+        break;
+    case Op::CALL2:
+        call_args[0].d = a;
+        call_args[1].d = *in.b;
+        g_arg2 = &call_args[0];
+        g_arg1 = &call_args[1];
+        in.fn();
+        out = call_args[0].d;
+        break;
+    default:
+        break;
+    }
+}
+
+struct StackOp
+{
+    FunctionPtr fn;
+    FormulaVM::Op op;
+};
+
+const StackOp UNARY_OPS[]{
+    {d_stk_neg, FormulaVM::Op::NEG},   //
+    {d_stk_real, FormulaVM::Op::REAL}, //
+    {d_stk_imag, FormulaVM::Op::IMAG}, //
+    {d_stk_conj, FormulaVM::Op::CONJ}, //
+    {d_stk_flip, FormulaVM::Op::FLIP}, //
+    {d_stk_abs, FormulaVM::Op::ABS},   //
+    {d_stk_mod, FormulaVM::Op::MOD},   //
+    {d_stk_cabs, FormulaVM::Op::CABS}, //
+    {d_stk_sqr, FormulaVM::Op::SQR},   //
+    {d_stk_sin, FormulaVM::Op::SIN},   //
+    {d_stk_cos, FormulaVM::Op::COS},   //
+    {d_stk_sinh, FormulaVM::Op::SINH}, //
+    {d_stk_cosh, FormulaVM::Op::COSH}, //
+};
+
+const StackOp BINARY_OPS[]{
+    {d_stk_add, FormulaVM::Op::ADD},   //
+    {d_stk_sub, FormulaVM::Op::SUB},   //
+    {d_stk_mul, FormulaVM::Op::MUL},   //
+    {d_stk_div, FormulaVM::Op::DIV},   //
+    {d_stk_pwr, FormulaVM::Op::CALL2}, //
+    {d_stk_lt, FormulaVM::Op::LT},     //
+    {d_stk_gt, FormulaVM::Op::GT},     //
+    {d_stk_lte, FormulaVM::Op::LTE},   //
+    {d_stk_gte, FormulaVM::Op::GTE},   //
+    {d_stk_eq, FormulaVM::Op::EQ},     //
+    {d_stk_ne, FormulaVM::Op::NE},     //
+    {d_stk_and, FormulaVM::Op::AND},   //
+    {d_stk_or, FormulaVM::Op::OR},     //
+};
+
+// Unary operations left to the interpreter's functions.
+const FunctionPtr CALLED_OPS[]{
+    d_stk_tan, d_stk_tanh, d_stk_cotan, d_stk_cotanh, d_stk_cosxx, d_stk_log, d_stk_exp, //
+    d_stk_asin, d_stk_asinh, d_stk_acos, d_stk_acosh, d_stk_atan, d_stk_atanh,           //
+    d_stk_sqrt, d_stk_floor, d_stk_ceil, d_stk_trunc, d_stk_round, d_stk_recip,          //
+    d_stk_srand, d_stk_fn1, d_stk_fn2, d_stk_fn3, d_stk_fn4,                             //
+};
+
+template <std::size_t N>
+const StackOp *find_op(const StackOp (&ops)[N], const FunctionPtr fn)
+{
+    const auto it{std::find_if(std::begin(ops), std::end(ops), [fn](const StackOp &op) { return op.fn == fn; })};
+    return it == std::end(ops) ? nullptr : it;
+}
+
+bool is_jump(const FunctionPtr fn)
+{
+    return fn == stk_jump || fn == d_stk_jump_on_false || fn == d_stk_jump_on_true || fn == stk_jump_label;
+}
+
+} // namespace
+
+// Symbolically executes the stack operations, tracking for each stack
+// slot where its value currently lives.  Values are only copied into the
+// register for their slot when something would otherwise overwrite them,
+// or when control flow merges and all paths must agree on the layout.
+class FormulaVM::Lowering
+{
+public:
+    Lowering(FormulaVM &vm, CompiledFormula &formula) :
+        m_vm(vm),
+        m_formula(formula)
+    {
+    }
+
+    bool lower();
+
+private:
+    // How the stack is laid out where branches join, chosen by what follows.
+    enum class MergeKind
+    {
+        CLEAR, // a clear follows: only the top survives, in register 0
+        END,   // the section ends: register 0 and the top, in the result register
+        OTHER  // every slot in its own register
+    };
+
+    struct Target
+    {
+        bool is_target{};
+        bool has_edge{};
+        MergeKind kind{};
+        std::size_t depth{};
+        int pc{-1};
+    };
+
+    struct Value
+    {
+        const DComplex *ptr;
+        bool constant;
+    };
+
+    DComplex *reg(const int slot) const
+    {
+        return &m_vm.m_registers[slot];
+    }
+    const DComplex *var(const int index) const
+    {
+        return &m_formula.vars[index].a.d;
+    }
+    int emit(Op op, DComplex *dst, const DComplex *a, const DComplex *b = nullptr, FunctionPtr fn = nullptr);
+    const DComplex *constant(const DComplex &value);
+    void claim(const DComplex *location, std::size_t keep);
+    void claim_variables(std::size_t keep);
+    void materialize(std::size_t slot);
+    bool push(const DComplex *ptr);
+    bool unary(Op op, FunctionPtr fn = nullptr);
+    bool binary(Op op, FunctionPtr fn = nullptr);
+    bool store(DComplex *target);
+    std::vector<Instruction> merge_moves(const Target &target) const;
+    void set_merged_stack(const Target &target);
+    bool add_edge(int target_op);
+    bool jump(int op, int jump_index, bool conditional, bool jump_when);
+    bool arrive(int op);
+    void end_section();
+    bool lower_op(int op);
+
+    FormulaVM &m_vm;
+    CompiledFormula &m_formula;
+    std::vector<Value> m_stack;
+    std::vector<bool> m_constant_vars;
+    std::vector<Target> m_targets;
+    std::vector<std::pair<int, int>> m_patches; // instruction, target op
+    int m_section_end{};
+    int m_load_index{};
+    int m_store_index{};
+    int m_jump_index{};
+    bool m_reachable{true};
+};
+
+int FormulaVM::Lowering::emit(
+    const Op op, DComplex *dst, const DComplex *a, const DComplex *b, const FunctionPtr fn)
+{
+    m_vm.m_code.push_back(Instruction{op, dst, a, b, 0, fn});
+    return static_cast<int>(m_vm.m_code.size()) - 1;
+}
+
+const DComplex *FormulaVM::Lowering::constant(const DComplex &value)
+{
+    m_vm.m_constants.push_back(value);
+    return &m_vm.m_constants.back();
+}
+
+// Copies any stack value still living at location to its own register,
+// so that location can be written.
+void FormulaVM::Lowering::claim(const DComplex *location, const std::size_t keep)
+{
+    for (std::size_t slot = 0; slot < m_stack.size(); ++slot)
+    {
+        if (slot != keep && m_stack[slot].ptr == location)
+        {
+            materialize(slot);
+        }
+    }
+}
+
+// Operations run by the interpreter may write formula variables.
+void FormulaVM::Lowering::claim_variables(const std::size_t keep)
+{
+    const DComplex *registers{m_vm.m_registers.data()};
+    for (std::size_t slot = 0; slot < m_stack.size(); ++slot)
+    {
+        const Value &value{m_stack[slot]};
+        const bool in_register{value.ptr >= registers && value.ptr < registers + NUM_REGISTERS};
+        if (slot != keep && !value.constant && !in_register)
+        {
+            materialize(slot);
+        }
+    }
+}
+
+void FormulaVM::Lowering::materialize(const std::size_t slot)
+{
+    DComplex *dst{reg(static_cast<int>(slot))};
+    if (m_stack[slot].ptr == dst)
+    {
+        return;
+    }
+    claim(dst, slot);
+    emit(Op::MOVE, dst, m_stack[slot].ptr);
+    m_stack[slot] = Value{dst, false};
+}
+
+bool FormulaVM::Lowering::push(const DComplex *ptr)
+{
+    if (m_stack.size() >= STACK_SIZE)
+    {
+        return false;
+    }
+    const auto index{(reinterpret_cast<const char *>(ptr) - reinterpret_cast<const char *>(var(0))) /
+        static_cast<std::ptrdiff_t>(sizeof(ConstArg))};
+    if (index < 0 || index >= static_cast<std::ptrdiff_t>(m_constant_vars.size()))
+    {
+        return false;
+    }
+    m_stack.push_back(Value{ptr, m_constant_vars[index]});
+    return true;
+}
+
+bool FormulaVM::Lowering::unary(const Op op, const FunctionPtr fn)
+{
+    if (m_stack.empty())
+    {
+        return false;
+    }
+    const std::size_t slot{m_stack.size() - 1};
+    const Value value{m_stack[slot]};
+    if (value.constant && is_pure(op))
+    {
+        DComplex result;
+        DComplex unused;
+        execute(Instruction{op, &result, value.ptr, nullptr, 0, nullptr}, unused, nullptr);
+        m_stack[slot] = Value{constant(result), true};
+        return true;
+    }
+    DComplex *dst{reg(static_cast<int>(slot))};
+    claim(dst, slot);
+    if (op == Op::SQR)
+    {
+        claim(var(LAST_SQR_VAR), slot);
+    }
+    else if (op == Op::CALL1)
+    {
+        claim_variables(slot);
+    }
+    emit(op, dst, value.ptr, nullptr, fn);
+    m_stack[slot] = Value{dst, false};
+    return true;
+}
+
+bool FormulaVM::Lowering::binary(const Op op, const FunctionPtr fn)
+{
+    if (m_stack.size() < 2)
+    {
+        return false;
+    }
+    const Value rhs{m_stack.back()};
+    m_stack.pop_back();
+    const std::size_t slot{m_stack.size() - 1};
+    const Value lhs{m_stack[slot]};
+    if (lhs.constant && rhs.constant && is_pure(op))
+    {
+        DComplex result;
+        DComplex unused;
+        execute(Instruction{op, &result, lhs.ptr, rhs.ptr, 0, nullptr}, unused, nullptr);
+        m_stack[slot] = Value{constant(result), true};
+        return true;
+    }
+    DComplex *dst{reg(static_cast<int>(slot))};
+    claim(dst, slot);
+    if (op == Op::CALL2)
+    {
+        claim_variables(slot);
+    }
+    emit(op, dst, lhs.ptr, rhs.ptr, fn);
+    m_stack[slot] = Value{dst, false};
+    return true;
+}
+
+bool FormulaVM::Lowering::store(DComplex *target)
+{
+    if (m_stack.empty())
+    {
+        return false;
+    }
+    const DComplex *value{m_stack.back().ptr};
+    if (value != target)
+    {
+        claim(target, m_stack.size());
+        emit(Op::MOVE, target, m_stack.back().ptr);
+    }
+    return true;
+}
+
+// The copies that bring the current stack to the layout expected where
+// branches join at target.
+std::vector<FormulaVM::Instruction> FormulaVM::Lowering::merge_moves(const Target &target) const
+{
+    std::vector<Instruction> moves;
+    auto move = [&moves](DComplex *dst, const DComplex *src)
+    {
+        if (dst != src)
+        {
+            moves.push_back(Instruction{Op::MOVE, dst, src, nullptr, 0, nullptr});
+        }
+    };
+    switch (target.kind)
+    {
+    case MergeKind::CLEAR:
+        move(reg(0), m_stack.back().ptr);
+        break;
+    case MergeKind::END:
+        // the top can't live in register 0 unless it is slot 0, so order matters
+        move(reg(RESULT_REGISTER), m_stack.back().ptr);
+        move(reg(0), m_stack[0].ptr);
+        break;
+    case MergeKind::OTHER:
+        // only slot 0 can refer to another slot's register, so copy it first
+        for (std::size_t slot = 0; slot < m_stack.size(); ++slot)
+        {
+            move(reg(static_cast<int>(slot)), m_stack[slot].ptr);
+        }
+        break;
+    }
+    return moves;
+}
+
+void FormulaVM::Lowering::set_merged_stack(const Target &target)
+{
+    m_stack.clear();
+    switch (target.kind)
+    {
+    case MergeKind::CLEAR:
+        m_stack.push_back(Value{reg(0), false});
+        break;
+    case MergeKind::END:
+        m_stack.push_back(Value{reg(0), false});
+        m_stack.push_back(Value{reg(RESULT_REGISTER), false});
+        break;
+    case MergeKind::OTHER:
+        for (std::size_t slot = 0; slot < target.depth; ++slot)
+        {
+            m_stack.push_back(Value{reg(static_cast<int>(slot)), false});
+        }
+        break;
+    }
+}
+
+// Records the current stack as arriving at target_op; all arrivals at
+// a general merge must agree on the stack depth.
+bool FormulaVM::Lowering::add_edge(const int target_op)
+{
+    Target &target{m_targets[target_op]};
+    if (target.kind == MergeKind::OTHER && target.has_edge && target.depth != m_stack.size())
+    {
+        return false;
+    }
+    target.has_edge = true;
+    target.depth = m_stack.size();
+    return true;
+}
+
+bool FormulaVM::Lowering::jump(const int op, const int jump_index, const bool conditional, const bool jump_when)
+{
+    if (jump_index >= static_cast<int>(m_formula.jump_control.size()) || m_stack.empty())
+    {
+        return false;
+    }
+    const int target_op{m_formula.jump_control[jump_index].ptrs.jump_op_ptr + 1};
+    if (target_op <= op || target_op > m_section_end || !m_targets[target_op].is_target || !add_edge(target_op))
+    {
+        return false;
+    }
+
+    const std::vector<Instruction> moves{merge_moves(m_targets[target_op])};
+    const DComplex *condition{m_stack.back().ptr};
+    if (conditional && moves.empty())
+    {
+        const int pc{emit(jump_when ? Op::JUMP_IF_TRUE : Op::JUMP_IF_FALSE, nullptr, condition)};
+        m_patches.emplace_back(pc, target_op);
+        return true;
+    }
+    int skip{-1};
+    if (conditional)
+    {
+        skip = emit(jump_when ? Op::JUMP_IF_FALSE : Op::JUMP_IF_TRUE, nullptr, condition);
+    }
+    m_vm.m_code.insert(m_vm.m_code.end(), moves.begin(), moves.end());
+    m_patches.emplace_back(emit(Op::JUMP, nullptr, nullptr), target_op);
+    if (conditional)
+    {
+        m_vm.m_code[skip].target = static_cast<int>(m_vm.m_code.size());
+    }
+    else
+    {
+        m_reachable = false;
+    }
+    return true;
+}
+
+// Joins the fall through path with the jumps to op.
+bool FormulaVM::Lowering::arrive(const int op)
+{
+    Target &target{m_targets[op]};
+    if (m_reachable)
+    {
+        if (!add_edge(op))
+        {
+            return false;
+        }
+        for (const Instruction &move : merge_moves(target))
+        {
+            m_vm.m_code.push_back(move);
+        }
+    }
+    if (!target.has_edge)
+    {
+        return true;
+    }
+    set_merged_stack(target);
+    m_reachable = true;
+    target.pc = static_cast<int>(m_vm.m_code.size());
+    return true;
+}
+
+void FormulaVM::Lowering::end_section()
+{
+    if (m_reachable && !m_stack.empty())
+    {
+        materialize(0);
+        m_vm.m_result = m_stack.back().ptr;
+    }
+    emit(Op::END, nullptr, nullptr);
+}
+
+bool FormulaVM::Lowering::lower_op(const int op)
+{
+    const FunctionPtr fn{m_formula.fns[op]};
+    if (fn == stk_lod)
+    {
+        const Arg *arg{m_formula.load[m_load_index++]};
+        return !m_reachable || push(&arg->d);
+    }
+    if (fn == stk_sto)
+    {
+        Arg *arg{m_formula.store[m_store_index++]};
+        return !m_reachable || store(&arg->d);
+    }
+    if (is_jump(fn))
+    {
+        const int jump_index{m_jump_index++};
+        if (!m_reachable || fn == stk_jump_label)
+        {
+            return true;
+        }
+        return jump(op, jump_index, fn != stk_jump, fn == d_stk_jump_on_true);
+    }
+    if (!m_reachable)
+    {
+        return true;
+    }
+    if (fn == stk_clr)
+    {
+        if (m_stack.empty())
+        {
+            return false;
+        }
+        m_stack.erase(m_stack.begin(), m_stack.end() - 1);
+        return true;
+    }
+    if (fn == stk_ident)
+    {
+        return !m_stack.empty();
+    }
+    if (fn == d_stk_zero || fn == d_stk_one)
+    {
+        if (m_stack.empty())
+        {
+            return false;
+        }
+        m_stack.back() = Value{constant({fn == d_stk_one ? 1.0 : 0.0, 0.0}), true};
+        return true;
+    }
+    if (const StackOp *unary_op{find_op(UNARY_OPS, fn)})
+    {
+        return unary(unary_op->op);
+    }
+    if (const StackOp *binary_op{find_op(BINARY_OPS, fn)})
+    {
+        return binary(binary_op->op, fn);
+    }
+    if (std::find(std::begin(CALLED_OPS), std::end(CALLED_OPS), fn) != std::end(CALLED_OPS))
+    {
+        return unary(Op::CALL1, fn);
+    }
+    return false;
+}
+
+bool FormulaVM::Lowering::lower()
+{
+    const int op_count{m_formula.op_count};
+    if (op_count > static_cast<int>(m_formula.fns.size()))
+    {
+        return false;
+    }
+
+    // variables that are never stored keep the value they were parsed with
+    m_constant_vars.assign(m_formula.vars.size(), true);
+    std::fill_n(m_constant_vars.begin(), std::min(VARIABLES.size(), m_constant_vars.size()), false);
+    for (int i = 0; i < m_formula.store_index; ++i)
+    {
+        m_constant_vars[(reinterpret_cast<const char *>(m_formula.store[i]) -
+                            reinterpret_cast<const char *>(&m_formula.vars[0].a)) /
+            static_cast<std::ptrdiff_t>(sizeof(ConstArg))] = false;
+    }
+
+    const auto fns_end{m_formula.fns.begin() + op_count};
+    const auto init_op{std::find(m_formula.fns.begin(), fns_end, end_init)};
+    const int init_end{init_op != fns_end ? static_cast<int>(init_op - m_formula.fns.begin()) : -1};
+
+    m_targets.assign(op_count + 1, Target{});
+    for (std::size_t i = 0; m_formula.uses_jump && i < m_formula.jump_control.size(); ++i)
+    {
+        if (m_formula.jump_control[i].type == JumpControlType::END_IF)
+        {
+            continue;
+        }
+        const int target_op{m_formula.jump_control[i].ptrs.jump_op_ptr + 1};
+        if (target_op <= 0 || target_op > op_count)
+        {
+            return false;
+        }
+        Target &target{m_targets[target_op]};
+        target.is_target = true;
+        if (target_op == op_count || target_op == init_end)
+        {
+            target.kind = MergeKind::END;
+        }
+        else
+        {
+            target.kind = m_formula.fns[target_op] == stk_clr ? MergeKind::CLEAR : MergeKind::OTHER;
+        }
+    }
+
+    // both sections start with the interpreter stack pointer at slot 0
+    m_vm.m_constants.reserve(op_count + 2);
+    m_stack.assign(1, Value{reg(0), false});
+    m_section_end = init_end >= 0 ? init_end : 0;
+    for (int op = 0; op < m_section_end; ++op)
+    {
+        if ((m_targets[op].is_target && !arrive(op)) || !lower_op(op))
+        {
+            return false;
+        }
+    }
+    if (init_end >= 0 && m_targets[init_end].is_target && !arrive(init_end))
+    {
+        return false;
+    }
+    end_section();
+
+    m_vm.m_orbit_start = static_cast<int>(m_vm.m_code.size());
+    m_stack.assign(1, Value{reg(0), false});
+    m_reachable = true;
+    m_section_end = op_count;
+    for (int op = init_end + 1; op < op_count; ++op)
+    {
+        if ((m_targets[op].is_target && !arrive(op)) || !lower_op(op))
+        {
+            return false;
+        }
+    }
+    if (m_targets[op_count].is_target && !arrive(op_count))
+    {
+        return false;
+    }
+    end_section();
+
+    for (const auto &[pc, target_op] : m_patches)
+    {
+        if (m_targets[target_op].pc < 0)
+        {
+            return false;
+        }
+        m_vm.m_code[pc].target = m_targets[target_op].pc;
+    }
+    return true;
+}
+
+bool FormulaVM::compile(CompiledFormula &formula)
+{
+    clear();
+    m_last_sqr = formula.vars.size() > LAST_SQR_VAR ? &formula.vars[LAST_SQR_VAR].a.d : nullptr;
+    if (m_last_sqr == nullptr || !Lowering{*this, formula}.lower())
+    {
+        clear();
+        return false;
+    }
+    eliminate_dead_stores(formula);
+    return true;
+}
+
+void FormulaVM::clear()
+{
+    m_code.clear();
+    m_constants.clear();
+    m_registers.fill({});
+    m_result = &m_registers[0];
+    m_orbit_start = 0;
+}
+
+// Removes side effect free instructions whose results are overwritten
+// before anything reads them.  Formula variables are assumed to be read
+// after every section, as they carry from one iteration to the next.
+void FormulaVM::eliminate_dead_stores(const CompiledFormula &formula)
+{
+    const std::size_t num_vars{formula.vars.size()};
+    const std::size_t num_locations{NUM_REGISTERS + num_vars};
+    const auto *first_var{reinterpret_cast<const char *>(&formula.vars[0].a.d)};
+    auto location = [&](const DComplex *ptr) -> std::ptrdiff_t
+    {
+        if (ptr >= m_registers.data() && ptr < m_registers.data() + NUM_REGISTERS)
+        {
+            return ptr - m_registers.data();
+        }
+        const std::ptrdiff_t offset{reinterpret_cast<const char *>(ptr) - first_var};
+        if (offset >= 0 && offset % static_cast<std::ptrdiff_t>(sizeof(ConstArg)) == 0 &&
+            offset / static_cast<std::ptrdiff_t>(sizeof(ConstArg)) < static_cast<std::ptrdiff_t>(num_vars))
+        {
+            return NUM_REGISTERS + offset / static_cast<std::ptrdiff_t>(sizeof(ConstArg));
+        }
+        return -1;
+    };
+    auto use = [&](std::vector<bool> &live, const DComplex *ptr)
+    {
+        if (ptr != nullptr)
+        {
+            if (const std::ptrdiff_t loc{location(ptr)}; loc >= 0)
+            {
+                live[loc] = true;
+            }
+        }
+    };
+    auto use_variables = [&](std::vector<bool> &live)
+    { std::fill(live.begin() + NUM_REGISTERS, live.end(), true); };
+
+    bool removed{true};
+    while (removed)
+    {
+        const int size{static_cast<int>(m_code.size())};
+        std::vector<std::vector<bool>> live_in(size, std::vector<bool>(num_locations));
+        std::vector<std::vector<bool>> live_out(size, std::vector<bool>(num_locations));
+        bool changed{true};
+        while (changed)
+        {
+            changed = false;
+            for (int pc = size - 1; pc >= 0; --pc)
+            {
+                const Instruction &in{m_code[pc]};
+                std::vector<bool> out(num_locations);
+                auto merge = [&](const int succ)
+                {
+                    for (std::size_t i = 0; i < num_locations; ++i)
+                    {
+                        out[i] = out[i] || live_in[succ][i];
+                    }
+                };
+                if (in.op == Op::END)
+                {
+                    merge(m_orbit_start);
+                    if (pc == size - 1)
+                    {
+                        merge(0);
+                        use(out, m_result);
+                    }
+                    use_variables(out);
+                }
+                else if (in.op == Op::JUMP)
+                {
+                    merge(in.target);
+                }
+                else
+                {
+                    merge(pc + 1);
+                    if (in.op == Op::JUMP_IF_FALSE || in.op == Op::JUMP_IF_TRUE)
+                    {
+                        merge(in.target);
+                    }
+                }
+
+                std::vector<bool> live{out};
+                if (in.dst != nullptr)
+                {
+                    if (const std::ptrdiff_t loc{location(in.dst)}; loc >= 0)
+                    {
+                        live[loc] = false;
+                    }
+                }
+                if (in.op == Op::SQR)
+                {
+                    live[NUM_REGISTERS + LAST_SQR_VAR] = false;
+                }
+                use(live, in.a);
+                use(live, in.b);
+                if (in.op == Op::CALL1 || in.op == Op::CALL2)
+                {
+                    use_variables(live);
+                }
+                if (live != live_in[pc] || out != live_out[pc])
+                {
+                    live_in[pc] = std::move(live);
+                    live_out[pc] = std::move(out);
+                    changed = true;
+                }
+            }
+        }
+
+        std::vector<bool> keep(size, true);
+        removed = false;
+        for (int pc = 0; pc < size; ++pc)
+        {
+            const Instruction &in{m_code[pc]};
+            if (is_pure(in.op))
+            {
+                if (const std::ptrdiff_t loc{location(in.dst)}; loc >= 0 && !live_out[pc][loc])
+                {
+                    keep[pc] = false;
+                    removed = true;
+                }
+            }
+        }
+        if (!removed)
+        {
+            break;
+        }
+
+        std::vector<int> new_pc(size + 1);
+        std::vector<Instruction> code;
+        for (int pc = 0; pc < size; ++pc)
+        {
+            new_pc[pc] = static_cast<int>(code.size());
+            if (keep[pc])
+            {
+                code.push_back(m_code[pc]);
+            }
+        }
+        new_pc[size] = static_cast<int>(code.size());
+        for (Instruction &in : code)
+        {
+            if (in.op == Op::JUMP || in.op == Op::JUMP_IF_FALSE || in.op == Op::JUMP_IF_TRUE)
+            {
+                in.target = new_pc[in.target];
+            }
+        }
+        m_orbit_start = new_pc[m_orbit_start];
+        m_code = std::move(code);
+    }
+}
+
+void FormulaVM::run(int pc)
+{
+    const Instruction *code{m_code.data()};
+    DComplex &last_sqr{*m_last_sqr};
+    Arg *call_args{m_call_args.data()};
+    for (;;)
+    {
+        const Instruction &in{code[pc]};
+        switch (in.op)
+        {
+        case Op::JUMP:
+            pc = in.target;
+            continue;
+        case Op::JUMP_IF_FALSE:
+            if (in.a->x == 0.0)
+            {
+                pc = in.target;
+                continue;
+            }
+            break;
+        case Op::JUMP_IF_TRUE:
+            if (in.a->x != 0.0)
+            {
+                pc = in.target;
+                continue;
+            }
+            break;
+        case Op::END:
+            return;
+        default:
+            execute(in, last_sqr, call_args);
+            break;
+        }
+        ++pc;
+    }
+}
+
+} // namespace id::fractals
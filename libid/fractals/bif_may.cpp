@@ -22,6 +22,11 @@ void set_bifurc_may_beta(const double beta)
     s_beta = static_cast<long>(g_params[2]);
 }
 
+long bifurc_may_beta()
+{
+    return s_beta;
+}
+
 int bifurc_may_orbit()
 {
     /* X = (lambda * X) / (1 + X)^beta, from R.May as described in Pickover,
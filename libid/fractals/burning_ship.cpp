@@ -47,9 +47,10 @@ int burning_ship_orbit()
     return g_bailout_float();
 }
 
-static double diff_abs(const double c, const double d)
+template <typename T>
+static T diff_abs(const T &c, const T &d)
 {
-    const double cd = c + d;
+    const T cd = c + d;
 
     if (c >= 0.0)
     {
@@ -58,79 +59,79 @@ static double diff_abs(const double c, const double d)
     return cd > 0.0 ? d + 2.0 * c : -d;
 }
 
-void burning_ship_perturb(
-    const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0)
+// Shared by the double and extended exponent deltas; T is the delta component type.
+template <typename T>
+static void burning_ship_perturb(
+    const std::complex<double> &ref, T &delta_real, T &delta_imag, const T &a0, const T &b0)
 {
+    using std::abs;
     const int degree = static_cast<int>(g_params[2]);
     const double r{ref.real()};
     const double i{ref.imag()};
     const double r2 = r * r;
     const double i2 = i * i;
-    const double a{delta_n.real()};
-    const double b{delta_n.imag()};
-    const double a2 = a * a;
-    const double b2 = b * b;
-    const double a0{delta0.real()};
-    const double b0{delta0.imag()};
+    const T a{delta_real};
+    const T b{delta_imag};
+    const T a2 = a * a;
+    const T b2 = b * b;
 
     switch (degree)
     {
     case 2:
-        delta_n.real(2.0 * a * r + a2 - 2.0 * b * i - b2);
-        delta_n.imag(diff_abs(r * i, r * b + i * a + a * b) * 2);
-        delta_n += delta0;
+        delta_real = 2.0 * a * r + a2 - 2.0 * b * i - b2 + a0;
+        delta_imag = diff_abs<T>(r * i, r * b + i * a + a * b) * 2 + b0;
         break;
 
     case 3:
     {
-        double dnr = diff_abs(r, a);
-        double ab = r + a;
-        dnr = (r * r - 3 * i * i) * dnr                            //
-            + (2 * a * r + a2 - 6 * i * b - 3 * b2) * std::abs(ab) //
+        T dnr = diff_abs<T>(r, a);
+        T ab = r + a;
+        dnr = (r * r - 3 * i * i) * dnr                        //
+            + (2 * a * r + a2 - 6 * i * b - 3 * b2) * abs(ab) //
             + a0;
-        double dni = diff_abs(i, b);
+        T dni = diff_abs<T>(i, b);
         ab = i + b;
-        dni = (3 * r * r - i * i) * dni                             //
-            + (6 * r * a + 3 * a2 - 2 * i * b - b2) * std::abs(ab) //
+        dni = (3 * r * r - i * i) * dni                         //
+            + (6 * r * a + 3 * a2 - 2 * i * b - b2) * abs(ab) //
             + b0;
-        delta_n.imag(dni);
-        delta_n.real(dnr);
+        delta_imag = dni;
+        delta_real = dnr;
         break;
     }
 
     case 4:
     {
-        const double dnr = 4 * r2 * r * a //
-            + 6 * r2 * a2                 //
-            + 4 * r * a2 * a              //
-            + a2 * a2                     //
-            + 4 * i2 * i * b              //
-            + 6 * i2 * b2                 //
-            + 4 * i * b2 * b              //
-            + b2 * b2                     //
-            - 12 * r2 * i * b             //
-            - 6 * r2 * b2                 //
-            - 12 * r * a * i2             //
-            - 24 * r * a * i * b          //
-            - 12 * r * a * b2             //
-            - 6 * a2 * i2                 //
-            - 12 * a2 * i * b             //
-            - 6 * a2 * b2                 //
+        const T dnr = 4 * r2 * r * a //
+            + 6 * r2 * a2            //
+            + 4 * r * a2 * a         //
+            + a2 * a2                //
+            + 4 * i2 * i * b         //
+            + 6 * i2 * b2            //
+            + 4 * i * b2 * b         //
+            + b2 * b2                //
+            - 12 * r2 * i * b        //
+            - 6 * r2 * b2            //
+            - 12 * r * a * i2        //
+            - 24 * r * a * i * b     //
+            - 12 * r * a * b2        //
+            - 6 * a2 * i2            //
+            - 12 * a2 * i * b        //
+            - 6 * a2 * b2            //
             + a0;
-        double dni = diff_abs(r * i, r * b + a * i + a * b);
-        dni = 4 * (r2 - i2) * dni                                                              //
-            + 4 * std::abs(r * i + r * b + a * i + a * b) * (2 * a * r + a2 - 2 * b * i - b2) //
+        T dni = diff_abs<T>(r * i, r * b + a * i + a * b);
+        dni = 4 * (r2 - i2) * dni                                                          //
+            + 4 * abs(r * i + r * b + a * i + a * b) * (2 * a * r + a2 - 2 * b * i - b2) //
             + b0;
-        delta_n.imag(dni);
-        delta_n.real(dnr);
+        delta_imag = dni;
+        delta_real = dnr;
         break;
     }
 
     case 5:
     {
-        double dnr = diff_abs(r, a);
+        T dnr = diff_abs<T>(r, a);
         dnr = dnr * (r * r * r * r - 10 * r * r * i * i + 5 * i * i * i * i) //
-            + std::abs(r + a) *
+            + abs(r + a) *
                 (4 * r * r * r * a       //
                     + 6 * r * r * a2     //
                     + 4 * r * a2 * a     //
@@ -148,8 +149,8 @@ void burning_ship_perturb(
                     + 20 * i * b2 * b    //
                     + 5 * b2 * b2)       //
             + a0;
-        const double dni = diff_abs(i, b) * (5 * r2 * r2 - 10 * r2 * i2 + i2 * i2) + //
-            std::abs(i + b) *
+        const T dni = diff_abs<T>(i, b) * (5 * r2 * r2 - 10 * r2 * i2 + i2 * i2) + //
+            abs(i + b) *
                 (20 * r2 * r * a         //
                     + 30 * r2 * a2       //
                     + 20 * r * a2 * a    //
@@ -167,8 +168,8 @@ void burning_ship_perturb(
                     + 4 * i * b2 * b     //
                     + b2 * b2)           //
             + b0;
-        delta_n.imag(dni);
-        delta_n.real(dnr);
+        delta_imag = dni;
+        delta_real = dnr;
         break;
     }
 
@@ -177,6 +178,22 @@ void burning_ship_perturb(
     }
 }
 
+void burning_ship_perturb(
+    const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0)
+{
+    double real{delta_n.real()};
+    double imag{delta_n.imag()};
+    burning_ship_perturb(ref, real, imag, delta0.real(), delta0.imag());
+    delta_n.real(real);
+    delta_n.imag(imag);
+}
+
+void burning_ship_perturb_fe(
+    const std::complex<double> &ref, FloatExpComplex &delta_n, const FloatExpComplex &delta0)
+{
+    burning_ship_perturb(ref, delta_n.x, delta_n.y, delta0.x, delta0.y);
+}
+
 void burning_ship_ref_pt(const std::complex<double> &center, std::complex<double> &z)
 {
     if (const int degree = static_cast<int>(g_params[2]); degree == 2)
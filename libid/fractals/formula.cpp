@@ -5,10 +5,12 @@
 #include "engine/calcfrac.h"
 #include "engine/Inversion.h"
 #include "engine/pixel_grid.h"
+#include "fractals/FormulaVM.h"
 #include "fractals/interpreter.h"
 #include "fractals/newton.h"
 #include "fractals/parser.h"
 #include "math/fixed_pt.h"
+#include "misc/debug_flags.h"
 
 #include <fmt/format.h>
 
@@ -23,6 +25,13 @@ std::filesystem::path g_formula_filename; // file to find formulas in
 std::string g_formula_name;               // Name of the Formula (if not empty)
 bool g_frm_is_mandelbrot{true};           // true if the formula is a mandelbrot type
 
+// The register form skips the interpreter's tracing, so tracing uses the interpreter.
+bool use_formula_vm()
+{
+    return g_formula_vm.compiled() && g_debug_flag != DebugFlags::WRITE_FORMULA_DEBUG_INFORMATION &&
+        g_debug_flag != DebugFlags::FORCE_FORMULA_INTERPRETER;
+}
+
 int bad_formula()
 {
     //  this is called when a formula is bad, instead of calling
@@ -89,6 +98,13 @@ int formula_per_pixel()
         g_formula.vars[0].a.d.y = dy_pixel();
     }
 
+    if (use_formula_vm())
+    {
+        g_formula_vm.run_init();
+        g_old_z = g_formula.vars[3].a.d;
+        return g_overflow ? 0 : 1;
+    }
+
     if (g_formula.last_init_op)
     {
         g_formula.last_init_op = g_formula.op_count;
@@ -127,6 +143,14 @@ int formula_orbit()
         d_random();
     }
 
+    if (use_formula_vm())
+    {
+        const bool bailout{g_formula_vm.run_orbit().x == 0.0};
+        g_new_z = g_formula.vars[3].a.d;
+        g_old_z = g_new_z;
+        return bailout;
+    }
+
     g_arg1 = g_runtime.stack.data();
     g_arg2 = g_runtime.stack.data();
     --g_arg2;
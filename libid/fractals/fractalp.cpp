@@ -121,6 +121,7 @@ static constexpr const char *CONSTANT_Y{"Constant C (imaginary)"};
 // bifurcations
 static constexpr const char *FILT{"+Filter Cycles"};
 static constexpr const char *SEED_POP{"Seed Population"};
+static constexpr const char *BIF_COLORING{"+Coloring (0 = Hit Count, 1 = Log Density)"};
 
 // frothy basins
 static constexpr const char *FROTH_MAPPING{"+Apply mapping once (1) or twice (2)"};
@@ -131,7 +132,7 @@ static constexpr const char *FROTH_A_VALUE{"A (imaginary part of C)"};
 static constexpr const char *RANDOM_SEED{"+Random Seed Value (0 = Random, 1 = Reuse Last)"};
 
 // ifs
-static constexpr const char *COLOR_METHOD{"+Coloring method (0,1)"};
+static constexpr const char *COLOR_METHOD{"+Coloring method (0,1,2)"};
 
 // phoenix fractals
 static constexpr const char *DEGREE_Z{"Degree = 0 | >= 2 | <= -3"};
@@ -224,7 +225,8 @@ const FractalSpecific g_fractal_specific[] = {
         orbit fn, per_pixel fn, per_image fn,
         calc type fn,
         bailout,
-        perturbation ref pt, perturbation bf ref pt, perturbation point
+        perturbation ref pt, perturbation bf ref pt, perturbation point,
+        extended exponent perturbation point
     }
     */
 
@@ -256,7 +258,8 @@ const FractalSpecific g_fractal_specific[] = {
         julia_orbit, mandel_per_pixel, mandel_per_image,                         //
         standard_fractal_type,                                                   //
         STD_BAILOUT,                                                             //
-        mandel_ref_pt, mandel_ref_pt_bf, mandel_perturb                          //
+        mandel_ref_pt, mandel_ref_pt_bf, mandel_perturb,                         //
+        mandel_perturb_fe                                                        //
     },
 
     {
@@ -423,7 +426,7 @@ const FractalSpecific g_fractal_specific[] = {
     {
         FractalType::BIFURCATION,                                                                        //
         "bifurcation",                                                                                   //
-        {FILT, SEED_POP, "", ""},                                                                        //
+        {FILT, SEED_POP, BIF_COLORING, ""},                                                              //
         {1000.0, 0.66, 0, 0},                                                                            //
         HelpLabels::HT_BIFURCATION, HelpLabels::HF_BIFURCATION,                                          //
         FractalFlags::TRIG1 | FractalFlags::NO_GUESS | FractalFlags::NO_TRACE | FractalFlags::NO_ROTATE, //
@@ -584,7 +587,8 @@ const FractalSpecific g_fractal_specific[] = {
         mandel_z_power_orbit, other_mandel_per_pixel, mandel_per_image,          //
         standard_fractal_type,                                                   //
         STD_BAILOUT,                                                             //
-        mandel_z_power_ref_pt, mandel_z_power_ref_pt_bf, mandel_z_power_perturb  //
+        mandel_z_power_ref_pt, mandel_z_power_ref_pt_bf, mandel_z_power_perturb, //
+        mandel_z_power_perturb_fe                                                //
     },
 
     {
@@ -1108,7 +1112,7 @@ const FractalSpecific g_fractal_specific[] = {
     {
         FractalType::BIF_LAMBDA,                                                                         //
         "biflambda",                                                                                     //
-        {FILT, SEED_POP, "", ""},                                                                        //
+        {FILT, SEED_POP, BIF_COLORING, ""},                                                              //
         {1000.0, 0.66, 0, 0},                                                                            //
         HelpLabels::HT_BIFURCATION, HelpLabels::HF_BIF_LAMBDA,                                           //
         FractalFlags::TRIG1 | FractalFlags::NO_GUESS | FractalFlags::NO_TRACE | FractalFlags::NO_ROTATE, //
@@ -1123,7 +1127,7 @@ const FractalSpecific g_fractal_specific[] = {
     {
         FractalType::BIF_PLUS_SIN_PI,                                                                    //
         "bif+sinpi",                                                                                     //
-        {FILT, SEED_POP, "", ""},                                                                        //
+        {FILT, SEED_POP, BIF_COLORING, ""},                                                              //
         {1000.0, 0.66, 0, 0},                                                                            //
         HelpLabels::HT_BIFURCATION, HelpLabels::HF_BIF_PLUS_SIN_PI,                                      //
         FractalFlags::TRIG1 | FractalFlags::NO_GUESS | FractalFlags::NO_TRACE | FractalFlags::NO_ROTATE, //
@@ -1138,7 +1142,7 @@ const FractalSpecific g_fractal_specific[] = {
     {
         FractalType::BIF_EQ_SIN_PI,                                                                      //
         "bif=sinpi",                                                                                     //
-        {FILT, SEED_POP, "", ""},                                                                        //
+        {FILT, SEED_POP, BIF_COLORING, ""},                                                              //
         {1000.0, 0.66, 0, 0},                                                                            //
         HelpLabels::HT_BIFURCATION, HelpLabels::HF_BIF_EQ_SIN_PI,                                        //
         FractalFlags::TRIG1 | FractalFlags::NO_GUESS | FractalFlags::NO_TRACE | FractalFlags::NO_ROTATE, //
@@ -1243,7 +1247,7 @@ const FractalSpecific g_fractal_specific[] = {
     {
         FractalType::BIF_STEWART,                                                                        //
         "bifstewart",                                                                                    //
-        {FILT, SEED_POP, "", ""},                                                                        //
+        {FILT, SEED_POP, BIF_COLORING, ""},                                                              //
         {1000.0, 0.66, 0, 0},                                                                            //
         HelpLabels::HT_BIFURCATION, HelpLabels::HF_BIF_STEWART,                                          //
         FractalFlags::TRIG1 | FractalFlags::NO_GUESS | FractalFlags::NO_TRACE | FractalFlags::NO_ROTATE, //
@@ -1426,7 +1430,7 @@ const FractalSpecific g_fractal_specific[] = {
     {
         FractalType::BIF_MAY,                                                      //
         "bifmay",                                                                  //
-        {FILT, SEED_POP, "Beta >= 2", ""},                                         //
+        {FILT, SEED_POP, "Beta >= 2", BIF_COLORING},                               //
         {300.0, 0.9, 5, 0},                                                        //
         HelpLabels::HT_BIFURCATION, HelpLabels::HF_BIF_MAY,                        //
         FractalFlags::NO_GUESS | FractalFlags::NO_TRACE | FractalFlags::NO_ROTATE, //
@@ -1933,7 +1937,8 @@ const FractalSpecific g_fractal_specific[] = {
         burning_ship_orbit, other_mandel_per_pixel, burning_ship_per_image,      //
         standard_fractal_type,                                                   //
         STD_BAILOUT,                                                             //
-        burning_ship_ref_pt, burning_ship_ref_pt_bf, burning_ship_perturb        //
+        burning_ship_ref_pt, burning_ship_ref_pt_bf, burning_ship_perturb,       //
+        burning_ship_perturb_fe                                                  //
     },
 
     // marks the END of the list
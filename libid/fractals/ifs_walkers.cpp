@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "fractals/ifs_walkers.h"
+
+#include "engine/calcfrac.h"
+#include "engine/random_seed.h"
+#include "engine/TileScheduler.h"
+#include "engine/VideoInfo.h"
+#include "geometry/line3d.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace id::engine;
+using namespace id::geometry;
+
+namespace id::fractals
+{
+
+namespace
+{
+
+// Walker batches per image; fixed so the random streams, and therefore the
+// image, are the same however many workers run them.
+constexpr int BATCHES{64};
+constexpr int LANES{IFS_WALKER_LANES};
+constexpr long POINTS_PER_STEP{static_cast<long>(BATCHES) * LANES};
+
+// Points each walker discards while it settles onto the attractor.
+constexpr long WARMUP_STEPS{32};
+
+// pixels can't get this big; see the serial IFS in lorenz.cpp
+constexpr long BAD_PIXEL{10000L};
+
+} // namespace
+
+IFSWalkers::IFSWalkers(const IFSDimension dim, const IFSProjection &projection) :
+    m_dim(dim),
+    m_projection(projection),
+    m_num_params(dim == IFSDimension::TWO ? NUM_IFS_2D_PARAMS : NUM_IFS_3D_PARAMS),
+    m_batches(BATCHES)
+{
+    // the last parameter of each transform is its probability
+    const int num_coefficients{m_num_params - 1};
+    double sum{};
+    for (int k = 0; k < g_num_affine_transforms; ++k)
+    {
+        const float *row{g_ifs_definition.data() + k * m_num_params};
+        m_coefficients.insert(m_coefficients.end(), row, row + num_coefficients);
+        sum += row[num_coefficients];
+        m_thresholds.push_back(sum);
+    }
+    // the last transform takes every draw the others leave
+    if (!m_thresholds.empty())
+    {
+        m_thresholds.pop_back();
+    }
+
+    for (Batch &batch : m_batches)
+    {
+        for (std::uint32_t &random : batch.random)
+        {
+            random = static_cast<std::uint32_t>(random15()) << 15U | static_cast<std::uint32_t>(random15());
+        }
+        step(batch, WARMUP_STEPS, nullptr);
+    }
+    m_hits.resize(static_cast<std::size_t>(m_projection.width) * m_projection.height);
+}
+
+void IFSWalkers::step(Batch &batch, const long steps, std::uint32_t *hits) const
+{
+    const IFSProjection &proj{m_projection};
+    const int stride{m_num_params - 1};
+    const int num_thresholds{static_cast<int>(m_thresholds.size())};
+    for (long i = 0; i < steps; ++i)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            // pick which iterated function to execute, weighted by probability
+            const double r{static_cast<double>(random15(batch.random[lane])) / ID_RANDOM_MAX};
+            int k{};
+            for (int t = 0; t < num_thresholds; ++t)
+            {
+                k += m_thresholds[t] < r ? 1 : 0;
+            }
+            const double *f{&m_coefficients[static_cast<std::size_t>(k) * stride]};
+            const double x{batch.x[lane]};
+            const double y{batch.y[lane]};
+            const double z{batch.z[lane]};
+            double u;
+            double v;
+            if (m_dim == IFSDimension::TWO)
+            {
+                batch.x[lane] = f[0] * x + f[1] * y + f[4];
+                batch.y[lane] = f[2] * x + f[3] * y + f[5];
+                u = batch.x[lane];
+                v = batch.y[lane];
+            }
+            else
+            {
+                batch.x[lane] = f[0] * x + f[1] * y + f[2] * z + f[9];
+                batch.y[lane] = f[3] * x + f[4] * y + f[5] * z + f[10];
+                batch.z[lane] = f[6] * x + f[7] * y + f[8] * z + f[11];
+                const double orbit[3]{batch.x[lane], batch.y[lane], batch.z[lane]};
+                double view[3];
+                for (int j = 0; j < 3; ++j)
+                {
+                    view[j] = orbit[0] * proj.view[0][j] + orbit[1] * proj.view[1][j] +
+                        orbit[2] * proj.view[2][j] + proj.view[3][j];
+                }
+                if (proj.perspective)
+                {
+                    const double denom{proj.viewer[2] - view[2]};
+                    if (denom >= 0.0)
+                    {
+                        // behind the viewer
+                        view[0] = BAD_VALUE;
+                        view[1] = BAD_VALUE;
+                    }
+                    else
+                    {
+                        view[0] = (view[0] * proj.viewer[2] - proj.viewer[0] * view[2]) / denom;
+                        view[1] = (view[1] * proj.viewer[2] - proj.viewer[1] * view[2]) / denom;
+                    }
+                }
+                u = view[0];
+                v = view[1];
+            }
+            const double col{proj.cvt.a * u + proj.cvt.b * v + proj.cvt.e + proj.x_adjust};
+            const double row{proj.cvt.c * u + proj.cvt.d * v + proj.cvt.f + proj.y_adjust};
+            if (std::abs(col) + std::abs(row) > BAD_PIXEL)
+            {
+                // restart the walker before its orbit overflows
+                batch.diverged = true;
+                batch.x[lane] = 0.0;
+                batch.y[lane] = 0.0;
+                batch.z[lane] = 0.0;
+                continue;
+            }
+            const int x_pixel{static_cast<int>(col)};
+            const int y_pixel{static_cast<int>(row)};
+            if (hits != nullptr && x_pixel >= 0 && x_pixel < proj.width && y_pixel >= 0 && y_pixel < proj.height)
+            {
+                ++hits[static_cast<std::size_t>(y_pixel) * proj.width + x_pixel];
+            }
+        }
+    }
+}
+
+long IFSWalkers::run(const long count)
+{
+    const long steps{std::max(1L, (count + POINTS_PER_STEP - 1) / POINTS_PER_STEP)};
+    TileScheduler &scheduler{tile_scheduler()};
+    m_worker_hits.resize(scheduler.num_workers());
+    scheduler.run(BATCHES,
+        [&](const int tile, const unsigned worker)
+        {
+            std::vector<std::uint32_t> &hits{m_worker_hits[worker]};
+            hits.resize(m_hits.size());
+            step(m_batches[tile], steps, hits.data());
+        });
+
+    // merge and clear the worker histograms a row at a time
+    const int width{m_projection.width};
+    std::vector<std::uint32_t> row_max(m_projection.height);
+    scheduler.run(m_projection.height,
+        [&](const int row, unsigned)
+        {
+            const std::size_t begin{static_cast<std::size_t>(row) * width};
+            for (std::vector<std::uint32_t> &worker_hits : m_worker_hits)
+            {
+                if (worker_hits.empty())
+                {
+                    continue;
+                }
+                for (std::size_t i = begin; i < begin + width; ++i)
+                {
+                    m_hits[i] += worker_hits[i];
+                    worker_hits[i] = 0;
+                }
+            }
+            row_max[row] = *std::max_element(m_hits.begin() + begin, m_hits.begin() + begin + width);
+        });
+    m_max_hits = row_max.empty() ? 0 : *std::max_element(row_max.begin(), row_max.end());
+    return steps * POINTS_PER_STEP;
+}
+
+bool IFSWalkers::diverged() const
+{
+    return std::any_of(m_batches.begin(), m_batches.end(), [](const Batch &batch) { return batch.diverged; });
+}
+
+int ifs_density_color(const std::uint32_t hits, const std::uint32_t max_hits, const int colors)
+{
+    if (hits == 0)
+    {
+        return 0;
+    }
+    if (colors <= 2 || max_hits <= 1)
+    {
+        return 1;
+    }
+    const double density{std::log1p(static_cast<double>(hits)) / std::log1p(static_cast<double>(max_hits))};
+    return std::min(colors - 1, 1 + static_cast<int>(density * (colors - 2)));
+}
+
+void plot_ifs_density(const IFSWalkers &walkers)
+{
+    const int width{walkers.projection().width};
+    const int height{walkers.projection().height};
+    const std::vector<std::uint32_t> &hits{walkers.hits()};
+    for (int row = 0; row < height; ++row)
+    {
+        for (int col = 0; col < width; ++col)
+        {
+            if (const std::uint32_t count = hits[static_cast<std::size_t>(row) * width + col]; count != 0)
+            {
+                g_plot(col, row, ifs_density_color(count, walkers.max_hits(), g_colors));
+            }
+        }
+    }
+}
+
+} // namespace id::fractals
@@ -2,16 +2,23 @@
 //
 #include "fractals/julibrot.h"
 
+#include "engine/bailout_formula.h"
 #include "engine/fractals.h"
 #include "engine/get_julia_attractor.h"
 #include "engine/ImageRegion.h"
 #include "engine/LogicalScreen.h"
 #include "engine/spindac.h"
+#include "engine/TileScheduler.h"
 #include "engine/VideoInfo.h"
 #include "fractals/fractalp.h"
 #include "fractals/fractype.h"
+#include "fractals/hypercomplex_mandelbrot.h"
+#include "fractals/interpreter.h"
 #include "fractals/pickover_mandelbrot.h"
+#include "fractals/quaternion_mandelbrot.h"
 #include "io/loadmap.h"
+#include "math/arg.h"
+#include "math/fpu087.h"
 #include "math/sqr.h"
 #include "misc/debug_flags.h"
 #include "misc/Driver.h"
@@ -21,6 +28,7 @@
 #include "ui/stop_msg.h"
 
 #include <algorithm>
+#include <array>
 
 using namespace id::engine;
 using namespace id::io;
@@ -67,6 +75,261 @@ struct JuliBrot
     DComplex jb_c{};
 };
 
+// row pairs per worker between keyboard checks
+constexpr int BAND_PAIRS{2};
+
+// A coarse sample that escapes after more than this fraction of the
+// iteration limit is taken to be near the surface.
+constexpr long NEAR_SURFACE_DIVISOR{4};
+
+void cmplx_cosxx(const DComplex &arg, DComplex &out)
+{
+    cmplx_cos(arg, out);
+    out.y = -out.y;
+}
+
+struct FnKernel
+{
+    void (*stack_fn)();
+    JulibrotFn fn;
+};
+
+// the functions whose parser stack version computes exactly this
+const std::array<FnKernel, 9> FN_KERNELS{{
+    {d_stk_sin, cmplx_sin},      //
+    {d_stk_cos, cmplx_cos},      //
+    {d_stk_cosxx, cmplx_cosxx},  //
+    {d_stk_sinh, cmplx_sinh},    //
+    {d_stk_cosh, cmplx_cosh},    //
+    {d_stk_exp, cmplx_exp},      //
+    {d_stk_log, cmplx_log},      //
+    {d_stk_sqr, cmplx_sqr},      //
+    {stk_ident, nullptr},        //
+}};
+
+const FnKernel *find_fn_kernel()
+{
+    const auto it{std::find_if(FN_KERNELS.begin(), FN_KERNELS.end(),
+        [](const FnKernel &kernel) { return kernel.stack_fn == g_d_trig0; })};
+    return it == FN_KERNELS.end() ? nullptr : &*it;
+}
+
+bool find_orbit(JulibrotOrbit &orbit)
+{
+    const OrbitCalc calc{make_julibrot_orbit_dispatch().orbit_calc()};
+    if (calc == julia_orbit)
+    {
+        orbit = JulibrotOrbit::JULIA;
+    }
+    else if (calc == quaternion_orbit)
+    {
+        orbit = JulibrotOrbit::QUATERNION;
+    }
+    else if (calc == hyper_complex_orbit)
+    {
+        orbit = JulibrotOrbit::HYPER_COMPLEX;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+const DComplex &pixel_eye(const JulibrotContext &ctx, const int col, const int row)
+{
+    switch (ctx.mode)
+    {
+    case Julibrot3DMode::RIGHT_EYE:
+        return ctx.right_eye;
+    case Julibrot3DMode::RED_BLUE:
+        return row + col & 1 ? ctx.left_eye : ctx.right_eye;
+    default:
+        return ctx.left_eye;
+    }
+}
+
+// The nearest depth sample of the ray through (x, y) seen from eye, and the
+// step to the next one.
+void depth_ray(const JulibrotContext &ctx, const DComplex &eye, const double x, const double y,
+    JulibrotSample &sample, JulibrotSample &step)
+{
+    sample.jx = ((eye.x - x) * ctx.init_z / ctx.dist - x) * ctx.x_per_inch;
+    sample.jx += ctx.x_offset;
+    step.jx = ctx.depth / ctx.dist * (eye.x - x) * ctx.x_per_inch / ctx.z_dots;
+
+    sample.jy = ((eye.y - y) * ctx.init_z / ctx.dist - y) * ctx.y_per_inch;
+    sample.jy += ctx.y_offset;
+    step.jy = ctx.depth / ctx.dist * (eye.y - y) * ctx.y_per_inch / ctx.z_dots;
+
+    sample.mx = ctx.x_min;
+    sample.my = ctx.y_min;
+    step.mx = ctx.delta_mx;
+    step.my = ctx.delta_my;
+}
+
+// Returns the index of the first sample whose orbit doesn't escape, or
+// ctx.z_dots.  iterations(sample) returns the iterations before the orbit
+// escapes, or ctx.max_iterations.
+//
+// With a coarse step only every coarse_step'th sample is iterated until one
+// is inside or escapes slowly enough to be near the surface; the samples
+// skipped before it are then tested in order.  Features thinner than the
+// coarse step whose coarse neighbors escape quickly can be missed.
+template <typename Iterations>
+int march_depth(const JulibrotContext &ctx, JulibrotSample sample, const JulibrotSample &step,
+    const Iterations &iterations)
+{
+    const long near_surface{ctx.max_iterations / NEAR_SURFACE_DIVISOR};
+    const int coarse_step{std::clamp(ctx.coarse_step, 1, JULIBROT_MAX_COARSE_STEP)};
+    std::array<JulibrotSample, JULIBROT_MAX_COARSE_STEP> skipped;
+    int num_skipped{};
+    for (int z = 0; z < ctx.z_dots; ++z)
+    {
+        if (num_skipped + 1 < coarse_step && z + 1 < ctx.z_dots)
+        {
+            skipped[num_skipped++] = sample;
+        }
+        else
+        {
+            if (const long n = iterations(sample); n >= near_surface)
+            {
+                for (int i = 0; i < num_skipped; ++i)
+                {
+                    if (iterations(skipped[i]) == ctx.max_iterations)
+                    {
+                        return z - num_skipped + i;
+                    }
+                }
+                if (n == ctx.max_iterations)
+                {
+                    return z;
+                }
+            }
+            num_skipped = 0;
+        }
+        // accumulate like the original scan so the samples are the same
+        sample.mx += step.mx;
+        sample.my += step.my;
+        sample.jx += step.jx;
+        sample.jy += step.jy;
+    }
+    return ctx.z_dots;
+}
+
+long julia_iterations(const JulibrotContext &ctx, const JulibrotSample &sample)
+{
+    double x{sample.jx};
+    double y{sample.jy};
+    double x_sqr{sqr(x)};
+    double y_sqr{sqr(y)};
+    long n{};
+    for (; n < ctx.max_iterations; ++n)
+    {
+        const double new_x{x_sqr - y_sqr + sample.mx};
+        const double new_y{2.0 * x * y + sample.my};
+        x_sqr = sqr(new_x);
+        y_sqr = sqr(new_y);
+        if (x_sqr + y_sqr >= ctx.magnitude_limit)
+        {
+            break;
+        }
+        x = new_x;
+        y = new_y;
+    }
+    return n;
+}
+
+// The orbit start and quaternion c of a sample, as z_line() sets them up.
+void quaternion_start(const JulibrotContext &ctx, const JulibrotSample &sample, double (&z)[4], double (&c)[4])
+{
+    if (ctx.mandel_start)
+    {
+        z[0] = 0.0;
+        z[1] = 0.0;
+        z[2] = 0.0;
+        z[3] = 0.0;
+        c[0] = sample.jx;
+        c[1] = sample.jy;
+        c[2] = sample.mx;
+        c[3] = sample.my;
+    }
+    else
+    {
+        z[0] = sample.jx;
+        z[1] = sample.jy;
+        z[2] = sample.mx;
+        z[3] = sample.my;
+        std::copy(ctx.c.begin(), ctx.c.end(), c);
+    }
+}
+
+long quaternion_iterations(const JulibrotContext &ctx, const JulibrotSample &sample)
+{
+    double a[4];
+    double c[4];
+    quaternion_start(ctx, sample, a, c);
+    long n{};
+    for (; n < ctx.max_iterations; ++n)
+    {
+        const double n0{a[0] * a[0] - a[1] * a[1] - a[2] * a[2] - a[3] * a[3] + c[0]};
+        const double n1{2 * a[0] * a[1] + c[1]};
+        const double n2{2 * a[0] * a[2] + c[2]};
+        const double n3{2 * a[0] * a[3] + c[3]};
+        if (a[0] * a[0] + a[1] * a[1] + a[2] * a[2] + a[3] * a[3] > ctx.magnitude_limit)
+        {
+            break;
+        }
+        a[0] = n0;
+        a[1] = n1;
+        a[2] = n2;
+        a[3] = n3;
+    }
+    return n;
+}
+
+long hyper_complex_iterations(const JulibrotContext &ctx, const JulibrotSample &sample)
+{
+    double h[4];
+    double c[4];
+    quaternion_start(ctx, sample, h, c);
+    long n{};
+    for (; n < ctx.max_iterations; ++n)
+    {
+        // apply the function to each part of the duplex form, as hcmplx_trig0() does
+        DComplex a{h[0] - h[3], h[1] + h[2]};
+        DComplex b{h[0] + h[3], h[1] - h[2]};
+        if (ctx.fn != nullptr)
+        {
+            ctx.fn(a, a);
+            ctx.fn(b, b);
+        }
+        h[0] = (a.x + b.x) / 2 + c[0];
+        h[1] = (a.y + b.y) / 2 + c[1];
+        h[2] = (a.y - b.y) / 2 + c[2];
+        h[3] = (b.x - a.x) / 2 + c[3];
+        if (sqr(h[0]) + sqr(h[1]) + sqr(h[2]) + sqr(h[3]) > ctx.magnitude_limit)
+        {
+            break;
+        }
+    }
+    return n;
+}
+
+int depth_color(const JulibrotContext &ctx, const int z_pixel, const bool left_eye)
+{
+    if (ctx.mode == Julibrot3DMode::RED_BLUE)
+    {
+        const int color{static_cast<int>(128L * z_pixel / ctx.z_dots)};
+        if (left_eye)
+        {
+            return 127 - color;
+        }
+        return 127 + ctx.b_base - std::clamp(static_cast<int>(color * ctx.br_ratio), 1, 127);
+    }
+    return static_cast<int>(254L * z_pixel / ctx.z_dots) + 1;
+}
+
 } // namespace
 
 static JuliBrot s_jb{};
@@ -82,6 +345,7 @@ double g_julibrot_x_max{-.83};
 double g_julibrot_y_max{.25};
 //
 int g_julibrot_z_dots{128};
+int g_julibrot_coarse_step{1};
 float g_julibrot_origin{8.0F};
 float g_julibrot_height{7.0F};
 float g_julibrot_width{10.0F};
@@ -102,7 +366,7 @@ static int s_z_pixel;
 static bool s_plotted{};
 static long s_n;
 
-static void z_line(const FractalDispatch &dispatch, double x, double y);
+static void z_line(const FractalDispatch &dispatch, const JulibrotContext &ctx, double x, double y);
 
 FractalDispatch make_julibrot_orbit_dispatch()
 {
@@ -191,101 +455,133 @@ int julibrot_per_pixel()
     return 1;
 }
 
-static void z_line(const FractalDispatch &dispatch, const double x, const double y)
+static void z_line(const FractalDispatch &dispatch, const JulibrotContext &ctx, const double x, const double y)
 {
-    s_jb.x_pixel = x;
-    s_jb.y_pixel = y;
-    s_jb.mx = g_julibrot_x_min;
-    s_jb.my = g_julibrot_y_min;
-    switch (g_julibrot_3d_mode)
-    {
-    case Julibrot3DMode::MONOCULAR:
-    case Julibrot3DMode::LEFT_EYE:
-        s_jb.per = &s_jb.left_eye;
-        break;
-    case Julibrot3DMode::RIGHT_EYE:
-        s_jb.per = &s_jb.right_eye;
-        break;
-    case Julibrot3DMode::RED_BLUE:
-        if (g_row + g_col & 1)
-        {
-            s_jb.per = &s_jb.left_eye;
-        }
-        else
-        {
-            s_jb.per = &s_jb.right_eye;
-        }
-        break;
-    }
-    julibrot_per_pixel();
-    for (s_z_pixel = 0; s_z_pixel < g_julibrot_z_dots; s_z_pixel++)
-    {
-        // Special initialization for Mandelbrot types
-        if (g_new_orbit_type == FractalType::QUAT || g_new_orbit_type == FractalType::HYPER_CMPLX)
-        {
-            g_old_z.x = 0.0;
-            g_old_z.y = 0.0;
-            s_jb.jb_c.x = 0.0;
-            s_jb.jb_c.y = 0.0;
-            g_quaternion_c = s_jb.jx;
-            g_quaternion_ci = s_jb.jy;
-            g_quaternion_cj = s_jb.mx;
-            g_quaternion_ck = s_jb.my;
-        }
-        else
-        {
-            g_old_z.x = s_jb.jx;
-            g_old_z.y = s_jb.jy;
-            s_jb.jb_c.x = s_jb.mx;
-            s_jb.jb_c.y = s_jb.my;
-            g_quaternion_c = g_params[0];
-
-            g_quaternion_ci = g_params[1];
-            g_quaternion_cj = g_params[2];
-            g_quaternion_ck = g_params[3];
-        }
-        g_temp_sqr_x = sqr(g_old_z.x);
-        g_temp_sqr_y = sqr(g_old_z.y);
-
-        for (s_n = 0; s_n < g_max_iterations; s_n++)
+    JulibrotSample sample;
+    JulibrotSample step;
+    const DComplex &eye{pixel_eye(ctx, g_col, g_row)};
+    depth_ray(ctx, eye, x, y, sample, step);
+    s_z_pixel = march_depth(ctx, sample, step,
+        [&](const JulibrotSample &point)
         {
-            if (dispatch.orbit_calc()())
+            // Special initialization for Mandelbrot types
+            if (g_new_orbit_type == FractalType::QUAT || g_new_orbit_type == FractalType::HYPER_CMPLX)
             {
-                break;
+                g_old_z.x = 0.0;
+                g_old_z.y = 0.0;
+                s_jb.jb_c.x = 0.0;
+                s_jb.jb_c.y = 0.0;
+                g_quaternion_c = point.jx;
+                g_quaternion_ci = point.jy;
+                g_quaternion_cj = point.mx;
+                g_quaternion_ck = point.my;
             }
-        }
-        if (s_n == g_max_iterations)
-        {
-            if (g_julibrot_3d_mode == Julibrot3DMode::RED_BLUE)
+            else
             {
-                g_color = static_cast<int>(128L * s_z_pixel / g_julibrot_z_dots);
-                if (g_row + g_col & 1)
-                {
-                    g_plot(g_col, g_row, 127 - g_color);
-                }
-                else
-                {
-                    g_color = static_cast<int>(g_color * s_br_ratio);
-                    g_color = std::max(g_color, 1);
-                    g_color = std::min(g_color, 127);
-                    g_plot(g_col, g_row, 127 + s_b_base - g_color);
-                }
+                g_old_z.x = point.jx;
+                g_old_z.y = point.jy;
+                s_jb.jb_c.x = point.mx;
+                s_jb.jb_c.y = point.my;
+                g_quaternion_c = g_params[0];
+
+                g_quaternion_ci = g_params[1];
+                g_quaternion_cj = g_params[2];
+                g_quaternion_ck = g_params[3];
             }
-            else
+            g_temp_sqr_x = sqr(g_old_z.x);
+            g_temp_sqr_y = sqr(g_old_z.y);
+
+            for (s_n = 0; s_n < g_max_iterations; s_n++)
             {
-                g_color = static_cast<int>(254L * s_z_pixel / g_julibrot_z_dots);
-                g_plot(g_col, g_row, g_color + 1);
+                if (dispatch.orbit_calc()())
+                {
+                    break;
+                }
             }
-            s_plotted = 1;
-            break;
-        }
-        s_jb.mx += s_jb.delta_mx;
-        s_jb.my += s_jb.delta_my;
-        s_jb.jx += s_jb.delta_jx;
-        s_jb.jy += s_jb.delta_jy;
+            return s_n;
+        });
+    if (s_z_pixel < ctx.z_dots)
+    {
+        g_color = depth_color(ctx, s_z_pixel, &eye == &ctx.left_eye);
+        g_plot(g_col, g_row, g_color);
+        s_plotted = true;
     }
 }
 
+JulibrotContext julibrot_context()
+{
+    JulibrotContext ctx;
+    find_orbit(ctx.orbit);
+    if (const FnKernel *kernel = find_fn_kernel())
+    {
+        ctx.fn = kernel->fn;
+    }
+    ctx.mandel_start = g_new_orbit_type == FractalType::QUAT || g_new_orbit_type == FractalType::HYPER_CMPLX;
+    ctx.c = {g_params[0], g_params[1], g_params[2], g_params[3]};
+    ctx.max_iterations = g_max_iterations;
+    ctx.magnitude_limit = g_magnitude_limit;
+    ctx.mode = g_julibrot_3d_mode;
+    ctx.z_dots = g_julibrot_z_dots;
+    ctx.coarse_step = g_julibrot_coarse_step;
+    ctx.left_eye = {s_jb.left_eye.x, s_jb.left_eye.y};
+    ctx.right_eye = {s_jb.right_eye.x, s_jb.right_eye.y};
+    ctx.dist = g_julibrot_dist;
+    ctx.depth = g_julibrot_depth;
+    ctx.x_per_inch = s_jb.x_per_inch;
+    ctx.y_per_inch = s_jb.y_per_inch;
+    ctx.x_offset = s_jb.x_offset;
+    ctx.y_offset = s_jb.y_offset;
+    ctx.init_z = s_jb.init_z;
+    ctx.x_min = g_julibrot_x_min;
+    ctx.y_min = g_julibrot_y_min;
+    ctx.delta_mx = s_jb.delta_mx;
+    ctx.delta_my = s_jb.delta_my;
+    ctx.b_base = s_b_base;
+    ctx.br_ratio = s_br_ratio;
+    return ctx;
+}
+
+bool use_julibrot_lines()
+{
+    JulibrotOrbit orbit;
+    if (!find_orbit(orbit))
+    {
+        return false;
+    }
+    if (orbit == JulibrotOrbit::JULIA && g_bailout_test != Bailout::MOD)
+    {
+        return false;
+    }
+    return orbit != JulibrotOrbit::HYPER_COMPLEX || find_fn_kernel() != nullptr;
+}
+
+int julibrot_depth(const JulibrotContext &ctx, const double x, const double y, const DComplex &eye)
+{
+    JulibrotSample sample;
+    JulibrotSample step;
+    depth_ray(ctx, eye, x, y, sample, step);
+    switch (ctx.orbit)
+    {
+    case JulibrotOrbit::QUATERNION:
+        return march_depth(ctx, sample, step,
+            [&](const JulibrotSample &point) { return quaternion_iterations(ctx, point); });
+    case JulibrotOrbit::HYPER_COMPLEX:
+        return march_depth(ctx, sample, step,
+            [&](const JulibrotSample &point) { return hyper_complex_iterations(ctx, point); });
+    case JulibrotOrbit::JULIA:
+    default:
+        return march_depth(
+            ctx, sample, step, [&](const JulibrotSample &point) { return julia_iterations(ctx, point); });
+    }
+}
+
+int julibrot_pixel_color(const JulibrotContext &ctx, const double x, const double y, const int col, const int row)
+{
+    const DComplex &eye{pixel_eye(ctx, col, row)};
+    const int z_pixel{julibrot_depth(ctx, x, y, eye)};
+    return z_pixel < ctx.z_dots ? depth_color(ctx, z_pixel, &eye == &ctx.left_eye) : -1;
+}
+
 Standard4D::Standard4D()
 {
     g_c_exponent = static_cast<int>(g_params[2]);
@@ -299,6 +595,18 @@ Standard4D::Standard4D()
     m_x_dot = 0;
     s_plotted = false;
     m_x = -g_julibrot_width / 2.0;
+    m_ctx = julibrot_context();
+    m_use_lines = use_julibrot_lines();
+    if (m_use_lines)
+    {
+        m_cols.resize(g_logical_screen.x_dots);
+        double x{m_x};
+        for (double &col : m_cols)
+        {
+            col = x;
+            x += s_jb.inch_per_x_dot;
+        }
+    }
 }
 
 bool Standard4D::iterate()
@@ -307,13 +615,17 @@ bool Standard4D::iterate()
     {
         return false;
     }
+    if (m_use_lines)
+    {
+        return iterate_lines();
+    }
 
     g_col = m_x_dot;
     g_row = m_y_dot;
-    z_line(m_orbit_dispatch, m_x, m_y);
+    z_line(m_orbit_dispatch, m_ctx, m_x, m_y);
     g_col = g_logical_screen.x_dots - g_col - 1;
     g_row = g_logical_screen.y_dots - g_row - 1;
-    z_line(m_orbit_dispatch, -m_x, -m_y);
+    z_line(m_orbit_dispatch, m_ctx, -m_x, -m_y);
     ++m_x_dot;
     m_x += s_jb.inch_per_x_dot;
     if (m_x_dot == g_logical_screen.x_dots)
@@ -333,4 +645,63 @@ bool Standard4D::iterate()
     return true;
 }
 
+// Computes a band of scanlines and their mirror images on the tile
+// scheduler, a pair per task, then plots them in the order of the serial scan.
+bool Standard4D::iterate_lines()
+{
+    TileScheduler &scheduler{tile_scheduler()};
+    const int x_dots{g_logical_screen.x_dots};
+    const int y_dots{g_logical_screen.y_dots};
+    const int band{std::min(m_y_dot + 1, static_cast<int>(scheduler.num_workers()) * BAND_PAIRS)};
+    std::vector<double> rows(band);
+    double y{m_y};
+    for (double &row : rows)
+    {
+        row = y;
+        y -= s_jb.inch_per_y_dot;
+    }
+    m_colors.resize(static_cast<std::size_t>(band) * 2 * x_dots);
+
+    scheduler.run(band,
+        [&](const int pair, unsigned)
+        {
+            const int row{m_y_dot - pair};
+            int *colors{&m_colors[static_cast<std::size_t>(pair) * 2 * x_dots]};
+            for (int col = 0; col < x_dots; ++col)
+            {
+                colors[col] = julibrot_pixel_color(m_ctx, m_cols[col], rows[pair], col, row);
+                colors[x_dots + col] = julibrot_pixel_color(
+                    m_ctx, -m_cols[col], -rows[pair], x_dots - col - 1, y_dots - row - 1);
+            }
+        });
+
+    for (int pair = 0; pair < band; ++pair)
+    {
+        const int row{m_y_dot};
+        const int *colors{&m_colors[static_cast<std::size_t>(pair) * 2 * x_dots]};
+        bool plotted{};
+        for (int col = 0; col < x_dots; ++col)
+        {
+            if (colors[col] >= 0)
+            {
+                g_plot(col, row, colors[col]);
+                plotted = true;
+            }
+            if (const int color = colors[x_dots + col]; color >= 0)
+            {
+                g_plot(x_dots - col - 1, y_dots - row - 1, color);
+                plotted = true;
+            }
+        }
+        // the serial scan stops at the first empty scanline off the center
+        if (!plotted && m_y != 0.0)
+        {
+            return false;
+        }
+        --m_y_dot;
+        m_y -= s_jb.inch_per_y_dot;
+    }
+    return m_y_dot >= 0;
+}
+
 } // namespace id::fractals
@@ -22,6 +22,7 @@
 #include "fractals/fractalp.h"
 #include "fractals/fractype.h"
 #include "fractals/ifs.h"
+#include "fractals/ifs_walkers.h"
 #include "geometry/3d.h"
 #include "geometry/line3d.h"
 #include "geometry/plot3d.h"
@@ -41,6 +42,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
@@ -83,6 +85,9 @@ enum
     BAD_PIXEL = 10000L
 };
 
+// Points plotted by the IFS walkers between screen updates and key checks.
+constexpr long IFS_WALKER_ROUND{1L << 22};
+
 } // namespace
 
 static int ifs3d();
@@ -90,6 +95,8 @@ static void setup_matrix(Matrix double_mat);
 static bool float_view_transf3d(ViewTransform3D *inf);
 static std::FILE *open_orbit_save();
 static void plot_hist(int x, int y, int color);
+static IFSColorMethod ifs_color_method();
+static void run_ifs_walkers(IFSWalkers &walkers, bool &unbounded);
 
 static bool s_real_time{};
 static int s_t{};
@@ -1585,7 +1592,9 @@ done:
 
 IFS3D::IFS3D() :
     m_fp(open_orbit_save()),
-    m_color_method(g_params[0] == 0.0 ? IFSColorMethod::INCREMENT_PIXEL : IFSColorMethod::TRANSFORM_INDEX)
+    m_color_method(ifs_color_method()),
+    // the walkers need every point and a single view
+    m_use_walkers(m_color_method == IFSColorMethod::DENSITY && m_fp == nullptr && !s_real_time)
 {
     // setup affine screen coord conversion
     setup_convert_to_screen(&m_inf.cvt);
@@ -1622,6 +1631,27 @@ bool IFS3D::done() const
 
 void IFS3D::iterate()
 {
+    // the first points establish the view transform used by the walkers
+    if (m_use_walkers && g_color_iter >= s_waste)
+    {
+        if (!m_walkers)
+        {
+            IFSProjection projection;
+            projection.cvt = m_inf.cvt;
+            projection.three_d = true;
+            std::copy(&m_inf.double_mat[0][0], &m_inf.double_mat[0][0] + ROW_MAX * COL_MAX, &projection.view[0][0]);
+            projection.perspective = g_viewer_z != 0;
+            std::copy(std::begin(g_view), std::end(g_view), std::begin(projection.viewer));
+            projection.x_adjust = g_xx_adjust;
+            projection.y_adjust = g_yy_adjust;
+            projection.width = g_logical_screen.x_dots;
+            projection.height = g_logical_screen.y_dots;
+            m_walkers = std::make_unique<IFSWalkers>(IFSDimension::THREE, projection);
+        }
+        run_ifs_walkers(*m_walkers, m_unbounded);
+        return;
+    }
+
     ++g_color_iter;
     double r = random_unit(); // generate a random number between 0 and 1
 
@@ -1709,7 +1739,7 @@ void IFS3D::iterate()
 }
 
 IFS2D::IFS2D() :
-    m_color_method(g_params[0] == 0.0 ? IFSColorMethod::INCREMENT_PIXEL : IFSColorMethod::TRANSFORM_INDEX),
+    m_color_method(ifs_color_method()),
     m_fp(open_orbit_save())
 {
     // setup affine screen coord conversion
@@ -1717,6 +1747,15 @@ IFS2D::IFS2D() :
     set_random_seed();
     g_max_count = g_max_iterations > 0x1fffffL ? 0x7fffffffL : g_max_iterations * 1024L;
     g_color_iter = 0L;
+    // the walkers plot points out of order, so an orbit save needs a single orbit
+    if (m_color_method == IFSColorMethod::DENSITY && m_fp == nullptr)
+    {
+        IFSProjection projection;
+        projection.cvt = m_cvt;
+        projection.width = g_logical_screen.x_dots;
+        projection.height = g_logical_screen.y_dots;
+        m_walkers = std::make_unique<IFSWalkers>(IFSDimension::TWO, projection);
+    }
 }
 
 IFS2D::~IFS2D()
@@ -1735,6 +1774,12 @@ bool IFS2D::done() const
 
 void IFS2D::iterate()
 {
+    if (m_walkers)
+    {
+        run_ifs_walkers(*m_walkers, m_unbounded);
+        return;
+    }
+
     ++g_color_iter;
 
     const double r = random_unit(); // generate random number between 0 and 1
@@ -1783,6 +1828,24 @@ void IFS2D::iterate()
     }
 }
 
+// Parameter 1 selects the coloring; density falls back to incrementing
+// pixels when the walkers can't be used.
+static IFSColorMethod ifs_color_method()
+{
+    if (g_params[0] == 0.0)
+    {
+        return IFSColorMethod::INCREMENT_PIXEL;
+    }
+    return g_params[0] == 2.0 ? IFSColorMethod::DENSITY : IFSColorMethod::TRANSFORM_INDEX;
+}
+
+static void run_ifs_walkers(IFSWalkers &walkers, bool &unbounded)
+{
+    g_color_iter += walkers.run(std::min(IFS_WALKER_ROUND, g_max_count - g_color_iter + 1));
+    plot_ifs_density(walkers);
+    unbounded = walkers.diverged();
+}
+
 int ifs_type() // front-end for ifs2d and ifs3d
 {
     if (g_ifs_definition.empty() && ifs_load() < 0)
@@ -20,6 +20,7 @@
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
@@ -154,6 +155,7 @@ private:
     bool push_draw_frame(
         LSysCmd *command, LSysCmd **rules, int depth, bool restore_turtle, const LSysTurtleSnapshot &saved_turtle);
     void free_commands();
+    void start_expansion();
 
     int m_order;
     LSysTurtleState m_turtle{};
@@ -818,7 +820,7 @@ static LSysCmd *lsys_size_transform(const char *s, LSysTurtleState *ts)
     return doubled;
 }
 
-static bool lsys_find_scale(LSysCmd *command, LSysTurtleState *ts, LSysCmd **rules, const int depth)
+static void lsys_reset_size_turtle(LSysTurtleState *ts)
 {
     ts->aspect = g_screen_aspect*g_logical_screen.x_dots/g_logical_screen.y_dots;
     ts->y_min = 0;
@@ -832,16 +834,13 @@ static bool lsys_find_scale(LSysCmd *command, LSysTurtleState *ts, LSysCmd **rul
     ts->angle = 0;
     ts->real_angle = 0;
     ts->size = 1;
-    const LSysCmd *f_s_ret = find_size(command, ts, rules, depth);
-    thinking_end(); // erase thinking message if any
-    const LDouble x_min = ts->x_min;
-    const LDouble x_max = ts->x_max;
-    const LDouble y_min = ts->y_min;
-    const LDouble y_max = ts->y_max;
-    if (f_s_ret == nullptr)
-    {
-        return false;
-    }
+}
+
+// Sets the starting position and step size that fit the bounds of the
+// unit-size drawing on the screen.
+static void lsys_set_scale(
+    LSysTurtleState *ts, const LDouble x_min, const LDouble x_max, const LDouble y_min, const LDouble y_max)
+{
     float horiz;
     if (x_max == x_min)
     {
@@ -879,7 +878,18 @@ static bool lsys_find_scale(LSysCmd *command, LSysTurtleState *ts, LSysCmd **rul
         ts->y_pos = (g_logical_screen.y_dots-local_size*(y_max+y_min))/2;
     }
     ts->size = local_size;
+}
 
+static bool lsys_find_scale(LSysCmd *command, LSysTurtleState *ts, LSysCmd **rules, const int depth)
+{
+    lsys_reset_size_turtle(ts);
+    const LSysCmd *f_s_ret = find_size(command, ts, rules, depth);
+    thinking_end(); // erase thinking message if any
+    if (f_s_ret == nullptr)
+    {
+        return false;
+    }
+    lsys_set_scale(ts, ts->x_min, ts->x_max, ts->y_min, ts->y_max);
     return true;
 }
 
@@ -907,6 +917,209 @@ static void restore_turtle(LSysTurtleState &turtle, const LSysTurtleSnapshot &sn
     turtle.curr_color = snapshot.curr_color;
 }
 
+static bool lsys_moves(const LSysCmd *command)
+{
+    return command->f == lsys_draw_d || command->f == lsys_draw_f || command->f == lsys_draw_m ||
+        command->f == lsys_draw_g;
+}
+
+// Applies a command to the turtle, moving instead of drawing.
+static void lsys_step(const LSysCmd *command, LSysTurtleState &ts)
+{
+    switch (command->param_type)
+    {
+    case 4:
+        ts.param.n = command->param.n;
+        break;
+    case 10:
+        ts.param.nf = command->param.nf;
+        break;
+    default:
+        break;
+    }
+    if (command->f == lsys_draw_d)
+    {
+        lsys_draw_m(&ts);
+    }
+    else if (command->f == lsys_draw_f)
+    {
+        lsys_draw_g(&ts);
+    }
+    else
+    {
+        (*command->f)(&ts);
+    }
+}
+
+namespace
+{
+
+struct LSysBounds
+{
+    LDouble x_min{};
+    LDouble y_min{};
+    LDouble x_max{};
+    LDouble y_max{};
+
+    void add(const LDouble x, const LDouble y)
+    {
+        x_min = std::min(x, x_min);
+        y_min = std::min(y, y_min);
+        x_max = std::max(x, x_max);
+        y_max = std::max(y, y_max);
+    }
+};
+
+// The turtle after drawing a rule at unit step size from one starting
+// angle and direction, with the bounds of its path relative to the start.
+struct LSysExit
+{
+    LDouble dx;
+    LDouble dy;
+    LSysBounds bounds;
+    char angle;
+    char reverse;
+};
+
+struct LSysRuleSummary
+{
+    LDouble size{1};             // step size factor
+    std::vector<LSysExit> exits; // indexed by angle * 2 + reverse
+};
+
+} // namespace
+
+// Summarizes the drawing of every rule at every depth, so the bounds of the
+// image are found without walking the expansion.  Summaries are kept per
+// starting angle and direction, which covers every turtle only while turns
+// are whole steps of the angle.  The image is still drawn by walking the
+// expansion, so every line lands where the walk has always put it.
+class LSysExpansion
+{
+public:
+    LSysExpansion(LSysCmd **rules, int order, const LSysTurtleState &turtle);
+
+    static bool supported();
+
+    // Bounds of the drawing at unit step size.
+    LSysBounds bounds(const LSysCmd *axiom, int depth, const LSysTurtleState &turtle) const;
+
+private:
+    bool has_rules(const char ch) const
+    {
+        return !m_rules_for[static_cast<unsigned char>(ch)].empty();
+    }
+    // Moves the turtle past the drawing of the rules for ch at depth.
+    void skip(char ch, int depth, LSysTurtleState &ts, LSysBounds &bounds) const;
+    const LSysCmd *summarize(const LSysCmd *command, int depth, LSysTurtleState &ts, LSysBounds &bounds) const;
+
+    LSysCmd **m_rules;
+    std::array<std::vector<int>, 256> m_rules_for;
+    std::vector<std::vector<LSysRuleSummary>> m_summaries; // [depth][rule]
+};
+
+LSysExpansion::LSysExpansion(LSysCmd **rules, const int order, const LSysTurtleState &turtle) :
+    m_rules(rules)
+{
+    int num_rules{};
+    for (; m_rules[num_rules] != nullptr; ++num_rules)
+    {
+        m_rules_for[static_cast<unsigned char>(m_rules[num_rules]->ch)].push_back(num_rules);
+    }
+
+    for (int depth = 0; depth < order; ++depth)
+    {
+        std::vector<LSysRuleSummary> summaries(num_rules);
+        for (int rule = 0; rule < num_rules; ++rule)
+        {
+            LSysRuleSummary &summary{summaries[rule]};
+            const LSysCmd *body{m_rules[rule] + 1};
+            for (int angle = 0; angle < turtle.max_angle; ++angle)
+            {
+                for (char reverse = 0; reverse < 2; ++reverse)
+                {
+                    LSysTurtleState ts{turtle};
+                    ts.angle = static_cast<char>(angle);
+                    ts.reverse = reverse;
+                    ts.real_angle = 0;
+                    ts.size = 1;
+                    ts.x_pos = 0;
+                    ts.y_pos = 0;
+                    LSysBounds bounds;
+                    summarize(body, depth, ts, bounds);
+                    summary.exits.push_back({ts.x_pos, ts.y_pos, bounds, ts.angle, ts.reverse});
+                    summary.size = ts.size;
+                }
+            }
+        }
+        m_summaries.push_back(std::move(summaries));
+    }
+}
+
+bool LSysExpansion::supported()
+{
+    // turning by an arbitrary angle makes the bounds of a rule depend on
+    // the direction it starts in
+    const auto whole_steps = [](const std::string &text) { return text.find_first_of("/\\") == std::string::npos; };
+    return whole_steps(s_axiom) && std::all_of(s_rules.begin(), s_rules.end(), whole_steps);
+}
+
+LSysBounds LSysExpansion::bounds(const LSysCmd *axiom, const int depth, const LSysTurtleState &turtle) const
+{
+    LSysTurtleState ts{turtle};
+    LSysBounds bounds;
+    summarize(axiom, depth, ts, bounds);
+    return bounds;
+}
+
+void LSysExpansion::skip(const char ch, const int depth, LSysTurtleState &ts, LSysBounds &bounds) const
+{
+    for (const int rule : m_rules_for[static_cast<unsigned char>(ch)])
+    {
+        const LSysRuleSummary &summary{m_summaries[depth - 1][rule]};
+        const LSysExit &exit{summary.exits[ts.angle * 2 + (ts.reverse ? 1 : 0)]};
+        bounds.add(ts.x_pos + ts.size * exit.bounds.x_min, ts.y_pos + ts.size * exit.bounds.y_min);
+        bounds.add(ts.x_pos + ts.size * exit.bounds.x_max, ts.y_pos + ts.size * exit.bounds.y_max);
+        ts.x_pos += ts.size * exit.dx;
+        ts.y_pos += ts.size * exit.dy;
+        ts.size *= summary.size;
+        ts.angle = exit.angle;
+        ts.reverse = exit.reverse;
+    }
+}
+
+const LSysCmd *LSysExpansion::summarize(
+    const LSysCmd *command, const int depth, LSysTurtleState &ts, LSysBounds &bounds) const
+{
+    while (command->ch && command->ch != ']')
+    {
+        if (depth && has_rules(command->ch))
+        {
+            skip(command->ch, depth, ts, bounds);
+        }
+        else if (command->f)
+        {
+            lsys_step(command, ts);
+            if (lsys_moves(command))
+            {
+                bounds.add(ts.x_pos, ts.y_pos);
+            }
+        }
+        else if (command->ch == '[')
+        {
+            const LSysTurtleSnapshot saved{save_turtle(ts)};
+            command = summarize(command + 1, depth, ts, bounds);
+            restore_turtle(ts, saved);
+            if (!command->ch)
+            {
+                break;
+            }
+        }
+        command++;
+    }
+    return command;
+}
+
 LSystem::Impl::Impl() :
     m_order{std::max(static_cast<int>(g_params[0]), 0)}
 {
@@ -957,6 +1170,11 @@ void LSystem::suspend()
 
 void LSystem::Impl::start()
 {
+    if (LSysExpansion::supported())
+    {
+        start_expansion();
+        return;
+    }
     build_size_commands();
     lsys_build_trig_table();
     if (find_scale())
@@ -972,6 +1190,20 @@ void LSystem::Impl::start()
     }
 }
 
+// Finds the scale from rule summaries instead of walking the expansion an
+// extra time, then draws it with the usual walk.
+void LSystem::Impl::start_expansion()
+{
+    lsys_build_trig_table();
+    build_draw_commands();
+    lsys_reset_size_turtle(&m_turtle);
+    const LSysExpansion expansion{&m_rule_cmds[1], m_order, m_turtle};
+    const LSysBounds bounds{expansion.bounds(m_rule_cmds[0], m_order, m_turtle)};
+    lsys_set_scale(&m_turtle, bounds.x_min, bounds.x_max, bounds.y_min, bounds.y_max);
+    reset_turtle_for_drawing();
+    start_drawing();
+}
+
 bool LSystem::Impl::done() const
 {
     return m_done;
@@ -8,6 +8,7 @@
 #include "engine/log_map.h"
 #include "engine/pixel_grid.h"
 #include "engine/random_seed.h"
+#include "engine/simd_escape.h"
 #include "engine/StandardFractal.h"
 #include "engine/UserData.h"
 #include "engine/VideoInfo.h"
@@ -20,7 +21,9 @@
 #include "ui/stop_msg.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <iterator>
 #include <memory>
 
 using namespace id::engine;
@@ -38,6 +41,196 @@ static int s_lya_rxy[34]{};
 
 static int lyapunov_cycles(long filter_cycles, double a, double b);
 
+// Maps the product of the population derivatives over the measured rounds
+// of the sequence, scaled by e^ln_adjust, to a color; 0 when the orbit
+// overflowed or the exponent is positive.
+static int lyapunov_exponent_color(const bool overflow, const double total, const int ln_adjust, const long rounds,
+    const int length, const bool log_map, const int colors)
+{
+    double temp;
+    if (overflow || total <= 0 || (temp = std::log(total) + ln_adjust) > 0)
+    {
+        return 0;
+    }
+    double lyap;
+    if (log_map)
+    {
+        lyap = -temp / (static_cast<double>(length) * rounds);
+    }
+    else
+    {
+        lyap = 1 - std::exp(temp / (static_cast<double>(length) * rounds));
+    }
+    return 1 + static_cast<int>(lyap * (colors - 1));
+}
+
+static int lyapunov_pixel_color(const LyapunovContext &ctx, const int color)
+{
+    if (ctx.inside_method > ColorMethod::COLOR && color == 0)
+    {
+        return ctx.inside_color;
+    }
+    if (color >= ctx.colors)
+    {
+        return ctx.colors - 1;
+    }
+    return color;
+}
+
+namespace
+{
+
+constexpr int LANES{LYAPUNOV_LANES};
+constexpr double E10{22026.4657948};
+constexpr double E_MINUS10{0.0000453999297625};
+
+template <typename T>
+using LaneArray = std::array<T, LANES>;
+
+// Computes the pixels of a row LYAPUNOV_LANES at a time, a round of the
+// sequence for all lanes together.  Every lane runs the same sequence, so
+// the rate selection and the population update vectorize; a lane whose
+// pixel overflowed or finished its rounds is retired at the end of a
+// round and refilled with the next pixel.
+class LyapunovRow
+{
+public:
+    LyapunovRow(const LyapunovContext &ctx, const PixelGrid &grid, int row, int first_col, int last_col, int *colors);
+
+    void run();
+
+private:
+    void load(int lane);
+    void retire(int lane);
+
+    const LyapunovContext &m_ctx;
+    const PixelGrid &m_grid;
+    const int m_row;
+    const int m_first_col;
+    const int m_count;
+    int *const m_colors;
+    const long m_rounds{m_ctx.filter_cycles + m_ctx.max_iterations / 2};
+
+    int m_next_pixel{};
+    int m_active{};
+
+    alignas(64) LaneArray<double> m_a{};
+    alignas(64) LaneArray<double> m_b{};
+    alignas(64) LaneArray<double> m_population{};
+    alignas(64) LaneArray<double> m_total{};
+    alignas(64) LaneArray<long> m_overflow{};
+    LaneArray<long> m_round{};
+    LaneArray<int> m_ln_adjust{};
+    LaneArray<int> m_pixel{};
+};
+
+LyapunovRow::LyapunovRow(const LyapunovContext &ctx, const PixelGrid &grid, const int row, const int first_col,
+    const int last_col, int *colors) :
+    m_ctx(ctx),
+    m_grid(grid),
+    m_row(row),
+    m_first_col(first_col),
+    m_count(last_col - first_col + 1),
+    m_colors(colors)
+{
+}
+
+void LyapunovRow::load(const int lane)
+{
+    m_population[lane] = m_ctx.population;
+    m_total[lane] = 1.0;
+    m_overflow[lane] = 0;
+    m_round[lane] = 0;
+    m_ln_adjust[lane] = 0;
+    if (m_next_pixel >= m_count)
+    {
+        // idle lane: iterates harmlessly at the origin and never finishes
+        m_pixel[lane] = -1;
+        m_a[lane] = 0.0;
+        m_b[lane] = 0.0;
+        m_population[lane] = 0.0;
+        return;
+    }
+
+    const int pixel{m_next_pixel++};
+    const int col{m_first_col + pixel};
+    m_a[lane] = m_grid.dy(col, m_row);
+    m_b[lane] = m_grid.dx(col, m_row);
+    m_pixel[lane] = pixel;
+    ++m_active;
+    if (m_rounds <= 0)
+    {
+        retire(lane);
+    }
+}
+
+void LyapunovRow::retire(const int lane)
+{
+    const long measured{std::max(0L, m_round[lane] - m_ctx.filter_cycles)};
+    const int color{lyapunov_exponent_color(m_overflow[lane] != 0, m_total[lane], m_ln_adjust[lane], measured,
+        m_ctx.sequence.length, m_ctx.log_map, m_ctx.colors)};
+    m_colors[m_pixel[lane]] = lyapunov_pixel_color(m_ctx, color);
+    --m_active;
+    load(lane);
+}
+
+void LyapunovRow::run()
+{
+    for (int lane = 0; lane < LANES; ++lane)
+    {
+        load(lane);
+    }
+
+    while (m_active > 0)
+    {
+        for (int count = 0; count < m_ctx.sequence.length; ++count)
+        {
+            const bool use_a{m_ctx.sequence.rxy[count] != 0};
+            for (int lane = 0; lane < LANES; ++lane)
+            {
+                const double rate{use_a ? m_a[lane] : m_b[lane]};
+                const double population{rate * m_population[lane] * (1 - m_population[lane])};
+                const bool measuring{m_round[lane] >= m_ctx.filter_cycles};
+                const double temp{std::abs(rate - 2.0 * rate * population)};
+                const double total{measuring ? m_total[lane] * temp : m_total[lane]};
+                const bool overflow{m_overflow[lane] != 0 || population_exceeded(population) ||
+                    (measuring && total == 0)};
+                // an overflowed lane stops at the origin; its pixel is colored 0
+                m_population[lane] = overflow ? 0.0 : population;
+                m_total[lane] = overflow ? m_total[lane] : total;
+                m_overflow[lane] = overflow ? 1 : 0;
+            }
+        }
+
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            if (m_pixel[lane] < 0)
+            {
+                continue;
+            }
+            if (m_overflow[lane] == 0 && m_round[lane] >= m_ctx.filter_cycles)
+            {
+                while (m_total[lane] > E10)
+                {
+                    m_total[lane] *= E_MINUS10;
+                    m_ln_adjust[lane] += 10;
+                }
+                while (m_total[lane] < E_MINUS10)
+                {
+                    m_total[lane] *= E10;
+                    m_ln_adjust[lane] -= 10;
+                }
+            }
+            if (m_overflow[lane] != 0 || ++m_round[lane] >= m_rounds)
+            {
+                retire(lane);
+            }
+        }
+    }
+}
+
+} // namespace
+
 // per-pixel calculation for "lyapunov"
 int lyapunov_type()
 {
@@ -213,7 +406,6 @@ bool lyapunov_per_image()
 
 static int lyapunov_cycles(const long filter_cycles, const double a, const double b)
 {
-    int color;
     double temp;
     // e10=22026.4657948  e-10=0.0000453999297625
 
@@ -263,24 +455,110 @@ static int lyapunov_cycles(const long filter_cycles, const double a, const doubl
     }
 
 jump_out:
-    if (g_overflow || total <= 0 || (temp = std::log(total) + ln_adjust) > 0)
+    return lyapunov_exponent_color(g_overflow, total, ln_adjust, i, s_lya_length, g_log_map_flag != 0, g_colors);
+}
+
+LyapunovContext lyapunov_context()
+{
+    LyapunovContext ctx;
+    ctx.sequence.length = s_lya_length;
+    std::copy(std::begin(s_lya_rxy), std::end(s_lya_rxy), ctx.sequence.rxy.begin());
+    ctx.filter_cycles = static_cast<long>(s_filter_cycles);
+    ctx.max_iterations = g_max_iterations;
+    ctx.population = g_params[1];
+    ctx.log_map = g_log_map_flag != 0;
+    ctx.colors = g_colors;
+    ctx.inside_method = g_inside_method;
+    ctx.inside_color = g_inside_color;
+    return ctx;
+}
+
+bool use_lyapunov_rows()
+{
+    if (g_dispatch.calc_type() != lyapunov_type || g_dispatch.orbit_calc() != lyapunov_orbit)
     {
-        color = 0;
+        return false;
     }
-    else
+    // with a random population seed each pixel's population depends on the
+    // pixels before it
+    return g_std_calc_mode == CalcMode::ONE_PASS && g_params[1] != 0 && g_params[1] != 1 && g_inversion.invert == 0;
+}
+
+int lyapunov_color(const LyapunovContext &ctx, const double a, const double b)
+{
+    double population{ctx.population};
+    double total{1.0};
+    int ln_adjust{};
+    bool overflow{};
+    long i;
+    for (i = 0; i < ctx.filter_cycles && !overflow; i++)
+    {
+        for (int count = 0; count < ctx.sequence.length; count++)
+        {
+            const double rate{ctx.sequence.rxy[count] ? a : b};
+            population = rate * population * (1 - population);
+            if (population_exceeded(population))
+            {
+                overflow = true;
+                break;
+            }
+        }
+    }
+    for (i = 0; i < ctx.max_iterations / 2 && !overflow; i++)
     {
-        double lyap;
-        if (g_log_map_flag)
+        for (int count = 0; count < ctx.sequence.length; count++)
+        {
+            const double rate{ctx.sequence.rxy[count] ? a : b};
+            population = rate * population * (1 - population);
+            if (population_exceeded(population))
+            {
+                overflow = true;
+                break;
+            }
+            total *= std::abs(rate - 2.0 * rate * population);
+            if (total == 0)
+            {
+                overflow = true;
+                break;
+            }
+        }
+        if (overflow)
+        {
+            break;
+        }
+        while (total > E10)
         {
-            lyap = -temp / (static_cast<double>(s_lya_length) * i);
+            total *= E_MINUS10;
+            ln_adjust += 10;
         }
-        else
+        while (total < E_MINUS10)
         {
-            lyap = 1 - std::exp(temp / (static_cast<double>(s_lya_length) * i));
+            total *= E10;
+            ln_adjust -= 10;
         }
-        color = 1 + static_cast<int>(lyap * (g_colors - 1));
     }
-    return color;
+    const int color{
+        lyapunov_exponent_color(overflow, total, ln_adjust, i, ctx.sequence.length, ctx.log_map, ctx.colors)};
+    return lyapunov_pixel_color(ctx, color);
+}
+
+void lyapunov_row(const LyapunovContext &ctx, const PixelGrid &grid, const int row, const int first_col,
+    const int last_col, int *colors)
+{
+    if (last_col < first_col)
+    {
+        return;
+    }
+    if (g_simd_mode == SimdMode::OFF)
+    {
+        for (int col = first_col; col <= last_col; ++col)
+        {
+            colors[col - first_col] = lyapunov_color(ctx, grid.dy(col, row), grid.dx(col, row));
+        }
+        return;
+    }
+    LyapunovRow kernel{ctx, grid, row, first_col, last_col, colors};
+    kernel.run();
 }
 
 int lyapunov_orbit()
@@ -23,6 +23,7 @@
 #include "engine/LogicalScreen.h"
 #include "engine/pixel_grid.h"
 #include "fractals/formula.h"
+#include "fractals/FormulaVM.h"
 #include "fractals/fractalp.h"
 #include "fractals/interpreter.h"
 #include "fractals/newton.h"
@@ -2506,6 +2507,7 @@ static void parser_allocate()
 
 void free_work_area()
 {
+    g_formula_vm.clear();
     g_formula.store.clear();
     g_formula.load.clear();
     g_formula.vars.clear();
@@ -3419,6 +3421,8 @@ bool parse_formula(const FormulaEntry &formula_entry, const bool report_bad_sym)
         stop_msg(parse_error_text(ParseError::ERROR_IN_PARSING_JUMP_STATEMENTS));
         return false;
     }
+    // formulas the register form can't express run on the interpreter
+    g_formula_vm.compile(g_formula);
 
     return true;
 }
@@ -118,39 +118,48 @@ void mandel_z_power_ref_pt_bf(const BFComplex &center, BFComplex &z)
     }
 }
 
+// z^3 + c; shared by the double and extended exponent deltas, T is the delta component type.
+template <typename T>
+static void mandel_cube_perturb(const std::complex<double> &ref, T &delta_real, T &delta_imag, const T &a0, const T &b0)
+{
+    const double r{ref.real()};
+    const double i{ref.imag()};
+    const T a{delta_real};
+    const T b{delta_imag};
+    const T dnr{            //
+        3 * r * r * a       //
+        - 6 * r * i * b     //
+        - 3 * i * i * a     //
+        + 3 * r * a * a     //
+        - 3 * r * b * b     //
+        - 3 * i * 2 * a * b //
+        + a * a * a         //
+        - 3 * a * b * b     //
+        + a0};
+    const T dni{            //
+        3 * r * r * b       //
+        + 6 * r * i * a     //
+        - 3 * i * i * b     //
+        + 3 * r * 2 * a * b //
+        + 3 * i * a * a     //
+        - 3 * i * b * b     //
+        + 3 * a * a * b     //
+        - b * b * b         //
+        + b0};
+    delta_imag = dni;
+    delta_real = dnr;
+}
+
 void mandel_z_power_perturb(
     const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0)
 {
     if (g_c_exponent == 3)
     {
-        const double r{ref.real()};
-        const double i{ref.imag()};
-        const double a{delta_n.real()};
-        const double b{delta_n.imag()};
-        const double a0{delta0.real()};
-        const double b0{delta0.imag()};
-        const double dnr{       //
-            3 * r * r * a       //
-            - 6 * r * i * b     //
-            - 3 * i * i * a     //
-            + 3 * r * a * a     //
-            - 3 * r * b * b     //
-            - 3 * i * 2 * a * b //
-            + a * a * a         //
-            - 3 * a * b * b     //
-            + a0};
-        const double dni{       //
-            3 * r * r * b       //
-            + 6 * r * i * a     //
-            - 3 * i * i * b     //
-            + 3 * r * 2 * a * b //
-            + 3 * i * a * a     //
-            - 3 * i * b * b     //
-            + 3 * a * a * b     //
-            - b * b * b         //
-            + b0};
-        delta_n.imag(dni);
-        delta_n.real(dnr);
+        double real{delta_n.real()};
+        double imag{delta_n.imag()};
+        mandel_cube_perturb(ref, real, imag, delta0.real(), delta0.imag());
+        delta_n.imag(imag);
+        delta_n.real(real);
     }
     else
     {
@@ -167,6 +176,27 @@ void mandel_z_power_perturb(
     }
 }
 
+void mandel_z_power_perturb_fe(
+    const std::complex<double> &ref, FloatExpComplex &delta_n, const FloatExpComplex &delta0)
+{
+    if (g_c_exponent == 3)
+    {
+        mandel_cube_perturb(ref, delta_n.x, delta_n.y, delta0.x, delta0.y);
+    }
+    else
+    {
+        std::complex<double> zp(1.0, 0.0);
+        FloatExpComplex sum{};
+        for (int j = 0; j < g_c_exponent; j++)
+        {
+            sum += FloatExpComplex{zp.real(), zp.imag()} * static_cast<double>(s_pascal_triangle[j]);
+            sum = sum * delta_n;
+            zp *= ref;
+        }
+        delta_n = sum + delta0;
+    }
+}
+
 int mandel_z_to_z_plus_z_pwr_orbit()
 {
     pow(&g_old_z, static_cast<int>(g_params[2]), &g_new_z);
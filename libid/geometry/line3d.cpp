@@ -9,11 +9,12 @@
 
 #include "engine/calcfrac.h"
 #include "engine/LogicalScreen.h"
-#include "engine/pixel_limits.h"
 #include "engine/Potential.h"
 #include "engine/random_seed.h"
 #include "engine/spindac.h"
+#include "engine/TileScheduler.h"
 #include "engine/VideoInfo.h"
+#include "geometry/mesh_writer.h"
 #include "geometry/plot3d.h"
 #include "io/check_write_file.h"
 #include "io/gifview.h"
@@ -60,6 +61,25 @@ struct PointColorT
 using PointColor = PointColorT<int>;
 using FPointColor = PointColorT<float>;
 
+// A source pixel moved to the screen by the non-sphere transform.
+struct RowPoint
+{
+    PointColor cur;     // only x and y are used
+    FPointColor f_cur;  // transformed point for light source fills and ray tracing
+};
+
+// Fewest columns transformed by each tile scheduler task.  A column takes
+// about 13 ns, while handing a run to the workers costs several us, so only
+// rows of many thousands of transformed columns are split.
+constexpr int TRANSFORM_MIN_COLUMNS{4096};
+
+// Where a triangle corner is in the height field, for meshes with shared vertices.
+struct GridPoint
+{
+    bool previous_row;
+    int col;
+};
+
 struct MinMax
 {
     int min_x;
@@ -86,7 +106,9 @@ static bool set_pixel_buff(Byte *pixels, Byte *fraction, unsigned line_len);
 static void set_upr_lwr();
 static int end_object(bool tri_out);
 static int off_screen(PointColor pt);
-static int out_triangle(FPointColor pt1, FPointColor pt2, FPointColor pt3, int c1, int c2, int c3);
+static bool mesh_output();
+static int out_triangle(FPointColor pt1, FPointColor pt2, FPointColor pt3, int c1, int c2, int c3,
+    const GridPoint (&grid)[3]);
 static int ray_header();
 static int start_object();
 static void draw_light_box(const double *origin, const double *direct, Matrix light_m);
@@ -97,6 +119,8 @@ static void interp_color(int x, int y, int color);
 static void put_triangle(PointColor pt1, PointColor pt2, PointColor pt3, int color);
 static void put_min_max(int x, int y, int color);
 static void triangle_bounds(float pt_t[3][3]);
+static bool skip_column(int col, int last_dot);
+static void transform_row(const Byte *pixels, int line_len, int last_dot);
 static void transparent_clip_color(int x, int y, int color);
 static void vec_draw_line(const double *v1, const double *v2, int color);
 static void file_error(const std::string &filename, FileError error);
@@ -123,6 +147,7 @@ static float s_min_xyz[3]{}, s_max_xyz[3]{};             // For Raytrace output
 static int s_line_length1{};                             //
 static int s_targa_header_24 = 18;                       // Size of current Targa-24 header
 static std::FILE *s_raytrace_file{};                     //
+static MeshWriter s_mesh;                                // PLY and STL output
 static std::filesystem::path s_raytrace_path;            //
 static unsigned int s_i_ambient{};                       //
 static int s_rand_factor{};                              //
@@ -157,6 +182,8 @@ static std::vector<MinMax> s_min_max_x;          // array of min and max x value
 static Vector s_cross{};                         //
 static Vector s_tmp_cross{};                     //
 static PointColor s_old_last{};                  // old pixels
+static std::vector<RowPoint> s_row_points;       // transformed points of the current row
+static std::vector<int> s_row_columns;           // columns of the current row line3d() reads
 
 // global variables defined here
 void (*g_standard_plot)(int, int, int){};
@@ -207,6 +234,7 @@ int line3d(Byte * pixels, unsigned line_len)
     VectorL lv;                  // long equivalent of v
     VectorL lv0;                 // long equivalent of v
     int last_dot;
+    int old_col{};               // column of old
     long fudge;
 
     fudge = 1L << 16;
@@ -241,10 +269,6 @@ int line3d(Byte * pixels, unsigned line_len)
         {
             return err;
         }
-        if (g_logical_screen.x_dots > OLD_MAX_PIXELS)
-        {
-            return -1;
-        }
         cross_avg[0] = 0;
         cross_avg[1] = 0;
         cross_avg[2] = 0;
@@ -336,14 +360,21 @@ int line3d(Byte * pixels, unsigned line_len)
     {
         start_object();
     }
+    if (!g_sphere)
+    {
+        transform_row(pixels, static_cast<int>(line_len), last_dot);
+
+        // the waterline is the same height everywhere
+        v[0] = 0;
+        v[1] = 0;
+        v[2] = g_water_line;
+        vec_g_mat_mul(v);
+        f_water = static_cast<float>(v[2]);
+    }
     // PROCESS ROW LOOP BEGINS HERE
     while (col < static_cast<int>(line_len))
     {
-        if ((g_raytrace_format != RayTraceFormat::NONE || g_preview || g_fill_type < FillType::POINTS)
-            && col != last_dot             // if this is not the last col
-                                            // if not the 1st or mod factor col
-            && col % static_cast<int>(s_aspect * s_local_preview_factor)
-            && !(g_raytrace_format == RayTraceFormat::NONE && g_fill_type > FillType::SOLID_FILL && col == 1))
+        if (skip_column(col, last_dot))
         {
             goto loop_bottom;
         }
@@ -465,42 +496,15 @@ int line3d(Byte * pixels, unsigned line_len)
                 v[2] = 0;               // TODO: Why do we do this?
             }
         }
-        else                            // non-sphere 3D
+        else                            // non-sphere 3D, transformed by transform_row()
         {
-            // do in float if integer math overflowed or doing Ray trace
-            // slow float version for comparison
-            v[0] = col;
-            v[1] = g_current_row;
-            v[2] = f_cur.color; // Actually the z value
-
-            vec_g_mat_mul(v);   // matrix*vector routine
-
+            const RowPoint &point{s_row_points[col]};
             if (g_fill_type > FillType::SOLID_FILL || g_raytrace_format != RayTraceFormat::NONE)
             {
-                f_cur.x = static_cast<float>(v[0]);
-                f_cur.y = static_cast<float>(v[1]);
-                f_cur.color = static_cast<float>(v[2]);
-
-                if (g_raytrace_format == RayTraceFormat::ACROSPIN)
-                {
-                    f_cur.x = f_cur.x * (2.0F / g_logical_screen.x_dots) - 1.0F;
-                    f_cur.y = f_cur.y * (2.0F / g_logical_screen.y_dots) - 1.0F;
-                    f_cur.color = -f_cur.color * (2.0F / g_num_colors) - 1.0F;
-                }
+                f_cur = point.f_cur;
             }
-
-            if (s_persp && g_raytrace_format == RayTraceFormat::NONE)
-            {
-                perspective(v);
-            }
-            cur.x = static_cast<int>(std::lround(v[0] + g_xx_adjust));
-            cur.y = static_cast<int>(std::lround(v[1] + g_yy_adjust));
-
-            v[0] = 0;
-            v[1] = 0;
-            v[2] = g_water_line;
-            vec_g_mat_mul(v);
-            f_water = static_cast<float>(v[2]);
+            cur.x = point.cur.x;
+            cur.y = point.cur.y;
         }
 
         if (g_randomize_3d != 0)
@@ -553,7 +557,8 @@ int line3d(Byte * pixels, unsigned line_len)
                 if (g_raytrace_format != RayTraceFormat::ACROSPIN)      // Output the vertex info
                 {
                     out_triangle(f_cur, f_old, s_f_last_row[col],
-                                 cur.color, old.color, s_last_row[col].color);
+                                 cur.color, old.color, s_last_row[col].color,
+                                 {{false, col}, {false, old_col}, {true, col}});
                 }
 
                 tout = true;
@@ -588,7 +593,8 @@ int line3d(Byte * pixels, unsigned line_len)
                 if (g_raytrace_format != RayTraceFormat::ACROSPIN)      // Output the vertex info
                 {
                     out_triangle(f_cur, s_f_last_row[col], s_f_last_row[next],
-                                 cur.color, s_last_row[col].color, s_last_row[next].color);
+                                 cur.color, s_last_row[col].color, s_last_row[next].color,
+                                 {{false, col}, {true, col}, {true, next}});
                 }
 
                 tout = true;
@@ -842,6 +848,7 @@ loop_bottom:
             s_old_last = s_last_row[col];
             s_last_row[col] = cur;
             old = s_last_row[col];
+            old_col = col;
 
             // for illumination model purposes
             s_f_last_row[col] = f_cur;
@@ -851,7 +858,7 @@ loop_bottom:
             {
                 end_object(tout);
                 tout = false;
-                if (std::ferror(s_raytrace_file))
+                if (s_raytrace_file != nullptr && std::ferror(s_raytrace_file))
                 {
                     std::fclose(s_raytrace_file);
                     s_raytrace_file = nullptr;
@@ -1104,6 +1111,95 @@ static void draw_rect(Vector v0, Vector v1, Vector v2, Vector v3, const int colo
     }
 }
 
+// True for the columns preview, ray tracing and surface fills pass over:
+// all but the first, the last and every s_aspect * s_local_preview_factor'th
+static bool skip_column(const int col, const int last_dot)
+{
+    return (g_raytrace_format != RayTraceFormat::NONE || g_preview || g_fill_type < FillType::POINTS)
+        && col != last_dot             // if this is not the last col
+                                        // if not the 1st or mod factor col
+        && col % static_cast<int>(s_aspect * s_local_preview_factor)
+        && !(g_raytrace_format == RayTraceFormat::NONE && g_fill_type > FillType::SOLID_FILL && col == 1);
+}
+
+// Transforms the columns of the current row of a non-sphere image that
+// line3d() reads.  The transform only reads the matrix and view set up by
+// first_time(), so a row with enough columns is split into runs on the tile
+// scheduler; the fills and triangles that use the points are still drawn in
+// column order by line3d().  Each row arrives from the decoder on its own,
+// so runs can't span rows.
+static void transform_row(const Byte *pixels, const int line_len, const int last_dot)
+{
+    const int width{std::min(line_len, static_cast<int>(s_row_points.size()))};
+    s_row_columns.clear();
+    for (int col = 0; col < width; ++col)
+    {
+        if (!skip_column(col, last_dot))
+        {
+            s_row_columns.push_back(col);
+        }
+    }
+
+    const bool float_point{g_fill_type > FillType::SOLID_FILL || g_raytrace_format != RayTraceFormat::NONE};
+    auto transform = [&](const int begin, const int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            const int col{s_row_columns[i]};
+            // the same height line3d() gives the pixel
+            const int color{pixels[col]};
+            float z{static_cast<float>(color)};
+            if (color > 0 && color < g_water_line)
+            {
+                z = static_cast<float>(static_cast<Byte>(g_water_line)); // "lake"
+            }
+            else if (g_potential.store_16bit)
+            {
+                z += static_cast<float>(s_fraction[col]) / static_cast<float>(1 << 8);
+            }
+
+            Vector v{static_cast<double>(col), static_cast<double>(g_current_row), z};
+            vec_g_mat_mul(v); // matrix*vector routine
+
+            RowPoint &point{s_row_points[col]};
+            if (float_point)
+            {
+                point.f_cur.x = static_cast<float>(v[0]);
+                point.f_cur.y = static_cast<float>(v[1]);
+                point.f_cur.color = static_cast<float>(v[2]);
+
+                if (g_raytrace_format == RayTraceFormat::ACROSPIN)
+                {
+                    point.f_cur.x = point.f_cur.x * (2.0F / g_logical_screen.x_dots) - 1.0F;
+                    point.f_cur.y = point.f_cur.y * (2.0F / g_logical_screen.y_dots) - 1.0F;
+                    point.f_cur.color = -point.f_cur.color * (2.0F / g_num_colors) - 1.0F;
+                }
+            }
+
+            if (s_persp && g_raytrace_format == RayTraceFormat::NONE)
+            {
+                perspective(v);
+            }
+            point.cur.x = static_cast<int>(std::lround(v[0] + g_xx_adjust));
+            point.cur.y = static_cast<int>(std::lround(v[1] + g_yy_adjust));
+        }
+    };
+
+    const int num_columns{static_cast<int>(s_row_columns.size())};
+    const int num_runs{std::min(
+        static_cast<int>(tile_scheduler().num_workers()), num_columns / TRANSFORM_MIN_COLUMNS)};
+    if (num_runs <= 1)
+    {
+        transform(0, num_columns);
+        return;
+    }
+    tile_scheduler().run(num_runs,
+        [&](const int run, unsigned)
+        {
+            transform(num_columns * run / num_runs, num_columns * (run + 1) / num_runs);
+        });
+}
+
 // replacement for plot - builds a table of min and max x's instead of plot
 // called by draw_line as part of triangle fill routine
 static void put_min_max(const int x, const int y, const int /*color*/)
@@ -1896,6 +1992,16 @@ static int ray_header()
     {
         return -1;              // Oops, something's wrong!
     }
+    if (mesh_output())
+    {
+        // binary meshes have no text header; the writer builds theirs
+        return s_mesh.open(s_raytrace_path,
+                   g_raytrace_format == RayTraceFormat::PLY ? MeshFormat::PLY : MeshFormat::STL,
+                   g_logical_screen.x_dots, !g_brief,
+                   fmt::format("Created by " ID_PROGRAM_NAME " Ver. {:s}", to_string(current_id_version())))
+            ? 0
+            : -1;
+    }
     s_raytrace_file = std::fopen(s_raytrace_path.string().c_str(), "w");
     if (s_raytrace_file == nullptr)
     {
@@ -1993,8 +2099,13 @@ static int ray_header()
 //
 //******************************************************************
 
+static bool mesh_output()
+{
+    return g_raytrace_format == RayTraceFormat::PLY || g_raytrace_format == RayTraceFormat::STL;
+}
+
 static int out_triangle(const FPointColor pt1, const FPointColor pt2, const FPointColor pt3, //
-    const int c1, const int c2, const int c3)
+    const int c1, const int c2, const int c3, const GridPoint (&grid)[3])
 {
     float c[3];
     float pt_t[3][3];
@@ -2027,6 +2138,22 @@ static int out_triangle(const FPointColor pt1, const FPointColor pt2, const FPoi
         return 0;
     }
 
+    if (mesh_output())
+    {
+        // vertices keep their own colors; points shared with other triangles are written once
+        const int colors[3]{c1, c2, c3};
+        MeshCorner corners[3];
+        for (int i = 0; i < 3; i++)
+        {
+            const int color = std::clamp(colors[i], 0, 255);
+            corners[i] = MeshCorner{grid[i].previous_row, grid[i].col,
+                {{pt_t[i][0], pt_t[i][1], pt_t[i][2]},
+                    {g_dac_box[color][0], g_dac_box[color][1], g_dac_box[color][2]}}};
+        }
+        s_mesh.triangle(corners[0], corners[1], corners[2]);
+        return 0;
+    }
+
     // Describe the triangle
     if (g_raytrace_format == RayTraceFormat::DKB_POVRAY)
     {
@@ -2210,6 +2337,11 @@ static void triangle_bounds(float pt_t[3][3])
 
 static int start_object()
 {
+    if (mesh_output())
+    {
+        s_mesh.next_row();
+        return 0;
+    }
     if (g_raytrace_format != RayTraceFormat::DKB_POVRAY)
     {
         return 0;
@@ -2238,7 +2370,7 @@ static int start_object()
 
 static int end_object(const bool tri_out)
 {
-    if (g_raytrace_format == RayTraceFormat::DXF)
+    if (g_raytrace_format == RayTraceFormat::DXF || mesh_output())
     {
         return 0;
     }
@@ -2295,6 +2427,10 @@ static int end_object(const bool tri_out)
 
 static void line3d_cleanup()
 {
+    if (mesh_output() && !s_mesh.close())
+    {
+        file_error(g_raytrace_filename, FileError::DISK_FULL);
+    }
     if (g_raytrace_format != RayTraceFormat::NONE && s_raytrace_file)
     {
         // Finish up the ray tracing files
@@ -2856,6 +2992,10 @@ static int line3d_mem()
         s_sin_theta_array.resize(g_logical_screen.x_dots);
         s_cos_theta_array.resize(g_logical_screen.x_dots);
     }
+    else
+    {
+        s_row_points.resize(g_logical_screen.x_dots);
+    }
     s_f_last_row.resize(g_logical_screen.x_dots);
     if (g_potential.store_16bit)
     {
@@ -2863,11 +3003,11 @@ static int line3d_mem()
     }
     s_min_max_x.clear();
 
-    // these fill types call putatriangle which uses minmax_x
+    // these fill types call putatriangle which uses minmax_x, a row at a time
     if (g_fill_type == FillType::SURFACE_INTERPOLATED || g_fill_type == FillType::SURFACE_CONSTANT ||
         g_fill_type == FillType::LIGHT_SOURCE_BEFORE || g_fill_type == FillType::LIGHT_SOURCE_AFTER)
     {
-        s_min_max_x.resize(OLD_MAX_PIXELS);
+        s_min_max_x.resize(g_logical_screen.y_dots);
     }
 
     return 0;
@@ -0,0 +1,287 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "geometry/mesh_writer.h"
+
+#include <boost/endian/buffers.hpp>
+#include <boost/endian/conversion.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace id::geometry
+{
+
+namespace
+{
+
+// Width of the zero padded element counts in a PLY header, enough for any uint32.
+constexpr int PLY_COUNT_WIDTH{10};
+
+constexpr std::size_t STL_HEADER_SIZE{80};
+
+} // namespace
+
+BufferedWriter::BufferedWriter(const std::size_t size) :
+    m_buffer(size)
+{
+}
+
+void BufferedWriter::attach(std::FILE *file)
+{
+    m_file = file;
+    m_used = 0;
+    m_failed = false;
+}
+
+void BufferedWriter::write(const void *data, std::size_t size)
+{
+    const Byte *bytes{static_cast<const Byte *>(data)};
+    while (size > 0)
+    {
+        if (m_used == m_buffer.size())
+        {
+            flush();
+        }
+        const std::size_t count{std::min(size, m_buffer.size() - m_used)};
+        std::memcpy(&m_buffer[m_used], bytes, count);
+        m_used += count;
+        bytes += count;
+        size -= count;
+    }
+}
+
+void BufferedWriter::write_u8(const Byte value)
+{
+    write(&value, 1);
+}
+
+void BufferedWriter::write_u32(const std::uint32_t value)
+{
+    Byte bytes[4];
+    boost::endian::store_little_u32(bytes, value);
+    write(bytes, sizeof(bytes));
+}
+
+void BufferedWriter::write_f32(const float value)
+{
+    const boost::endian::little_float32_buf_t buffer(value);
+    write(buffer.data(), 4);
+}
+
+bool BufferedWriter::flush()
+{
+    if (m_used > 0 && !m_failed)
+    {
+        m_failed = m_file == nullptr || std::fwrite(m_buffer.data(), 1, m_used, m_file) != m_used;
+    }
+    m_used = 0;
+    return !m_failed;
+}
+
+MeshWriter::~MeshWriter()
+{
+    close();
+}
+
+bool MeshWriter::open(const std::filesystem::path &path, const MeshFormat format, const int width,
+    const bool colors, const std::string &comment)
+{
+    close();
+    m_file = std::fopen(path.string().c_str(), "w+b");
+    if (m_file == nullptr)
+    {
+        return false;
+    }
+    m_format = format;
+    m_colors = colors;
+    m_num_vertices = 0;
+    m_num_faces = 0;
+    m_out.attach(m_file);
+    m_row.assign(width, NO_VERTEX);
+    m_previous_row.assign(width, NO_VERTEX);
+
+    if (m_format == MeshFormat::STL)
+    {
+        // the header must not start with "solid", which marks a text STL file
+        std::string header{"binary STL " + comment};
+        header.resize(STL_HEADER_SIZE, '\0');
+        m_out.write(header.data(), header.size());
+        m_out.write_u32(0); // triangle count, filled in by close()
+        return true;
+    }
+
+    // faces can only follow all the vertices, so they wait in a spool file
+    m_faces_file = std::tmpfile();
+    if (m_faces_file == nullptr)
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    m_faces.attach(m_faces_file);
+
+    std::string header{"ply\n"
+                       "format binary_little_endian 1.0\n"};
+    header += fmt::format("comment {:s}\n", comment);
+    header += "element vertex ";
+    m_vertex_count_offset = static_cast<long>(header.size());
+    header += fmt::format("{:0{}d}\n", 0, PLY_COUNT_WIDTH);
+    header += "property float x\n"
+              "property float y\n"
+              "property float z\n";
+    if (m_colors)
+    {
+        header += "property uchar red\n"
+                  "property uchar green\n"
+                  "property uchar blue\n";
+    }
+    header += "element face ";
+    m_face_count_offset = static_cast<long>(header.size());
+    header += fmt::format("{:0{}d}\n", 0, PLY_COUNT_WIDTH);
+    header += "property list uchar uint vertex_indices\n"
+              "end_header\n";
+    m_out.write(header.data(), header.size());
+    return true;
+}
+
+void MeshWriter::next_row()
+{
+    std::swap(m_row, m_previous_row);
+    std::fill(m_row.begin(), m_row.end(), NO_VERTEX);
+}
+
+std::uint32_t MeshWriter::vertex_index(const MeshCorner &corner)
+{
+    std::vector<std::uint32_t> &row{corner.previous_row ? m_previous_row : m_row};
+    const bool cached{corner.col >= 0 && corner.col < static_cast<int>(row.size())};
+    if (cached && row[corner.col] != NO_VERTEX)
+    {
+        return row[corner.col];
+    }
+
+    for (const float value : corner.vertex.pos)
+    {
+        m_out.write_f32(value);
+    }
+    if (m_colors)
+    {
+        for (const Byte value : corner.vertex.rgb)
+        {
+            m_out.write_u8(value);
+        }
+    }
+    if (cached)
+    {
+        row[corner.col] = m_num_vertices;
+    }
+    return m_num_vertices++;
+}
+
+void MeshWriter::triangle(const MeshCorner &c1, const MeshCorner &c2, const MeshCorner &c3)
+{
+    if (m_file == nullptr)
+    {
+        return;
+    }
+    ++m_num_faces;
+
+    if (m_format == MeshFormat::STL)
+    {
+        const std::array<float, 3> &p1{c1.vertex.pos};
+        const std::array<float, 3> &p2{c2.vertex.pos};
+        const std::array<float, 3> &p3{c3.vertex.pos};
+        const float u[3]{p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2]};
+        const float v[3]{p3[0] - p1[0], p3[1] - p1[1], p3[2] - p1[2]};
+        float normal[3]{u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+        if (const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            length > 0.0F)
+        {
+            for (float &value : normal)
+            {
+                value /= length;
+            }
+        }
+        for (const float value : normal)
+        {
+            m_out.write_f32(value);
+        }
+        for (const MeshCorner *corner : {&c1, &c2, &c3})
+        {
+            for (const float value : corner->vertex.pos)
+            {
+                m_out.write_f32(value);
+            }
+        }
+        m_out.write_u8(0); // attribute byte count
+        m_out.write_u8(0);
+        return;
+    }
+
+    const std::uint32_t i1{vertex_index(c1)};
+    const std::uint32_t i2{vertex_index(c2)};
+    const std::uint32_t i3{vertex_index(c3)};
+    m_faces.write_u8(3);
+    m_faces.write_u32(i1);
+    m_faces.write_u32(i2);
+    m_faces.write_u32(i3);
+}
+
+bool MeshWriter::patch_count(const long offset, const std::uint32_t count, const bool text)
+{
+    if (std::fseek(m_file, offset, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    if (text)
+    {
+        const std::string digits{fmt::format("{:0{}d}", count, PLY_COUNT_WIDTH)};
+        return std::fwrite(digits.data(), 1, digits.size(), m_file) == digits.size();
+    }
+    Byte bytes[4];
+    boost::endian::store_little_u32(bytes, count);
+    return std::fwrite(bytes, 1, sizeof(bytes), m_file) == sizeof(bytes);
+}
+
+bool MeshWriter::close()
+{
+    if (m_file == nullptr)
+    {
+        return true;
+    }
+
+    bool ok{true};
+    if (m_format == MeshFormat::STL)
+    {
+        ok = m_out.flush() && patch_count(static_cast<long>(STL_HEADER_SIZE), m_num_faces, false);
+    }
+    else
+    {
+        // append the spooled faces to the vertices
+        ok = m_faces.flush() && std::fflush(m_faces_file) == 0 && std::fseek(m_faces_file, 0, SEEK_SET) == 0;
+        std::vector<Byte> chunk(1U << 16U);
+        while (ok)
+        {
+            const std::size_t count{std::fread(chunk.data(), 1, chunk.size(), m_faces_file)};
+            if (count == 0)
+            {
+                ok = std::ferror(m_faces_file) == 0;
+                break;
+            }
+            m_out.write(chunk.data(), count);
+        }
+        ok = m_out.flush() && ok;
+        ok = ok && patch_count(m_vertex_count_offset, m_num_vertices, true) &&
+            patch_count(m_face_count_offset, m_num_faces, true);
+        std::fclose(m_faces_file);
+        m_faces_file = nullptr;
+    }
+    ok = std::fclose(m_file) == 0 && ok;
+    m_file = nullptr;
+    m_out.attach(nullptr);
+    m_faces.attach(nullptr);
+    return ok;
+}
+
+} // namespace id::geometry
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "engine/calmanfp.h"
+#include "engine/pixel_grid.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace id::engine
+{
+
+// Lets the one-pass Mandelbrot/Julia scans of several images share the
+// tile scheduler, as for the evolver's grid of small images.
+//
+// While recording, the scan captures the rows it would compute, with the
+// render constants and pixel grid of its image, and returns without
+// computing them.  compute() then computes the rows of every recorded scan
+// at once.  While replaying an image, its scans plot the computed rows
+// instead of computing them again.
+class DeferredScans
+{
+public:
+    enum class Mode
+    {
+        OFF = 0,
+        RECORD = 1,
+        REPLAY = 2
+    };
+
+    // Rows [first_row, last_row] of one image; the first row starts at
+    // first_col, the others at start_col, and all end at stop_col.
+    struct Scan
+    {
+        // Index into orbits of the first computed pixel of row.
+        std::size_t offset(int row) const;
+        const MandelbrotOrbit *row(const int row) const
+        {
+            return &orbits[offset(row)];
+        }
+
+        int image{};
+        int first_row{};
+        int first_col{};
+        int last_row{};
+        int start_col{};
+        int stop_col{};
+        MandelbrotContext ctx;
+        std::vector<MandelbrotOrbit> orbits;
+    };
+
+    DeferredScans() = default;
+    DeferredScans(const DeferredScans &) = delete;
+    DeferredScans(DeferredScans &&) = delete;
+    ~DeferredScans() = default;
+    DeferredScans &operator=(const DeferredScans &) = delete;
+    DeferredScans &operator=(DeferredScans &&) = delete;
+
+    Mode mode() const
+    {
+        return m_mode;
+    }
+
+    // Discards recorded scans and starts recording.
+    void record();
+    // Following scans belong to a new image; returns its index.
+    int begin_image();
+    // Number of scans recorded for image.
+    int scans(int image) const;
+    // Computes every recorded scan on the tile scheduler; returns false
+    // when interrupted, leaving nothing to replay.
+    bool compute();
+    // Following scans take their rows from those recorded for image.
+    void replay(int image);
+    // Discards recorded scans and stops recording or replaying.
+    void clear();
+
+    // Called by the scan while recording.
+    void defer(int first_row, int first_col, int last_row, int start_col, int stop_col);
+    // Called by the scan while replaying; returns the computed rows of the
+    // next recorded scan of the image, or nullptr when there are none for
+    // these bounds and the scan must compute its rows itself.
+    const Scan *next(int first_row, int first_col, int last_row, int start_col, int stop_col);
+
+private:
+    Mode m_mode{};
+    int m_image{-1};
+    std::vector<Scan> m_scans;
+    std::vector<PixelGrid> m_grids; // per image, captured by its first scan
+    std::size_t m_next{};
+    bool m_computed{};
+};
+
+// Process-wide deferred scans, used by the one-pass scan.
+DeferredScans &deferred_scans();
+
+} // namespace id::engine
@@ -3,10 +3,14 @@
 #pragma once
 
 #include "engine/Point.h"
+#include "engine/ReferenceOrbitCache.h"
+#include "engine/SeriesApproximation.h"
 #include "engine/UserData.h"
 #include "math/big.h"
+#include "math/FloatExp.h"
 
 #include <complex>
+#include <cstddef>
 #include <vector>
 
 namespace id::engine
@@ -15,48 +19,86 @@ namespace id::engine
 class PertEngine
 {
 public:
-    math::BFComplex initialize_frame_bf(double zoom_radius);
+    // Zoom radius below which pixel deltas no longer fit in a double.
+    static constexpr double EXTENDED_DELTA_RADIUS{1e-290};
+
+    math::BFComplex initialize_frame_bf(const math::FloatExp &zoom_radius);
     void initialize_frame(const std::complex<double> &center, double zoom_radius);
     void initialize_pixel_strategy();
     int calculate_pixel(const Point &pt);
     int calculate_pixel(int col, int row);
+    void calculate_pixels(const std::vector<Point> &points, std::size_t begin, std::size_t end);
     bool retry_needed(const std::vector<Point> &points) const;
     bool select_retry_reference(const std::vector<Point> &points);
     void set_glitch_tolerance(double tolerance);
+    void set_rebase(bool rebase);
     double glitch_tolerance_threshold(const std::complex<double> &value) const;
     int reference_count() const;
+    bool extended_deltas() const;
+    int skipped_iterations() const;
     std::vector<Point> take_glitch_points();
     void finish();
 
 private:
+    // Result of iterating one pixel, independent of any other pixel.
+    struct PointOrbit
+    {
+        std::complex<double> w;
+        double min_orbit{1e5}; // orbit value closest to origin
+        long min_index{};      // iteration of min_orbit
+        int iteration{};
+        bool glitched{};
+    };
+
+    static bool parallel_eligible();
     void cleanup();
     void complete_frame();
     void initialize_pixel_state();
     void allocate_working_values();
     bool select_center_reference();
     void select_reference_point(const Point &pt);
-    void reset_for_frame(double zoom_radius);
-    int calculate_point(const Point &pt, double magnified_radius, int window_radius);
+    void find_reference_length();
+    void reset_for_frame(const math::FloatExp &zoom_radius);
+    math::FloatExpComplex pixel_offset(const Point &pt) const;
+    void add_glitch_point(const Point &pt, int iteration);
+    PointOrbit iterate_point(const Point &pt) const;
+    PointOrbit iterate_point_extended(const Point &pt) const;
+    int color_index(const PointOrbit &orbit) const;
+    int plot_point(const Point &pt, const PointOrbit &orbit);
+    void calculate_band(int first_row);
     void reference_zoom_point(const math::BFComplex &center, int max_iteration);
     void reference_zoom_point(const std::complex<double> &center, int max_iteration);
+    static ReferenceOrbitKey orbit_key(int bf_length, std::vector<unsigned char> center);
+    int restore_reference_orbit(const ReferenceOrbit *orbit, std::size_t z_size, int max_iteration);
+    void store_reference_orbit(
+        const ReferenceOrbitKey &key, std::vector<unsigned char> next_z, int max_iteration, bool persist);
+    void fill_tolerance_check(int max_iteration);
+    void compute_series_approximation();
+    math::FloatExp reference_pixel_radius() const;
 
     std::vector<std::complex<double>> m_xn;
     std::vector<double> m_perturbation_tolerance_check;
+    int m_reference_length{}; // iterations before the reference orbit escapes
+    SeriesApproximation m_series;
     math::BFComplex m_c_bf{};
     math::BFComplex m_reference_coordinate_bf{};
     math::BigFloat m_tmp_bf{};
     std::complex<double> m_c{};
     std::complex<double> m_reference_coordinate{};
+    math::FloatExpComplex m_reference_delta{}; // reference offset from the center
     double m_delta_real{};
     double m_delta_imag{};
     std::vector<Point> m_glitch_points;
+    std::vector<std::vector<Point>> m_worker_glitch_points;
+    std::vector<int> m_pixel_colors; // colors from parallel bands, by screen row and column
     long m_glitch_point_count{};
     math::BFComplex m_center_bf{};
     std::complex<double> m_center{};
     double m_magnified_radius{};
-    double m_zoom_radius{};
+    math::FloatExp m_zoom_radius{};
     int m_window_radius{};
-    bool m_calculate_glitches{true};
+    bool m_rebase{true}; // rebase onto the reference instead of detecting glitches
+    bool m_extended_deltas{};
     bool m_center_stack_saved{};
     bool m_done{true};
     bool m_frame_initialized{};
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "fractals/fractype.h"
+
+#include <complex>
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <vector>
+
+namespace id::engine
+{
+
+// Identifies a perturbation reference orbit independently of its length.
+struct ReferenceOrbitKey
+{
+    fractals::FractalType fractal_type{};
+    int bf_length{};                   // 0 for a double precision reference
+    std::vector<unsigned char> center; // exact bytes of the reference coordinate
+    std::vector<double> params;        // fractal parameters the orbit depends on
+
+    bool operator==(const ReferenceOrbitKey &rhs) const
+    {
+        return fractal_type == rhs.fractal_type && bf_length == rhs.bf_length && center == rhs.center &&
+            params == rhs.params;
+    }
+    bool operator!=(const ReferenceOrbitKey &rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
+struct ReferenceOrbit
+{
+    std::vector<std::complex<double>> xn;
+    std::vector<unsigned char> next_z; // exact z after the last stored iteration, to extend the orbit
+};
+
+// Keeps recently computed reference orbits in memory, and optionally in
+// files in a directory, so that re-rendering around the same reference
+// does not have to recompute it.  The least recently used orbits are
+// discarded first.
+class ReferenceOrbitCache
+{
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY{8};
+    static constexpr std::size_t MAX_FILES{8};
+
+    explicit ReferenceOrbitCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+    // An empty directory disables the disk cache.
+    void set_directory(const std::filesystem::path &dir);
+    std::shared_ptr<const ReferenceOrbit> find(const ReferenceOrbitKey &key);
+    void store(const ReferenceOrbitKey &key, ReferenceOrbit orbit, bool persist);
+    void clear();
+
+    std::size_t size() const
+    {
+        return m_entries.size();
+    }
+
+private:
+    struct Entry
+    {
+        ReferenceOrbitKey key;
+        std::shared_ptr<const ReferenceOrbit> orbit;
+    };
+
+    void insert(const ReferenceOrbitKey &key, std::shared_ptr<const ReferenceOrbit> orbit);
+    std::filesystem::path file_path(const ReferenceOrbitKey &key) const;
+    std::shared_ptr<const ReferenceOrbit> load(const ReferenceOrbitKey &key) const;
+    void save(const ReferenceOrbitKey &key, const ReferenceOrbit &orbit) const;
+    void prune_files() const;
+
+    std::list<Entry> m_entries; // most recently used first
+    std::filesystem::path m_directory;
+    std::size_t m_capacity;
+};
+
+// Process-wide cache shared by all perturbation frames.
+ReferenceOrbitCache &reference_orbit_cache();
+
+} // namespace id::engine
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "math/FloatExp.h"
+
+#include <complex>
+#include <vector>
+
+namespace id::engine
+{
+
+// Third order series approximation of the Mandelbrot perturbation delta.
+//
+// For every pixel within radius of the reference, delta_n is approximated by
+// A_n dc + B_n dc^2 + C_n dc^3, where the coefficients depend only on the
+// reference orbit.  The iterations shared by all pixels can then be skipped
+// up to the last iteration where the cubic term is still negligible.
+// Coefficients are stored pre-scaled by the radius with extended exponents
+// so they stay in range at any zoom depth.
+class SeriesApproximation
+{
+public:
+    // Relative size of the cubic term at which the approximation stops.
+    static constexpr double TOLERANCE{1e-12};
+
+    void compute(const std::vector<std::complex<double>> &xn, int max_iteration, const math::FloatExp &radius,
+        double magnitude_limit);
+    void reset();
+
+    // Number of iterations every pixel can skip.
+    int skip() const
+    {
+        return m_skip;
+    }
+
+    // Approximate delta at iteration skip() for the given initial delta.
+    std::complex<double> delta(const std::complex<double> &delta0) const;
+    math::FloatExpComplex delta(const math::FloatExpComplex &delta0) const;
+
+private:
+    math::FloatExpComplex m_a{};
+    math::FloatExpComplex m_b{};
+    math::FloatExpComplex m_c{};
+    math::FloatExp m_radius{};
+    // double copies for radii within the range of a double
+    std::complex<double> m_a_double{};
+    std::complex<double> m_b_double{};
+    std::complex<double> m_c_double{};
+    double m_radius_double{};
+    int m_skip{};
+};
+
+} // namespace id::engine
@@ -23,6 +23,7 @@ struct StandardPassStatus
     std::string detail;
     float progress_percent{};
     int perturbation_reference_count{};
+    int perturbation_skipped_iterations{}; // series approximation skip per pixel
     bool perturbation_active{};
 };
 
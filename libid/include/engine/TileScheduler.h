@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace id::engine
+{
+
+// Runs independent tiles of work on a pool of worker threads.
+//
+// Each worker owns a queue of tile indices; an idle worker steals from
+// the back of another worker's queue.  The calling thread participates
+// as worker 0, so run() returns only after every tile has completed.
+// Tile functions must not touch the driver or per-pixel engine globals.
+class TileScheduler
+{
+public:
+    using TileFn = std::function<void(int tile, unsigned worker)>;
+
+    explicit TileScheduler(unsigned num_workers = 0);
+    ~TileScheduler();
+
+    TileScheduler(const TileScheduler &) = delete;
+    TileScheduler(TileScheduler &&) = delete;
+    TileScheduler &operator=(const TileScheduler &) = delete;
+    TileScheduler &operator=(TileScheduler &&) = delete;
+
+    unsigned num_workers() const
+    {
+        return static_cast<unsigned>(m_queues.size());
+    }
+
+    void run(int num_tiles, const TileFn &tile_fn);
+
+private:
+    struct WorkQueue
+    {
+        std::mutex lock;
+        std::deque<int> tiles;
+    };
+
+    bool next_tile(unsigned worker, int &tile);
+    void work(unsigned worker);
+    void worker_main(unsigned worker);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_lock;
+    std::condition_variable m_start;
+    std::condition_variable m_finished;
+    const TileFn *m_tile_fn{};
+    std::exception_ptr m_error;
+    unsigned long m_generation{};
+    unsigned m_busy{};
+    bool m_shutdown{};
+};
+
+// Process-wide scheduler sized to the hardware concurrency.
+TileScheduler &tile_scheduler();
+
+} // namespace id::engine
@@ -14,6 +14,12 @@ enum class PerturbationMode
     NO = 2
 };
 
+enum class PerturbationGlitch
+{
+    REBASE = 0, // rebase pixel orbits onto the single reference orbit
+    RETRY = 1   // detect glitched pixels and retry them with new references
+};
+
 constexpr double DEFAULT_PERTURBATION_TOLERANCE{1e-6};
 
 // user_xxx is what the user wants,
@@ -24,6 +30,7 @@ struct UserData
     long distance_estimator_value{}; //
     PerturbationMode perturbation{}; //
     double perturbation_tolerance{DEFAULT_PERTURBATION_TOLERANCE};
+    PerturbationGlitch perturbation_glitch{}; //
     int periodicity_value{};         //
     CalcMode std_calc_mode{};        //
     long bailout_value{};            // user input bailout value
@@ -212,8 +212,19 @@ int calc_fract();
 int calc_mandelbrot_type();
 int standard_fractal_type();
 void init_atan_colors();
+// Sets up the log map table or ranges for the current coloring options.
+void init_log_map();
 int find_alternate_math(fractals::FractalType type, math::BFMathType math);
 bool select_alternate_math_dispatch();
+int plot_mandelbrot_color();
+int mandelbrot_color(long &color_iter, long real_color_iter, double magnitude);
+// The coloring steps of StandardFractal::calculate_standard_pixel() that
+// work from g_color_iter and g_new_z alone, for the lane kernels.
+void save_color_iter();
+void outside_method_color(double mem_value, double total_dist);
+void escaped_color(bool attracted);
+bool inside_color(bool caught_a_cycle);
+void color_from_color_iter();
 int potential(double mag, long iterations);
 void sym_pi_plot(int x, int y, int color);
 void sym_pi_plot2j(int x, int y, int color);
@@ -226,5 +237,7 @@ void sym_plot2_basin(int x, int y, int color);
 void sym_plot4_basin(int x, int y, int color);
 void no_plot(int x, int y, int color);
 void sym_fill_line(int row, int left, int right, const Byte *str);
+void sym_put_line(int row, int left, int right, const Byte *str);
+bool plot_rows_by_span();
 
 } // namespace id::engine
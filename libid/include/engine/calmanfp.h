@@ -2,10 +2,60 @@
 //
 #pragma once
 
+#include "engine/calcfrac.h"
+#include "engine/pixel_grid.h"
+#include "math/cmplx.h"
+
 namespace id::engine
 {
 
+// Result of one optimized Mandelbrot/Julia orbit; the reentrant kernel
+// reads only render constants, so rows can be computed on any thread.
+struct MandelbrotOrbit
+{
+    math::DComplex new_z{}; // final z, set on bailout
+    double magnitude{};     // |z|^2 of the last iterate
+    long color_iter{};      // color index after inside/outside adjustment
+    long real_color_iter{}; // iteration count before adjustment
+    long old_color_iter{};  // periodicity check threshold, carried to the next pixel
+    long iterations{};      // iterations consumed, for keyboard check pacing
+};
+
+// Render constants read by the optimized Mandelbrot/Julia kernels.  Rows
+// computed from a captured context don't read the globals, so they can be
+// computed after the globals have moved on to another image.
+struct MandelbrotContext
+{
+    math::DComplex param_z1{};
+    double magnitude_limit{};
+    double close_enough{};
+    long max_iterations{};
+    long first_saved_and{};
+    int next_saved_incr{};
+    int periodicity_check{};
+    bool julia{};
+    ColorMethod outside_method{};
+    int outside_color{};
+    int atan_colors{};
+    long inside_color{};
+    long periodicity_color{};
+    bool simd{}; // rows run on the SIMD lane kernel, as set from use_simd_escape()
+};
+
 void calc_mandelbrot_init();
+// Captures the render constants of the current image, leaving simd unset.
+MandelbrotContext mandelbrot_context();
 long mandelbrot_orbit();
+long mandelbrot_orbit(const math::DComplex &init, bool reset_periodicity, MandelbrotOrbit &orbit);
+long mandelbrot_orbit(
+    const MandelbrotContext &ctx, const math::DComplex &init, bool reset_periodicity, MandelbrotOrbit &orbit);
+void mandelbrot_orbit_row(int row, int first_col, int last_col, MandelbrotOrbit *orbits);
+void mandelbrot_orbit_row(const MandelbrotContext &ctx, const PixelGrid &grid, int row, int first_col,
+    int last_col, MandelbrotOrbit *orbits);
+
+// Orbit outcomes shared by the scalar and SIMD kernels; cx counts down from max_iterations.
+void mandelbrot_orbit_escaped(const MandelbrotContext &ctx, long cx, double x, double y, MandelbrotOrbit &orbit);
+void mandelbrot_orbit_periodic(const MandelbrotContext &ctx, long cx, MandelbrotOrbit &orbit);
+void mandelbrot_orbit_inside(const MandelbrotContext &ctx, MandelbrotOrbit &orbit);
 
 } // namespace id::engine
@@ -38,6 +38,8 @@ void mandel_ref_pt(const std::complex<double> &center, std::complex<double> &z);
 void mandel_ref_pt_bf(const math::BFComplex &center, math::BFComplex &z);
 void mandel_perturb(
     const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0);
+void mandel_perturb_fe(
+    const std::complex<double> &ref, math::FloatExpComplex &delta_n, const math::FloatExpComplex &delta0);
 int julia_per_pixel();
 int other_mandel_per_pixel();
 int other_julia_per_pixel();
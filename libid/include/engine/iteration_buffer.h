@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "math/cmplx.h"
+
+namespace id::engine
+{
+
+// With recolor=yes the iteration count and final z of every pixel of the
+// escape time engines are kept while the image is computed, so changing
+// only the inside, outside, logmap or biomorph coloring redraws the image
+// from them instead of computing it again.
+extern bool g_keep_iterations;
+
+// Starts keeping the pixels plotted by the image about to be computed,
+// keeping those already kept when resuming.  Wraps g_put_color, so call
+// after it is set.
+void start_iteration_buffer(bool resuming);
+// Stops keeping pixels and restores g_put_color; the buffer describes
+// the screen once the image is completed.
+void stop_iteration_buffer(bool completed);
+void free_iteration_buffer();
+
+// The pixel the engine computed next; every pixel plotted until it is
+// cleared, such as the copies made by symmetry, keeps it.  Pixels plotted
+// without one, such as guessed pixels, are filled in when recoloring from
+// a computed neighbor of the same color.
+void set_pixel_iteration(long real_color_iter, const math::DComplex &z);
+void clear_pixel_iteration();
+
+// Returns why the image can't be redrawn from the buffer with the current
+// coloring options, or nullptr.
+const char *recolor_ineligible_reason();
+
+// Redraws the image from the buffer with the current coloring options.
+// Returns false when the buffer doesn't cover the image.
+bool recolor_image();
+
+// The least iteration count around the edges of the image, as
+// auto_log_map() finds it by computing the edges, from the buffer.
+long iteration_buffer_auto_log_map();
+
+} // namespace id::engine
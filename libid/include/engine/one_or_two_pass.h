@@ -12,6 +12,10 @@ class OneOrTwoPass
 protected:
     int standard_calc(int pass_num, CalcMode calc_mode);
     int stop_row_for_resume() const;
+    static bool tiled_calc_eligible(CalcMode calc_mode);
+    int tiled_calc();
+    int simd_formula_calc();
+    int lyapunov_calc();
 
     int m_current_pass{};
     int m_row{};
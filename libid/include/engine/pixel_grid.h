@@ -7,8 +7,32 @@
 namespace id::engine
 {
 
+// Complex coordinates of the pixels at the current zoom corners, held as
+// per-axis grids that sum to each pixel's coordinates.
+struct PixelGrid
+{
+    double dx(const int col, const int row) const
+    {
+        return x0[col] + x1[row];
+    }
+    double dy(const int col, const int row) const
+    {
+        return y0[row] + y1[col];
+    }
+
+    std::vector<double> x0;
+    std::vector<double> y0;
+    std::vector<double> x1;
+    std::vector<double> y1;
+};
+
+// The grid read by dx_pixel() and dy_pixel().
+const PixelGrid &pixel_grid();
+
 double dx_pixel();
 double dy_pixel();
+double dx_pixel(int col, int row);
+double dy_pixel(int col, int row);
 void alloc_pixel_grid();
 void free_pixel_grid();
 void fill_pixel_grid();
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "engine/calmanfp.h"
+
+namespace id::engine
+{
+
+enum class SimdMode
+{
+    AUTO = 0,
+    OFF = 1,
+    FORCE = 2
+};
+
+// Number of pixels iterated together by the row kernel.
+constexpr int SIMD_ESCAPE_LANES{8};
+
+extern SimdMode g_simd_mode;
+
+// Returns nullptr when the current render state is supported by the lane
+// kernel, otherwise a short description of the first unsupported setting.
+const char *simd_escape_ineligible_reason();
+
+bool use_simd_escape();
+
+// Computes pixels [first_col, last_col] of a row with the same results as
+// calling mandelbrot_orbit() for each pixel in turn, starting the row with
+// reset periodicity checking.
+void simd_escape_row(int row, int first_col, int last_col, MandelbrotOrbit *orbits);
+void simd_escape_row(const MandelbrotContext &ctx, const PixelGrid &grid, int row, int first_col, int last_col,
+    MandelbrotOrbit *orbits);
+
+} // namespace id::engine
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "math/cmplx.h"
+
+namespace id::engine
+{
+
+// Outcome of one formula pixel, before the standard coloring adjustments.
+struct FormulaPixel
+{
+    math::DComplex new_z{};  // z after the last iteration
+    long color_iter{};       // iteration that ended the orbit, g_max_iterations when inside
+    long threshold{};        // periodicity checking started after this iteration
+    bool caught_cycle{};     // periodicity checking ended the orbit
+    bool new_z_set{};        // false when initialization overflowed, leaving g_new_z alone
+};
+
+// Returns nullptr when the current render state is supported by the
+// formula lane kernel, otherwise a short description of the first
+// unsupported setting.
+const char *simd_formula_ineligible_reason();
+
+bool use_simd_formula();
+
+// Computes pixels [first_col, last_col] of a row with the same results as
+// the standard fractal loop running formula_per_pixel() and formula_orbit()
+// for each pixel in turn, starting the row with reset periodicity checking.
+void simd_formula_row(int row, int first_col, int last_col, FormulaPixel *pixels);
+
+// Applies the standard fractal coloring to pixel and plots it at g_col, g_row.
+// Pixels must be plotted in scan order.
+int plot_formula_pixel(const FormulaPixel &pixel);
+
+// As plot_formula_pixel(), but only sets and returns g_color.
+int formula_pixel_color(const FormulaPixel &pixel);
+
+} // namespace id::engine
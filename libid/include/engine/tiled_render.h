@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include <config/port.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace id::engine
+{
+
+// Size of an image rendered tile by tile, as set by tiledgif=.
+struct TiledRenderSize
+{
+    bool enabled() const
+    {
+        return width > 0 && height > 0;
+    }
+
+    int width{};
+    int height{};
+    int tile_size{256};
+};
+
+extern TiledRenderSize g_tiled_render;
+
+// Orbit data of one pixel before coloring.
+struct IterationSample
+{
+    std::uint32_t iterations{}; // iteration count; max iterations for inside
+    float smooth{};             // continuous iteration count; max iterations for inside
+    float z_real{};             // final z on bailout; 0 for inside
+    float z_imag{};             //
+};
+
+// One square (or edge clipped) tile of the image, its color indices in
+// row order.
+struct RenderedTile
+{
+    int left{};
+    int top{};
+    int width{};
+    int height{};
+    std::vector<Byte> pixels;
+    std::vector<IterationSample> samples; // in row order, when requested
+};
+
+// Receives each tile in raster order; returns false to stop rendering.
+using TileSink = std::function<bool(const RenderedTile &tile)>;
+
+// Returns why the current image can't be rendered in tiles, or nullptr.
+const char *tiled_render_ineligible_reason();
+
+// Renders the current image, as set up for the screen, at size.width by
+// size.height.  Tiles are computed on the tile scheduler and handed to
+// sink as they complete, so only a few tiles are held at once no matter
+// how large the image.  With keep_samples each tile also carries the
+// orbit data of its pixels.  Returns false when interrupted or stopped by
+// sink.
+bool tiled_render(const TiledRenderSize &size, const TileSink &sink, bool keep_samples = false);
+
+} // namespace id::engine
@@ -2,6 +2,9 @@
 //
 #pragma once
 
+#include "config/port.h"
+#include "math/cmplx.h"
+
 #include <vector>
 
 namespace id::fractals
@@ -11,7 +14,9 @@ namespace id::fractals
 struct BifurcationPeriod
 {
     void init();
+    void init(double delta_y);
     bool periodic(long time);
+    bool periodic(long time, double population);
 
     double close_enough{};
     double saved_pop{};
@@ -19,6 +24,40 @@ struct BifurcationPeriod
     long saved_and{};
 };
 
+// The population maps the column kernel computes without the global orbit.
+enum class BifurcationMap
+{
+    VERHULST,
+    LAMBDA,
+    ADD_TRIG_PI,
+    SET_TRIG_PI,
+    STEWART,
+    MAY
+};
+
+// The real part of out is that of the function applied to arg.
+using BifurcationTrig = void (*)(const math::DComplex &arg, math::DComplex &out);
+
+// Render constants read by the reentrant column kernel.  Each column keeps
+// its population in locals, so columns can be computed on any thread.
+struct BifurcationContext
+{
+    BifurcationMap map{};
+    BifurcationTrig trig{}; // nullptr for ident
+    long may_beta{};
+    double seed{}; // starting population of every column
+    unsigned long filter_cycles{};
+    bool half_time_check{};
+    bool periodicity_check{};
+    long max_iterations{};
+    int stop_row{};
+    double init_y{}; // population of the bottom row
+    LDouble delta_y{};
+};
+
+// Number of columns iterated together by the column kernel.
+constexpr int BIFURCATION_LANES{8};
+
 class Bifurcation
 {
 public:
@@ -31,15 +70,32 @@ public:
     const std::vector<int> &calculate_column(double rate);
 
 private:
+    bool iterate_columns();
+    void plot_column(int x, int *counts);
+
     std::vector<int> m_verhulst;
+    std::vector<int> m_columns; // hit counts of a band of columns
+    std::vector<double> m_rates;
+    BifurcationContext m_ctx;
     unsigned long m_filter_cycles{};
     bool m_half_time_check{};
+    bool m_use_columns{};
+    bool m_log_density{};
     bool m_mono{};
     int m_outside_x{};
     int m_x{};
     BifurcationPeriod s_period;
 };
 
+// True when pixels are colored by the log of their hit count.
+bool bifurcation_log_density();
+BifurcationContext bifurcation_context();
+// True when columns can be computed with the reentrant kernel.
+bool use_bifurcation_columns();
+// Computes the row hit counts of count columns the same as calculate_column();
+// the counts of column i start at hits[i * (ctx.stop_row + 1)].
+void bifurcation_columns(const BifurcationContext &ctx, const double *rates, int count, int *hits);
+
 int bifurc_add_trig_pi_orbit();
 int bifurc_lambda_trig_orbit();
 int bifurc_set_trig_pi_orbit();
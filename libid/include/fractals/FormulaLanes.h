@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "fractals/FormulaVM.h"
+#include "fractals/parser.h"
+#include "math/cmplx.h"
+
+#include <array>
+#include <vector>
+
+namespace id::fractals
+{
+
+// Number of pixels run together by FormulaLanes.
+constexpr int FORMULA_LANES{8};
+
+// One complex value for each lane, as structure-of-arrays.
+struct LaneComplex
+{
+    alignas(64) std::array<double, FORMULA_LANES> x;
+    alignas(64) std::array<double, FORMULA_LANES> y;
+};
+
+// Runs the register program of a FormulaVM over several pixels at once.
+//
+// Every register and variable the program uses gets a value for each lane,
+// starting from the variable's value when the lanes are constructed.
+// Branches become lane predicates: each lane keeps its own program counter,
+// and because formula jumps only go forward, one pass over the program runs
+// every instruction once for the lanes waiting at it.  Arithmetic runs in
+// lane loops the compiler can vectorize, with the same operations as the VM
+// so results are identical; operations the VM leaves to the interpreter are
+// called lane by lane, copying LastSqr in and out for sqr as fn1..fn4.
+class FormulaLanes
+{
+public:
+    using Mask = std::array<bool, FORMULA_LANES>;
+
+    // Returns nullptr when the compiled formula can run in lanes, otherwise
+    // a short description of why not.
+    static const char *ineligible_reason(const FormulaVM &vm, const CompiledFormula &formula);
+
+    // Captures the formula's per image values, so construct after per_image.
+    FormulaLanes(const FormulaVM &vm, const CompiledFormula &formula);
+    FormulaLanes(const FormulaLanes &) = delete;
+    FormulaLanes(FormulaLanes &&) = delete;
+    ~FormulaLanes() = default;
+    FormulaLanes &operator=(const FormulaLanes &) = delete;
+    FormulaLanes &operator=(FormulaLanes &&) = delete;
+
+    // Sets the per pixel variables of lane and runs the initialization
+    // section for it, as formula_per_pixel() does.
+    void start(int lane, const math::DComplex &pixel, int col, int row);
+    // Runs one iteration for each selected lane, as formula_orbit() does.
+    void orbit(const Mask &lanes);
+
+    // True when the last iteration of lane returned zero, ending the orbit.
+    bool bailout(int lane) const
+    {
+        return m_values[m_program.result].x[lane] == 0.0;
+    }
+    // True when an operation overflowed since the lane was started.
+    bool overflow(int lane) const
+    {
+        return m_overflow[lane];
+    }
+    math::DComplex z(int lane) const
+    {
+        const LaneComplex &z{m_values[m_program.z]};
+        return {z.x[lane], z.y[lane]};
+    }
+
+private:
+    struct Instruction
+    {
+        FormulaVM::Op op;
+        int dst;
+        int a;
+        int b;
+        int target;
+        FunctionPtr fn;
+    };
+
+    struct Program
+    {
+        std::vector<Instruction> code;
+        std::vector<const math::DComplex *> locations; // scalar location of each value
+        int orbit_start{};
+        int result{-1};
+        int last_sqr{-1};
+        int z{-1};
+        int pixel{-1};
+        int white_square{-1};
+        int screen_pixel{-1};
+    };
+
+    static Program translate(const FormulaVM &vm, const CompiledFormula &formula);
+
+    void set(int value, int lane, const math::DComplex &z);
+    void run(int pc, const Mask &lanes);
+    void execute(const Instruction &in, const Mask &active);
+    void call(const Instruction &in, const Mask &active);
+
+    Program m_program;
+    std::vector<LaneComplex> m_values;
+    std::array<int, FORMULA_LANES> m_pc{};
+    std::array<bool, FORMULA_LANES> m_overflow{};
+};
+
+} // namespace id::fractals
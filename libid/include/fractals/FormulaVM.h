@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "fractals/parser.h"
+#include "math/cmplx.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace id::fractals
+{
+
+// Register form of a parsed formula.
+//
+// The stack operations produced by the parser are lowered to instructions
+// whose operands point directly at formula variables, constants or a small
+// register file standing in for the stack.  Loads disappear into operands,
+// operations on constants are folded, and writes that are never read are
+// removed.  The result is run by a switch dispatched loop instead of one
+// indirect call per stack operation.
+class FormulaVM
+{
+public:
+    enum class Op
+    {
+        MOVE,
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        NEG,
+        REAL,
+        IMAG,
+        CONJ,
+        FLIP,
+        ABS,
+        MOD,
+        CABS,
+        SQR,
+        SIN,
+        COS,
+        SINH,
+        COSH,
+        LT,
+        GT,
+        LTE,
+        GTE,
+        EQ,
+        NE,
+        AND,
+        OR,
+        CALL1,
+        CALL2,
+        JUMP,
+        JUMP_IF_FALSE,
+        JUMP_IF_TRUE,
+        END
+    };
+
+    struct Instruction
+    {
+        Op op;
+        math::DComplex *dst;
+        const math::DComplex *a;
+        const math::DComplex *b;
+        int target;
+        FunctionPtr fn;
+    };
+
+    FormulaVM() = default;
+    FormulaVM(const FormulaVM &) = delete;
+    FormulaVM(FormulaVM &&) = delete;
+    ~FormulaVM() = default;
+    FormulaVM &operator=(const FormulaVM &) = delete;
+    FormulaVM &operator=(FormulaVM &&) = delete;
+
+    // Lowers the parsed formula; returns false, leaving the VM empty, when
+    // the formula uses something the VM can't express.  The formula's
+    // variables must stay where they are while the VM is in use.
+    bool compile(CompiledFormula &formula);
+    void clear();
+
+    bool compiled() const
+    {
+        return !m_code.empty();
+    }
+    const std::vector<Instruction> &code() const
+    {
+        return m_code;
+    }
+    // First instruction of the iteration section.
+    int orbit_start() const
+    {
+        return m_orbit_start;
+    }
+    // Where an iteration leaves the value that decides whether to continue.
+    const math::DComplex *result() const
+    {
+        return m_result;
+    }
+    // The variable that sqr() also writes.
+    const math::DComplex *last_sqr() const
+    {
+        return m_last_sqr;
+    }
+
+    // Runs the per pixel initialization section.
+    void run_init()
+    {
+        run(0);
+    }
+    // Runs one iteration and returns the value left on top of the stack,
+    // which is non-zero to continue iterating.
+    const math::DComplex &run_orbit()
+    {
+        run(m_orbit_start);
+        return *m_result;
+    }
+
+private:
+    // one more than the interpreter stack, to hold a result merged from branches
+    static constexpr int NUM_REGISTERS{21};
+
+    class Lowering;
+
+    void run(int pc);
+    void eliminate_dead_stores(const CompiledFormula &formula);
+
+    std::vector<Instruction> m_code;
+    std::vector<math::DComplex> m_constants; // folded values, reserved so pointers are stable
+    std::array<math::DComplex, NUM_REGISTERS> m_registers{};
+    std::array<math::Arg, 2> m_call_args{}; // stack for operations run by the interpreter
+    math::DComplex *m_last_sqr{};
+    const math::DComplex *m_result{&m_registers[0]};
+    int m_orbit_start{};
+};
+
+extern FormulaVM g_formula_vm;
+
+} // namespace id::fractals
@@ -8,5 +8,6 @@ namespace id::fractals
 int bifurc_may_orbit();
 bool bifurc_may_per_image();
 void set_bifurc_may_beta(double beta);
+long bifurc_may_beta();
 
 } // namespace id::fractals
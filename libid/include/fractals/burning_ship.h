@@ -15,5 +15,7 @@ void burning_ship_ref_pt(const std::complex<double> &center, std::complex<double
 void burning_ship_ref_pt_bf(const math::BFComplex &center, math::BFComplex &z);
 void burning_ship_perturb(
     const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0);
+void burning_ship_perturb_fe(
+    const std::complex<double> &ref, math::FloatExpComplex &delta_n, const math::FloatExpComplex &delta0);
 
 } // namespace id::fractals
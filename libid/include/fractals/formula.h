@@ -16,5 +16,7 @@ bool formula_per_image();
 int formula_per_pixel();
 int formula_orbit();
 int bad_formula();
+// True when formulas run on g_formula_vm instead of the interpreter.
+bool use_formula_vm();
 
 } // namespace id::fractals
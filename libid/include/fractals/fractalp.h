@@ -94,6 +94,8 @@ using PerturbationReference = void (*)(const std::complex<double> &center, std::
 using PerturbationReferenceBF = void (*)(const math::BFComplex &center, math::BFComplex &z);
 using PerturbationPoint = void (*)(
     const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0);
+using PerturbationPointFloatExp = void (*)(
+    const std::complex<double> &ref, math::FloatExpComplex &delta_n, const math::FloatExpComplex &delta0);
 
 struct FractalSpecific
 {
@@ -120,6 +122,7 @@ struct FractalSpecific
     PerturbationReference pert_ref{};       // compute perturbation reference orbit
     PerturbationReferenceBF pert_ref_bf{};  // compute BFComplex perturbation reference orbit
     PerturbationPoint pert_pt{};            // compute point via perturbation
+    PerturbationPointFloatExp pert_pt_fe{}; // compute point via perturbation with extended exponent deltas
 };
 
 const FractalSpecific *get_fractal_specific(FractalType type);
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include "fractals/ifs.h"
+#include "fractals/lorenz.h"
+#include "geometry/3d.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace id::fractals
+{
+
+// Maps IFS points to screen pixels.  For 3D IFS the point is first moved
+// into view space by the matrix established from the first orbit points.
+struct IFSProjection
+{
+    Affine cvt{};
+    bool three_d{};
+    geometry::Matrix view{};
+    bool perspective{};
+    double viewer[3]{}; // perspective view point
+    int x_adjust{};
+    int y_adjust{};
+    int width{};
+    int height{};
+};
+
+// Number of walkers advanced together by a batch.
+constexpr int IFS_WALKER_LANES{16};
+
+// Runs many independent chaos-game walkers over the current IFS definition
+// and counts the hits on each pixel.  Walkers are grouped in a fixed number
+// of batches, each with its own random stream, and the batches are spread
+// over the tile scheduler with a hit-count histogram per worker.  The
+// merged histogram does not depend on the number of workers.
+class IFSWalkers
+{
+public:
+    IFSWalkers(IFSDimension dim, const IFSProjection &projection);
+
+    // Plots at least count more points and returns the number plotted.
+    long run(long count);
+    // True once a walker has left the screen far enough to be unbounded.
+    bool diverged() const;
+
+    const IFSProjection &projection() const
+    {
+        return m_projection;
+    }
+    const std::vector<std::uint32_t> &hits() const
+    {
+        return m_hits;
+    }
+    std::uint32_t max_hits() const
+    {
+        return m_max_hits;
+    }
+
+private:
+    struct Batch
+    {
+        alignas(64) std::array<double, IFS_WALKER_LANES> x{};
+        alignas(64) std::array<double, IFS_WALKER_LANES> y{};
+        alignas(64) std::array<double, IFS_WALKER_LANES> z{};
+        std::array<std::uint32_t, IFS_WALKER_LANES> random{};
+        bool diverged{};
+    };
+
+    void step(Batch &batch, long steps, std::uint32_t *hits) const;
+
+    IFSDimension m_dim;
+    IFSProjection m_projection;
+    int m_num_params;
+    std::vector<double> m_coefficients;
+    std::vector<double> m_thresholds;
+    std::vector<Batch> m_batches;
+    std::vector<std::vector<std::uint32_t>> m_worker_hits;
+    std::vector<std::uint32_t> m_hits;
+    std::uint32_t m_max_hits{};
+};
+
+// Maps a hit count to a color on a log scale of the densest pixel's count;
+// 0 for a pixel that was never hit.
+int ifs_density_color(std::uint32_t hits, std::uint32_t max_hits, int colors);
+
+// Plots every hit pixel with its density color.
+void plot_ifs_density(const IFSWalkers &walkers);
+
+} // namespace id::fractals
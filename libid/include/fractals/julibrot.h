@@ -3,6 +3,10 @@
 #pragma once
 
 #include "fractals/fractalp.h"
+#include "math/cmplx.h"
+
+#include <array>
+#include <vector>
 
 namespace id::fractals
 {
@@ -38,6 +42,60 @@ constexpr const char *to_string(const Julibrot3DMode value)
     }
 }
 
+// The orbits the reentrant depth march computes.
+enum class JulibrotOrbit
+{
+    JULIA,
+    QUATERNION,
+    HYPER_COMPLEX
+};
+
+// Computes out = fn(arg) without going through the formula parser stack.
+using JulibrotFn = void (*)(const math::DComplex &arg, math::DComplex &out);
+
+// A point on a ray through the volume: the orbit start (jx, jy) and the
+// Mandelbrot parameter (mx, my) that selects the Julia set.
+struct JulibrotSample
+{
+    double jx;
+    double jy;
+    double mx;
+    double my;
+};
+
+// Render constants read by the reentrant depth march.  Each depth sample
+// keeps its orbit in locals, so rows can be computed on any thread.
+struct JulibrotContext
+{
+    JulibrotOrbit orbit{};
+    bool mandel_start{};            // samples are the quaternion c, not the orbit start
+    JulibrotFn fn{};                // hypercomplex function; nullptr for ident
+    std::array<double, 4> c{};      // quaternion c when the samples start the orbit
+    long max_iterations{};
+    double magnitude_limit{};
+    Julibrot3DMode mode{};
+    int z_dots{};
+    int coarse_step{1};
+    math::DComplex left_eye{};      // viewer positions in inches
+    math::DComplex right_eye{};
+    float dist{};
+    float depth{};
+    double x_per_inch{};
+    double y_per_inch{};
+    double x_offset{};
+    double y_offset{};
+    double init_z{};
+    double x_min{};                 // Mandelbrot parameter of the nearest sample
+    double y_min{};
+    double delta_mx{};
+    double delta_my{};
+    int b_base{};
+    float br_ratio{};
+};
+
+// Largest number of depth samples between the coarse samples of a ray.
+constexpr int JULIBROT_MAX_COARSE_STEP{32};
+
 extern bool                  g_julibrot;
 extern float                 g_eyes;
 extern Julibrot3DMode        g_julibrot_3d_mode;
@@ -51,6 +109,7 @@ extern double                g_julibrot_x_min;
 extern double                g_julibrot_y_max;
 extern double                g_julibrot_y_min;
 extern int                   g_julibrot_z_dots;
+extern int                   g_julibrot_coarse_step;
 extern FractalType           g_new_orbit_type;
 extern const char *          g_julibrot_3d_options[];
 extern SaveDAC               g_save_dac;
@@ -59,6 +118,17 @@ bool julibrot_per_image();
 int julibrot_per_pixel();
 FractalDispatch make_julibrot_orbit_dispatch();
 
+// Valid after julibrot_per_image().
+JulibrotContext julibrot_context();
+// True when the orbit can be computed with the reentrant depth march.
+bool use_julibrot_lines();
+// The index of the first depth sample of the ray through (x, y) inches seen
+// from eye whose orbit doesn't escape, or ctx.z_dots if they all escape.
+int julibrot_depth(const JulibrotContext &ctx, double x, double y, const math::DComplex &eye);
+// The color z_line() plots at (col, row) for the ray through (x, y) inches,
+// or -1 when every depth sample escapes.
+int julibrot_pixel_color(const JulibrotContext &ctx, double x, double y, int col, int row);
+
 class Standard4D
 {
 public:
@@ -66,11 +136,17 @@ public:
     bool iterate();
 
 private:
+    bool iterate_lines();
+
     double m_y{};
     double m_x{};
     int m_y_dot{};
     int m_x_dot{};
     FractalDispatch m_orbit_dispatch{};
+    JulibrotContext m_ctx;
+    bool m_use_lines{};
+    std::vector<double> m_cols;   // x inches of each column
+    std::vector<int> m_colors;    // a band of row pairs
 };
 
 } // namespace id::fractals
@@ -6,6 +6,7 @@
 #include "geometry/3d.h"
 
 #include <cstdio>
+#include <memory>
 #include <string>
 
 namespace id::fractals
@@ -180,9 +181,12 @@ private:
 enum class IFSColorMethod
 {
     INCREMENT_PIXEL = 0,
-    TRANSFORM_INDEX = 1
+    TRANSFORM_INDEX = 1,
+    DENSITY = 2 // log density of hits from batched walkers
 };
 
+class IFSWalkers;
+
 class IFS2D
 {
 public:
@@ -202,6 +206,7 @@ private:
     std::FILE *m_fp{};
     double m_x{};
     double m_y{};
+    std::unique_ptr<IFSWalkers> m_walkers;
     bool m_unbounded{};
 };
 
@@ -226,6 +231,8 @@ private:
     int m_k{};
     ViewTransform3D m_inf{};
     IFSColorMethod m_color_method{};
+    std::unique_ptr<IFSWalkers> m_walkers;
+    bool m_use_walkers{};
     bool m_unbounded{};
 };
 
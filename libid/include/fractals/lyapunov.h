@@ -2,6 +2,8 @@
 //
 #pragma once
 
+#include "engine/calcfrac.h"
+
 #include <array>
 #include <memory>
 
@@ -9,6 +11,7 @@ namespace id::engine
 {
 
 class StandardFractal;
+struct PixelGrid;
 
 }
 
@@ -21,6 +24,24 @@ struct LyapunovSequence
     std::array<int, 34> rxy{};
 };
 
+// Render constants read by the reentrant Lyapunov kernel.  Pixels are
+// computed with the population held in locals, so rows can be computed on
+// any thread.
+struct LyapunovContext
+{
+    LyapunovSequence sequence;
+    long filter_cycles{};
+    long max_iterations{};
+    double population{}; // seed population of every pixel
+    bool log_map{};
+    int colors{};
+    engine::ColorMethod inside_method{};
+    int inside_color{};
+};
+
+// Number of pixels iterated together by the row kernel.
+constexpr int LYAPUNOV_LANES{8};
+
 class Lyapunov
 {
 public:
@@ -46,4 +67,15 @@ bool lyapunov_per_image();
 int lyapunov_type();
 int lyapunov_orbit();
 
+LyapunovContext lyapunov_context();
+// True when rows can be computed independently with the reentrant kernel;
+// multiple passes, a random population seed and inversion tie each pixel to
+// the ones before it.
+bool use_lyapunov_rows();
+// The color lyapunov_type() plots for the pixel with rates a and b.
+int lyapunov_color(const LyapunovContext &ctx, double a, double b);
+// Computes the colors of pixels [first_col, last_col] of a row.
+void lyapunov_row(const LyapunovContext &ctx, const engine::PixelGrid &grid, int row, int first_col, int last_col,
+    int *colors);
+
 } // namespace id::fractals
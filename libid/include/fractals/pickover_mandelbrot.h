@@ -17,6 +17,8 @@ void mandel_z_power_ref_pt(const std::complex<double> &center, std::complex<doub
 void mandel_z_power_ref_pt_bf(const math::BFComplex &center, math::BFComplex &z);
 void mandel_z_power_perturb(
     const std::complex<double> &ref, std::complex<double> &delta_n, const std::complex<double> &delta0);
+void mandel_z_power_perturb_fe(
+    const std::complex<double> &ref, math::FloatExpComplex &delta_n, const math::FloatExpComplex &delta0);
 
 int mandel_z_to_z_plus_z_pwr_orbit();
 
@@ -10,10 +10,15 @@ namespace id::fractals
 extern double g_population;
 extern double g_rate;
 
-inline bool population_exceeded()
+inline bool population_exceeded(const double population)
 {
     constexpr double LIMIT{100000.0};
-    return std::abs(g_population) > LIMIT;
+    return std::abs(population) > LIMIT;
+}
+
+inline bool population_exceeded()
+{
+    return population_exceeded(g_population);
 }
 
 inline int population_orbit()
@@ -21,7 +21,9 @@ enum class RayTraceFormat
     MTV = 4,
     RAYSHADE = 5,
     ACROSPIN = 6,
-    DXF = 7
+    DXF = 7,
+    PLY = 8, // binary meshes
+    STL = 9
 };
 
 constexpr int BAD_VALUE{-10000}; // set bad values to this
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include <config/port.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace id::geometry
+{
+
+enum class MeshFormat
+{
+    PLY = 0, // binary little endian PLY with shared vertices
+    STL = 1  // binary STL
+};
+
+// Writes through a large buffer to a file opened elsewhere.
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(std::size_t size = 1U << 20U);
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter(BufferedWriter &&) = delete;
+    ~BufferedWriter() = default;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(BufferedWriter &&) = delete;
+
+    void attach(std::FILE *file);
+    void write(const void *data, std::size_t size);
+    void write_u8(Byte value);
+    void write_u32(std::uint32_t value);
+    void write_f32(float value);
+    // Returns false if any write failed.
+    bool flush();
+
+private:
+    std::FILE *m_file{};
+    std::vector<Byte> m_buffer;
+    std::size_t m_used{};
+    bool m_failed{};
+};
+
+struct MeshVertex
+{
+    std::array<float, 3> pos;
+    std::array<Byte, 3> rgb;
+};
+
+// A corner of a triangle: a point of the current or the previous row of the
+// height field, identified by its column.
+struct MeshCorner
+{
+    bool previous_row;
+    int col;
+    MeshVertex vertex;
+};
+
+// Streams a triangle mesh built a row at a time.  PLY files index each point
+// once, however many triangles share it across adjacent rows; the faces are
+// spooled to a temporary file and appended to the vertices when the mesh is
+// closed.  The element counts in the header are filled in on close.
+class MeshWriter
+{
+public:
+    MeshWriter() = default;
+    MeshWriter(const MeshWriter &) = delete;
+    MeshWriter(MeshWriter &&) = delete;
+    ~MeshWriter();
+    MeshWriter &operator=(const MeshWriter &) = delete;
+    MeshWriter &operator=(MeshWriter &&) = delete;
+
+    bool open(const std::filesystem::path &path, MeshFormat format, int width, bool colors,
+        const std::string &comment);
+    // The current row becomes the previous row.
+    void next_row();
+    void triangle(const MeshCorner &c1, const MeshCorner &c2, const MeshCorner &c3);
+    // Returns false if the mesh could not be written completely.
+    bool close();
+
+    std::uint32_t num_vertices() const
+    {
+        return m_num_vertices;
+    }
+    std::uint32_t num_faces() const
+    {
+        return m_num_faces;
+    }
+
+private:
+    static constexpr std::uint32_t NO_VERTEX{0xFFFFFFFFU};
+
+    std::uint32_t vertex_index(const MeshCorner &corner);
+    bool patch_count(long offset, std::uint32_t count, bool text);
+
+    MeshFormat m_format{};
+    bool m_colors{};
+    std::FILE *m_file{};
+    std::FILE *m_faces_file{};
+    BufferedWriter m_out;
+    BufferedWriter m_faces;
+    std::vector<std::uint32_t> m_row;
+    std::vector<std::uint32_t> m_previous_row;
+    long m_vertex_count_offset{};
+    long m_face_count_offset{};
+    std::uint32_t m_num_vertices{};
+    std::uint32_t m_num_faces{};
+};
+
+} // namespace id::geometry
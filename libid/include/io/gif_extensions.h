@@ -22,7 +22,7 @@ namespace id::io
 enum
 {
     FRACTAL_INFO_VERSION_LEGACY_20_4 = 17,
-    FRACTAL_INFO_VERSION = 18
+    FRACTAL_INFO_VERSION = 19
     // file version, independent of system
     // increment this EVERY time the fractal_info structure changes
 };
@@ -41,7 +41,7 @@ static_assert(sizeof(double) == sizeof(std::uint64_t));
 
 enum
 {
-    NUM_FRACTAL_INFO_FUTURE = 5
+    NUM_FRACTAL_INFO_FUTURE = 4
 };
 
 // for saving data in GIF file
@@ -162,6 +162,7 @@ struct FractalInfo
     std::uint8_t version_minor;    //
     std::uint8_t version_patch;    //
     std::uint8_t version_tweak;    //
+    std::int16_t julibrot_coarse_step; // version 19, Iterated Dynamics 1.5
     std::int16_t future[NUM_FRACTAL_INFO_FUTURE]; //
 } ID_PACKED;
 
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include <config/port.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace id::io
+{
+
+// Pixels of one horizontal strip of an image compressed as GIF LZW codes,
+// starting from an empty string table as if just after a clear code.
+// Strips compressed independently can be written one after another with a
+// clear code before each, so they can be compressed concurrently.
+struct LzwStrip
+{
+    std::vector<Byte> bits;     // codes, packed least significant bit first
+    std::uint64_t num_bits{};   //
+    int end_code_size{};        // code size in effect after the last code
+};
+
+// Compresses count color indices of min_code_size bits into strip, with
+// the same string table and code sizes as the serial encoder.
+void lzw_compress_strip(const Byte *pixels, std::size_t count, int min_code_size, LzwStrip &strip);
+
+// Writes strips to file as GIF image data sub-blocks, a clear code ahead
+// of each strip and the end of information code after the last one.  The
+// sub-blocks are gathered in memory and written in large pieces.  The
+// caller writes the LZW minimum code size before and the block
+// terminator after.
+class GifStripWriter
+{
+public:
+    GifStripWriter(std::FILE *file, int min_code_size);
+    GifStripWriter(const GifStripWriter &) = delete;
+    GifStripWriter(GifStripWriter &&) = delete;
+    ~GifStripWriter() = default;
+    GifStripWriter &operator=(const GifStripWriter &) = delete;
+    GifStripWriter &operator=(GifStripWriter &&) = delete;
+
+    void put_strip(const LzwStrip &strip);
+    // Writes the end of information code and everything pending; returns
+    // false on a write error.
+    bool finish();
+
+private:
+    void put_code(std::uint32_t code, int size);
+    void put_byte(Byte value);
+    bool flush_blocks();
+
+    std::FILE *m_file;
+    int m_min_code_size;
+    int m_code_size;
+    std::uint64_t m_accum{};
+    int m_accum_bits{};
+    std::vector<Byte> m_blocks; // complete sub-blocks not yet written
+    Byte m_block[255]{};
+    int m_block_len{};
+    bool m_ok{true};
+};
+
+} // namespace id::io
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+
+namespace id::engine
+{
+struct RenderedTile;
+}
+
+namespace id::io
+{
+
+// File named by iterdata=, written with the tiledgif= image; empty for none.
+extern std::filesystem::path g_iteration_data_filename;
+
+// An iteration data file holds the uncolored orbit data of each pixel as
+// planes of 32 bit values, so an image can be recolored or post-processed
+// without computing it again.  All values are little endian.
+//
+//   header  "IDITDATA", version, width, height, max iterations,
+//           plane count, then the kind of each plane (uint32 each)
+//   tile    "TILE", left, top, width, height (uint32 each), then each
+//           plane's width * height values in row order
+//   end     "END", 0
+enum class IterationPlane : std::uint32_t
+{
+    ITERATIONS = 1, // uint32 iteration count
+    SMOOTH = 2,     // float32 continuous iteration count
+    Z_REAL = 3,     // float32 real part of the final z
+    Z_IMAG = 4,     // float32 imaginary part of the final z
+};
+
+constexpr std::uint32_t ITERATION_DATA_VERSION{1};
+
+bool write_iteration_data_header(std::FILE *file, int width, int height, long max_iterations);
+bool write_iteration_data_tile(std::FILE *file, const engine::RenderedTile &tile);
+bool write_iteration_data_end(std::FILE *file);
+
+} // namespace id::io
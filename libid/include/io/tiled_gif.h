@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#pragma once
+
+#include <filesystem>
+
+namespace id::io
+{
+
+// Renders the current image at the size set by tiledgif=, writing each
+// tile to path as an image block of a multi-image GIF as soon as it is
+// computed.  When iterdata= names a file, the orbit data of each tile is
+// written to it as well.  Returns false when interrupted or when path
+// can't be written.
+bool write_tiled_gif(const std::filesystem::path &path);
+
+} // namespace id::io
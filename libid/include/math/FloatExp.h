@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+// Extended exponent floating point: a double mantissa with a separate
+// int binary exponent, for values far outside the range of a double.
+//
+#pragma once
+
+#include "math/cmplx.h"
+
+#include <climits>
+#include <cmath>
+
+namespace id::math
+{
+
+class FloatExp
+{
+public:
+    FloatExp() = default;
+
+    // implicit so formulas can mix double and FloatExp operands
+    FloatExp(const double value) // NOLINT(google-explicit-constructor)
+    {
+        set(value, 0);
+    }
+
+    // mantissa * 2^exponent
+    FloatExp(const double mantissa, const int exponent)
+    {
+        set(mantissa, exponent);
+    }
+
+    double mantissa() const
+    {
+        return m_mantissa;
+    }
+
+    int exponent() const
+    {
+        return m_exponent;
+    }
+
+    bool is_zero() const
+    {
+        return m_mantissa == 0.0;
+    }
+
+    // underflows to zero or overflows to infinity outside the range of a double
+    double to_double() const
+    {
+        if (m_exponent < MIN_DOUBLE_EXPONENT)
+        {
+            return 0.0 * m_mantissa;
+        }
+        if (m_exponent > MAX_DOUBLE_EXPONENT)
+        {
+            return m_mantissa * HUGE_VAL;
+        }
+        return std::ldexp(m_mantissa, m_exponent);
+    }
+
+    FloatExp operator-() const
+    {
+        FloatExp result{*this};
+        result.m_mantissa = -result.m_mantissa;
+        return result;
+    }
+
+    FloatExp &operator+=(const FloatExp &rhs)
+    {
+        *this = *this + rhs;
+        return *this;
+    }
+
+    FloatExp &operator-=(const FloatExp &rhs)
+    {
+        *this = *this + -rhs;
+        return *this;
+    }
+
+    FloatExp &operator*=(const FloatExp &rhs)
+    {
+        set(m_mantissa * rhs.m_mantissa, m_exponent + rhs.m_exponent);
+        return *this;
+    }
+
+    FloatExp &operator/=(const FloatExp &rhs)
+    {
+        set(m_mantissa / rhs.m_mantissa, m_exponent - rhs.m_exponent);
+        return *this;
+    }
+
+    friend FloatExp operator+(const FloatExp &lhs, const FloatExp &rhs)
+    {
+        if (rhs.is_zero())
+        {
+            return lhs;
+        }
+        if (lhs.is_zero())
+        {
+            return rhs;
+        }
+        const int shift{lhs.m_exponent - rhs.m_exponent};
+        if (shift > MANTISSA_BITS)
+        {
+            return lhs;
+        }
+        if (shift < -MANTISSA_BITS)
+        {
+            return rhs;
+        }
+        return shift >= 0 ? FloatExp{lhs.m_mantissa + std::ldexp(rhs.m_mantissa, -shift), lhs.m_exponent}
+                          : FloatExp{std::ldexp(lhs.m_mantissa, shift) + rhs.m_mantissa, rhs.m_exponent};
+    }
+
+    friend FloatExp operator-(const FloatExp &lhs, const FloatExp &rhs)
+    {
+        return lhs + -rhs;
+    }
+
+    friend FloatExp operator*(FloatExp lhs, const FloatExp &rhs)
+    {
+        lhs *= rhs;
+        return lhs;
+    }
+
+    friend FloatExp operator/(FloatExp lhs, const FloatExp &rhs)
+    {
+        lhs /= rhs;
+        return lhs;
+    }
+
+    friend bool operator==(const FloatExp &lhs, const FloatExp &rhs)
+    {
+        return lhs.m_mantissa == rhs.m_mantissa && (lhs.m_exponent == rhs.m_exponent || lhs.is_zero());
+    }
+
+    friend bool operator!=(const FloatExp &lhs, const FloatExp &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator<(const FloatExp &lhs, const FloatExp &rhs)
+    {
+        return (lhs - rhs).m_mantissa < 0.0;
+    }
+
+    friend bool operator>(const FloatExp &lhs, const FloatExp &rhs)
+    {
+        return rhs < lhs;
+    }
+
+    friend bool operator<=(const FloatExp &lhs, const FloatExp &rhs)
+    {
+        return (lhs - rhs).m_mantissa <= 0.0;
+    }
+
+    friend bool operator>=(const FloatExp &lhs, const FloatExp &rhs)
+    {
+        return rhs <= lhs;
+    }
+
+    friend FloatExp abs(FloatExp value)
+    {
+        value.m_mantissa = std::abs(value.m_mantissa);
+        return value;
+    }
+
+    friend FloatExp sqrt(const FloatExp &value)
+    {
+        if (value.is_zero())
+        {
+            return value;
+        }
+        // halve an even exponent so the mantissa keeps its precision
+        const int odd{value.m_exponent & 1};
+        return {std::sqrt(std::ldexp(value.m_mantissa, odd)), (value.m_exponent - odd) / 2};
+    }
+
+private:
+    static constexpr int MANTISSA_BITS{64};
+    static constexpr int MIN_DOUBLE_EXPONENT{-1074};
+    static constexpr int MAX_DOUBLE_EXPONENT{1024};
+    static constexpr int ZERO_EXPONENT{INT_MIN / 4};
+
+    // keeps |mantissa| in [0.5, 1) so exponents compare directly
+    void set(const double mantissa, const int exponent)
+    {
+        if (mantissa == 0.0 || !std::isfinite(mantissa))
+        {
+            m_mantissa = mantissa;
+            m_exponent = mantissa == 0.0 ? ZERO_EXPONENT : exponent;
+            return;
+        }
+        int shift;
+        m_mantissa = std::frexp(mantissa, &shift);
+        m_exponent = exponent + shift;
+    }
+
+    double m_mantissa{};
+    int m_exponent{ZERO_EXPONENT};
+};
+
+using FloatExpComplex = Complex<FloatExp>;
+
+inline FloatExp mag_squared(const FloatExpComplex &z)
+{
+    return z.x * z.x + z.y * z.y;
+}
+
+inline FloatExpComplex operator*(const FloatExpComplex &lhs, const FloatExpComplex &rhs)
+{
+    return {lhs.x * rhs.x - lhs.y * rhs.y, lhs.x * rhs.y + lhs.y * rhs.x};
+}
+
+} // namespace id::math
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "math/cmplx.h"
+#include "math/FloatExp.h"
 #include "misc/sized_types.h"
 
 #include <config/port.h>
@@ -111,6 +112,8 @@ BigFloat copy_bf(BigFloat r, BigFloat n);
 BigFloat float_to_bf(BigFloat r, LDouble f);
 BigFloat float_to_bf1(BigFloat r, LDouble f);
 LDouble bf_to_float(BigFloat n);
+BigFloat float_exp_to_bf(BigFloat r, const FloatExp &f);
+FloatExp bf_to_float_exp(BigFloat n);
 LDouble bn_to_float(BigNum n);
 LDouble extract256(LDouble f, int *exp_ptr);
 LDouble scale256(LDouble f, int n);
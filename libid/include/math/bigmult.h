@@ -0,0 +1,15 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+// Magnitude multiplication for the big number routines.
+//
+#pragma once
+
+namespace id::math
+{
+
+// Operands are unsigned little endian byte strings of length bytes; the
+// product r is 2*length bytes and may overlap the operands.
+void mult_magnitudes(unsigned char *r, const unsigned char *n1, const unsigned char *n2, int length);
+void square_magnitude(unsigned char *r, const unsigned char *n, int length);
+
+} // namespace id::math
@@ -42,6 +42,15 @@ enum class Buzzer
  * redraw
  * read_palette, write_palette
  * read_pixel, write_pixel
+ * read_span, write_span
+ * Read or write the pixels [x, last_x] of row y, one byte per pixel.  The
+ * default implementations go through read_pixel and write_pixel; drivers
+ * that keep the screen in memory should copy the whole row at once.
+ *
+ * read_rect, write_rect
+ * Read or write a width by height block of pixels at (x, y), one byte per
+ * pixel in row order.  The defaults go a span at a time.
+ *
  * draw_line
  * get_key
  * key_cursor
@@ -79,6 +88,10 @@ public:
     virtual void write_palette() = 0;                                         // write g_dac_box into palette
     virtual int read_pixel(int x, int y) = 0;                                 // reads a single pixel
     virtual void write_pixel(int x, int y, int color) = 0;                    // writes a single pixel
+    virtual void read_span(int y, int x, int last_x, Byte *pixels);           // reads a row of pixels
+    virtual void write_span(int y, int x, int last_x, const Byte *pixels);    // writes a row of pixels
+    virtual void read_rect(int x, int y, int width, int height, Byte *pixels);        // reads a block of pixels
+    virtual void write_rect(int x, int y, int width, int height, const Byte *pixels); // writes a block of pixels
     virtual void draw_line(int x1, int y1, int x2, int y2, int color) = 0;    // draw line
     virtual void draw_xor_line(int x1, int y1, int x2, int y2) = 0;           // draw transient xor line
     virtual void clear_xor_lines() = 0;                                       // restore transient xor lines
@@ -177,6 +190,26 @@ inline void driver_write_pixel(const int x, const int y, const int color)
     g_driver->write_pixel(x, y, color);
 }
 
+inline void driver_read_span(const int y, const int x, const int last_x, Byte *pixels)
+{
+    g_driver->read_span(y, x, last_x, pixels);
+}
+
+inline void driver_write_span(const int y, const int x, const int last_x, const Byte *pixels)
+{
+    g_driver->write_span(y, x, last_x, pixels);
+}
+
+inline void driver_read_rect(const int x, const int y, const int width, const int height, Byte *pixels)
+{
+    g_driver->read_rect(x, y, width, height, pixels);
+}
+
+inline void driver_write_rect(const int x, const int y, const int width, const int height, const Byte *pixels)
+{
+    g_driver->write_rect(x, y, width, height, pixels);
+}
+
 inline void driver_draw_line(const int x1, const int y1, const int x2, const int y2, const int color)
 {
     g_driver->draw_line(x1, y1, x2, y2, color);
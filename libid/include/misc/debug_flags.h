@@ -13,6 +13,7 @@ enum class DebugFlags
     FORCE_STANDARD_FRACTAL              = 90,
     FORCE_REAL_POPCORN                  = 96,
     WRITE_FORMULA_DEBUG_INFORMATION     = 98,
+    FORCE_FORMULA_INTERPRETER           = 99,
     ALLOW_INIT_COMMANDS_ANYTIME         = 110,
     PREVENT_MIIM                        = 300,
     SHOW_FORMULA_INFO_AFTER_COMPILE     = 324,
@@ -36,6 +36,9 @@ struct MemoryHandle
 // TODO: Get rid of this and use regular memory routines;
 // see about creating standard disk memory routines for disk video
 MemoryLocation memory_type(MemoryHandle handle);
+// Address of the memory for handle when it can be accessed directly, as for
+// heap memory or a mapped disk file, otherwise nullptr.
+Byte *memory_address(MemoryHandle handle);
 void init_memory();
 void exit_check();
 MemoryHandle memory_alloc(U16 size, std::uint64_t count, MemoryLocation stored_at);
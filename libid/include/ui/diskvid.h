@@ -30,6 +30,8 @@ const std::filesystem::path &targa_disk_path();
 void end_disk();
 int disk_read_pixel(int col, int row);
 void disk_write_pixel(int col, int row, int color);
+void disk_read_span(int row, int col, int last_col, Byte *pixels);
+void disk_write_span(int row, int col, int last_col, const Byte *pixels);
 void targa_read_disk(unsigned int col, unsigned int row, Byte *red, Byte *green, Byte *blue);
 void targa_write_disk(unsigned int col, unsigned int row, Byte red, Byte green, Byte blue);
 void dvid_status(int line, const char *msg);
@@ -40,6 +42,9 @@ inline void dvid_status(const int line, const std::string &msg)
 bool disk_video_memory_blocks(std::int64_t row_size, std::int64_t col_size, int colors, int header_length,
     std::uint64_t &blocks);
 id::misc::MemoryLocation disk_video_memory_type();
+// True when pixels are addressed in heap memory or a mapped file rather
+// than through the block cache.
+bool disk_video_direct();
 int common_start_disk(std::int64_t new_row_size, std::int64_t new_col_size, int colors);
 bool from_mem_disk(std::int64_t offset, int size, void *dest);
 bool to_mem_disk(std::int64_t offset, int size, const void *src);
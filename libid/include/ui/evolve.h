@@ -144,6 +144,9 @@ void set_mutation_level(int strength);
 void draw_param_box(int mode);
 void spiral_map(int count);
 int unspiral_map();
+// Renders the evolver grid from sub image count on; returns the number of
+// sub images completed, which is less than the grid size when interrupted.
+int calc_evolve_grid(GeneBase gene[NUM_GENES], int count);
 void setup_param_box();
 void release_param_box();
 
@@ -9,7 +9,7 @@ namespace id::ui
 
 extern bool g_tab_enabled; // tab display enabled
 
-std::string perturbation_status_text(int reference_count);
+std::string perturbation_status_text(int reference_count, int skipped_iterations = 0);
 int tab_display();
 
 } // namespace id::ui
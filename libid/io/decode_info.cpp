@@ -463,6 +463,7 @@ void decode_fractal_info_big_endian(FractalInfo &info)
     info.version_minor = decode_uint8(&buf_ptr);
     info.version_patch = decode_uint8(&buf_ptr);
     info.version_tweak = decode_uint8(&buf_ptr);
+    info.julibrot_coarse_step = decode_int16(&buf_ptr);
 
     for (int i = 0; i < sizeof(info.future) / sizeof(short); i++) // NOLINT(modernize-loop-convert)
     {
@@ -613,6 +614,7 @@ void encode_fractal_info_big_endian(FractalInfo &info)
     encode_uint8(info.version_minor, &buf_ptr);
     encode_uint8(info.version_patch, &buf_ptr);
     encode_uint8(info.version_tweak, &buf_ptr);
+    encode_int16(info.julibrot_coarse_step, &buf_ptr);
 
     for (int i = 0; i < sizeof(info.future) / sizeof(short); i++) // NOLINT(modernize-loop-convert)
     {
@@ -22,6 +22,7 @@
 #include "engine/solid_guess.h"
 #include "engine/spindac.h"
 #include "engine/sticky_orbits.h"
+#include "engine/TileScheduler.h"
 #include "engine/trig_fns.h"
 #include "engine/UserData.h"
 #include "engine/VideoInfo.h"
@@ -39,6 +40,7 @@
 #include "io/check_write_file.h"
 #include "io/decode_info.h"
 #include "io/gif_extensions.h"
+#include "io/gif_lzw.h"
 #include "io/is_writeable.h"
 #include "io/library.h"
 #include "io/loadfile.h"
@@ -69,6 +71,7 @@
 #include <limits>
 #include <string>
 #include <string_view>
+#include <vector>
 
 using namespace id::engine;
 using namespace id::fractals;
@@ -96,6 +99,11 @@ static int s_out_color_1s{};
 static int s_out_color_2s{};
 static int s_start_bits{};
 
+// GIF image pixels compressed together as one strip of rows.
+static constexpr std::size_t STRIP_PIXELS{256 * 1024};
+// Strips handed to the tile scheduler per band of rows read.
+static constexpr int STRIPS_PER_WORKER_PER_BAND{2};
+
 // B&W palette
 static constexpr Byte s_palette_bw[]{
     0, 0, 0,    //
@@ -923,6 +931,7 @@ void setup_save_info(FractalInfo *save_info)
     save_info->julibrot_y_max = g_julibrot_y_max;
     save_info->julibrot_y_min = g_julibrot_y_min;
     save_info->julibrot_z_dots = static_cast<std::int16_t>(g_julibrot_z_dots);
+    save_info->julibrot_coarse_step = static_cast<std::int16_t>(g_julibrot_coarse_step);
     save_info->julibrot_origin_fp = g_julibrot_origin;
     save_info->julibrot_depth_fp = g_julibrot_depth;
     save_info->julibrot_height_fp = g_julibrot_height;
@@ -1058,6 +1067,101 @@ static int s_cur_bits{};
 //
 static char s_accum[256]{};
 
+// Reads row y_dot of the image a span at a time; rows below the screen
+// hold the second half of 16 bit continuous potential in disk video.
+static void read_row(const int y_dot, Byte *pixels)
+{
+    if (s_save_16bit == 0 || y_dot < g_logical_screen.y_dots)
+    {
+        // pixels off the screen read as 0, as for get_color()
+        std::fill_n(pixels, g_logical_screen.x_dots, Byte{});
+        if (const int width = std::min(g_logical_screen.x_dots, g_screen_x_dots - g_logical_screen.x_offset);
+            width > 0)
+        {
+            read_span(y_dot, 0, width - 1, pixels);
+        }
+    }
+    else
+    {
+        disk_read_span(y_dot + g_logical_screen.y_offset, g_logical_screen.x_offset,
+            g_logical_screen.x_offset + g_logical_screen.x_dots - 1, pixels);
+    }
+}
+
+// Draws the progress bars at the ends of row y_dot once it has been read.
+static void show_save_progress(const int y_dot, int &out_color1, int &out_color2)
+{
+    if (driver_is_disk()) // supress this on disk-video
+    {
+        return;
+    }
+    if ((y_dot & 4) == 0)
+    {
+        if (++out_color1 >= g_colors)
+        {
+            out_color1 = 0;
+        }
+        if (++out_color2 >= g_colors)
+        {
+            out_color2 = 0;
+        }
+    }
+    for (int i = 0; 250*i < g_logical_screen.x_dots; i++)
+    {
+        // display vert status bars
+        // (this is NOT GIF-related)
+        g_put_color(i, y_dot, get_color(i, y_dot) ^ out_color1);
+        g_put_color(g_logical_screen.x_dots - 1 - i, y_dot,
+                 get_color(g_logical_screen.x_dots - 1 - i, y_dot) ^ out_color2);
+    }
+    s_last_color_bar = y_dot;
+}
+
+// Reads the image a band of rows at a time and compresses each band as
+// strips on the tile scheduler, each strip starting with a clear code.
+static void compress_strips(const int row_limit, int out_color1, int out_color2)
+{
+    const int x_dots{g_logical_screen.x_dots};
+    const int y_dots{g_logical_screen.y_dots};
+    const std::size_t row_width{static_cast<std::size_t>(x_dots) * (row_limit > y_dots ? 2 : 1)};
+    const int strip_rows{std::max(1, static_cast<int>(STRIP_PIXELS / row_width))};
+    TileScheduler &scheduler{tile_scheduler()};
+    const int band_strips{static_cast<int>(scheduler.num_workers()) * STRIPS_PER_WORKER_PER_BAND};
+    const int band_rows{std::min(band_strips * strip_rows, y_dots)};
+    std::vector<Byte> pixels(band_rows * row_width);
+    std::vector<LzwStrip> strips(band_strips);
+    GifStripWriter writer{s_outfile, s_start_bits - 1};
+    for (int first = 0; first < y_dots; first += band_rows)
+    {
+        const int rows{std::min(band_rows, y_dots - first)};
+        for (int row = 0; row < rows; ++row)
+        {
+            const int row_num{first + row};
+            Byte *row_pixels{&pixels[row * row_width]};
+            for (int y_dot = row_num; y_dot < row_limit; y_dot += y_dots, row_pixels += x_dots)
+            {
+                read_row(y_dot, row_pixels);
+            }
+            show_save_progress(row_num, out_color1, out_color2);
+        }
+        const int count{(rows + strip_rows - 1) / strip_rows};
+        scheduler.run(count,
+            [&](const int strip, unsigned)
+            {
+                const int top{strip * strip_rows};
+                const int height{std::min(strip_rows, rows - top)};
+                lzw_compress_strip(&pixels[top * row_width], height * row_width, s_start_bits - 1, strips[strip]);
+            });
+        for (int i = 0; i < count; ++i)
+        {
+            writer.put_strip(strips[i]);
+        }
+    }
+    // write errors are reported by the caller's ferror()
+    writer.finish();
+    std::fflush(s_outfile);
+}
+
 static bool compress(const int row_limit)
 {
     int color;
@@ -1083,6 +1187,12 @@ static bool compress(const int row_limit)
     s_out_color_1s = out_color1;
     s_out_color_2s = out_color2;
 
+    if (tile_scheduler().num_workers() > 1)
+    {
+        compress_strips(row_limit, out_color1, out_color2);
+        return interrupted;
+    }
+
     // Set up the necessary values
     s_cur_accum = 0;
     s_cur_bits = 0;
@@ -1107,21 +1217,17 @@ static bool compress(const int row_limit)
 
     output(s_clear_code);
 
+    std::vector<Byte> pixels(g_logical_screen.x_dots);
+
     for (int row_num = 0; row_num < g_logical_screen.y_dots; row_num++)
     {
         // scan through the dots
         for (int y_dot = row_num; y_dot < row_limit; y_dot += g_logical_screen.y_dots)
         {
+            read_row(y_dot, pixels.data());
             for (int x_dot = 0; x_dot < g_logical_screen.x_dots; x_dot++)
             {
-                if (s_save_16bit == 0 || y_dot < g_logical_screen.y_dots)
-                {
-                    color = get_color(x_dot, y_dot);
-                }
-                else
-                {
-                    color = disk_read_pixel(x_dot + g_logical_screen.x_offset, y_dot + g_logical_screen.y_offset);
-                }
+                color = pixels[x_dot];
                 if (in_count == 0)
                 {
                     in_count = 1;
@@ -1175,30 +1281,10 @@ no_match:
                     cl_block();
                 }
             } // end for xdot
-            if (! driver_is_disk()       // supress this on disk-video
-                && y_dot == row_num)
+            if (y_dot == row_num)
             {
-                if ((y_dot & 4) == 0)
-                {
-                    if (++out_color1 >= g_colors)
-                    {
-                        out_color1 = 0;
-                    }
-                    if (++out_color2 >= g_colors)
-                    {
-                        out_color2 = 0;
-                    }
-                }
-                for (int i = 0; 250*i < g_logical_screen.x_dots; i++)
-                {
-                    // display vert status bars
-                    // (this is NOT GIF-related)
-                    g_put_color(i, y_dot, get_color(i, y_dot) ^ out_color1);
-                    g_put_color(g_logical_screen.x_dots - 1 - i, y_dot,
-                             get_color(g_logical_screen.x_dots - 1 - i, y_dot) ^ out_color2);
-                }
-                s_last_color_bar = y_dot;
-            } // end if !driver_diskp()
+                show_save_progress(y_dot, out_color1, out_color2);
+            }
         } // end for ydot
     } // end for rownum
 
@@ -406,6 +406,7 @@ FractalInfo get_fractal_info(GifFileType *gif)
     result.version_minor = deser.extract_byte();
     result.version_patch = deser.extract_byte();
     result.version_tweak = deser.extract_byte();
+    result.julibrot_coarse_step = deser.extract_int16();
     {
         // TODO: error: cannot bind packed field
         std::int16_t future[NUM_FRACTAL_INFO_FUTURE];
@@ -660,6 +661,7 @@ void put_fractal_info(GifFileType *gif, const FractalInfo &info)
     ser.insert_byte(info.version_minor);
     ser.insert_byte(info.version_patch);
     ser.insert_byte(info.version_tweak);
+    ser.insert_int16(info.julibrot_coarse_step);
     for (int16_t zero : info.future)
     {
         zero = 0;
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+// GIF LZW compression of image strips.
+//
+// lzw_compress_strip() is the 'compress' based hash table LZW of the
+// serial encoder in encoder.cpp, working on a buffer of pixels with its
+// own string table so that strips can be compressed on several threads.
+//
+#include "io/gif_lzw.h"
+
+#include <algorithm>
+
+namespace id::io
+{
+
+enum
+{
+    MAX_BITS = 12,
+    MAX_MAX_CODE = 1 << MAX_BITS, // should NEVER generate this code
+    H_SIZE = 5003                 // 80% occupancy
+};
+
+// Sub-block bytes gathered before they are written.
+static constexpr std::size_t WRITE_LEN{64 * 1024};
+
+static constexpr int max_code(const int n_bits)
+{
+    return (1 << n_bits) - 1;
+}
+
+namespace
+{
+
+class StripCompressor
+{
+public:
+    StripCompressor(int min_code_size, LzwStrip &strip);
+
+    void compress(const Byte *pixels, std::size_t count);
+
+private:
+    void output(int code);
+    void clear_block();
+
+    LzwStrip &m_strip;
+    int m_start_bits;
+    int m_n_bits;
+    int m_max_code;
+    int m_clear_code;
+    int m_free_ent;
+    bool m_clear_flag{};
+    std::uint64_t m_accum{};
+    int m_accum_bits{};
+    std::vector<long> m_h_tab;
+    std::vector<unsigned short> m_code_tab;
+};
+
+} // namespace
+
+StripCompressor::StripCompressor(const int min_code_size, LzwStrip &strip) :
+    m_strip(strip),
+    m_start_bits(min_code_size + 1),
+    m_n_bits(m_start_bits),
+    m_max_code(max_code(m_n_bits)),
+    m_clear_code(1 << min_code_size),
+    m_free_ent(m_clear_code + 2),
+    m_h_tab(H_SIZE, -1),
+    m_code_tab(H_SIZE)
+{
+    m_strip.bits.clear();
+    m_strip.num_bits = 0;
+}
+
+void StripCompressor::compress(const Byte *pixels, const std::size_t count)
+{
+    int h_shift = 0;
+    for (long f_code = H_SIZE; f_code < 65536L; f_code *= 2L)
+    {
+        h_shift++;
+    }
+    h_shift = 8 - h_shift; // set hash code range bound
+
+    int ent = count > 0 ? pixels[0] : 0;
+    for (std::size_t n = 1; n < count; ++n)
+    {
+        const int color = pixels[n];
+        const long f_code = (static_cast<long>(color) << MAX_BITS) + ent;
+        int i = color << h_shift ^ ent; // xor hashing
+        if (m_h_tab[i] == f_code)
+        {
+            ent = m_code_tab[i];
+            continue;
+        }
+        if (m_h_tab[i] >= 0) // occupied slot, probe
+        {
+            const int disp = i == 0 ? 1 : H_SIZE - i; // secondary hash (after G. Knott)
+            bool found = false;
+            do
+            {
+                if ((i -= disp) < 0)
+                {
+                    i += H_SIZE;
+                }
+                if (m_h_tab[i] == f_code)
+                {
+                    found = true;
+                    break;
+                }
+            } while (m_h_tab[i] > 0);
+            if (found)
+            {
+                ent = m_code_tab[i];
+                continue;
+            }
+        }
+        output(ent);
+        ent = color;
+        if (m_free_ent < MAX_MAX_CODE)
+        {
+            // code -> hashtable
+            m_code_tab[i] = static_cast<unsigned short>(m_free_ent++);
+            m_h_tab[i] = f_code;
+        }
+        else
+        {
+            clear_block();
+        }
+    }
+    if (count > 0)
+    {
+        output(ent);
+    }
+
+    // pad the last byte
+    while (m_accum_bits > 0)
+    {
+        m_strip.bits.push_back(static_cast<Byte>(m_accum & 0xff));
+        m_accum >>= 8;
+        m_accum_bits -= 8;
+    }
+    m_strip.end_code_size = m_n_bits;
+}
+
+// As output() in encoder.cpp, but packing into the strip.
+void StripCompressor::output(const int code)
+{
+    m_accum |= static_cast<std::uint64_t>(code) << m_accum_bits;
+    m_accum_bits += m_n_bits;
+    m_strip.num_bits += m_n_bits;
+    while (m_accum_bits >= 8)
+    {
+        m_strip.bits.push_back(static_cast<Byte>(m_accum & 0xff));
+        m_accum >>= 8;
+        m_accum_bits -= 8;
+    }
+
+    // If the next entry is going to be too big for the code size,
+    // then increase it, if possible.
+    if (m_free_ent > m_max_code || m_clear_flag)
+    {
+        if (m_clear_flag)
+        {
+            m_n_bits = m_start_bits;
+            m_max_code = max_code(m_n_bits);
+            m_clear_flag = false;
+        }
+        else
+        {
+            m_n_bits++;
+            m_max_code = m_n_bits == MAX_BITS ? MAX_MAX_CODE : max_code(m_n_bits);
+        }
+    }
+}
+
+void StripCompressor::clear_block()
+{
+    std::fill(m_h_tab.begin(), m_h_tab.end(), -1);
+    m_free_ent = m_clear_code + 2;
+    m_clear_flag = true;
+    output(m_clear_code);
+}
+
+void lzw_compress_strip(const Byte *pixels, const std::size_t count, const int min_code_size, LzwStrip &strip)
+{
+    StripCompressor compressor{min_code_size, strip};
+    compressor.compress(pixels, count);
+}
+
+GifStripWriter::GifStripWriter(std::FILE *file, const int min_code_size) :
+    m_file(file),
+    m_min_code_size(min_code_size),
+    m_code_size(min_code_size + 1)
+{
+    m_blocks.reserve(WRITE_LEN + 256);
+}
+
+void GifStripWriter::put_strip(const LzwStrip &strip)
+{
+    // the clear code has the size left by the previous strip
+    put_code(1U << m_min_code_size, m_code_size);
+    const std::size_t whole_bytes{static_cast<std::size_t>(strip.num_bits / 8)};
+    if (m_accum_bits == 0)
+    {
+        for (std::size_t i = 0; i < whole_bytes; ++i)
+        {
+            put_byte(strip.bits[i]);
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < whole_bytes; ++i)
+        {
+            put_code(strip.bits[i], 8);
+        }
+    }
+    if (const int rest{static_cast<int>(strip.num_bits % 8)}; rest > 0)
+    {
+        put_code(strip.bits[whole_bytes] & ((1U << rest) - 1), rest);
+    }
+    m_code_size = strip.end_code_size;
+}
+
+bool GifStripWriter::finish()
+{
+    put_code((1U << m_min_code_size) + 1, m_code_size);
+    if (m_accum_bits > 0)
+    {
+        put_byte(static_cast<Byte>(m_accum & 0xff));
+        m_accum = 0;
+        m_accum_bits = 0;
+    }
+    if (m_block_len > 0)
+    {
+        m_blocks.push_back(static_cast<Byte>(m_block_len));
+        m_blocks.insert(m_blocks.end(), m_block, m_block + m_block_len);
+        m_block_len = 0;
+    }
+    return flush_blocks() && m_ok;
+}
+
+void GifStripWriter::put_code(const std::uint32_t code, const int size)
+{
+    m_accum |= static_cast<std::uint64_t>(code) << m_accum_bits;
+    m_accum_bits += size;
+    while (m_accum_bits >= 8)
+    {
+        put_byte(static_cast<Byte>(m_accum & 0xff));
+        m_accum >>= 8;
+        m_accum_bits -= 8;
+    }
+}
+
+void GifStripWriter::put_byte(const Byte value)
+{
+    m_block[m_block_len++] = value;
+    if (m_block_len == static_cast<int>(sizeof(m_block)))
+    {
+        m_blocks.push_back(static_cast<Byte>(m_block_len));
+        m_blocks.insert(m_blocks.end(), m_block, m_block + m_block_len);
+        m_block_len = 0;
+        if (m_blocks.size() >= WRITE_LEN)
+        {
+            m_ok = flush_blocks() && m_ok;
+        }
+    }
+}
+
+bool GifStripWriter::flush_blocks()
+{
+    const bool ok{m_blocks.empty() || std::fwrite(m_blocks.data(), m_blocks.size(), 1, m_file) == 1};
+    m_blocks.clear();
+    return ok;
+}
+
+} // namespace id::io
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "io/iteration_data.h"
+
+#include "engine/tiled_render.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+using namespace id::engine;
+
+namespace id::io
+{
+
+std::filesystem::path g_iteration_data_filename;
+
+static constexpr std::array PLANES{
+    IterationPlane::ITERATIONS, IterationPlane::SMOOTH, IterationPlane::Z_REAL, IterationPlane::Z_IMAG};
+
+static void put_u32(std::vector<Byte> &buffer, const std::uint32_t value)
+{
+    buffer.push_back(static_cast<Byte>(value & 0xFF));
+    buffer.push_back(static_cast<Byte>(value >> 8 & 0xFF));
+    buffer.push_back(static_cast<Byte>(value >> 16 & 0xFF));
+    buffer.push_back(static_cast<Byte>(value >> 24 & 0xFF));
+}
+
+static void put_float(std::vector<Byte> &buffer, const float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_u32(buffer, bits);
+}
+
+static void put_tag(std::vector<Byte> &buffer, const char *tag)
+{
+    buffer.insert(buffer.end(), tag, tag + std::strlen(tag));
+}
+
+static bool write_buffer(std::FILE *file, const std::vector<Byte> &buffer)
+{
+    return std::fwrite(buffer.data(), buffer.size(), 1, file) == 1;
+}
+
+bool write_iteration_data_header(std::FILE *file, const int width, const int height, const long max_iterations)
+{
+    std::vector<Byte> buffer;
+    put_tag(buffer, "IDITDATA");
+    put_u32(buffer, ITERATION_DATA_VERSION);
+    put_u32(buffer, static_cast<std::uint32_t>(width));
+    put_u32(buffer, static_cast<std::uint32_t>(height));
+    put_u32(buffer, static_cast<std::uint32_t>(max_iterations));
+    put_u32(buffer, static_cast<std::uint32_t>(PLANES.size()));
+    for (IterationPlane plane : PLANES)
+    {
+        put_u32(buffer, static_cast<std::uint32_t>(plane));
+    }
+    return write_buffer(file, buffer);
+}
+
+bool write_iteration_data_tile(std::FILE *file, const RenderedTile &tile)
+{
+    std::vector<Byte> buffer;
+    buffer.reserve(20 + tile.samples.size() * PLANES.size() * 4);
+    put_tag(buffer, "TILE");
+    put_u32(buffer, static_cast<std::uint32_t>(tile.left));
+    put_u32(buffer, static_cast<std::uint32_t>(tile.top));
+    put_u32(buffer, static_cast<std::uint32_t>(tile.width));
+    put_u32(buffer, static_cast<std::uint32_t>(tile.height));
+    for (const IterationSample &sample : tile.samples)
+    {
+        put_u32(buffer, sample.iterations);
+    }
+    for (const IterationSample &sample : tile.samples)
+    {
+        put_float(buffer, sample.smooth);
+    }
+    for (const IterationSample &sample : tile.samples)
+    {
+        put_float(buffer, sample.z_real);
+    }
+    for (const IterationSample &sample : tile.samples)
+    {
+        put_float(buffer, sample.z_imag);
+    }
+    return write_buffer(file, buffer);
+}
+
+bool write_iteration_data_end(std::FILE *file)
+{
+    std::vector<Byte> buffer;
+    put_tag(buffer, "END");
+    buffer.push_back(0);
+    return write_buffer(file, buffer);
+}
+
+} // namespace id::io
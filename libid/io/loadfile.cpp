@@ -307,7 +307,8 @@ bool operator==(const FractalInfo &lhs, const FractalInfo &rhs)
         && lhs.version_major == rhs.version_major                     //
         && lhs.version_minor == rhs.version_minor                     //
         && lhs.version_patch == rhs.version_patch                     //
-        && lhs.version_tweak == rhs.version_tweak;                    //
+        && lhs.version_tweak == rhs.version_tweak                     //
+        && lhs.julibrot_coarse_step == rhs.julibrot_coarse_step;      //
 }
 
 bool operator==(const FormulaInfo &lhs, const FormulaInfo &rhs)
@@ -758,6 +759,15 @@ static void backwards_info17(const FractalInfo &read_info)
     }
 }
 
+static void backwards_info19(const FractalInfo &read_info)
+{
+    g_julibrot_coarse_step = 1;
+    if (read_info.info_version > 18) // post-version 1.5
+    {
+        g_julibrot_coarse_step = read_info.julibrot_coarse_step;
+    }
+}
+
 bool backwards_id1_3_palette_needed(const Version &version, const Byte palette[256][3], const unsigned int colors)
 {
     const Version first_quantized_gif{1, 3, 1, 0, false};
@@ -1029,6 +1039,7 @@ int read_overlay()      // read overlay/3D files, if required
     backwards_info15();
     backwards_info16(read_info);
     backwards_info17(read_info);
+    backwards_info19(read_info);
     backwards_legacy_v18();
     backwards_legacy_v19();
     backwards_legacy_v20();
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "io/tiled_gif.h"
+
+#include "engine/calcfrac.h"
+#include "engine/spindac.h"
+#include "engine/tiled_render.h"
+#include "engine/VideoInfo.h"
+#include "io/encoder.h"
+#include "io/gif_extensions.h"
+#include "io/gif_file.h"
+#include "io/iteration_data.h"
+#include "ui/stop_msg.h"
+
+#include <fmt/format.h>
+#include <gif_lib.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <system_error>
+
+using namespace id::engine;
+using namespace id::ui;
+
+namespace id::io
+{
+
+// Smallest GIF color table holding g_colors entries.
+static int color_table_size()
+{
+    int size{2};
+    while (size < g_colors && size < 256)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+static bool write_screen(GifFileType *gif, const TiledRenderSize &size)
+{
+    std::array<GifColorType, 256> colors{};
+    const int count{color_table_size()};
+    for (int i = 0; i < count; ++i)
+    {
+        colors[i] = GifColorType{g_dac_box[i][0], g_dac_box[i][1], g_dac_box[i][2]};
+    }
+    ColorMapObject *map{GifMakeMapObject(count, colors.data())};
+    if (map == nullptr)
+    {
+        return false;
+    }
+    const bool written{EGifPutScreenDesc(gif, size.width, size.height, 8, 0, map) != GIF_ERROR};
+    GifFreeMapObject(map);
+    return written;
+}
+
+static bool write_tile(GifFileType *gif, const RenderedTile &tile)
+{
+    if (EGifPutImageDesc(gif, tile.left, tile.top, tile.width, tile.height, false, nullptr) == GIF_ERROR)
+    {
+        return false;
+    }
+    for (int row = 0; row < tile.height; ++row)
+    {
+        auto *line{const_cast<GifPixelType *>(&tile.pixels[static_cast<std::size_t>(row) * tile.width])};
+        if (EGifPutLine(gif, line, tile.width) == GIF_ERROR)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The fractal info extension, so the file restores the image's parameters
+// at its full size when loaded.
+static bool write_fractal_info(GifFileType *gif, const TiledRenderSize &size)
+{
+    FractalInfo info{};
+    setup_save_info(&info);
+    info.x_dots = static_cast<std::uint16_t>(size.width);
+    info.y_dots = static_cast<std::uint16_t>(size.height);
+    put_fractal_info(gif, info);
+
+    bool written{true};
+    for (int i = 0; written && i < gif->ExtensionBlockCount; ++i)
+    {
+        const ExtensionBlock &block{gif->ExtensionBlocks[i]};
+        if (block.Function != CONTINUE_EXT_FUNC_CODE)
+        {
+            written = (i == 0 || EGifPutExtensionTrailer(gif) != GIF_ERROR) &&
+                EGifPutExtensionLeader(gif, block.Function) != GIF_ERROR;
+        }
+        written = written && EGifPutExtensionBlock(gif, block.ByteCount, block.Bytes) != GIF_ERROR;
+    }
+    written = written && (gif->ExtensionBlockCount == 0 || EGifPutExtensionTrailer(gif) != GIF_ERROR);
+    GifFreeExtensions(&gif->ExtensionBlockCount, &gif->ExtensionBlocks);
+    return written;
+}
+
+bool write_tiled_gif(const std::filesystem::path &path)
+{
+    const TiledRenderSize &size{g_tiled_render};
+    if (const char *reason = tiled_render_ineligible_reason(); reason != nullptr)
+    {
+        stop_msg(std::string{"tiledgif: image can't be rendered in tiles: "} + reason);
+        return false;
+    }
+    constexpr int MAX_GIF_DIMENSION{std::numeric_limits<std::uint16_t>::max()};
+    if (size.width > MAX_GIF_DIMENSION || size.height > MAX_GIF_DIMENSION)
+    {
+        stop_msg(fmt::format("tiledgif: {:d} x {:d} exceeds GIF limits", size.width, size.height));
+        return false;
+    }
+
+    const std::filesystem::path &data_path{g_iteration_data_filename};
+    std::FILE *data{};
+    if (!data_path.empty())
+    {
+        data = std::fopen(data_path.string().c_str(), "wb");
+        if (data == nullptr)
+        {
+            stop_msg("Can't create " + data_path.string());
+            return false;
+        }
+    }
+
+    int error{};
+    GifFileType *gif{EGifOpenFileName(path.string().c_str(), false, &error)};
+    if (gif == nullptr)
+    {
+        stop_msg("Can't create " + path.string());
+        if (data != nullptr)
+        {
+            std::fclose(data);
+            std::error_code ignored;
+            std::filesystem::remove(data_path, ignored);
+        }
+        return false;
+    }
+    EGifSetGifVersion(gif, true);
+    bool written{write_screen(gif, size) &&
+        (data == nullptr || write_iteration_data_header(data, size.width, size.height, g_max_iterations))};
+    const bool rendered{written &&
+        tiled_render(
+            size,
+            [gif, data, &written](const RenderedTile &tile)
+            {
+                written = write_tile(gif, tile) && (data == nullptr || write_iteration_data_tile(data, tile));
+                return written;
+            },
+            data != nullptr)};
+    const bool interrupted{written && !rendered};
+    written = rendered && write_fractal_info(gif, size);
+    int close_error{};
+    written = EGifCloseFile(gif, &close_error) != GIF_ERROR && written;
+    if (data != nullptr)
+    {
+        written = written && write_iteration_data_end(data);
+        written = std::fclose(data) == 0 && written;
+    }
+    if (!written)
+    {
+        if (!interrupted)
+        {
+            stop_msg("Error writing " + path.string() + " (disk full?)");
+        }
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+        if (data != nullptr)
+        {
+            std::filesystem::remove(data_path, ignored);
+        }
+    }
+    return written;
+}
+
+} // namespace id::io
@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+// Big number multiplication on machine word limbs.
+//
+// The byte strings used by the big number routines are converted to 64-bit
+// limbs (32-bit where the compiler has no 128-bit integer), multiplied with
+// a schoolbook loop that accumulates in a double width integer, and with
+// Karatsuba's method above a size threshold.  The conversions are linear in
+// the length, so they are cheap compared to the quadratic products they
+// replace.
+//
+#include "math/bigmult.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace id::math
+{
+
+namespace
+{
+
+#if defined(__SIZEOF_INT128__)
+using Limb = std::uint64_t;
+using DoubleLimb = unsigned __int128;
+#else
+using Limb = std::uint32_t;
+using DoubleLimb = std::uint64_t;
+#endif
+
+constexpr int LIMB_BYTES{sizeof(Limb)};
+constexpr int LIMB_BITS{LIMB_BYTES * 8};
+
+// Below this many limbs the schoolbook product is faster than splitting.
+constexpr int KARATSUBA_THRESHOLD{24};
+
+void to_limbs(Limb *limbs, const int num_limbs, const unsigned char *bytes, const int length)
+{
+    for (int i = 0; i < num_limbs; ++i)
+    {
+        Limb value{};
+        for (int b = 0; b < LIMB_BYTES; ++b)
+        {
+            if (const int index{i * LIMB_BYTES + b}; index < length)
+            {
+                value |= static_cast<Limb>(bytes[index]) << (8 * b);
+            }
+        }
+        limbs[i] = value;
+    }
+}
+
+void from_limbs(unsigned char *bytes, const int length, const Limb *limbs)
+{
+    for (int index = 0; index < length; ++index)
+    {
+        bytes[index] = static_cast<unsigned char>(limbs[index / LIMB_BYTES] >> (8 * (index % LIMB_BYTES)));
+    }
+}
+
+// r[0, na + nb) = a * b
+void mult_basecase(Limb *r, const Limb *a, const int na, const Limb *b, const int nb)
+{
+    std::fill(r, r + na + nb, Limb{});
+    for (int i = 0; i < na; ++i)
+    {
+        Limb carry{};
+        for (int j = 0; j < nb; ++j)
+        {
+            const DoubleLimb sum{static_cast<DoubleLimb>(a[i]) * b[j] + r[i + j] + carry};
+            r[i + j] = static_cast<Limb>(sum);
+            carry = static_cast<Limb>(sum >> LIMB_BITS);
+        }
+        r[i + nb] = carry;
+    }
+}
+
+// r[0, 2n) = a^2, computing each cross product once and doubling
+void square_basecase(Limb *r, const Limb *a, const int n)
+{
+    std::fill(r, r + 2 * n, Limb{});
+    for (int i = 0; i < n; ++i)
+    {
+        Limb carry{};
+        for (int j = i + 1; j < n; ++j)
+        {
+            const DoubleLimb sum{static_cast<DoubleLimb>(a[i]) * a[j] + r[i + j] + carry};
+            r[i + j] = static_cast<Limb>(sum);
+            carry = static_cast<Limb>(sum >> LIMB_BITS);
+        }
+        r[i + n] = carry;
+    }
+
+    Limb top_bit{};
+    for (int i = 0; i < 2 * n; ++i)
+    {
+        const Limb value{r[i]};
+        r[i] = value << 1 | top_bit;
+        top_bit = value >> (LIMB_BITS - 1);
+    }
+
+    Limb carry{};
+    for (int i = 0; i < n; ++i)
+    {
+        DoubleLimb sum{static_cast<DoubleLimb>(a[i]) * a[i] + r[2 * i] + carry};
+        r[2 * i] = static_cast<Limb>(sum);
+        sum = (sum >> LIMB_BITS) + r[2 * i + 1];
+        r[2 * i + 1] = static_cast<Limb>(sum);
+        carry = static_cast<Limb>(sum >> LIMB_BITS);
+    }
+}
+
+// r[0, n) += a[0, na), propagating the carry through r; na <= n
+// returns the carry out of r
+Limb add_in_place(Limb *r, const Limb *a, const int na, const int n)
+{
+    Limb carry{};
+    int i = 0;
+    for (; i < na; ++i)
+    {
+        const DoubleLimb sum{static_cast<DoubleLimb>(r[i]) + a[i] + carry};
+        r[i] = static_cast<Limb>(sum);
+        carry = static_cast<Limb>(sum >> LIMB_BITS);
+    }
+    for (; carry != 0 && i < n; ++i)
+    {
+        carry = ++r[i] == 0 ? 1 : 0;
+    }
+    return carry;
+}
+
+// r[0, n) -= a[0, na), propagating the borrow through r; na <= n
+void sub_in_place(Limb *r, const Limb *a, const int na, const int n)
+{
+    Limb borrow{};
+    int i = 0;
+    for (; i < na; ++i)
+    {
+        const Limb value{r[i]};
+        const Limb diff{value - a[i] - borrow};
+        borrow = value < a[i] || (value == a[i] && borrow != 0) ? 1 : 0;
+        r[i] = diff;
+    }
+    for (; borrow != 0 && i < n; ++i)
+    {
+        borrow = r[i]-- == 0 ? 1 : 0;
+    }
+}
+
+// sum[0, hi) = high[0, hi) + low[0, lo), returning the carry out; lo <= hi
+Limb add_halves(Limb *sum, const Limb *high, const int hi, const Limb *low, const int lo)
+{
+    std::copy(high, high + hi, sum);
+    return add_in_place(sum, low, lo, hi);
+}
+
+// r[0, 2n) = a * b; a and b may be the same pointer, which squares.
+// scratch must hold scratch_limbs(n) limbs.
+void karatsuba(Limb *r, const Limb *a, const Limb *b, const int n, Limb *scratch)
+{
+    if (n < KARATSUBA_THRESHOLD)
+    {
+        if (a == b)
+        {
+            square_basecase(r, a, n);
+        }
+        else
+        {
+            mult_basecase(r, a, n, b, n);
+        }
+        return;
+    }
+
+    // a = a1 B^lo + a0, b = b1 B^lo + b0
+    // a b = z2 B^2lo + (z1 - z2 - z0) B^lo + z0
+    //   where z0 = a0 b0, z2 = a1 b1, z1 = (a0 + a1)(b0 + b1)
+    const int lo{n / 2};
+    const int hi{n - lo};
+    karatsuba(r, a, b, lo, scratch);
+    karatsuba(r + 2 * lo, a + lo, b + lo, hi, scratch);
+
+    Limb *sum_a{scratch};
+    Limb *sum_b{a == b ? sum_a : scratch + hi};
+    Limb *z1{scratch + 2 * hi};
+    Limb *next{z1 + 2 * hi + 1};
+    const Limb carry_a{add_halves(sum_a, a + lo, hi, a, lo)};
+    const Limb carry_b{a == b ? carry_a : add_halves(sum_b, b + lo, hi, b, lo)};
+    karatsuba(z1, sum_a, sum_b, hi, next);
+    z1[2 * hi] = 0;
+    // the carries out of the sums are worth B^hi each
+    if (carry_a != 0)
+    {
+        add_in_place(z1 + hi, sum_b, hi, hi + 1);
+    }
+    if (carry_b != 0)
+    {
+        add_in_place(z1 + hi, sum_a, hi, hi + 1);
+    }
+    if (carry_a != 0 && carry_b != 0)
+    {
+        ++z1[2 * hi];
+    }
+
+    sub_in_place(z1, r, 2 * lo, 2 * hi + 1);
+    sub_in_place(z1, r + 2 * lo, 2 * hi, 2 * hi + 1);
+    add_in_place(r + lo, z1, 2 * hi + 1, 2 * n - lo);
+}
+
+int scratch_limbs(const int n)
+{
+    // each level uses 4 hi + 1 limbs, with hi <= n/2 + 1
+    return 4 * n + 64;
+}
+
+Limb *buffer(const std::size_t size)
+{
+    thread_local std::vector<Limb> limbs;
+    if (limbs.size() < size)
+    {
+        limbs.resize(size);
+    }
+    return limbs.data();
+}
+
+} // namespace
+
+void mult_magnitudes(unsigned char *r, const unsigned char *n1, const unsigned char *n2, const int length)
+{
+    const int n{(length + LIMB_BYTES - 1) / LIMB_BYTES};
+    Limb *a{buffer(static_cast<std::size_t>(4 * n + scratch_limbs(n)))};
+    Limb *b{a + n};
+    Limb *product{b + n};
+    to_limbs(a, n, n1, length);
+    to_limbs(b, n, n2, length);
+    karatsuba(product, a, b, n, product + 2 * n);
+    from_limbs(r, 2 * length, product);
+}
+
+void square_magnitude(unsigned char *r, const unsigned char *n, const int length)
+{
+    const int num_limbs{(length + LIMB_BYTES - 1) / LIMB_BYTES};
+    Limb *a{buffer(static_cast<std::size_t>(3 * num_limbs + scratch_limbs(num_limbs)))};
+    Limb *product{a + num_limbs};
+    to_limbs(a, num_limbs, n, length);
+    karatsuba(product, a, a, num_limbs, product + 2 * num_limbs);
+    from_limbs(r, 2 * length, product);
+}
+
+} // namespace id::math
@@ -7,16 +7,22 @@ Wesley Loewer's Big Numbers.        (C) 1994-95, Wesley B. Loewer
 */
 #include "math/big.h"
 
+#include "math/bigmult.h"
+
 #include <array>
 #include <cfloat>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <vector>
 
 using namespace id::misc;
 
 namespace id::math
 {
 
+static std::vector<unsigned char> s_product; // double wide product for the truncated multiplies
+
 /********************************************************************
  The following code contains the C versions of the routines from the
  file BIGNUMA.ASM.  It is provided here for portibility and for clarity.
@@ -30,9 +36,8 @@ namespace id::math
  and is_bn_not_zero(), can use 32-bit integers as long as g_bn_step
  is set to 4.
 
- The 16/32 bit combination of integer sizes could be increased to
- 32/64 bit to improve efficiency, but since many compilers don't offer
- 64-bit integers, this option was not included.
+ The multiplications and squares hand the magnitudes to bigmult.cpp,
+ which works on 64-bit limbs (32-bit without a 128-bit integer type).
 
 *********************************************************************/
 
@@ -354,10 +359,6 @@ BigNum half_a_bn(BigNum r)
 BigNum unsafe_full_mult_bn(BigNum r, BigNum n1, BigNum n2)
 {
     bool sign2 = false;
-    int double_steps;
-    // pointers for n1, n2
-    BigNum rp2;
-    // pointers for r
 
     const bool sign1 = is_bn_neg(n1);
     if (sign1) // =, not ==
@@ -374,40 +375,13 @@ BigNum unsafe_full_mult_bn(BigNum r, BigNum n1, BigNum n2)
         }
     }
 
-    BigNum n1_p = n1;
-    const int steps = g_bn_length >> 1; // two bytes at a time
-    int carry_steps = double_steps = (steps << 1) - 2;
-    g_bn_length <<= 1;
-    clear_bn(r);        // double width
-    g_bn_length >>= 1;
-    BigNum rp1 = rp2 = r;
-    for (int i = 0; i < steps; i++)
+    if (same_var)
     {
-        BigNum n2_p = n2;
-        for (int j = 0; j < steps; j++)
-        {
-            const U32 prod = static_cast<U32>(BIG_ACCESS16(n1_p)) * static_cast<U32>(BIG_ACCESS16(n2_p)); // U16*U16=U32
-            U32 sum = static_cast<U32>(BIG_ACCESS16(rp2)) + prod; // add to previous, including overflow
-            BIG_SET16(rp2, static_cast<U16>(sum)); // save the lower 2 bytes
-            sum >>= 16;             // keep just the upper 2 bytes
-            BigNum rp3 = rp2 + 2;          // move over 2 bytes
-            sum += BIG_ACCESS16(rp3);     // add what was the upper two bytes
-            BIG_SET16(rp3 , static_cast<U16>(sum)); // save what was the upper two bytes
-            sum >>= 16;             // keep just the overflow
-            for (int k = 0; sum != 0 && k < carry_steps; k++)
-            {
-                rp3 += 2;               // move over 2 bytes
-                sum += BIG_ACCESS16(rp3);     // add to what was the overflow
-                BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the overflow
-                sum >>= 16;             // keep just the new overflow
-            }
-            n2_p += 2;       // to next word
-            rp2 += 2;
-            carry_steps--;  // use one less step
-        }
-        n1_p += 2;           // to next word
-        rp2 = rp1 += 2;
-        carry_steps = --double_steps; // decrease doubles steps and reset carry_steps
+        square_magnitude(r, n1, g_bn_length);
+    }
+    else
+    {
+        mult_magnitudes(r, n1, n2, g_bn_length);
     }
 
     // if they were the same or same sign, the product must be positive
@@ -429,13 +403,9 @@ BigNum unsafe_full_mult_bn(BigNum r, BigNum n1, BigNum n2)
 BigNum unsafe_mult_bn(BigNum r, BigNum n1, BigNum n2)
 {
     bool sign2 = false;
-    int double_steps;
-    // pointers for n1, n2
-    BigNum rp1;
 
-    int bnl = g_bn_length;
     const bool sign1 = is_bn_neg(n1);
-    if (sign1 != 0)   // =, not ==
+    if (sign1)   // =, not ==
     {
         neg_a_bn(n1);
     }
@@ -448,61 +418,24 @@ BigNum unsafe_mult_bn(BigNum r, BigNum n1, BigNum n2)
             neg_a_bn(n2);
         }
     }
-    BigNum n1_p = n1;
-    n2 += (g_bn_length << 1) - g_r_length;  // shift n2 over to where it is needed
-
-    g_bn_length = g_r_length;
-    clear_bn(r);        // zero out r, g_r_length width
-    g_bn_length = bnl;
 
-    int steps = (g_r_length - g_bn_length) >> 1;
-    int skips = (g_bn_length >> 1) - steps;
-    int carry_steps = double_steps = (g_r_length >> 1) - 2;
-    BigNum rp2 = rp1 = r;
-    for (int i = g_bn_length >> 1; i > 0; i--)
+    // the full product is exact and, on word sized limbs, cheaper than
+    // the byte-wise partial product it replaces
+    s_product.resize(g_bn_length << 1);
+    if (same_var)
     {
-        BigNum n2_p = n2;
-        for (int j = 0; j < steps; j++)
-        {
-            const U32 prod = static_cast<U32>(BIG_ACCESS16(n1_p)) * static_cast<U32>(BIG_ACCESS16(n2_p)); // U16*U16=U32
-            U32 sum = static_cast<U32>(BIG_ACCESS16(rp2)) + prod; // add to previous, including overflow
-            BIG_SET16(rp2, static_cast<U16>(sum)); // save the lower 2 bytes
-            sum >>= 16;             // keep just the upper 2 bytes
-            BigNum rp3 = rp2 + 2;          // move over 2 bytes
-            sum += BIG_ACCESS16(rp3);     // add what was the upper two bytes
-            BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the upper two bytes
-            sum >>= 16;             // keep just the overflow
-            for (int k = 0; sum != 0 && k < carry_steps; k++)
-            {
-                rp3 += 2;               // move over 2 bytes
-                sum += BIG_ACCESS16(rp3);     // add to what was the overflow
-                BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the overflow
-                sum >>= 16;             // keep just the new overflow
-            }
-            n2_p += 2;                   // increase by two bytes
-            rp2 += 2;
-            carry_steps--;
-        }
-        n1_p += 2;   // increase by two bytes
-
-        if (skips != 0)
-        {
-            n2 -= 2;    // shift n2 back a word
-            steps++;    // one more step this time
-            skips--;    // keep track of how many times we've done this
-        }
-        else
-        {
-            rp1 += 2;           // shift forward a word
-            double_steps--;      // reduce the carry steps needed next time
-        }
-        rp2 = rp1;
-        carry_steps = double_steps;
+        square_magnitude(s_product.data(), n1, g_bn_length);
     }
+    else
+    {
+        mult_magnitudes(s_product.data(), n1, n2, g_bn_length);
+    }
+    std::memcpy(r, s_product.data() + (g_bn_length << 1) - g_r_length, g_r_length);
 
     // if they were the same or same sign, the product must be positive
     if (!same_var && sign1 != sign2)
     {
+        const int bnl = g_bn_length;
         g_bn_length = g_r_length;
         neg_a_bn(r);            // wider bignumber
         g_bn_length = bnl;
@@ -522,90 +455,12 @@ BigNum unsafe_mult_bn(BigNum r, BigNum n1, BigNum n2)
 // SIDE-EFFECTS: n is changed to its absolute value
 BigNum unsafe_full_square_bn(BigNum r, BigNum n)
 {
-    int double_steps;
-    BigNum rp1;
-    BigNum rp3;
-    U32 prod;
-    U32 sum;
-
     if (is_bn_neg(n))    // don't need to keep track of sign since the
     {
         neg_a_bn(n);   // answer must be positive.
     }
 
-    g_bn_length <<= 1;
-    clear_bn(r);        // zero out r, double width
-    g_bn_length >>= 1;
-
-    int steps = (g_bn_length >> 1) - 1;
-    int carry_steps = double_steps = (steps << 1) - 1;
-    BigNum rp2 = rp1 = r + 2;  // start with second two-byte word
-    BigNum n1_p = n;
-    if (steps != 0) // if zero, then skip all the middle term calculations
-    {
-        for (int i = steps; i > 0; i--) // steps gets altered, count backwards
-        {
-            BigNum n2_p = n1_p + 2;  // set n2p pointer to 1 step beyond n1p
-            for (int j = 0; j < steps; j++)
-            {
-                prod = static_cast<U32>(BIG_ACCESS16(n1_p)) * static_cast<U32>(BIG_ACCESS16(n2_p)); // U16*U16=U32
-                sum = static_cast<U32>(BIG_ACCESS16(rp2)) + prod; // add to previous, including overflow
-                BIG_SET16(rp2, static_cast<U16>(sum)); // save the lower 2 bytes
-                sum >>= 16;             // keep just the upper 2 bytes
-                rp3 = rp2 + 2;          // move over 2 bytes
-                sum += BIG_ACCESS16(rp3);     // add what was the upper two bytes
-                BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the upper two bytes
-                sum >>= 16;             // keep just the overflow
-                for (int k = 0; sum != 0 && k < carry_steps; k++)
-                {
-                    rp3 += 2;               // move over 2 bytes
-                    sum += BIG_ACCESS16(rp3);     // add to what was the overflow
-                    BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the overflow
-                    sum >>= 16;             // keep just the new overflow
-                }
-                n2_p += 2;       // increase by two bytes
-                rp2 += 2;
-                carry_steps--;
-            }
-            n1_p += 2;           // increase by two bytes
-            rp2 = rp1 += 4;     // increase by 2 * two bytes
-            carry_steps = double_steps -= 2;   // reduce the carry steps needed
-            steps--;
-        }
-        // All the middle terms have been multiplied.  Now double it.
-        g_bn_length <<= 1;     // double wide bignumber
-        double_a_bn(r);
-        g_bn_length >>= 1;
-        // finished with middle terms
-    }
-
-    // Now go back and add in the squared terms.
-    n1_p = n;
-    steps = g_bn_length >> 1;
-    carry_steps = double_steps = (steps << 1) - 2;
-    rp1 = r;
-    for (int i = 0; i < steps; i++)
-    {
-        // square it
-        prod = static_cast<U32>(BIG_ACCESS16(n1_p)) * static_cast<U32>(BIG_ACCESS16(n1_p)); // U16*U16=U32
-        sum = static_cast<U32>(BIG_ACCESS16(rp1)) + prod; // add to previous, including overflow
-        BIG_SET16(rp1, static_cast<U16>(sum)); // save the lower 2 bytes
-        sum >>= 16;             // keep just the upper 2 bytes
-        rp3 = rp1 + 2;          // move over 2 bytes
-        sum += BIG_ACCESS16(rp3);     // add what was the upper two bytes
-        BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the upper two bytes
-        sum >>= 16;             // keep just the overflow
-        for (int k = 0; sum != 0 && k < carry_steps; k++)
-        {
-            rp3 += 2;               // move over 2 bytes
-            sum += BIG_ACCESS16(rp3);     // add to what was the overflow
-            BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the overflow
-            sum >>= 16;             // keep just the new overflow
-        }
-        n1_p += 2;       // increase by 2 bytes
-        rp1 += 4;       // increase by 4 bytes
-        carry_steps = double_steps -= 2;
-    }
+    square_magnitude(r, n, g_bn_length);
     return r;
 }
 
@@ -623,131 +478,14 @@ BigNum unsafe_full_square_bn(BigNum r, BigNum n)
 // SIDE-EFFECTS: n is changed to its absolute value
 BigNum unsafe_square_bn(BigNum r, BigNum n)
 {
-    int double_steps;
-    BigNum n2_p;
-    BigNum rp1;
-    BigNum rp3;
-    U32 prod;
-    U32 sum;
-
-    // This whole procedure would be a great deal simpler if we could assume that
-    // g_r_length < 2*g_bn_length (that is, not =).  Therefore, we will take the
-    // easy way out and call full_square_bn() if it is.
-    if (g_r_length == g_bn_length << 1)   // g_r_length == 2*g_bn_length
-    {
-        return unsafe_full_square_bn(r, n);    // call full_square_bn() and quit
-    }
-
     if (is_bn_neg(n))    // don't need to keep track of sign since the
     {
         neg_a_bn(n);   // answer must be positive.
     }
 
-    int bnl = g_bn_length;
-    g_bn_length = g_r_length;
-    clear_bn(r);        // zero out r, of width g_r_length
-    g_bn_length = bnl;
-
-    // determine whether r is on an odd or even two-byte word in the number
-    const int rodd = static_cast<U16>(((g_bn_length << 1) - g_r_length) >> 1) & 0x0001;
-    int i = (g_bn_length >> 1)-1;
-    int steps = (g_r_length - g_bn_length) >> 1;
-    int carry_steps = double_steps = (g_bn_length >> 1) + steps - 2;
-    int skips = (i - steps) >> 1;     // how long to skip over pointer shifts
-    BigNum rp2 = rp1 = r;
-    BigNum n1_p = n;
-    BigNum n3_p = n2_p = n1_p + (((g_bn_length >> 1) - steps) << 1);    // n2p = n1p + 2*(g_bn_length/2 - steps)
-    if (i != 0) // if zero, skip middle term calculations
-    {
-        // i is already set
-        for (; i > 0; i--)
-        {
-            for (int j = 0; j < steps; j++)
-            {
-                prod = static_cast<U32>(BIG_ACCESS16(n1_p)) * static_cast<U32>(BIG_ACCESS16(n2_p)); // U16*U16=U32
-                sum = static_cast<U32>(BIG_ACCESS16(rp2)) + prod; // add to previous, including overflow
-                BIG_SET16(rp2, static_cast<U16>(sum)); // save the lower 2 bytes
-                sum >>= 16;             // keep just the upper 2 bytes
-                rp3 = rp2 + 2;          // move over 2 bytes
-                sum += BIG_ACCESS16(rp3);     // add what was the upper two bytes
-                BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the upper two bytes
-                sum >>= 16;             // keep just the overflow
-                for (int k = 0; sum != 0 && k < carry_steps; k++)
-                {
-                    rp3 += 2;               // move over 2 bytes
-                    sum += BIG_ACCESS16(rp3);     // add to what was the overflow
-                    BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the overflow
-                    sum >>= 16;             // keep just the new overflow
-                }
-                n2_p += 2;       // increase by 2-byte word size
-                rp2 += 2;
-                carry_steps--;
-            }
-            n1_p += 2;       // increase by 2-byte word size
-            if (skips > 0)
-            {
-                n2_p = n3_p -= 2;
-                steps++;
-                skips--;
-            }
-            else if (skips == 0)    // only gets executed once
-            {
-                steps -= rodd;  // rodd is 1 or 0
-                double_steps -= rodd+1;
-                rp1 += (rodd+1) << 1;
-                n2_p = n1_p+2;
-                skips--;
-            }
-            else // skips < 0
-            {
-                steps--;
-                double_steps -= 2;
-                rp1 += 4;           // add two 2-byte words
-                n2_p = n1_p + 2;
-            }
-            rp2 = rp1;
-            carry_steps = double_steps;
-        }
-        // All the middle terms have been multiplied.  Now double it.
-        g_bn_length = g_r_length;
-        double_a_bn(r);
-        g_bn_length = bnl;
-    }
-    // Now go back and add in the squared terms.
-
-    // be careful, the next dozen or so lines are confusing!
-    // determine whether r is on an odd or even word in the number
-    // using i as a temporary variable here
-    i = (g_bn_length << 1)-g_r_length;
-    rp1 = r + (static_cast<U16>(i) & static_cast<U16>(0x0002));
-    i = static_cast<U16>((i >> 1) + 1) & static_cast<U16>(0xFFFE);
-    n1_p = n + i;
-    // i here is no longer a temp var., but will be used as a loop counter
-    i = (g_bn_length - i) >> 1;
-    carry_steps = double_steps = (i << 1)-2;
-    // i is already set
-    for (; i > 0; i--)
-    {
-        // square it
-        prod = static_cast<U32>(BIG_ACCESS16(n1_p)) * static_cast<U32>(BIG_ACCESS16(n1_p)); // U16*U16=U32
-        sum = static_cast<U32>(BIG_ACCESS16(rp1)) + prod; // add to previous, including overflow
-        BIG_SET16(rp1, static_cast<U16>(sum)); // save the lower 2 bytes
-        sum >>= 16;             // keep just the upper 2 bytes
-        rp3 = rp1 + 2;          // move over 2 bytes
-        sum += BIG_ACCESS16(rp3);     // add what was the upper two bytes
-        BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the upper two bytes
-        sum >>= 16;             // keep just the overflow
-        for (int k = 0; sum != 0 && k < carry_steps; k++)
-        {
-            rp3 += 2;               // move over 2 bytes
-            sum += BIG_ACCESS16(rp3);     // add to what was the overflow
-            BIG_SET16(rp3, static_cast<U16>(sum)); // save what was the overflow
-            sum >>= 16;             // keep just the new overflow
-        }
-        n1_p += 2;
-        rp1 += 4;
-        carry_steps = double_steps -= 2;
-    }
+    s_product.resize(g_bn_length << 1);
+    square_magnitude(s_product.data(), n, g_bn_length);
+    std::memcpy(r, s_product.data() + (g_bn_length << 1) - g_r_length, g_r_length);
     return r;
 }
 
@@ -975,6 +713,50 @@ LDouble bf_to_float(BigFloat n)
     return f;
 }
 
+/*********************************************************************/
+//  b = f
+//  Converts an extended exponent float to a bigfloat
+BigFloat float_exp_to_bf(BigFloat r, const FloatExp &f)
+{
+    if (f.is_zero())
+    {
+        clear_bf(r);
+        return r;
+    }
+
+    // split the binary exponent into a base 256 exponent and a remainder
+    // small enough for the mantissa to stay within the range of a double
+    int power = f.exponent() / 8;
+    int bits = f.exponent() % 8;
+    if (bits < 0)
+    {
+        bits += 8;
+        --power;
+    }
+    float_to_bf(r, std::ldexp(f.mantissa(), bits));
+    const int exponent{static_cast<S16>(BIG_ACCESS16(r + g_bf_length)) + power};
+    BIG_SET16(r + g_bf_length, static_cast<S16>(exponent));
+    return r;
+}
+
+/*********************************************************************/
+//  f = b
+//  Converts a bigfloat to an extended exponent float, which keeps
+//  exponents beyond the range of a double
+FloatExp bf_to_float_exp(BigFloat n)
+{
+    int bnl = g_bn_length;
+    g_bn_length = g_bf_length;
+    int il = g_int_length;
+    g_int_length = 2;
+    const LDouble f = bn_to_float(n);
+    g_bn_length = bnl;
+    g_int_length = il;
+
+    const int power = static_cast<S16>(BIG_ACCESS16(n + g_bf_length));
+    return {static_cast<double>(f), power * 8};
+}
+
 /********************************************************************/
 // extracts the mantissa and exponent of f
 // finds m and n such that 1<=|m|<256 and f = m*256^n
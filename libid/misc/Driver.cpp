@@ -21,6 +21,38 @@ static std::vector<Driver *> s_available;
 
 Driver *g_driver{};
 
+void Driver::read_span(const int y, const int x, const int last_x, Byte *pixels)
+{
+    for (int col = x; col <= last_x; ++col)
+    {
+        *pixels++ = static_cast<Byte>(read_pixel(col, y));
+    }
+}
+
+void Driver::write_span(const int y, const int x, const int last_x, const Byte *pixels)
+{
+    for (int col = x; col <= last_x; ++col)
+    {
+        write_pixel(col, y, *pixels++);
+    }
+}
+
+void Driver::read_rect(const int x, const int y, const int width, const int height, Byte *pixels)
+{
+    for (int row = y; row < y + height; ++row, pixels += width)
+    {
+        read_span(row, x, x + width - 1, pixels);
+    }
+}
+
+void Driver::write_rect(const int x, const int y, const int width, const int height, const Byte *pixels)
+{
+    for (int row = y; row < y + height; ++row, pixels += width)
+    {
+        write_span(row, x, x + width - 1, pixels);
+    }
+}
+
 void load_driver(Driver *drv, std::vector<std::string> &args)
 {
     if (drv == nullptr || !drv->init(args))
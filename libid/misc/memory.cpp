@@ -15,6 +15,7 @@
 #include "ui/stop_msg.h"
 
 #include <config/getpid.h>
+#include <config/mapped_file.h>
 
 #include <fmt/format.h>
 
@@ -55,6 +56,7 @@ struct LinearMemory
 struct Disk
 {
     std::FILE *file;
+    Byte *mapped; // the whole file, when it can be mapped
 };
 
 struct Memory
@@ -168,6 +170,12 @@ bool MemoryHandle::from_memory(
         break;
 
     case MemoryLocation::DISK: // MoveToMemory
+        if (s_handles[index].disk.mapped != nullptr)
+        {
+            std::memcpy(s_handles[index].disk.mapped + start, buffer, static_cast<std::size_t>(to_move));
+            success = true;
+            break;
+        }
         if (!seek_file(s_handles[index].disk.file, start))
         {
             which_disk_error(3);
@@ -239,6 +247,12 @@ bool MemoryHandle::to_memory(Byte *buffer, const U16 size, const std::uint64_t c
         break;
 
     case MemoryLocation::DISK: // MoveFromMemory
+        if (s_handles[index].disk.mapped != nullptr)
+        {
+            std::memcpy(buffer, s_handles[index].disk.mapped + start, static_cast<std::size_t>(to_move));
+            success = true;
+            break;
+        }
         if (!seek_file(s_handles[index].disk.file, start))
         {
             which_disk_error(4);
@@ -311,6 +325,12 @@ bool MemoryHandle::set(const int value, const U16 size, const std::uint64_t coun
         break;
 
     case MemoryLocation::DISK: // SetMemory
+        if (s_handles[index].disk.mapped != nullptr)
+        {
+            std::memset(s_handles[index].disk.mapped + start, value, static_cast<std::size_t>(to_move));
+            success = true;
+            break;
+        }
         std::memset(disk_buff, value, static_cast<std::size_t>(DISK_WRITE_LEN));
         if (!seek_file(s_handles[index].disk.file, start))
         {
@@ -350,6 +370,20 @@ MemoryLocation memory_type(const MemoryHandle handle)
     return s_handles[handle.index].stored_at;
 }
 
+Byte *memory_address(const MemoryHandle handle)
+{
+    const Memory &memory{s_handles[handle.index]};
+    switch (memory.stored_at)
+    {
+    case MemoryLocation::MEMORY:
+        return memory.linear.memory;
+    case MemoryLocation::DISK:
+        return memory.disk.mapped;
+    default:
+        return nullptr;
+    }
+}
+
 static void display_error(const MemoryLocation stored_at, const std::uint64_t how_much)
 {
     // This routine is used to display an error message when the requested
@@ -604,6 +638,7 @@ MemoryHandle memory_alloc(const U16 size, const std::uint64_t count, const Memor
         }
         // cppcheck-suppress useClosedFile
         seek_file(s_handles[handle].disk.file, 0);
+        s_handles[handle].disk.mapped = static_cast<Byte *>(map_file(s_handles[handle].disk.file, to_allocate));
         s_handles[handle].size = to_allocate;
         s_handles[handle].stored_at = MemoryLocation::DISK;
         use_this_type = MemoryLocation::DISK;
@@ -642,6 +677,11 @@ void memory_release(const MemoryHandle handle)
         break;
 
     case MemoryLocation::DISK: // MemoryRelease
+        if (s_handles[index].disk.mapped != nullptr)
+        {
+            unmap_file(s_handles[index].disk.mapped, s_handles[index].size);
+            s_handles[index].disk.mapped = nullptr;
+        }
         std::fclose(s_handles[index].disk.file);
         if (!g_disk_targa)
         {
@@ -11,6 +11,7 @@
 #include "engine/Potential.h"
 #include "engine/sound.h"
 #include "engine/spindac.h"
+#include "engine/tiled_render.h"
 #include "engine/UserData.h"
 #include "engine/video_mode.h"
 #include "engine/VideoInfo.h"
@@ -640,25 +641,8 @@ MainState big_while_loop(MainContext &context)
                 g_evolve_param_box_count = 0;
                 g_evolve_dist_per_x = g_evolve_x_parameter_range /(g_evolve_image_grid_size -1);
                 g_evolve_dist_per_y = g_evolve_y_parameter_range /(g_evolve_image_grid_size -1);
-                const int grout = bit_set(g_evolving, EvolutionModeFlags::NO_GROUT) ? 0 : 1;
-                const int tmp_x_dots = g_logical_screen.x_dots + grout;
-                const int tmp_y_dots = g_logical_screen.y_dots + grout;
                 const int grid_sqr = g_evolve_image_grid_size * g_evolve_image_grid_size;
-                while (count < grid_sqr)
-                {
-                    spiral_map(count); // sets px & py
-                    g_logical_screen.x_offset = tmp_x_dots * g_evolve_param_grid_x;
-                    g_logical_screen.y_offset = tmp_y_dots * g_evolve_param_grid_y;
-                    restore_param_history();
-                    fiddle_params(gene, count);
-                    calc_frac_init();
-                    if (calc_fract() == -1)
-                    {
-                        goto done;
-                    }
-                    count ++;
-                }
-done:
+                count = calc_evolve_grid(gene, count);
                 driver_check_memory();
                 if (count == grid_sqr)
                 {
@@ -826,6 +810,14 @@ resumeloop:                             // return here on failed overlays
                     context.key = ID_KEY_ENTER;
                     g_init_batch = BatchMode::NORMAL;
                 }
+                else if (g_tiled_render.enabled()) // tiledgif= wrote the image as it was computed
+                {
+                    if (g_calc_status != CalcStatus::COMPLETED)
+                    {
+                        g_init_batch = BatchMode::BAILOUT_ERROR_NO_SAVE; // bailout with error
+                    }
+                    goodbye();
+                }
                 else if (g_init_batch == BatchMode::NORMAL || g_init_batch == BatchMode::BAILOUT_INTERRUPTED_TRY_SAVE)         // save-to-disk
                 {
                     context.key = g_debug_flag == DebugFlags::FORCE_DISK_RESTORE_NOT_SAVE ? 'r' : 's';
@@ -23,6 +23,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <chrono>
@@ -101,6 +102,8 @@ static std::filesystem::path s_targa_disk_path;
 static std::uint64_t s_mem_offset{};         //
 static std::uint64_t s_old_mem_offset{};     //
 static Byte *s_mem_buf_ptr{};               //
+static Byte *s_direct{};                    // pixels addressed in place, bypassing the cache
+static DiskOffset s_direct_size{};          //
 
 static int get_pixel_shift(int colors);
 static DiskOffset block_offset(DiskOffset offset);
@@ -238,6 +241,11 @@ MemoryLocation disk_video_memory_type()
     return s_dv_handle ? memory_type(s_dv_handle) : MemoryLocation::NOWHERE;
 }
 
+bool disk_video_direct()
+{
+    return s_direct != nullptr;
+}
+
 int common_start_disk(const std::int64_t new_row_size, const std::int64_t new_col_size, const int colors)
 {
     if (g_disk_flag)
@@ -307,11 +315,6 @@ int common_start_disk(const std::int64_t new_row_size, const std::int64_t new_co
         s_cache_end = nullptr;
         s_mem_buf.clear();
     };
-    if (driver_is_disk())
-    {
-        driver_put_string(BOX_ROW + 6, BOX_COL + 4, C_DVID_LO, fmt::format("Cache size: {:d}K", CACHE_SIZE));
-    }
-
     // preset cache to all invalid entries so we don't need free list logic
     for (unsigned int &elem : s_hash_ptr)
     {
@@ -374,8 +377,19 @@ int common_start_disk(const std::int64_t new_row_size, const std::int64_t new_co
         s_dv_handle.from_memory(s_mem_buf.data(), static_cast<U16>(s_header_length), 1L, 0);
     }
 
+    // Heap memory and mapped files hold a byte per pixel in place, so
+    // pixels are addressed directly and the cache isn't needed.
+    if (Byte *address = memory_address(s_dv_handle); address != nullptr && s_pixel_shift == 0)
+    {
+        s_direct = address + s_header_length;
+        s_direct_size = static_cast<DiskOffset>(memory_size * BLOCK_LEN) - s_header_length;
+        release_cache();
+    }
     if (driver_is_disk())
     {
+        driver_put_string(BOX_ROW + 6, BOX_COL + 4, C_DVID_LO,
+            s_direct != nullptr ? std::string{"Cache size: none, direct access"}
+                                : fmt::format("Cache size: {:d}K", CACHE_SIZE));
         dvid_status(0, "");
     }
     return 0;
@@ -405,6 +419,8 @@ void end_disk()
         s_fp = nullptr;
     }
 
+    s_direct = nullptr;
+    s_direct_size = 0;
     if (s_dv_handle)
     {
         memory_release(s_dv_handle);
@@ -460,6 +476,10 @@ int disk_read_pixel(const int col, int row)
         return 0;
     }
     const DiskOffset offset = s_cur_row_base + col;
+    if (s_direct != nullptr)
+    {
+        return s_direct[offset];
+    }
     const int col_index = block_index(offset); // offset within cache entry
     if (s_cur_offset != block_offset(offset)) // same entry as last ref?
     {
@@ -474,6 +494,15 @@ bool from_mem_disk(const std::int64_t offset, const int size, void *dest)
     {
         return false;
     }
+    if (s_direct != nullptr)
+    {
+        if (offset + size > s_direct_size)
+        {
+            return false;
+        }
+        std::memcpy(dest, s_direct + offset, size);
+        return true;
+    }
     const int col_index = block_index(offset);
     if (col_index + size > BLOCK_LEN)            // access violates  a
     {
@@ -522,6 +551,11 @@ void disk_write_pixel(const int col, int row, const int color)
         return;
     }
     const DiskOffset offset = s_cur_row_base + col;
+    if (s_direct != nullptr)
+    {
+        s_direct[offset] = static_cast<Byte>(color);
+        return;
+    }
     const int col_index = block_index(offset);
     if (s_cur_offset != block_offset(offset)) // same entry as last ref?
     {
@@ -534,12 +568,127 @@ void disk_write_pixel(const int col, int row, const int color)
     }
 }
 
+// Pixels of the row outside the disk video read as 0, as for
+// disk_read_pixel(); the rest are copied a cache block at a time.
+void disk_read_span(const int row, int col, const int last_col, Byte *pixels)
+{
+    s_time_to_display -= last_col - col + 1;
+    if (s_time_to_display < 0)
+    {
+        if (driver_is_disk())
+        {
+            dvid_status(0,
+                fmt::format(" reading line {:4d}",
+                    row >= g_screen_y_dots ? row - g_screen_y_dots : row)); // adjust when potfile
+        }
+        s_time_to_display = g_bf_math != BFMathType::NONE ? 10 : 1000;
+    }
+    if (row < 0 || row >= s_col_size)
+    {
+        if (col <= last_col)
+        {
+            std::memset(pixels, 0, last_col - col + 1);
+        }
+        return;
+    }
+    for (; col < 0 && col <= last_col; ++col)
+    {
+        *pixels++ = 0;
+    }
+    const DiskOffset row_base = static_cast<DiskOffset>(row) * s_row_size;
+    if (s_direct != nullptr && col <= last_col && col < s_row_size)
+    {
+        const int count = std::min(last_col, s_row_size - 1) - col + 1;
+        std::memcpy(pixels, s_direct + row_base + col, count);
+        pixels += count;
+        col += count;
+    }
+    while (col <= last_col && col < s_row_size)
+    {
+        const DiskOffset offset = row_base + col;
+        const int col_index = block_index(offset);
+        const int count = std::min({BLOCK_LEN - col_index, last_col - col + 1, s_row_size - col});
+        if (s_cur_offset != block_offset(offset))
+        {
+            find_load_cache(block_offset(offset));
+        }
+        std::memcpy(pixels, &s_cur_cache->pixel[col_index], count);
+        pixels += count;
+        col += count;
+    }
+    if (col <= last_col)
+    {
+        std::memset(pixels, 0, last_col - col + 1);
+    }
+}
+
+// Pixels of the row outside the disk video are dropped, as for
+// disk_write_pixel(); the rest are copied a cache block at a time.
+void disk_write_span(const int row, int col, const int last_col, const Byte *pixels)
+{
+    s_time_to_display -= last_col - col + 1;
+    if (s_time_to_display < 0)
+    {
+        if (driver_is_disk())
+        {
+            dvid_status(0,
+                fmt::format(" writing line {:4d}",
+                    row >= g_screen_y_dots ? row - g_screen_y_dots : row)); // adjust when potfile
+        }
+        s_time_to_display = 1000;
+    }
+    if (row < 0 || row >= s_col_size)
+    {
+        return;
+    }
+    if (col < 0)
+    {
+        pixels -= col;
+        col = 0;
+    }
+    const DiskOffset row_base = static_cast<DiskOffset>(row) * s_row_size;
+    if (s_direct != nullptr)
+    {
+        if (col <= last_col && col < s_row_size)
+        {
+            std::memcpy(s_direct + row_base + col, pixels, std::min(last_col, s_row_size - 1) - col + 1);
+        }
+        return;
+    }
+    while (col <= last_col && col < s_row_size)
+    {
+        const DiskOffset offset = row_base + col;
+        const int col_index = block_index(offset);
+        const int count = std::min({BLOCK_LEN - col_index, last_col - col + 1, s_row_size - col});
+        if (s_cur_offset != block_offset(offset))
+        {
+            find_load_cache(block_offset(offset));
+        }
+        if (std::memcmp(&s_cur_cache->pixel[col_index], pixels, count) != 0)
+        {
+            std::memcpy(&s_cur_cache->pixel[col_index], pixels, count);
+            s_cur_cache->dirty = true;
+        }
+        pixels += count;
+        col += count;
+    }
+}
+
 bool to_mem_disk(const std::int64_t offset, const int size, const void *src)
 {
     if (offset < 0 || size < 0)
     {
         return false;
     }
+    if (s_direct != nullptr)
+    {
+        if (offset + size > s_direct_size)
+        {
+            return false;
+        }
+        std::memcpy(s_direct + offset, src, size);
+        return true;
+    }
     const int col_index = block_index(offset);
 
     if (col_index + size > BLOCK_LEN)           // access violates  a
@@ -3,11 +3,14 @@
 #include "ui/evolve.h"
 
 #include "engine/bailout_formula.h"
+#include "engine/calc_frac_init.h"
 #include "engine/calcfrac.h"
+#include "engine/DeferredScans.h"
 #include "engine/Inversion.h"
 #include "engine/LogicalScreen.h"
 #include "engine/param_not_used.h"
 #include "engine/pixel_limits.h"
+#include "engine/resume.h"
 #include "engine/trig_fns.h"
 #include "engine/type_has_param.h"
 #include "engine/VideoInfo.h"
@@ -1088,4 +1091,91 @@ int unspiral_map()
     return s_evol_count_box[g_evolve_param_grid_x][g_evolve_param_grid_y];
 }
 
+int calc_evolve_grid(GeneBase gene[NUM_GENES], const int first_count)
+{
+    // Each sub image is small, so rather than spread one image at a time
+    // over the cores, sub images computed by the one-pass Mandelbrot/Julia
+    // scan only record their rows on a first pass over the grid.  The rows
+    // of all of them are then computed at once, and a second pass plots each
+    // sub image from its computed rows.  Other sub images render in the
+    // first pass as before.
+    struct Recorded
+    {
+        int count;
+        int image;
+    };
+    const int grout = bit_set(g_evolving, EvolutionModeFlags::NO_GROUT) ? 0 : 1;
+    const int tmp_x_dots = g_logical_screen.x_dots + grout;
+    const int tmp_y_dots = g_logical_screen.y_dots + grout;
+    const int grid_sqr = g_evolve_image_grid_size * g_evolve_image_grid_size;
+    auto setup_grid_image = [&](const int image_count)
+    {
+        spiral_map(image_count); // sets px & py
+        g_logical_screen.x_offset = tmp_x_dots * g_evolve_param_grid_x;
+        g_logical_screen.y_offset = tmp_y_dots * g_evolve_param_grid_y;
+        restore_param_history();
+        fiddle_params(gene, image_count);
+        calc_frac_init();
+    };
+    DeferredScans &deferred{deferred_scans()};
+    std::vector<Recorded> recorded;
+    int count = first_count;
+    deferred.record();
+    while (count < grid_sqr)
+    {
+        setup_grid_image(count);
+        const int image = deferred.begin_image();
+        const int result = calc_fract();
+        if (result == -1)
+        {
+            break;
+        }
+        if (deferred.scans(image) > 0)
+        {
+            recorded.push_back({count, image});
+        }
+        count++;
+    }
+
+    // plotting the recorded sub images mustn't lose the resume state of an
+    // interrupted one
+    const CalcStatus status{g_calc_status};
+    const std::vector<Byte> resume_data{g_resume_data};
+    const int resume_len{g_resume_len};
+    bool restore{count < grid_sqr};
+    if (!recorded.empty() && !deferred.compute())
+    {
+        count = recorded.front().count;
+        g_calc_status = CalcStatus::NON_RESUMABLE;
+        restore = false;
+    }
+    else
+    {
+        for (const Recorded &image : recorded)
+        {
+            setup_grid_image(image.count);
+            deferred.replay(image.image);
+            if (calc_fract() == -1)
+            {
+                count = image.count;
+                restore = false;
+                break;
+            }
+        }
+    }
+    deferred.clear();
+
+    if (count < grid_sqr)
+    {
+        setup_grid_image(count);
+    }
+    if (restore)
+    {
+        g_calc_status = status;
+        g_resume_data = resume_data;
+        g_resume_len = resume_len;
+    }
+    return count;
+}
+
 } // namespace id::ui
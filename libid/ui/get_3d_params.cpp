@@ -103,7 +103,8 @@ static bool prompt_3d_mode()
         g_targa_overlay = true;
     }
 
-    static const char *raytrace_formats[]{"No", "DKB/POV-Ray", "VIVID", "Raw", "MTV", "Rayshade", "AcroSpin", "DXF"};
+    static const char *raytrace_formats[]{
+        "No", "DKB/POV-Ray", "VIVID", "Raw", "MTV", "Rayshade", "AcroSpin", "DXF", "PLY", "STL"};
     builder.yes_no("Preview mode?", g_preview)
         .yes_no("    Show box?", g_show_box)
         .int_number("Coarseness, preview/grid/ray (in y dir)", g_preview_factor)
@@ -112,7 +113,7 @@ static bool prompt_3d_mode()
         .comment("                  3=photo,4=stereo pair)")
         .list("Ray trace output? (No, DKB/POV-Ray, VIVID, RAW, MTV,", static_cast<int>(std::size(raytrace_formats)), 11,
             raytrace_formats, static_cast<int>(g_raytrace_format))
-        .comment("                Rayshade, AcroSpin, DXF)")
+        .comment("                Rayshade, AcroSpin, DXF, PLY, STL)")
         .yes_no("    Brief output?", g_brief)
         .string("    Output file name", g_raytrace_filename.c_str())
         .yes_no("Targa output?", g_targa_out)
@@ -174,7 +175,7 @@ static bool prompt_3d_mode()
     {
         g_raytrace_format = RayTraceFormat::NONE;
     }
-    g_raytrace_format = std::min(g_raytrace_format, RayTraceFormat::DXF);
+    g_raytrace_format = std::min(g_raytrace_format, RayTraceFormat::STL);
 
     return true;
 }
@@ -762,6 +762,9 @@ gfp_top:
         param_values[prompt_num].uval.ival = g_julibrot_z_dots;
         param_values[prompt_num].type = 'i';
         choices[prompt_num++] = "Number of z pixels";
+        param_values[prompt_num].uval.ival = g_julibrot_coarse_step;
+        param_values[prompt_num].type = 'i';
+        choices[prompt_num++] = "Coarse z step (1 = every z pixel)";
 
         param_values[prompt_num].type = 'l';
         param_values[prompt_num].uval.ch.val  = static_cast<int>(g_julibrot_3d_mode);
@@ -947,6 +950,7 @@ gfp_top:
         g_julibrot_x_min    = param_values[prompt_num++].uval.dval;
         g_julibrot_y_min    = param_values[prompt_num++].uval.dval;
         g_julibrot_z_dots      = param_values[prompt_num++].uval.ival;
+        g_julibrot_coarse_step = std::clamp(param_values[prompt_num++].uval.ival, 1, JULIBROT_MAX_COARSE_STEP);
         g_julibrot_3d_mode = static_cast<Julibrot3DMode>(param_values[prompt_num++].uval.ch.val);
         g_eyes     = static_cast<float>(param_values[prompt_num++].uval.dval);
         g_julibrot_origin   = static_cast<float>(param_values[prompt_num++].uval.dval);
@@ -115,6 +115,7 @@ struct ImageHistory
     double julibrot_y_max;
     double julibrot_y_min;
     int julibrot_z_dots;
+    int julibrot_coarse_step;
     float julibrot_origin;
     float julibrot_depth;
     float julibrot_height;
@@ -213,6 +214,7 @@ bool operator==(const ImageHistory &lhs, const ImageHistory &rhs)
         && lhs.julibrot_y_max == rhs.julibrot_y_max                                                     //
         && lhs.julibrot_y_min == rhs.julibrot_y_min                                                     //
         && lhs.julibrot_z_dots == rhs.julibrot_z_dots                                                   //
+        && lhs.julibrot_coarse_step == rhs.julibrot_coarse_step                                         //
         && lhs.julibrot_origin == rhs.julibrot_origin                                                   //
         && lhs.julibrot_depth == rhs.julibrot_depth                                                     //
         && lhs.julibrot_height == rhs.julibrot_height                                                   //
@@ -513,6 +515,7 @@ std::ostream &operator<<(std::ostream &str, const ImageHistory &value)
     str << R"json("julibrot_y_max":)json" << value.julibrot_y_max << ',';
     str << R"json("julibrot_y_min":)json" << value.julibrot_y_min << ',';
     str << R"json("julibrot_z_dots":)json" << value.julibrot_z_dots << ',';
+    str << R"json("julibrot_coarse_step":)json" << value.julibrot_coarse_step << ',';
     str << R"json("julibrot_origin":)json" << value.julibrot_origin << ',';
     str << R"json("julibrot_depth":)json" << value.julibrot_depth << ',';
     str << R"json("julibrot_height":)json" << value.julibrot_height << ',';
@@ -651,6 +654,7 @@ void save_history_info()
     current.julibrot_y_max = g_julibrot_y_max;
     current.julibrot_y_min = g_julibrot_y_min;
     current.julibrot_z_dots = g_julibrot_z_dots;
+    current.julibrot_coarse_step = g_julibrot_coarse_step;
     current.julibrot_origin = g_julibrot_origin;
     current.julibrot_depth = g_julibrot_depth;
     current.julibrot_height = g_julibrot_height;
@@ -823,6 +827,7 @@ void restore_history_info(const int i)
     g_julibrot_y_max = last.julibrot_y_max;
     g_julibrot_y_min = last.julibrot_y_min;
     g_julibrot_z_dots = last.julibrot_z_dots;
+    g_julibrot_coarse_step = last.julibrot_coarse_step;
     g_julibrot_origin = last.julibrot_origin;
     g_julibrot_depth = last.julibrot_depth;
     g_julibrot_height = last.julibrot_height;
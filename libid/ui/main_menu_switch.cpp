@@ -6,6 +6,7 @@
 #include "engine/calcfrac.h"
 #include "engine/cmdfiles.h"
 #include "engine/ImageRegion.h"
+#include "engine/iteration_buffer.h"
 #include "engine/jiim.h"
 #include "engine/load_params.h"
 #include "engine/log_map.h"
@@ -228,9 +229,42 @@ static void toggle_mandelbrot_julia(MainContext &context)
     }
 }
 
+namespace
+{
+
+// The <X> options recolor_image() can apply without recalculating.
+struct ColoringOptions
+{
+    ColorMethod inside_method;
+    int inside_color;
+    ColorMethod outside_method;
+    int outside_color;
+    long log_map_flag;
+    int biomorph;
+};
+
+} // namespace
+
+static ColoringOptions coloring_options()
+{
+    return {g_inside_method, g_inside_color, g_outside_method, g_outside_color, g_log_map_flag,
+        g_user.biomorph_value};
+}
+
+// The number of options get_toggles() counts as changed that are coloring options.
+static int coloring_changes(const ColoringOptions &old)
+{
+    const ColoringOptions now{coloring_options()};
+    return static_cast<int>(now.inside_method != old.inside_method || now.inside_color != old.inside_color) +
+        static_cast<int>(now.outside_method != old.outside_method || now.outside_color != old.outside_color) +
+        static_cast<int>(now.log_map_flag != old.log_map_flag) + static_cast<int>(now.biomorph != old.biomorph);
+}
+
 static MainState prompt_options(MainContext &context)
 {
     const long old_max_iterations = g_max_iterations;
+    const ColoringOptions old_coloring{coloring_options()};
+    bool recolor{};
     clear_zoom_box();
     if (g_from_text)
     {
@@ -244,6 +278,7 @@ static MainState prompt_options(MainContext &context)
     if (context.key == 'x')
     {
         i = get_toggles();
+        recolor = i > 0 && i == coloring_changes(old_coloring) && recolor_ineligible_reason() == nullptr;
     }
     else if (context.key == 'y')
     {
@@ -284,6 +319,11 @@ static MainState prompt_options(MainContext &context)
         i = get_cmd_string();
     }
     driver_unstack_screen();
+    if (recolor && recolor_image())
+    {
+        save_param_history();
+        return MainState::NOTHING;
+    }
     if (g_evolving != EvolutionModeFlags::NONE && g_true_color)
     {
         g_true_color = false;          // truecolor doesn't play well with the evolver
@@ -882,6 +882,11 @@ void put_calculation_mode_params(WriteBatchData &wb_data)
     {
         put_param(wb_data, " perturbation-tolerance=%.15g", g_user.perturbation_tolerance);
     }
+
+    if (g_user.perturbation_glitch == PerturbationGlitch::RETRY)
+    {
+        put_param(wb_data, " perturbation-glitch=retry");
+    }
 }
 
 void put_fractal_params(WriteBatchData &wb_data)
@@ -1022,6 +1027,10 @@ static void write_batch_params(
                 put_param(" julibrot3d=%d/%g/%g/%g/%g/%g",
                          g_julibrot_z_dots, g_julibrot_origin, g_julibrot_depth, g_julibrot_height, g_julibrot_width, g_julibrot_dist);
             }
+            if (g_julibrot_coarse_step != 1)
+            {
+                put_param(" julibrotcoarse=%d", g_julibrot_coarse_step);
+            }
             if (g_eyes != 0)
             {
                 put_param(" julibroteyes=%g", g_eyes);
@@ -144,9 +144,15 @@ static void put_format(
     driver_put_string(row, col, color, format_text(format, std::forward<Args>(args)...));
 }
 
-std::string perturbation_status_text(const int reference_count)
+std::string perturbation_status_text(const int reference_count, const int skipped_iterations)
 {
-    return fmt::format("Perturbation ({:d} reference{:s})", reference_count, reference_count == 1 ? "" : "s");
+    std::string text{
+        fmt::format("Perturbation ({:d} reference{:s}", reference_count, reference_count == 1 ? "" : "s")};
+    if (skipped_iterations > 0)
+    {
+        text += fmt::format(", {:d} iteration{:s} skipped", skipped_iterations, skipped_iterations == 1 ? "" : "s");
+    }
+    return text + ")";
 }
 
 static void show_str_var(const char *name, const char *var, int *row)
@@ -415,8 +421,9 @@ top:
     }
     if (pass_status.perturbation_active && calculation_active)
     {
-        driver_put_string(
-            start_row++, 2, C_GENERAL_HI, perturbation_status_text(pass_status.perturbation_reference_count));
+        driver_put_string(start_row++, 2, C_GENERAL_HI,
+            perturbation_status_text(
+                pass_status.perturbation_reference_count, pass_status.perturbation_skipped_iterations));
     }
     driver_put_string(start_row, 2, C_GENERAL_MED, "Calculation time:");
     driver_put_string(-1, -1, C_GENERAL_HI, get_calculation_time(g_calc_time));
@@ -81,18 +81,26 @@ static void normal_read_span(const int y, const int x, const int last_x, Byte *p
     }
 }
 
+// Pixels and spans go to the driver, which copies a span at a time when
+// it can.
 void set_normal_dot()
 {
     s_write_pixel = driver_write_pixel;
     s_read_pixel = driver_read_pixel;
+    s_write_span = driver_write_span;
+    s_read_span = driver_read_span;
 }
 
+// Pixels and spans go to the disk video cache.
 void set_disk_dot()
 {
     s_write_pixel = disk_write_pixel;
     s_read_pixel = disk_read_pixel;
+    s_write_span = disk_write_span;
+    s_read_span = disk_read_span;
 }
 
+// Spans go a pixel at a time through the current pixel routines.
 void set_normal_span()
 {
     s_read_span = normal_read_span;
@@ -112,6 +120,7 @@ void set_null_video()
 {
     s_write_pixel = null_write_pixel;
     s_read_pixel = null_read_pixel;
+    set_normal_span();
 }
 
 // Return the color on the screen at the (xdot, ydot) point
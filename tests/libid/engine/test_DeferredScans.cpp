@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <engine/DeferredScans.h>
+
+#include <engine/calc_frac_init.h>
+#include <engine/calcfrac.h>
+#include <engine/calmanfp.h>
+#include <engine/fractals.h>
+#include <engine/ImageRegion.h>
+#include <engine/LogicalScreen.h>
+#include <engine/pixel_grid.h>
+#include <engine/simd_escape.h>
+#include <fractals/fractype.h>
+#include <misc/ValueSaver.h>
+#include <ui/KeyboardHandler.h>
+
+#include "MockDriver.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+using namespace id::misc::test;
+using namespace id::ui;
+using namespace testing;
+
+namespace id::test
+{
+
+constexpr int WIDTH{37};
+constexpr int HEIGHT{7};
+
+class TestDeferredScans : public Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    void set_region(const DComplex &min, const DComplex &max);
+    std::vector<MandelbrotOrbit> expected_rows(int first_row, int first_col, int last_row);
+    static void expect_same(const std::vector<MandelbrotOrbit> &expected, const DeferredScans::Scan &scan);
+
+    DeferredScans m_scans;
+    MockDriver m_driver;
+    ValueSaver<Driver *> m_saved_driver{g_driver, &m_driver};
+    ValueSaver<SimdMode> saved_simd_mode{g_simd_mode, SimdMode::OFF};
+    ValueSaver<LogicalScreen> saved_logical_screen{g_logical_screen, LogicalScreen{WIDTH, HEIGHT}};
+    ValueSaver<ImageRegion> saved_image_region{g_image_region};
+    ValueSaver<LDouble> saved_delta_x{g_delta_x};
+    ValueSaver<LDouble> saved_delta_y{g_delta_y};
+    ValueSaver<LDouble> saved_delta_x2{g_delta_x2, 0.0L};
+    ValueSaver<LDouble> saved_delta_y2{g_delta_y2, 0.0L};
+    ValueSaver<FractalType> saved_fractal_type{g_fractal_type, FractalType::MANDEL};
+    ValueSaver<DComplex> saved_param_z1{g_param_z1, DComplex{}};
+    ValueSaver<long> saved_max_iterations{g_max_iterations, 300};
+    ValueSaver<double> saved_magnitude_limit{g_magnitude_limit, 4.0};
+    ValueSaver<int> saved_periodicity_check{g_periodicity_check, 1};
+    ValueSaver<double> saved_close_enough{g_close_enough, 1e-10};
+    ValueSaver<long> saved_first_saved_and{g_first_saved_and, 9};
+    ValueSaver<int> saved_next_saved_incr{g_periodicity_next_saved_incr, 4};
+    ValueSaver<ColorMethod> saved_inside_method{g_inside_method, ColorMethod::ITER};
+    ValueSaver<ColorMethod> saved_outside_method{g_outside_method, ColorMethod::ITER};
+};
+
+void TestDeferredScans::SetUp()
+{
+    EXPECT_CALL(m_driver, key_pressed()).WillRepeatedly(Return(0));
+    reset_calc_interrupted();
+    alloc_pixel_grid();
+    set_region(DComplex{-2.0, -1.2}, DComplex{1.0, 1.2});
+    calc_mandelbrot_init();
+}
+
+void TestDeferredScans::TearDown()
+{
+    free_pixel_grid();
+    reset_calc_interrupted();
+}
+
+void TestDeferredScans::set_region(const DComplex &min, const DComplex &max)
+{
+    g_image_region.m_min = min;
+    g_image_region.m_max = max;
+    g_delta_x = (max.x - min.x) / (WIDTH - 1);
+    g_delta_y = (max.y - min.y) / (HEIGHT - 1);
+    fill_pixel_grid();
+}
+
+std::vector<MandelbrotOrbit> TestDeferredScans::expected_rows(
+    const int first_row, const int first_col, const int last_row)
+{
+    std::vector<MandelbrotOrbit> orbits;
+    for (int row = first_row; row <= last_row; ++row)
+    {
+        const int col{row == first_row ? first_col : 0};
+        std::vector<MandelbrotOrbit> row_orbits(WIDTH - col);
+        mandelbrot_orbit_row(row, col, WIDTH - 1, row_orbits.data());
+        orbits.insert(orbits.end(), row_orbits.begin(), row_orbits.end());
+    }
+    return orbits;
+}
+
+void TestDeferredScans::expect_same(const std::vector<MandelbrotOrbit> &expected, const DeferredScans::Scan &scan)
+{
+    auto it{expected.begin()};
+    for (int row = scan.first_row; row <= scan.last_row; ++row)
+    {
+        const MandelbrotOrbit *orbit{scan.row(row)};
+        for (int col = row == scan.first_row ? scan.first_col : scan.start_col; col <= scan.stop_col;
+            ++col, ++orbit, ++it)
+        {
+            ASSERT_NE(expected.end(), it);
+            EXPECT_EQ(it->color_iter, orbit->color_iter) << "row " << row << ", col " << col;
+            EXPECT_EQ(it->real_color_iter, orbit->real_color_iter) << "row " << row << ", col " << col;
+            EXPECT_EQ(it->magnitude, orbit->magnitude) << "row " << row << ", col " << col;
+        }
+    }
+    EXPECT_EQ(expected.end(), it);
+}
+
+TEST_F(TestDeferredScans, imagesComputedTogetherMatchEachImage)
+{
+    m_scans.record();
+    const int mandel{m_scans.begin_image()};
+    m_scans.defer(0, 0, HEIGHT - 1, 0, WIDTH - 1);
+    const std::vector<MandelbrotOrbit> expected_mandel{expected_rows(0, 0, HEIGHT - 1)};
+    g_fractal_type = FractalType::JULIA;
+    g_param_z1 = DComplex{-0.8, 0.156};
+    g_max_iterations = 150;
+    set_region(DComplex{-1.5, -1.0}, DComplex{1.5, 1.0});
+    calc_mandelbrot_init();
+    const int julia{m_scans.begin_image()};
+    m_scans.defer(2, 5, HEIGHT / 2, 0, WIDTH - 1);
+    m_scans.defer(HEIGHT / 2 + 1, 0, HEIGHT - 1, 0, WIDTH - 1);
+    const std::vector<MandelbrotOrbit> expected_julia_top{expected_rows(2, 5, HEIGHT / 2)};
+    const std::vector<MandelbrotOrbit> expected_julia_bottom{expected_rows(HEIGHT / 2 + 1, 0, HEIGHT - 1)};
+
+    ASSERT_TRUE(m_scans.compute());
+
+    EXPECT_EQ(1, m_scans.scans(mandel));
+    EXPECT_EQ(2, m_scans.scans(julia));
+    m_scans.replay(mandel);
+    EXPECT_EQ(DeferredScans::Mode::REPLAY, m_scans.mode());
+    const DeferredScans::Scan *scan{m_scans.next(0, 0, HEIGHT - 1, 0, WIDTH - 1)};
+    ASSERT_NE(nullptr, scan);
+    expect_same(expected_mandel, *scan);
+    EXPECT_EQ(nullptr, m_scans.next(0, 0, HEIGHT - 1, 0, WIDTH - 1));
+    m_scans.replay(julia);
+    scan = m_scans.next(2, 5, HEIGHT / 2, 0, WIDTH - 1);
+    ASSERT_NE(nullptr, scan);
+    expect_same(expected_julia_top, *scan);
+    scan = m_scans.next(HEIGHT / 2 + 1, 0, HEIGHT - 1, 0, WIDTH - 1);
+    ASSERT_NE(nullptr, scan);
+    expect_same(expected_julia_bottom, *scan);
+}
+
+TEST_F(TestDeferredScans, replayWithOtherBoundsComputesItself)
+{
+    m_scans.record();
+    const int image{m_scans.begin_image()};
+    m_scans.defer(0, 0, HEIGHT - 1, 0, WIDTH - 1);
+    ASSERT_TRUE(m_scans.compute());
+
+    m_scans.replay(image);
+
+    EXPECT_EQ(nullptr, m_scans.next(1, 0, HEIGHT - 1, 0, WIDTH - 1));
+}
+
+TEST_F(TestDeferredScans, interruptedComputeLeavesNothingToReplay)
+{
+    m_scans.record();
+    const int image{m_scans.begin_image()};
+    m_scans.defer(0, 0, HEIGHT - 1, 0, WIDTH - 1);
+    set_calc_interrupted();
+
+    EXPECT_FALSE(m_scans.compute());
+
+    EXPECT_EQ(DeferredScans::Mode::OFF, m_scans.mode());
+    EXPECT_EQ(0, m_scans.scans(image));
+}
+
+} // namespace id::test
@@ -2,13 +2,128 @@
 //
 #include <engine/PertEngine.h>
 
+#include <engine/calcfrac.h>
+#include <engine/Potential.h>
+#include <engine/random_seed.h>
+#include <engine/VideoInfo.h>
+#include <fractals/fractalp.h>
+#include <math/big.h>
+#include <misc/ValueSaver.h>
+#include <ui/video.h>
+
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
 using namespace id::engine;
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+using namespace id::ui;
 
 namespace id::test
 {
 
+namespace
+{
+
+constexpr int WIDTH{40};
+constexpr int HEIGHT{30};
+
+std::vector<int> s_screen;
+
+void record_plot(const int x, const int y, const int color)
+{
+    s_screen[y * WIDTH + x] = color;
+}
+
+std::vector<std::tuple<int, int, int>> sorted(const std::vector<Point> &points)
+{
+    std::vector<std::tuple<int, int, int>> result;
+    for (const Point &pt : points)
+    {
+        result.emplace_back(pt.get_y(), pt.get_x(), pt.get_iteration());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// A glitch prone view of the seahorse valley; glitched pixels read back as
+// color 0, which no iterated pixel is given.
+class TestPertEngineBands : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        set_null_video();
+        set_fractal_type(FractalType::MANDEL);
+        s_screen.assign(WIDTH * HEIGHT, -1);
+    }
+
+    void TearDown() override
+    {
+        set_normal_dot();
+    }
+
+    static void start(PertEngine &engine)
+    {
+        engine.set_rebase(false);
+        engine.set_glitch_tolerance(0.1);
+        engine.initialize_frame({-0.7436, 0.1318}, 1e-4);
+    }
+
+    // Plots every pixel through the serial per point path.
+    static std::vector<int> serial_colors(PertEngine &engine)
+    {
+        s_screen.assign(WIDTH * HEIGHT, -1);
+        for (int row = 0; row < HEIGHT; ++row)
+        {
+            for (int col = 0; col < WIDTH; ++col)
+            {
+                record_plot(col, row, engine.calculate_pixel(Point{col, HEIGHT - 1 - row}));
+            }
+        }
+        return s_screen;
+    }
+
+    // Plots every pixel in traversal order, so colors come from the bands.
+    static std::vector<int> band_colors(PertEngine &engine)
+    {
+        s_screen.assign(WIDTH * HEIGHT, -1);
+        for (int row = 0; row < HEIGHT; ++row)
+        {
+            for (int col = 0; col < WIDTH; ++col)
+            {
+                record_plot(col, row, engine.calculate_pixel(col, row));
+            }
+        }
+        return s_screen;
+    }
+
+    ValueSaver<int> m_saved_screen_x_dots{g_screen_x_dots, WIDTH};
+    ValueSaver<int> m_saved_screen_y_dots{g_screen_y_dots, HEIGHT};
+    ValueSaver<Point2i> m_saved_start_pt{g_i_start_pt, Point2i{0, 0}};
+    ValueSaver<Point2i> m_saved_stop_pt{g_i_stop_pt, Point2i{WIDTH - 1, HEIGHT - 1}};
+    ValueSaver<CalcMode> m_saved_std_calc_mode{g_std_calc_mode, CalcMode::ONE_PASS};
+    ValueSaver<BFMathType> m_saved_bf_math{g_bf_math, BFMathType::NONE};
+    ValueSaver<FractalType> m_saved_fractal_type{g_fractal_type};
+    ValueSaver<const FractalSpecific *> m_saved_specific{g_cur_fractal_specific};
+    ValueSaver<long> m_saved_max_iterations{g_max_iterations, 500};
+    ValueSaver<double> m_saved_magnitude_limit{g_magnitude_limit, 4.0};
+    ValueSaver<int> m_saved_biomorph{g_biomorph, -1};
+    ValueSaver<ColorMethod> m_saved_inside_method{g_inside_method, ColorMethod::COLOR};
+    ValueSaver<int> m_saved_inside_color{g_inside_color, 1};
+    ValueSaver<ColorMethod> m_saved_outside_method{g_outside_method, ColorMethod::ITER};
+    ValueSaver<Potential> m_saved_potential{g_potential, Potential{}};
+    ValueSaver<int> m_saved_random_seed{g_random_seed, 1};
+    ValueSaver<bool> m_saved_random_seed_flag{g_random_seed_flag, true};
+    ValueSaver<void (*)(int, int, int)> m_saved_plot{g_plot, record_plot};
+};
+
+} // namespace
+
 TEST(TestPertEngine, defaultGlitchToleranceScalesThreshold)
 {
     PertEngine engine;
@@ -25,4 +140,78 @@ TEST(TestPertEngine, nonDefaultGlitchToleranceScalesThreshold)
     EXPECT_DOUBLE_EQ(6.25, engine.glitch_tolerance_threshold({3.0, 4.0}));
 }
 
+TEST(TestPertEngine, rebasingNeedsNoRetries)
+{
+    ValueSaver saved_screen_x_dots{g_screen_x_dots, 10};
+    ValueSaver saved_screen_y_dots{g_screen_y_dots, 10};
+    PertEngine engine;
+    const std::vector<Point> glitched(50, Point{1, 1});
+
+    engine.set_rebase(true);
+
+    EXPECT_FALSE(engine.retry_needed(glitched));
+}
+
+TEST(TestPertEngine, retryNeededForGlitchedPixels)
+{
+    ValueSaver saved_screen_x_dots{g_screen_x_dots, 10};
+    ValueSaver saved_screen_y_dots{g_screen_y_dots, 10};
+    PertEngine engine;
+    const std::vector<Point> glitched(50, Point{1, 1});
+
+    engine.set_rebase(false);
+
+    EXPECT_TRUE(engine.retry_needed(glitched));
+}
+
+TEST_F(TestPertEngineBands, bandColorsMatchSerialColors)
+{
+    PertEngine serial;
+    start(serial);
+    const std::vector<int> expected{serial_colors(serial)};
+    serial.finish();
+    PertEngine banded;
+    start(banded);
+
+    const std::vector<int> colors{band_colors(banded)};
+    banded.finish();
+
+    EXPECT_EQ(expected, colors);
+    EXPECT_NE(colors.end(), std::find(colors.begin(), colors.end(), 0));
+}
+
+TEST_F(TestPertEngineBands, bandGlitchesMatchSerialGlitches)
+{
+    PertEngine serial;
+    start(serial);
+    serial_colors(serial);
+    const std::vector<Point> expected{serial.take_glitch_points()};
+    serial.finish();
+    PertEngine banded;
+    start(banded);
+
+    band_colors(banded);
+    const std::vector<Point> glitches{banded.take_glitch_points()};
+    banded.finish();
+
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(sorted(expected), sorted(glitches));
+}
+
+TEST_F(TestPertEngineBands, retryReferenceRecomputesBands)
+{
+    PertEngine engine;
+    start(engine);
+    const std::vector<int> first{band_colors(engine)};
+    const std::vector<Point> glitches{engine.take_glitch_points()};
+    ASSERT_TRUE(engine.select_retry_reference(glitches));
+
+    const std::vector<int> retried{band_colors(engine)};
+    const std::vector<int> expected{serial_colors(engine)};
+    engine.finish();
+
+    EXPECT_EQ(expected, retried);
+    EXPECT_NE(first, retried);
+}
+
 } // namespace id::test
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <engine/ReferenceOrbitCache.h>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <system_error>
+
+using namespace id::engine;
+using namespace id::fractals;
+
+namespace fs = std::filesystem;
+
+namespace id::test
+{
+
+static ReferenceOrbitKey make_key(const unsigned char center)
+{
+    ReferenceOrbitKey key;
+    key.fractal_type = FractalType::MANDEL;
+    key.bf_length = 10;
+    key.center = {center, 1, 2, 3};
+    key.params = {2.0, 0.0, 0.0, 0.0, 0.0};
+    return key;
+}
+
+static ReferenceOrbit make_orbit(const int length)
+{
+    ReferenceOrbit orbit;
+    for (int i = 0; i < length; ++i)
+    {
+        orbit.xn.emplace_back(i * 0.5, -i * 0.25);
+    }
+    orbit.next_z = {9, 8, 7, 6};
+    return orbit;
+}
+
+class TestReferenceOrbitCache : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_dir = fs::temp_directory_path() /
+            ("id-test-orbit-cache-" + std::string{testing::UnitTest::GetInstance()->current_test_info()->name()});
+        fs::remove_all(m_dir);
+        fs::create_directories(m_dir);
+    }
+    void TearDown() override
+    {
+        std::error_code ec;
+        fs::remove_all(m_dir, ec);
+    }
+
+    fs::path m_dir;
+};
+
+TEST_F(TestReferenceOrbitCache, emptyCacheMisses)
+{
+    ReferenceOrbitCache cache;
+
+    EXPECT_EQ(nullptr, cache.find(make_key(0)));
+}
+
+TEST_F(TestReferenceOrbitCache, storedOrbitIsFound)
+{
+    ReferenceOrbitCache cache;
+
+    cache.store(make_key(0), make_orbit(10), false);
+    const auto orbit{cache.find(make_key(0))};
+
+    ASSERT_NE(nullptr, orbit);
+    EXPECT_EQ(make_orbit(10).xn, orbit->xn);
+    EXPECT_EQ(make_orbit(10).next_z, orbit->next_z);
+}
+
+TEST_F(TestReferenceOrbitCache, differentCenterMisses)
+{
+    ReferenceOrbitCache cache;
+
+    cache.store(make_key(0), make_orbit(10), false);
+
+    EXPECT_EQ(nullptr, cache.find(make_key(1)));
+}
+
+TEST_F(TestReferenceOrbitCache, differentPrecisionMisses)
+{
+    ReferenceOrbitCache cache;
+    cache.store(make_key(0), make_orbit(10), false);
+    ReferenceOrbitKey key{make_key(0)};
+    key.bf_length = 12;
+
+    EXPECT_EQ(nullptr, cache.find(key));
+}
+
+TEST_F(TestReferenceOrbitCache, storeReplacesSameKey)
+{
+    ReferenceOrbitCache cache;
+
+    cache.store(make_key(0), make_orbit(10), false);
+    cache.store(make_key(0), make_orbit(20), false);
+
+    EXPECT_EQ(1U, cache.size());
+    EXPECT_EQ(20U, cache.find(make_key(0))->xn.size());
+}
+
+TEST_F(TestReferenceOrbitCache, leastRecentlyUsedIsEvicted)
+{
+    ReferenceOrbitCache cache{2};
+    cache.store(make_key(0), make_orbit(10), false);
+    cache.store(make_key(1), make_orbit(10), false);
+
+    ASSERT_NE(nullptr, cache.find(make_key(0)));
+    cache.store(make_key(2), make_orbit(10), false);
+
+    EXPECT_EQ(2U, cache.size());
+    EXPECT_NE(nullptr, cache.find(make_key(0)));
+    EXPECT_EQ(nullptr, cache.find(make_key(1)));
+    EXPECT_NE(nullptr, cache.find(make_key(2)));
+}
+
+TEST_F(TestReferenceOrbitCache, persistedOrbitIsLoadedFromDisk)
+{
+    {
+        ReferenceOrbitCache cache;
+        cache.set_directory(m_dir);
+        cache.store(make_key(0), make_orbit(100), true);
+    }
+    ReferenceOrbitCache cache;
+    cache.set_directory(m_dir);
+
+    const auto orbit{cache.find(make_key(0))};
+
+    ASSERT_NE(nullptr, orbit);
+    EXPECT_EQ(make_orbit(100).xn, orbit->xn);
+    EXPECT_EQ(make_orbit(100).next_z, orbit->next_z);
+    EXPECT_EQ(nullptr, cache.find(make_key(1)));
+}
+
+TEST_F(TestReferenceOrbitCache, unpersistedOrbitIsNotWritten)
+{
+    ReferenceOrbitCache cache;
+    cache.set_directory(m_dir);
+
+    cache.store(make_key(0), make_orbit(10), false);
+
+    EXPECT_TRUE(fs::is_empty(m_dir));
+}
+
+TEST_F(TestReferenceOrbitCache, diskFilesArePruned)
+{
+    ReferenceOrbitCache cache;
+    cache.set_directory(m_dir);
+
+    for (unsigned char i = 0; i < ReferenceOrbitCache::MAX_FILES + 3; ++i)
+    {
+        cache.store(make_key(i), make_orbit(10), true);
+    }
+
+    EXPECT_EQ(ReferenceOrbitCache::MAX_FILES,
+        static_cast<std::size_t>(std::distance(fs::directory_iterator{m_dir}, fs::directory_iterator{})));
+}
+
+} // namespace id::test
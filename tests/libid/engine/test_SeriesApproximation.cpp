@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <engine/SeriesApproximation.h>
+
+#include <gtest/gtest.h>
+
+#include <complex>
+#include <vector>
+
+using namespace id::engine;
+
+namespace id::test
+{
+
+constexpr int MAX_ITERATION{1000};
+constexpr double MAGNITUDE_LIMIT{4.0};
+
+static std::vector<std::complex<double>> reference_orbit(const std::complex<double> &center)
+{
+    std::vector<std::complex<double>> xn(MAX_ITERATION + 1);
+    std::complex<double> z{center};
+    for (std::complex<double> &x : xn)
+    {
+        x = z;
+        z = z * z + center;
+    }
+    return xn;
+}
+
+// delta_n by direct perturbation iteration, as PertEngine does without the series
+static std::complex<double> perturb(
+    const std::vector<std::complex<double>> &xn, const std::complex<double> &delta0, const int iterations)
+{
+    std::complex<double> delta{delta0};
+    for (int n = 0; n < iterations; ++n)
+    {
+        delta = 2.0 * xn[n] * delta + delta * delta + delta0;
+    }
+    return delta;
+}
+
+class TestSeriesApproximation : public testing::Test
+{
+protected:
+    // a point near the boundary of the main cardioid's seahorse valley
+    const std::vector<std::complex<double>> m_xn{reference_orbit({-0.743643887037151, 0.131825904205330})};
+    SeriesApproximation m_series;
+};
+
+TEST_F(TestSeriesApproximation, skipsSharedIterations)
+{
+    m_series.compute(m_xn, MAX_ITERATION, 1e-10, MAGNITUDE_LIMIT);
+
+    EXPECT_GT(m_series.skip(), 0);
+    EXPECT_LT(m_series.skip(), MAX_ITERATION);
+}
+
+TEST_F(TestSeriesApproximation, matchesPerturbationAtSkip)
+{
+    const double radius{1e-10};
+    m_series.compute(m_xn, MAX_ITERATION, radius, MAGNITUDE_LIMIT);
+    const std::complex<double> delta0{0.6 * radius, -0.7 * radius};
+
+    const std::complex<double> expected{perturb(m_xn, delta0, m_series.skip())};
+    const std::complex<double> actual{m_series.delta(delta0)};
+
+    EXPECT_LT(std::abs(actual - expected), 1e-6 * std::abs(expected));
+}
+
+TEST_F(TestSeriesApproximation, smallerRadiusSkipsMore)
+{
+    SeriesApproximation wide;
+    wide.compute(m_xn, MAX_ITERATION, 1e-6, MAGNITUDE_LIMIT);
+
+    m_series.compute(m_xn, MAX_ITERATION, 1e-12, MAGNITUDE_LIMIT);
+
+    EXPECT_GE(m_series.skip(), wide.skip());
+}
+
+TEST_F(TestSeriesApproximation, zeroRadiusSkipsNothing)
+{
+    m_series.compute(m_xn, MAX_ITERATION, 0.0, MAGNITUDE_LIMIT);
+
+    EXPECT_EQ(0, m_series.skip());
+    EXPECT_EQ(std::complex<double>(1.0, 2.0), m_series.delta(std::complex<double>{1.0, 2.0}));
+}
+
+TEST_F(TestSeriesApproximation, stopsBeforeReferenceEscapes)
+{
+    const std::vector<std::complex<double>> escaping{reference_orbit({0.3, 0.5})};
+
+    m_series.compute(escaping, MAX_ITERATION, 1e-30, MAGNITUDE_LIMIT);
+
+    ASSERT_LT(m_series.skip(), MAX_ITERATION);
+    for (int n = 0; n <= m_series.skip(); ++n)
+    {
+        EXPECT_LT(std::norm(escaping[n]), MAGNITUDE_LIMIT) << n;
+    }
+}
+
+TEST_F(TestSeriesApproximation, resetClearsSkip)
+{
+    m_series.compute(m_xn, MAX_ITERATION, 1e-10, MAGNITUDE_LIMIT);
+
+    m_series.reset();
+
+    EXPECT_EQ(0, m_series.skip());
+}
+
+} // namespace id::test
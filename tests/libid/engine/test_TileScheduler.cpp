@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <engine/TileScheduler.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace id::engine;
+
+namespace id::test
+{
+
+TEST(TestTileScheduler, defaultWorkerCountIsAtLeastOne)
+{
+    const TileScheduler scheduler;
+
+    EXPECT_GE(scheduler.num_workers(), 1U);
+}
+
+TEST(TestTileScheduler, runsEveryTileExactlyOnce)
+{
+    TileScheduler scheduler{4};
+    std::vector<std::atomic<int>> counts(1000);
+
+    scheduler.run(static_cast<int>(counts.size()), [&](const int tile, unsigned) { ++counts[tile]; });
+
+    for (const std::atomic<int> &count : counts)
+    {
+        EXPECT_EQ(1, count.load());
+    }
+}
+
+TEST(TestTileScheduler, workerIndexWithinPool)
+{
+    TileScheduler scheduler{3};
+    std::atomic<bool> out_of_range{};
+
+    scheduler.run(100,
+        [&](int, const unsigned worker)
+        {
+            if (worker >= scheduler.num_workers())
+            {
+                out_of_range = true;
+            }
+        });
+
+    EXPECT_FALSE(out_of_range);
+}
+
+TEST(TestTileScheduler, fewerTilesThanWorkers)
+{
+    TileScheduler scheduler{8};
+    std::atomic<int> count{};
+
+    scheduler.run(3, [&](int, unsigned) { ++count; });
+
+    EXPECT_EQ(3, count.load());
+}
+
+TEST(TestTileScheduler, noTilesDoesNothing)
+{
+    TileScheduler scheduler{2};
+    std::atomic<int> count{};
+
+    scheduler.run(0, [&](int, unsigned) { ++count; });
+
+    EXPECT_EQ(0, count.load());
+}
+
+TEST(TestTileScheduler, reusableAcrossRuns)
+{
+    TileScheduler scheduler{4};
+    std::atomic<int> count{};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        scheduler.run(50, [&](int, unsigned) { ++count; });
+    }
+
+    EXPECT_EQ(500, count.load());
+}
+
+TEST(TestTileScheduler, rethrowsTileException)
+{
+    TileScheduler scheduler{4};
+
+    EXPECT_THROW(scheduler.run(10,
+                     [](const int tile, unsigned)
+                     {
+                         if (tile == 5)
+                         {
+                             throw std::runtime_error("tile failed");
+                         }
+                     }),
+        std::runtime_error);
+}
+
+} // namespace id::test
@@ -21,17 +21,20 @@
 #include <engine/fractals.h>
 #include <engine/ImageRegion.h>
 #include <engine/Inversion.h>
+#include <engine/iteration_buffer.h>
 #include <engine/log_map.h>
 #include <engine/orbit.h>
 #include <engine/Potential.h>
 #include <engine/random_seed.h>
 #include <engine/show_dot.h>
+#include <engine/simd_escape.h>
 #include <engine/soi.h>
 #include <engine/solid_guess.h>
 #include <engine/sound.h>
 #include <engine/spindac.h>
 #include <engine/sticky_orbits.h>
 #include <engine/text_color.h>
+#include <engine/tiled_render.h>
 #include <engine/trig_fns.h>
 #include <engine/UserData.h>
 #include <engine/VideoInfo.h>
@@ -50,6 +53,7 @@
 #include <io/CurrentPathSaver.h>
 #include <io/encoder.h>
 #include <io/gifview.h>
+#include <io/iteration_data.h>
 #include <io/library.h>
 #include <io/loadfile.h>
 #include <io/loadmap.h>
@@ -112,6 +116,11 @@ TEST(TestUserData, perturbationToleranceDefault)
     EXPECT_DOUBLE_EQ(DEFAULT_PERTURBATION_TOLERANCE, UserData{}.perturbation_tolerance);
 }
 
+TEST(TestUserData, perturbationGlitchDefaultRebase)
+{
+    EXPECT_EQ(PerturbationGlitch::REBASE, UserData{}.perturbation_glitch);
+}
+
 static std::ostream &operator<<(std::ostream &str, const CmdArgFlags value)
 {
     if (value == CmdArgFlags::BAD_ARG)
@@ -2290,6 +2299,36 @@ TEST_F(TestParameterCommandError, perturbationMissingValue)
     EXPECT_EQ(PerturbationMode::YES, g_user.perturbation);
 }
 
+TEST_F(TestParameterCommand, perturbationGlitchRetry)
+{
+    ValueSaver saved_user_perturbation_glitch{g_user.perturbation_glitch, PerturbationGlitch::REBASE};
+
+    exec_cmd_arg("perturbation-glitch=retry", CmdFile::AT_CMD_LINE);
+
+    EXPECT_EQ(CmdArgFlags::FRACTAL_PARAM, m_result);
+    EXPECT_EQ(PerturbationGlitch::RETRY, g_user.perturbation_glitch);
+}
+
+TEST_F(TestParameterCommand, perturbationGlitchRebase)
+{
+    ValueSaver saved_user_perturbation_glitch{g_user.perturbation_glitch, PerturbationGlitch::RETRY};
+
+    exec_cmd_arg("perturbation-glitch=rebase", CmdFile::AT_CMD_LINE);
+
+    EXPECT_EQ(CmdArgFlags::FRACTAL_PARAM, m_result);
+    EXPECT_EQ(PerturbationGlitch::REBASE, g_user.perturbation_glitch);
+}
+
+TEST_F(TestParameterCommandError, perturbationGlitchInvalidValue)
+{
+    ValueSaver saved_user_perturbation_glitch{g_user.perturbation_glitch, PerturbationGlitch::RETRY};
+
+    exec_cmd_arg("perturbation-glitch=maybe", CmdFile::AT_CMD_LINE);
+
+    EXPECT_EQ(CmdArgFlags::BAD_ARG, m_result);
+    EXPECT_EQ(PerturbationGlitch::RETRY, g_user.perturbation_glitch);
+}
+
 TEST_F(TestParameterCommand, perturbationTolerance)
 {
     ValueSaver saved_user_perturbation_tolerance{g_user.perturbation_tolerance, DEFAULT_PERTURBATION_TOLERANCE};
@@ -2739,6 +2778,80 @@ TEST_F(TestParameterCommand, textColorsSkippedValues)
     EXPECT_EQ(0x28, g_text_color[1]);
 }
 
+TEST_F(TestParameterCommand, tiledGifSize)
+{
+    ValueSaver saved_tiled_render{g_tiled_render, TiledRenderSize{}};
+
+    exec_cmd_arg("tiledgif=65535/32768");
+
+    EXPECT_EQ(CmdArgFlags::NONE, m_result);
+    EXPECT_EQ(65535, g_tiled_render.width);
+    EXPECT_EQ(32768, g_tiled_render.height);
+    EXPECT_EQ(TiledRenderSize{}.tile_size, g_tiled_render.tile_size);
+}
+
+TEST_F(TestParameterCommand, tiledGifTileSize)
+{
+    ValueSaver saved_tiled_render{g_tiled_render, TiledRenderSize{}};
+
+    exec_cmd_arg("tiledgif=4096/2048/512");
+
+    EXPECT_EQ(CmdArgFlags::NONE, m_result);
+    EXPECT_EQ(4096, g_tiled_render.width);
+    EXPECT_EQ(2048, g_tiled_render.height);
+    EXPECT_EQ(512, g_tiled_render.tile_size);
+}
+
+TEST_F(TestParameterCommandError, tiledGifMissingHeight)
+{
+    ValueSaver saved_tiled_render{g_tiled_render, TiledRenderSize{}};
+
+    exec_cmd_arg("tiledgif=4096");
+
+    EXPECT_EQ(CmdArgFlags::BAD_ARG, m_result);
+    EXPECT_FALSE(g_tiled_render.enabled());
+}
+
+TEST_F(TestParameterCommandError, tiledGifZeroTileSize)
+{
+    ValueSaver saved_tiled_render{g_tiled_render, TiledRenderSize{}};
+
+    exec_cmd_arg("tiledgif=4096/2048/0");
+
+    EXPECT_EQ(CmdArgFlags::BAD_ARG, m_result);
+    EXPECT_FALSE(g_tiled_render.enabled());
+}
+
+TEST_F(TestParameterCommand, iterationDataFilename)
+{
+    ValueSaver saved_iteration_data{g_iteration_data_filename, std::filesystem::path{}};
+
+    exec_cmd_arg("iterdata=poster.itd");
+
+    EXPECT_EQ(CmdArgFlags::NONE, m_result);
+    EXPECT_EQ(std::filesystem::path{"poster.itd"}, g_iteration_data_filename);
+}
+
+TEST_F(TestParameterCommand, recolorYes)
+{
+    ValueSaver saved_keep_iterations{g_keep_iterations, false};
+
+    exec_cmd_arg("recolor=yes");
+
+    EXPECT_EQ(CmdArgFlags::NONE, m_result);
+    EXPECT_TRUE(g_keep_iterations);
+}
+
+TEST_F(TestParameterCommandError, recolorBadArg)
+{
+    ValueSaver saved_keep_iterations{g_keep_iterations, false};
+
+    exec_cmd_arg("recolor=maybe", CmdFile::SSTOOLS_INI);
+
+    EXPECT_EQ(CmdArgFlags::BAD_ARG, m_result);
+    EXPECT_FALSE(g_keep_iterations);
+}
+
 TEST_F(TestParameterCommand, potentialOneValue)
 {
     ValueSaver saved_potential_params0{g_potential.params[0], 9999.0};
@@ -3048,6 +3161,26 @@ TEST_F(TestParameterCommand, julibrot3DDistance)
     EXPECT_EQ(18.0F, g_julibrot_dist);
 }
 
+TEST_F(TestParameterCommand, julibrotCoarse)
+{
+    ValueSaver saved_julibrot_coarse_step{g_julibrot_coarse_step, 1};
+
+    exec_cmd_arg("julibrotcoarse=8");
+
+    EXPECT_EQ(CmdArgFlags::FRACTAL_PARAM, m_result);
+    EXPECT_EQ(8, g_julibrot_coarse_step);
+}
+
+TEST_F(TestParameterCommandError, julibrotCoarseTooLarge)
+{
+    ValueSaver saved_julibrot_coarse_step{g_julibrot_coarse_step, 1};
+
+    exec_cmd_arg("julibrotcoarse=33");
+
+    EXPECT_EQ(CmdArgFlags::BAD_ARG, m_result);
+    EXPECT_EQ(1, g_julibrot_coarse_step);
+}
+
 TEST_F(TestParameterCommand, julibrotEyes)
 {
     ValueSaver saved_eyes{g_eyes, 111.0F};
@@ -4568,6 +4701,46 @@ TEST_F(TestParameterCommand, lightSource)
     EXPECT_EQ(3, g_light_z);
 }
 
+TEST_F(TestParameterCommand, simdAuto)
+{
+    ValueSaver saved_simd_mode{g_simd_mode, SimdMode::OFF};
+
+    exec_cmd_arg("simd=auto", CmdFile::AT_CMD_LINE);
+
+    EXPECT_EQ(CmdArgFlags::NONE, m_result);
+    EXPECT_EQ(SimdMode::AUTO, g_simd_mode);
+}
+
+TEST_F(TestParameterCommand, simdOff)
+{
+    ValueSaver saved_simd_mode{g_simd_mode, SimdMode::AUTO};
+
+    exec_cmd_arg("simd=off", CmdFile::AT_CMD_LINE);
+
+    EXPECT_EQ(CmdArgFlags::NONE, m_result);
+    EXPECT_EQ(SimdMode::OFF, g_simd_mode);
+}
+
+TEST_F(TestParameterCommand, simdForce)
+{
+    ValueSaver saved_simd_mode{g_simd_mode, SimdMode::AUTO};
+
+    exec_cmd_arg("simd=force", CmdFile::AT_CMD_LINE);
+
+    EXPECT_EQ(CmdArgFlags::NONE, m_result);
+    EXPECT_EQ(SimdMode::FORCE, g_simd_mode);
+}
+
+TEST_F(TestParameterCommandError, simdInvalidValue)
+{
+    ValueSaver saved_simd_mode{g_simd_mode, SimdMode::OFF};
+
+    exec_cmd_arg("simd=fast", CmdFile::AT_CMD_LINE);
+
+    EXPECT_EQ(CmdArgFlags::BAD_ARG, m_result);
+    EXPECT_EQ(SimdMode::OFF, g_simd_mode);
+}
+
 TEST_F(TestParameterCommand, smoothing)
 {
     ValueSaver saved_light_avg{g_light_avg, -99};
@@ -5000,7 +5173,7 @@ TEST_F(TestParameterCommandError, rayNegative)
 
 TEST_F(TestParameterCommandError, rayTooLarge)
 {
-    exec_cmd_arg("ray=8");
+    exec_cmd_arg("ray=10");
 
     EXPECT_EQ(CmdArgFlags::BAD_ARG, m_result);
 }
@@ -5032,6 +5205,25 @@ TEST_F(TestParameterCommand, rayByNamePOVRay)
     EXPECT_EQ(RayTraceFormat::DKB_POVRAY, g_raytrace_format);
 }
 
+TEST_F(TestParameterCommand, rayByNamePLY)
+{
+    ValueSaver saved_raytrace_format{g_raytrace_format, RayTraceFormat::RAYSHADE};
+
+    exec_cmd_arg("ray=ply");
+
+    EXPECT_EQ(RayTraceFormat::PLY, g_raytrace_format);
+}
+
+TEST_F(TestParameterCommand, rayBinarySTL)
+{
+    ValueSaver saved_raytrace_format{g_raytrace_format, RayTraceFormat::NONE};
+
+    exec_cmd_arg("ray=9", CmdFile::AT_CMD_LINE);
+
+    EXPECT_EQ(CmdArgFlags::PARAM_3D, m_result);
+    EXPECT_EQ(RayTraceFormat::STL, g_raytrace_format);
+}
+
 TEST_F(TestParameterCommand, briefNo)
 {
     ValueSaver saved_brief{g_brief, true};
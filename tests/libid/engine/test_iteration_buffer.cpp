@@ -0,0 +1,302 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <engine/iteration_buffer.h>
+
+#include <engine/calc_frac_init.h>
+#include <engine/calcfrac.h>
+#include <engine/log_map.h>
+#include <engine/LogicalScreen.h>
+#include <engine/Potential.h>
+#include <engine/UserData.h>
+#include <engine/VideoInfo.h>
+#include <misc/debug_flags.h>
+#include <misc/Driver.h>
+#include <misc/ValueSaver.h>
+#include <ui/video.h>
+
+#include "MockDriver.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace id::engine;
+using namespace id::math;
+using namespace id::misc;
+using namespace id::misc::test;
+using namespace id::ui;
+using testing::_;
+using testing::Invoke;
+
+namespace id::test
+{
+
+namespace
+{
+
+constexpr int WIDTH{4};
+constexpr int HEIGHT{3};
+constexpr long MAX_ITERATIONS{100};
+
+std::vector<int> s_screen;
+
+int read_screen(const int x, const int y)
+{
+    return s_screen[y * WIDTH + x];
+}
+
+void write_screen(const int x, const int y, const int color)
+{
+    s_screen[y * WIDTH + x] = color;
+}
+
+void mirror_plot(const int x, const int y, const int color)
+{
+    g_put_color(x, y, color);
+    g_put_color(x, HEIGHT - 1 - y, color);
+}
+
+} // namespace
+
+class TestIterationBuffer : public testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    void start();
+    void plot(int x, int y, long iterations, DComplex z = {});
+    void guess(int x, int y, int color);
+    void finish();
+
+    MockDriver m_driver;
+    ValueSaver<Driver *> m_saved_driver{g_driver, &m_driver};
+    ValueSaver<LogicalScreen> m_saved_logical_screen{
+        g_logical_screen, LogicalScreen{WIDTH, HEIGHT, 0, 0, WIDTH - 1.0, HEIGHT - 1.0}};
+    ValueSaver<int> m_saved_screen_x_dots{g_screen_x_dots, WIDTH};
+    ValueSaver<int> m_saved_screen_y_dots{g_screen_y_dots, HEIGHT};
+    ValueSaver<int> m_saved_colors{g_colors, 256};
+    ValueSaver<int> m_saved_and_color{g_and_color, 255};
+    ValueSaver<long> m_saved_max_iterations{g_max_iterations, MAX_ITERATIONS};
+    ValueSaver<bool> m_saved_keep_iterations{g_keep_iterations, true};
+    ValueSaver<CalcStatus> m_saved_calc_status{g_calc_status, CalcStatus::COMPLETED};
+    ValueSaver<CalcMode> m_saved_std_calc_mode{g_std_calc_mode, CalcMode::ONE_PASS};
+    ValueSaver<DebugFlags> m_saved_debug_flag{g_debug_flag, DebugFlags::NONE};
+    ValueSaver<ColorMethod> m_saved_inside_method{g_inside_method, ColorMethod::COLOR};
+    ValueSaver<int> m_saved_inside_color{g_inside_color, 0};
+    ValueSaver<ColorMethod> m_saved_outside_method{g_outside_method, ColorMethod::ITER};
+    ValueSaver<int> m_saved_outside_color{g_outside_color, 1};
+    ValueSaver<long> m_saved_log_map_flag{g_log_map_flag, 0};
+    ValueSaver<bool> m_saved_log_map_auto_calculate{g_log_map_auto_calculate, false};
+    ValueSaver<int> m_saved_biomorph{g_biomorph, -1};
+    ValueSaver<UserData> m_saved_user{g_user, UserData{}};
+    ValueSaver<Potential> m_saved_potential{g_potential, Potential{}};
+    ValueSaver<long> m_saved_distance_estimator{g_distance_estimator, 0};
+    ValueSaver<int> m_saved_periodicity_check{g_periodicity_check, 1};
+    ValueSaver<void (*)(int, int, int)> m_saved_put_color{g_put_color, write_screen};
+    ValueSaver<void (*)(int, int, int)> m_saved_plot{g_plot, write_screen};
+};
+
+void TestIterationBuffer::SetUp()
+{
+    s_screen.assign(WIDTH * HEIGHT, 0);
+    EXPECT_CALL(m_driver, read_pixel(_, _)).WillRepeatedly(Invoke(read_screen));
+    EXPECT_CALL(m_driver, write_pixel(_, _, _)).WillRepeatedly(Invoke(write_screen));
+    set_normal_dot();
+    set_normal_span();
+    g_user.biomorph_value = -1;
+}
+
+void TestIterationBuffer::TearDown()
+{
+    free_iteration_buffer();
+    set_null_video();
+}
+
+void TestIterationBuffer::start()
+{
+    start_iteration_buffer(false);
+    g_plot = g_put_color;
+}
+
+void TestIterationBuffer::plot(const int x, const int y, const long iterations, const DComplex z)
+{
+    set_pixel_iteration(iterations, z);
+    g_plot(x, y, static_cast<int>(iterations >= MAX_ITERATIONS ? g_inside_color : iterations));
+    clear_pixel_iteration();
+}
+
+void TestIterationBuffer::guess(const int x, const int y, const int color)
+{
+    g_plot(x, y, color);
+}
+
+void TestIterationBuffer::finish()
+{
+    stop_iteration_buffer(true);
+}
+
+TEST_F(TestIterationBuffer, stopRestoresPutColor)
+{
+    start();
+    EXPECT_NE(write_screen, g_put_color);
+
+    finish();
+
+    EXPECT_EQ(write_screen, g_put_color);
+    EXPECT_EQ(write_screen, g_plot);
+}
+
+TEST_F(TestIterationBuffer, eligibleWithIterationColoring)
+{
+    start();
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        plot(i % WIDTH, i / WIDTH, i + 1);
+    }
+    finish();
+
+    EXPECT_EQ(nullptr, recolor_ineligible_reason());
+}
+
+TEST_F(TestIterationBuffer, ineligibleWithoutKeptImage)
+{
+    EXPECT_NE(nullptr, recolor_ineligible_reason());
+}
+
+TEST_F(TestIterationBuffer, ineligibleWithOrbitColoring)
+{
+    start();
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        plot(i % WIDTH, i / WIDTH, i + 1);
+    }
+    finish();
+
+    g_outside_method = ColorMethod::TDIS;
+    EXPECT_NE(nullptr, recolor_ineligible_reason());
+    g_outside_method = ColorMethod::ITER;
+    g_inside_method = ColorMethod::ZMAG;
+    EXPECT_NE(nullptr, recolor_ineligible_reason());
+    g_inside_method = ColorMethod::COLOR;
+    g_potential.flag = true;
+    EXPECT_NE(nullptr, recolor_ineligible_reason());
+}
+
+TEST_F(TestIterationBuffer, recolorOutsideAndInside)
+{
+    start();
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        plot(i % WIDTH, i / WIDTH, i % 2 == 0 ? i + 1 : MAX_ITERATIONS);
+    }
+    finish();
+    g_outside_method = ColorMethod::COLOR;
+    g_outside_color = 5;
+    g_inside_color = 9;
+
+    ASSERT_TRUE(recolor_image());
+
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        EXPECT_EQ(i % 2 == 0 ? 5 : 9, s_screen[i]) << "pixel " << i;
+    }
+}
+
+TEST_F(TestIterationBuffer, recolorUsesFinalZ)
+{
+    start();
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        plot(i % WIDTH, i / WIDTH, 10, DComplex{static_cast<double>(i), 0.0});
+    }
+    finish();
+    g_outside_method = ColorMethod::REAL;
+
+    ASSERT_TRUE(recolor_image());
+
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        EXPECT_EQ(10 + i + 7, s_screen[i]) << "pixel " << i;
+    }
+}
+
+TEST_F(TestIterationBuffer, guessedPixelsTakeNeighborIterations)
+{
+    start();
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        if (i % WIDTH == 2)
+        {
+            guess(i % WIDTH, i / WIDTH, 20);
+        }
+        else
+        {
+            plot(i % WIDTH, i / WIDTH, i % WIDTH == 3 ? 20 : 30, DComplex{2.0, 0.0});
+        }
+    }
+    finish();
+    g_outside_method = ColorMethod::REAL;
+
+    ASSERT_TRUE(recolor_image());
+
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        EXPECT_EQ(i % WIDTH >= 2 ? 29 : 39, s_screen[i]) << "pixel " << i;
+    }
+}
+
+TEST_F(TestIterationBuffer, symmetricCopiesKeepPixel)
+{
+    start();
+    g_plot = mirror_plot;
+    for (int x = 0; x < WIDTH; ++x)
+    {
+        plot(x, 0, x + 1, DComplex{static_cast<double>(x), 0.0});
+        plot(x, 1, 50);
+    }
+    finish();
+    g_outside_method = ColorMethod::REAL;
+
+    ASSERT_TRUE(recolor_image());
+
+    for (int x = 0; x < WIDTH; ++x)
+    {
+        EXPECT_EQ(x + 1 + x + 7, s_screen[x]) << "column " << x;
+        EXPECT_EQ(x + 1 + x + 7, s_screen[(HEIGHT - 1) * WIDTH + x]) << "column " << x;
+    }
+}
+
+TEST_F(TestIterationBuffer, changedScreenIsNotRecolored)
+{
+    start();
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        plot(i % WIDTH, i / WIDTH, i + 1);
+    }
+    finish();
+    write_screen(1, 1, 77);
+    g_outside_method = ColorMethod::COLOR;
+
+    EXPECT_FALSE(recolor_image());
+    EXPECT_EQ(77, s_screen[WIDTH + 1]);
+    EXPECT_NE(nullptr, recolor_ineligible_reason());
+}
+
+TEST_F(TestIterationBuffer, autoLogMapUsesEdges)
+{
+    start();
+    for (int i = 0; i < WIDTH * HEIGHT; ++i)
+    {
+        const int x{i % WIDTH};
+        const int y{i / WIDTH};
+        const bool edge{x == 0 || y == 0 || x == WIDTH - 1 || y == HEIGHT - 1};
+        plot(x, y, edge ? 40 - i : 2);
+    }
+    finish();
+
+    EXPECT_EQ(40 - (WIDTH * HEIGHT - 2), iteration_buffer_auto_log_map());
+}
+
+} // namespace id::test
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <engine/simd_escape.h>
+
+#include <engine/calc_frac_init.h>
+#include <engine/calcfrac.h>
+#include <engine/calmanfp.h>
+#include <engine/fractals.h>
+#include <engine/ImageRegion.h>
+#include <engine/LogicalScreen.h>
+#include <engine/pixel_grid.h>
+#include <fractals/fractype.h>
+#include <misc/ValueSaver.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+
+namespace id::test
+{
+
+constexpr int WIDTH{61};
+constexpr int HEIGHT{9};
+
+class TestSimdEscapeRow : public testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    void expect_rows_match_scalar();
+
+    ValueSaver<LogicalScreen> saved_logical_screen{g_logical_screen, LogicalScreen{WIDTH, HEIGHT}};
+    ValueSaver<ImageRegion> saved_image_region{g_image_region};
+    ValueSaver<LDouble> saved_delta_x{g_delta_x, 3.0L / (WIDTH - 1)};
+    ValueSaver<LDouble> saved_delta_y{g_delta_y, 2.4L / (HEIGHT - 1)};
+    ValueSaver<LDouble> saved_delta_x2{g_delta_x2, 0.0L};
+    ValueSaver<LDouble> saved_delta_y2{g_delta_y2, 0.0L};
+    ValueSaver<FractalType> saved_fractal_type{g_fractal_type, FractalType::MANDEL};
+    ValueSaver<DComplex> saved_param_z1{g_param_z1, DComplex{}};
+    ValueSaver<long> saved_max_iterations{g_max_iterations, 500};
+    ValueSaver<double> saved_magnitude_limit{g_magnitude_limit, 4.0};
+    ValueSaver<int> saved_periodicity_check{g_periodicity_check, 1};
+    ValueSaver<double> saved_close_enough{g_close_enough, 1e-10};
+    ValueSaver<long> saved_first_saved_and{g_first_saved_and, 9};
+    ValueSaver<int> saved_next_saved_incr{g_periodicity_next_saved_incr, 4};
+    ValueSaver<ColorMethod> saved_inside_method{g_inside_method, ColorMethod::ITER};
+    ValueSaver<ColorMethod> saved_outside_method{g_outside_method, ColorMethod::ITER};
+};
+
+void TestSimdEscapeRow::SetUp()
+{
+    g_image_region.m_min = DComplex{-2.0, -1.2};
+    g_image_region.m_max = DComplex{1.0, 1.2};
+    alloc_pixel_grid();
+    fill_pixel_grid();
+    calc_mandelbrot_init();
+}
+
+void TestSimdEscapeRow::TearDown()
+{
+    free_pixel_grid();
+}
+
+void TestSimdEscapeRow::expect_rows_match_scalar()
+{
+    std::vector<MandelbrotOrbit> lanes(WIDTH);
+    for (int row = 0; row < HEIGHT; ++row)
+    {
+        simd_escape_row(row, 0, WIDTH - 1, lanes.data());
+
+        MandelbrotOrbit scalar;
+        for (int col = 0; col < WIDTH; ++col)
+        {
+            mandelbrot_orbit({dx_pixel(col, row), dy_pixel(col, row)}, col == 0, scalar);
+            const MandelbrotOrbit &lane{lanes[col]};
+            EXPECT_EQ(scalar.color_iter, lane.color_iter) << "row " << row << ", col " << col;
+            EXPECT_EQ(scalar.real_color_iter, lane.real_color_iter) << "row " << row << ", col " << col;
+            EXPECT_EQ(scalar.old_color_iter, lane.old_color_iter) << "row " << row << ", col " << col;
+            EXPECT_EQ(scalar.magnitude, lane.magnitude) << "row " << row << ", col " << col;
+        }
+    }
+}
+
+TEST_F(TestSimdEscapeRow, mandelbrotMatchesScalar)
+{
+    expect_rows_match_scalar();
+}
+
+TEST_F(TestSimdEscapeRow, mandelbrotNoPeriodicityMatchesScalar)
+{
+    g_periodicity_check = 0;
+
+    expect_rows_match_scalar();
+}
+
+TEST_F(TestSimdEscapeRow, juliaMatchesScalar)
+{
+    g_fractal_type = FractalType::JULIA;
+    g_param_z1 = DComplex{-0.8, 0.156};
+
+    expect_rows_match_scalar();
+}
+
+TEST_F(TestSimdEscapeRow, partialRowMatchesScalar)
+{
+    std::vector<MandelbrotOrbit> lanes(SIMD_ESCAPE_LANES / 2);
+    const int first_col{WIDTH / 2};
+    const int last_col{first_col + static_cast<int>(lanes.size()) - 1};
+
+    simd_escape_row(HEIGHT / 2, first_col, last_col, lanes.data());
+
+    MandelbrotOrbit scalar;
+    for (int col = first_col; col <= last_col; ++col)
+    {
+        mandelbrot_orbit({dx_pixel(col, HEIGHT / 2), dy_pixel(col, HEIGHT / 2)}, col == first_col, scalar);
+        EXPECT_EQ(scalar.color_iter, lanes[col - first_col].color_iter) << "col " << col;
+    }
+}
+
+} // namespace id::test
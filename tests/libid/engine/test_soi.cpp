@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <engine/soi.h>
+
+#include "MockDriver.h"
+
+#include <engine/bailout_formula.h>
+#include <engine/calcfrac.h>
+#include <engine/fractals.h>
+#include <engine/ImageRegion.h>
+#include <engine/LogicalScreen.h>
+#include <fractals/fractalp.h>
+#include <fractals/fractype.h>
+#include <math/big.h>
+#include <misc/Driver.h>
+#include <misc/stack_avail.h>
+#include <misc/ValueSaver.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+using namespace id::misc::test;
+using testing::Return;
+
+namespace id::test
+{
+
+constexpr int WIDTH{160};
+constexpr int HEIGHT{120};
+
+static std::vector<int> s_image;
+
+static void capture_plot(const int x, const int y, const int color)
+{
+    if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
+    {
+        s_image[y * WIDTH + x] = color;
+    }
+}
+
+// The Mandelbrot orbit behind a different function, so SOI scans with the
+// engine globals on the calling thread.
+static int engine_orbit()
+{
+    return julia_orbit();
+}
+
+class TestSOI : public testing::Test
+{
+protected:
+    void SetUp() override;
+
+    std::vector<int> calculate(OrbitCalc orbit);
+    void expect_tasks_match_serial();
+
+    MockDriver m_driver;
+    ValueSaver<Driver *> m_saved_driver{g_driver, &m_driver};
+    ValueSaver<LogicalScreen> m_saved_logical_screen{g_logical_screen, LogicalScreen{WIDTH, HEIGHT}};
+    ValueSaver<ImageRegion> m_saved_image_region{g_image_region};
+    ValueSaver<BFMathType> m_saved_bf_math{g_bf_math, BFMathType::NONE};
+    ValueSaver<FractalDispatch> m_saved_dispatch{g_dispatch, FractalDispatch{FractalType::MANDEL}};
+    ValueSaver<long> m_saved_max_iterations{g_max_iterations, 256};
+    ValueSaver<double> m_saved_magnitude_limit{g_magnitude_limit, 4.0};
+    ValueSaver<Bailout> m_saved_bailout_test{g_bailout_test};
+    ValueSaver<int (*)()> m_saved_bailout_float{g_bailout_float};
+    ValueSaver<int (*)()> m_saved_bailout_bignum{g_bailout_bignum};
+    ValueSaver<int (*)()> m_saved_bailout_bigfloat{g_bailout_bigfloat};
+    ValueSaver<void (*)(int, int, int)> m_saved_plot{g_plot, capture_plot};
+    ValueSaver<int> m_saved_min_stack{g_soi_min_stack, 0};
+};
+
+void TestSOI::SetUp()
+{
+    EXPECT_CALL(m_driver, key_pressed()).WillRepeatedly(Return(0));
+    g_bailout_test = Bailout::MOD;
+    set_bailout_formula(g_bailout_test);
+    g_image_region.m_min = DComplex{-2.0, -1.2};
+    g_image_region.m_max = DComplex{1.0, 1.2};
+}
+
+std::vector<int> TestSOI::calculate(const OrbitCalc orbit)
+{
+    g_dispatch.set_orbit_calc(orbit);
+    s_image.assign(WIDTH * HEIGHT, -1);
+    char top_of_stack{};
+    ValueSaver saved_top_of_stack{g_top_of_stack, &top_of_stack};
+    SOI soi;
+    soi.calculate();
+    return s_image;
+}
+
+void TestSOI::expect_tasks_match_serial()
+{
+    const std::vector<int> tasks{calculate(julia_orbit)};
+    const std::vector<int> serial{calculate(engine_orbit)};
+
+    EXPECT_EQ(std::count(serial.begin(), serial.end(), -1), 0);
+    for (int y = 0; y < HEIGHT; ++y)
+    {
+        for (int x = 0; x < WIDTH; ++x)
+        {
+            ASSERT_EQ(serial[y * WIDTH + x], tasks[y * WIDTH + x]) << "pixel (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST_F(TestSOI, mandelbrotOrbitSplitsWalkIntoTasks)
+{
+    g_dispatch.set_orbit_calc(julia_orbit);
+
+    EXPECT_TRUE(use_soi_tasks());
+}
+
+TEST_F(TestSOI, engineOrbitKeepsWalkOnCallingThread)
+{
+    g_dispatch.set_orbit_calc(engine_orbit);
+
+    EXPECT_FALSE(use_soi_tasks());
+}
+
+TEST_F(TestSOI, tasksMatchSerialWalk)
+{
+    expect_tasks_match_serial();
+}
+
+TEST_F(TestSOI, tasksMatchSerialWalkZoomed)
+{
+    g_image_region.m_min = DComplex{-0.76, 0.09};
+    g_image_region.m_max = DComplex{-0.74, 0.11};
+
+    expect_tasks_match_serial();
+    EXPECT_LT(0, g_max_rhombus_depth);
+}
+
+TEST_F(TestSOI, tasksMatchSerialWalkManhattanBailout)
+{
+    g_bailout_test = Bailout::MANH;
+    set_bailout_formula(g_bailout_test);
+    g_image_region.m_min = DComplex{-0.76, 0.09};
+    g_image_region.m_max = DComplex{-0.74, 0.11};
+
+    expect_tasks_match_serial();
+}
+
+} // namespace id::test
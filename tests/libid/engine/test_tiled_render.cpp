@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <engine/tiled_render.h>
+
+#include <engine/calc_frac_init.h>
+#include <engine/calcfrac.h>
+#include <engine/calmanfp.h>
+#include <engine/fractals.h>
+#include <engine/ImageRegion.h>
+#include <engine/LogicalScreen.h>
+#include <engine/pixel_grid.h>
+#include <engine/Potential.h>
+#include <engine/simd_escape.h>
+#include <engine/VideoInfo.h>
+#include <fractals/fractalp.h>
+#include <fractals/fractype.h>
+#include <misc/ValueSaver.h>
+#include <ui/KeyboardHandler.h>
+
+#include "MockDriver.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+using namespace id::misc::test;
+using namespace id::ui;
+using namespace testing;
+
+namespace id::test
+{
+
+constexpr int WIDTH{37};
+constexpr int HEIGHT{21};
+
+class TestTiledRender : public Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    std::vector<Byte> screen_image();
+
+    MockDriver m_driver;
+    ValueSaver<Driver *> m_saved_driver{g_driver, &m_driver};
+    ValueSaver<SimdMode> saved_simd_mode{g_simd_mode, SimdMode::OFF};
+    ValueSaver<LogicalScreen> saved_logical_screen{g_logical_screen, LogicalScreen{WIDTH, HEIGHT}};
+    ValueSaver<ImageRegion> saved_image_region{g_image_region};
+    ValueSaver<LDouble> saved_delta_x{g_delta_x};
+    ValueSaver<LDouble> saved_delta_y{g_delta_y};
+    ValueSaver<LDouble> saved_delta_x2{g_delta_x2, 0.0L};
+    ValueSaver<LDouble> saved_delta_y2{g_delta_y2, 0.0L};
+    ValueSaver<FractalType> saved_fractal_type{g_fractal_type, FractalType::MANDEL};
+    ValueSaver<DComplex> saved_param_z1{g_param_z1, DComplex{}};
+    ValueSaver<long> saved_max_iterations{g_max_iterations, 300};
+    ValueSaver<double> saved_magnitude_limit{g_magnitude_limit, 4.0};
+    ValueSaver<int> saved_periodicity_check{g_periodicity_check, 0};
+    ValueSaver<long> saved_first_saved_and{g_first_saved_and, 9};
+    ValueSaver<int> saved_next_saved_incr{g_periodicity_next_saved_incr, 4};
+    ValueSaver<ColorMethod> saved_inside_method{g_inside_method, ColorMethod::ITER};
+    ValueSaver<ColorMethod> saved_outside_method{g_outside_method, ColorMethod::ITER};
+    ValueSaver<int> saved_colors{g_colors, 256};
+    ValueSaver<int> saved_and_color{g_and_color, 255};
+};
+
+void TestTiledRender::SetUp()
+{
+    EXPECT_CALL(m_driver, key_pressed()).WillRepeatedly(Return(0));
+    reset_calc_interrupted();
+    g_image_region.m_min = DComplex{-2.0, -1.2};
+    g_image_region.m_max = DComplex{1.0, 1.2};
+    g_image_region.m_3rd = g_image_region.m_min;
+    g_delta_x = static_cast<LDouble>(g_image_region.m_max.x - g_image_region.m_3rd.x) / (WIDTH - 1);
+    g_delta_y = static_cast<LDouble>(g_image_region.m_max.y - g_image_region.m_3rd.y) / (HEIGHT - 1);
+    alloc_pixel_grid();
+    fill_pixel_grid();
+    calc_mandelbrot_init();
+}
+
+void TestTiledRender::TearDown()
+{
+    free_pixel_grid();
+    reset_calc_interrupted();
+}
+
+// The image as the one-pass scan computes it on the screen.
+std::vector<Byte> TestTiledRender::screen_image()
+{
+    std::vector<Byte> image;
+    std::vector<MandelbrotOrbit> orbits(WIDTH);
+    for (int row = 0; row < HEIGHT; ++row)
+    {
+        mandelbrot_orbit_row(row, 0, WIDTH - 1, orbits.data());
+        for (MandelbrotOrbit &orbit : orbits)
+        {
+            image.push_back(static_cast<Byte>(mandelbrot_color(orbit.color_iter, orbit.real_color_iter, orbit.magnitude)));
+        }
+    }
+    return image;
+}
+
+TEST_F(TestTiledRender, tilesMatchScreenImage)
+{
+    const std::vector<Byte> expected{screen_image()};
+    std::vector<Byte> image(expected.size());
+    int tiles{};
+
+    const bool rendered{tiled_render(TiledRenderSize{WIDTH, HEIGHT, 8},
+        [&](const RenderedTile &tile)
+        {
+            ++tiles;
+            for (int row = 0; row < tile.height; ++row)
+            {
+                for (int col = 0; col < tile.width; ++col)
+                {
+                    image[(tile.top + row) * WIDTH + tile.left + col] = tile.pixels[row * tile.width + col];
+                }
+            }
+            return true;
+        })};
+
+    EXPECT_TRUE(rendered);
+    EXPECT_EQ(5 * 3, tiles);
+    EXPECT_EQ(expected, image);
+}
+
+TEST_F(TestTiledRender, samplesHoldOrbitData)
+{
+    std::vector<MandelbrotOrbit> expected(WIDTH * HEIGHT);
+    for (int row = 0; row < HEIGHT; ++row)
+    {
+        mandelbrot_orbit_row(row, 0, WIDTH - 1, &expected[row * WIDTH]);
+    }
+    std::vector<IterationSample> samples(expected.size());
+
+    tiled_render(
+        TiledRenderSize{WIDTH, HEIGHT, 8},
+        [&](const RenderedTile &tile)
+        {
+            EXPECT_EQ(tile.pixels.size(), tile.samples.size());
+            for (int row = 0; row < tile.height; ++row)
+            {
+                for (int col = 0; col < tile.width; ++col)
+                {
+                    samples[(tile.top + row) * WIDTH + tile.left + col] = tile.samples[row * tile.width + col];
+                }
+            }
+            return true;
+        },
+        true);
+
+    int escaped{};
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        const MandelbrotOrbit &orbit{expected[i]};
+        const IterationSample &sample{samples[i]};
+        EXPECT_EQ(orbit.real_color_iter, static_cast<long>(sample.iterations)) << "pixel " << i;
+        if (orbit.real_color_iter < g_max_iterations)
+        {
+            ++escaped;
+            EXPECT_NEAR(orbit.real_color_iter + 1.0 - std::log2(0.5 * std::log(orbit.magnitude)), sample.smooth, 1e-3)
+                << "pixel " << i;
+            EXPECT_EQ(static_cast<float>(orbit.new_z.x), sample.z_real) << "pixel " << i;
+            EXPECT_EQ(static_cast<float>(orbit.new_z.y), sample.z_imag) << "pixel " << i;
+        }
+        else
+        {
+            EXPECT_EQ(static_cast<float>(g_max_iterations), sample.smooth) << "pixel " << i;
+        }
+    }
+    EXPECT_LT(0, escaped);
+    EXPECT_LT(escaped, WIDTH * HEIGHT);
+}
+
+TEST_F(TestTiledRender, samplesOnlyWhenRequested)
+{
+    tiled_render(TiledRenderSize{WIDTH, HEIGHT, 16},
+        [](const RenderedTile &tile)
+        {
+            EXPECT_TRUE(tile.samples.empty());
+            return true;
+        });
+}
+
+TEST_F(TestTiledRender, tilesArriveInRasterOrder)
+{
+    std::vector<std::pair<int, int>> corners;
+
+    tiled_render(TiledRenderSize{WIDTH, HEIGHT, 16},
+        [&](const RenderedTile &tile)
+        {
+            corners.emplace_back(tile.left, tile.top);
+            EXPECT_EQ(static_cast<std::size_t>(tile.width) * tile.height, tile.pixels.size());
+            return true;
+        });
+
+    const std::vector<std::pair<int, int>> expected{{0, 0}, {16, 0}, {32, 0}, {0, 16}, {16, 16}, {32, 16}};
+    EXPECT_EQ(expected, corners);
+}
+
+TEST_F(TestTiledRender, sinkStopsRendering)
+{
+    int tiles{};
+
+    const bool rendered{tiled_render(TiledRenderSize{WIDTH, HEIGHT, 4},
+        [&](const RenderedTile &)
+        {
+            ++tiles;
+            return false;
+        })};
+
+    EXPECT_FALSE(rendered);
+    EXPECT_EQ(1, tiles);
+}
+
+TEST_F(TestTiledRender, interruptedRenderStops)
+{
+    int tiles{};
+    set_calc_interrupted();
+
+    const bool rendered{tiled_render(TiledRenderSize{WIDTH, HEIGHT, 4},
+        [&](const RenderedTile &)
+        {
+            ++tiles;
+            return true;
+        })};
+
+    EXPECT_FALSE(rendered);
+    EXPECT_EQ(0, tiles);
+}
+
+TEST_F(TestTiledRender, eligibleWithContinuousPotential)
+{
+    ValueSaver saved_dispatch{g_dispatch, FractalDispatch{nullptr, nullptr, nullptr, calc_mandelbrot_type}};
+    ValueSaver saved_potential{g_potential, Potential{{255.0, 820.0, 150.0}, false, true}};
+
+    EXPECT_EQ(nullptr, tiled_render_ineligible_reason());
+}
+
+TEST_F(TestTiledRender, ineligibleWith16BitPotential)
+{
+    ValueSaver saved_dispatch{g_dispatch, FractalDispatch{nullptr, nullptr, nullptr, calc_mandelbrot_type}};
+    ValueSaver saved_potential{g_potential, Potential{{255.0, 820.0, 150.0}, true, true}};
+
+    EXPECT_EQ(std::string{"16 bit continuous potential"}, tiled_render_ineligible_reason());
+}
+
+} // namespace id::test
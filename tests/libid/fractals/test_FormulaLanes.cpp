@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <fractals/FormulaLanes.h>
+
+#include <engine/calcfrac.h>
+#include <engine/ImageRegion.h>
+#include <fractals/formula.h>
+#include <fractals/FormulaVM.h>
+#include <fractals/interpreter.h>
+#include <fractals/parser.h>
+#include <math/arg.h>
+#include <math/fixed_pt.h>
+#include <misc/ValueSaver.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+
+namespace id::test
+{
+
+namespace
+{
+
+constexpr int NUM_ITERATIONS{40};
+constexpr int NUM_PIXELS{FORMULA_LANES + 3};
+
+struct Step
+{
+    DComplex z;
+    bool bailout;
+    bool overflow;
+};
+
+// escaping orbits overflow to NaN, which should still compare equal
+bool same(const double lhs, const double rhs)
+{
+    return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs));
+}
+
+bool operator==(const Step &lhs, const Step &rhs)
+{
+    return same(lhs.z.x, rhs.z.x) && same(lhs.z.y, rhs.z.y) && lhs.bailout == rhs.bailout &&
+        lhs.overflow == rhs.overflow;
+}
+
+std::ostream &operator<<(std::ostream &str, const Step &value)
+{
+    return str << "z(" << value.z.x << ", " << value.z.y << ")" << (value.bailout ? " bailout" : "")
+               << (value.overflow ? " overflow" : "");
+}
+
+DComplex pixel_value(const int i)
+{
+    return {-2.0 + 0.37 * i, 1.25 - 0.29 * i};
+}
+
+class TestFormulaLanes : public testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        parser_reset();
+    }
+
+    static bool parse(const FormulaEntry &entry)
+    {
+        g_formula_name = entry.name;
+        return parse_formula(entry, false);
+    }
+
+    // Orbit of one pixel on the scalar VM, as formula_per_pixel() and
+    // formula_orbit() run it, until it bails out.
+    static std::vector<Step> run_vm(const int i)
+    {
+        g_formula.vars[10].a.d = {static_cast<double>(i), 0.0};
+        g_formula.vars[9].a.d = {(i & 1) != 0 ? 1.0 : 0.0, 0.0};
+        g_formula.vars[0].a.d = pixel_value(i);
+        g_overflow = false;
+        g_formula_vm.run_init();
+        std::vector<Step> steps;
+        for (int n = 0; n < NUM_ITERATIONS; ++n)
+        {
+            const bool bailout{g_formula_vm.run_orbit().x == 0.0};
+            steps.push_back(Step{g_formula.vars[3].a.d, bailout, g_overflow});
+            if (bailout)
+            {
+                break;
+            }
+        }
+        return steps;
+    }
+
+    // The same orbits run in lanes, refilling a lane when its pixel bails out.
+    static std::vector<std::vector<Step>> run_lanes()
+    {
+        FormulaLanes lanes{g_formula_vm, g_formula};
+        std::vector<std::vector<Step>> steps(NUM_PIXELS);
+        std::vector<int> pixel(FORMULA_LANES, -1);
+        int next{};
+        auto load = [&](const int lane)
+        {
+            pixel[lane] = next < NUM_PIXELS ? next++ : -1;
+            if (pixel[lane] >= 0)
+            {
+                lanes.start(lane, pixel_value(pixel[lane]), pixel[lane], 0);
+            }
+        };
+        for (int lane = 0; lane < FORMULA_LANES; ++lane)
+        {
+            load(lane);
+        }
+        for (bool running = true; running;)
+        {
+            FormulaLanes::Mask mask{};
+            for (int lane = 0; lane < FORMULA_LANES; ++lane)
+            {
+                mask[lane] = pixel[lane] >= 0;
+            }
+            lanes.orbit(mask);
+            running = false;
+            for (int lane = 0; lane < FORMULA_LANES; ++lane)
+            {
+                if (pixel[lane] < 0)
+                {
+                    continue;
+                }
+                std::vector<Step> &orbit{steps[pixel[lane]]};
+                orbit.push_back(Step{lanes.z(lane), lanes.bailout(lane), lanes.overflow(lane)});
+                if (orbit.back().bailout || orbit.size() == NUM_ITERATIONS)
+                {
+                    load(lane);
+                }
+                running = running || pixel[lane] >= 0;
+            }
+        }
+        return steps;
+    }
+
+    static void expect_same_orbits()
+    {
+        ASSERT_TRUE(g_formula_vm.compiled());
+        ASSERT_EQ(nullptr, FormulaLanes::ineligible_reason(g_formula_vm, g_formula));
+        const std::vector<std::vector<Step>> actual{run_lanes()};
+        for (int i = 0; i < NUM_PIXELS; ++i)
+        {
+            EXPECT_EQ(run_vm(i), actual[i]) << "pixel " << i;
+        }
+    }
+
+    ValueSaver<std::string> m_saved_formula_name{g_formula_name};
+    ValueSaver<bool> m_saved_overflow{g_overflow};
+    ValueSaver<Arg *> m_saved_arg1{g_arg1};
+    ValueSaver<Arg *> m_saved_arg2{g_arg2};
+    ValueSaver<void (*)()> m_saved_trig0{g_d_trig0, d_stk_sin};
+    ValueSaver<void (*)()> m_saved_trig1{g_d_trig1, d_stk_sqr};
+    ValueSaver<RuntimeState> m_saved_runtime{g_runtime, RuntimeState{}};
+    ValueSaver<ImageRegion> m_saved_image_region{g_image_region, ImageRegion{{-2.0, -1.5}, {1.0, 1.5}, {-2.0, -1.5}}};
+};
+
+} // namespace
+
+TEST_F(TestFormulaLanes, mandelbrotMatchesVM)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"mandel", "", "z = pixel:\n z = sqr(z) + pixel,\n |z| <= 4\n"}));
+
+    expect_same_orbits();
+}
+
+TEST_F(TestFormulaLanes, branchesMatchVM)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"moe", "",
+        "s = exp(1.,0.), z = pixel, c = fn1(pixel)\n"
+        "if (real(p1) <= 0)\n test = 100\nelse\n test = real(p1)\nendif\n:\n"
+        "z = fn2(z)^s + c\n|z| <= test\n"}));
+
+    expect_same_orbits();
+}
+
+TEST_F(TestFormulaLanes, elseIfChainsMatchVM)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"chain", "",
+        "z = pixel, k = 0:\n"
+        "if (real(z) > 0 && imag(z) > 0)\n z = z*z + pixel\n"
+        "elseif (real(z) > 0 || imag(z) < -1)\n z = conj(z)*conj(z) + pixel\n"
+        "elseif (cabs(z) == 0)\n z = flip(z)\n"
+        "else\n  if (imag(z) != 0)\n   z = abs(z)*z/(1 + |z|) + pixel\n  endif\n"
+        "  z = sqr(z) + LastSqr - pixel + whitesq\n"
+        "endif\n"
+        "k = k + 1\n"
+        "|z| <= 100 && real(k) < 30\n"}));
+
+    expect_same_orbits();
+}
+
+TEST_F(TestFormulaLanes, lastSqrFromFunctionMatchesVM)
+{
+    g_d_trig0 = d_stk_sqr;
+    ASSERT_TRUE(parse(FormulaEntry{"fnsqr", "", "z = pixel:\n z = fn1(z) + pixel - 0.25*LastSqr,\n |z| <= 4\n"}));
+
+    expect_same_orbits();
+}
+
+TEST_F(TestFormulaLanes, divisionOverflowMatchesVM)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"divide", "", "z = pixel:\n z = 1/(z - pixel + scrnpix) + pixel,\n |z| <= 4\n"}));
+
+    expect_same_orbits();
+}
+
+TEST_F(TestFormulaLanes, randIsIneligible)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"random", "", "z = pixel:\n z = sqr(z) + rand*pixel,\n |z| <= 4\n"}));
+
+    EXPECT_STREQ("formula uses rand", FormulaLanes::ineligible_reason(g_formula_vm, g_formula));
+}
+
+TEST_F(TestFormulaLanes, valueCarriedBetweenPixelsIsIneligible)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"carry", "", "z = pixel + t:\n t = z, z = sqr(z) + pixel,\n |z| <= 4\n"}));
+
+    EXPECT_STREQ("formula reads values left by the previous pixel",
+        FormulaLanes::ineligible_reason(g_formula_vm, g_formula));
+}
+
+} // namespace id::test
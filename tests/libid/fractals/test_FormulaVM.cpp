@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <fractals/FormulaVM.h>
+
+#include <engine/calcfrac.h>
+#include <engine/ImageRegion.h>
+#include <fractals/formula.h>
+#include <fractals/interpreter.h>
+#include <fractals/parser.h>
+#include <math/arg.h>
+#include <math/fixed_pt.h>
+#include <misc/ValueSaver.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+
+namespace id::test
+{
+
+namespace
+{
+
+constexpr int NUM_ITERATIONS{40};
+
+struct Step
+{
+    DComplex z;
+    double top;
+};
+
+// escaping orbits overflow to NaN, which should still compare equal
+bool same(const double lhs, const double rhs)
+{
+    return lhs == rhs || (std::isnan(lhs) && std::isnan(rhs));
+}
+
+bool operator==(const Step &lhs, const Step &rhs)
+{
+    return same(lhs.z.x, rhs.z.x) && same(lhs.z.y, rhs.z.y) && same(lhs.top, rhs.top);
+}
+
+std::ostream &operator<<(std::ostream &str, const Step &value)
+{
+    return str << "z(" << value.z.x << ", " << value.z.y << ") top " << value.top;
+}
+
+class TestFormulaVM : public testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        parser_reset();
+    }
+
+    bool parse(const FormulaEntry &entry)
+    {
+        g_formula_name = entry.name;
+        if (!parse_formula(entry, false))
+        {
+            return false;
+        }
+        m_initial_vars.clear();
+        for (const ConstArg &var : g_formula.vars)
+        {
+            m_initial_vars.push_back(var.a.d);
+        }
+        return true;
+    }
+
+    void reset_vars()
+    {
+        for (std::size_t i = 0; i < m_initial_vars.size(); ++i)
+        {
+            g_formula.vars[i].a.d = m_initial_vars[i];
+        }
+        g_runtime.stack.fill(Arg{});
+        g_overflow = false;
+    }
+
+    // Same sequence of operations as formula_per_pixel and formula_orbit.
+    static std::vector<Step> interpret(const DComplex &pixel)
+    {
+        g_formula.vars[0].a.d = pixel;
+        g_runtime.jump_index = 0;
+        g_runtime.op_index = 0;
+        g_runtime.load_index = 0;
+        g_runtime.store_index = 0;
+        g_arg1 = g_runtime.stack.data();
+        g_arg2 = g_runtime.stack.data() - 1;
+        if (g_formula.last_init_op)
+        {
+            g_formula.last_init_op = g_formula.op_count;
+        }
+        while (g_runtime.op_index < g_formula.last_init_op)
+        {
+            g_formula.fns[g_runtime.op_index]();
+            g_runtime.op_index++;
+        }
+        g_runtime.init_load_index = g_runtime.load_index;
+        g_runtime.init_store_index = g_runtime.store_index;
+        g_runtime.init_op_index = g_runtime.op_index;
+
+        std::vector<Step> steps;
+        for (int i = 0; i < NUM_ITERATIONS; ++i)
+        {
+            g_runtime.load_index = g_runtime.init_load_index;
+            g_runtime.store_index = g_runtime.init_store_index;
+            g_runtime.op_index = g_runtime.init_op_index;
+            g_runtime.jump_index = g_runtime.init_jump_index;
+            g_arg1 = g_runtime.stack.data();
+            g_arg2 = g_runtime.stack.data() - 1;
+            while (g_runtime.op_index < g_formula.op_count)
+            {
+                g_formula.fns[g_runtime.op_index]();
+                g_runtime.op_index++;
+            }
+            steps.push_back(Step{g_formula.vars[3].a.d, g_arg1->d.x});
+        }
+        return steps;
+    }
+
+    static std::vector<Step> run_vm(const DComplex &pixel)
+    {
+        g_formula.vars[0].a.d = pixel;
+        g_formula_vm.run_init();
+        std::vector<Step> steps;
+        for (int i = 0; i < NUM_ITERATIONS; ++i)
+        {
+            const double top{g_formula_vm.run_orbit().x};
+            steps.push_back(Step{g_formula.vars[3].a.d, top});
+        }
+        return steps;
+    }
+
+    void expect_same_orbits()
+    {
+        ASSERT_TRUE(g_formula_vm.compiled());
+        const std::vector<DComplex> pixels{{0.25, 0.5}, {-1.5, 0.0}, {0.3, -0.6}, {-0.75, 0.1}, {2.0, 2.0}};
+        std::vector<std::vector<Step>> expected;
+        reset_vars();
+        for (const DComplex &pixel : pixels)
+        {
+            expected.push_back(interpret(pixel));
+        }
+        reset_vars();
+        for (std::size_t i = 0; i < pixels.size(); ++i)
+        {
+            EXPECT_EQ(expected[i], run_vm(pixels[i])) << "pixel " << i;
+        }
+    }
+
+    static int count(const FormulaVM::Op op)
+    {
+        const std::vector<FormulaVM::Instruction> &code{g_formula_vm.code()};
+        return static_cast<int>(
+            std::count_if(code.begin(), code.end(), [op](const FormulaVM::Instruction &in) { return in.op == op; }));
+    }
+
+    ValueSaver<std::string> m_saved_formula_name{g_formula_name};
+    ValueSaver<bool> m_saved_overflow{g_overflow};
+    ValueSaver<Arg *> m_saved_arg1{g_arg1};
+    ValueSaver<Arg *> m_saved_arg2{g_arg2};
+    ValueSaver<void (*)()> m_saved_trig0{g_d_trig0, d_stk_sin};
+    ValueSaver<void (*)()> m_saved_trig1{g_d_trig1, d_stk_sqr};
+    ValueSaver<RuntimeState> m_saved_runtime{g_runtime, RuntimeState{}};
+    ValueSaver<ImageRegion> m_saved_image_region{g_image_region, ImageRegion{{-2.0, -1.5}, {1.0, 1.5}, {-2.0, -1.5}}};
+    std::vector<DComplex> m_initial_vars;
+};
+
+} // namespace
+
+TEST_F(TestFormulaVM, mandelbrotLoadsBecomeOperands)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"mandel", "", "z = pixel:\n z = sqr(z) + pixel,\n |z| <= 4\n"}));
+
+    expect_same_orbits();
+    EXPECT_EQ(1, count(FormulaVM::Op::SQR));
+    EXPECT_EQ(1, count(FormulaVM::Op::ADD));
+    EXPECT_EQ(1, count(FormulaVM::Op::MOD));
+    EXPECT_EQ(1, count(FormulaVM::Op::LTE));
+}
+
+TEST_F(TestFormulaVM, constantsAreFolded)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"folded", "", "z = pixel:\n z = z*z + (2*3 - 5)*pixel,\n |z| <= 2*2\n"}));
+
+    expect_same_orbits();
+    EXPECT_EQ(0, count(FormulaVM::Op::SUB));
+    EXPECT_EQ(2, count(FormulaVM::Op::MUL));
+}
+
+TEST_F(TestFormulaVM, deadStoresAreRemoved)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"dead", "", "z = pixel:\n t = z*z, t = z + pixel, z = t*t + pixel,\n |z| <= 4\n"}));
+
+    expect_same_orbits();
+    EXPECT_EQ(1, count(FormulaVM::Op::MUL));
+}
+
+TEST_F(TestFormulaVM, branchesMatchInterpreter)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"moe", "",
+        "s = exp(1.,0.), z = pixel, c = fn1(pixel)\n"
+        "if (real(p1) <= 0)\n test = 100\nelse\n test = real(p1)\nendif\n:\n"
+        "z = fn2(z)^s + c\n|z| <= test\n"}));
+
+    expect_same_orbits();
+}
+
+TEST_F(TestFormulaVM, elseIfChainsMatchInterpreter)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"chain", "",
+        "z = pixel, k = 0:\n"
+        "if (real(z) > 0 && imag(z) > 0)\n z = z*z + pixel\n"
+        "elseif (real(z) > 0 || imag(z) < -1)\n z = conj(z)*conj(z) + pixel\n"
+        "elseif (cabs(z) == 0)\n z = flip(z)\n"
+        "else\n  if (imag(z) != 0)\n   z = abs(z)*z/(1 + |z|) + pixel\n  endif\n"
+        "  z = sqr(z) + LastSqr - pixel\n"
+        "endif\n"
+        "k = k + 1\n"
+        "|z| <= 100 && real(k) < 30\n"}));
+
+    expect_same_orbits();
+}
+
+TEST_F(TestFormulaVM, branchAtEndOfOrbitMatchesInterpreter)
+{
+    ASSERT_TRUE(parse(FormulaEntry{"tail", "",
+        "z = pixel:\n z = z*z + pixel\n"
+        "if (real(z) > 1)\n z = z - 1, |z| < 8\nelse\n |z| < 4\nendif\n"}));
+
+    expect_same_orbits();
+}
+
+} // namespace id::test
@@ -10,6 +10,7 @@
 #include "engine/VideoInfo.h"
 #include "fractals/bif_may.h"
 #include "fractals/fractalp.h"
+#include "fractals/ifs_walkers.h"
 #include "fractals/population.h"
 #include "math/arg.h"
 #include "math/fixed_pt.h"
@@ -99,6 +100,17 @@ struct BifurcationColumnCase
     BifurcationColumnSummary expected{};
 };
 
+struct BifurcationColumnsCase
+{
+    const char *name{};
+    OrbitCalc orbit_calc{};
+    TrigFn trig{TrigFn::IDENT};
+    double first_rate{};
+    double last_rate{};
+    int periodicity_check{};
+    double filter_cycles{};
+};
+
 class BifurcationColumnState
 {
 public:
@@ -133,6 +145,7 @@ private:
     ValueSaver<int> m_saved_periodicity_check{g_periodicity_check, 0};
     ValueSaver<int> m_saved_colors{g_colors, 16};
     ValueSaver<FractalDispatch> m_saved_dispatch{g_dispatch};
+    ValueSaver<double> m_saved_coloring{g_params[2], 0.0};
 };
 
 static BifurcationSequence run_bifurcation_sequence(const BifurcationSequenceInput &input)
@@ -385,4 +398,108 @@ TEST(TestBifurcationColumn, mapsPopulationToRows)
     }
 }
 
+static void set_column_orbit(const OrbitCalc orbit_calc, const TrigFn trig)
+{
+    g_dispatch.set_orbit_calc(orbit_calc);
+    g_trig_index[0] = trig;
+    set_trig_pointers(0);
+}
+
+TEST(TestBifurcationColumns, matchCalculateColumn)
+{
+    constexpr int NUM_COLUMNS{BIFURCATION_LANES + 5};
+    const std::vector<BifurcationColumnsCase> tests{
+        BifurcationColumnsCase{"Verhulst", bifurc_verhulst_trig_orbit, TrigFn::IDENT, 1.9, 3.0, 0, 16.0},
+        BifurcationColumnsCase{"Lambda", bifurc_lambda_trig_orbit, TrigFn::IDENT, 2.5, 4.0, 1, 16.0},
+        BifurcationColumnsCase{"LambdaHalfTime", bifurc_lambda_trig_orbit, TrigFn::IDENT, 2.5, 4.0, 1, 1000.0},
+        BifurcationColumnsCase{"LambdaExp", bifurc_lambda_trig_orbit, TrigFn::EXP, 0.5, 6.0, 1, 16.0},
+        BifurcationColumnsCase{"LambdaAbs", bifurc_lambda_trig_orbit, TrigFn::ABS, 2.5, 4.0, 1, 16.0},
+        BifurcationColumnsCase{"VerhulstSinh", bifurc_verhulst_trig_orbit, TrigFn::SINH, 1.0, 3.0, 1, 16.0},
+        BifurcationColumnsCase{"VerhulstLog", bifurc_verhulst_trig_orbit, TrigFn::LOG, 0.1, 2.0, 0, 16.0},
+        BifurcationColumnsCase{"StewartCosxx", bifurc_stewart_trig_orbit, TrigFn::COSXX, 1.0, 2.0, 1, 16.0},
+        BifurcationColumnsCase{"StewartCosh", bifurc_stewart_trig_orbit, TrigFn::COSH, 0.1, 1.0, 0, 16.0},
+        BifurcationColumnsCase{"PlusSinPi", bifurc_add_trig_pi_orbit, TrigFn::SIN, 0.0, 1.4, 0, 16.0},
+        BifurcationColumnsCase{"EqualSinPi", bifurc_set_trig_pi_orbit, TrigFn::SIN, 0.2, 1.2, 1, 1000.0},
+        BifurcationColumnsCase{"EqualCosPi", bifurc_set_trig_pi_orbit, TrigFn::COS, 0.2, 1.2, 1, 16.0},
+        BifurcationColumnsCase{"May", bifurc_may_orbit, TrigFn::IDENT, 0.0, 50.0, 1, 16.0}};
+
+    for (const BifurcationColumnsCase &test : tests)
+    {
+        SCOPED_TRACE(test.name);
+        BifurcationColumnState state;
+        ValueSaver saved_may_beta{g_params[2]};
+        set_bifurc_may_beta(5.0);
+        set_column_orbit(test.orbit_calc, test.trig);
+        g_periodicity_check = test.periodicity_check;
+        g_param_z1.x = test.filter_cycles;
+        ASSERT_TRUE(use_bifurcation_columns());
+        Bifurcation bifurcation;
+        const BifurcationContext ctx{bifurcation_context()};
+        EXPECT_EQ(test.filter_cycles > static_cast<double>(g_max_iterations) && test.periodicity_check != 0,
+            ctx.half_time_check);
+
+        std::vector<double> rates(NUM_COLUMNS);
+        for (int i = 0; i < NUM_COLUMNS; ++i)
+        {
+            rates[i] = test.first_rate + (test.last_rate - test.first_rate) * i / (NUM_COLUMNS - 1);
+        }
+        const int rows{ctx.stop_row + 1};
+        std::vector<int> hits(static_cast<std::size_t>(NUM_COLUMNS) * rows, -1);
+        bifurcation_columns(ctx, rates.data(), NUM_COLUMNS, hits.data());
+
+        for (int i = 0; i < NUM_COLUMNS; ++i)
+        {
+            const std::vector<int> &column{bifurcation.calculate_column(rates[i])};
+            const std::vector<int> lanes(hits.begin() + i * rows, hits.begin() + (i + 1) * rows);
+            EXPECT_EQ(column, lanes) << "rate " << rates[i];
+        }
+    }
+}
+
+TEST(TestBifurcationColumns, ineligibleForUnsupportedSettings)
+{
+    BifurcationColumnState state;
+
+    set_column_orbit(bifurc_lambda_trig_orbit, TrigFn::TAN);
+    EXPECT_FALSE(use_bifurcation_columns());
+
+    set_column_orbit([] { return 0; }, TrigFn::IDENT);
+    EXPECT_FALSE(use_bifurcation_columns());
+}
+
+static std::vector<int> s_plotted;
+
+static void plot_row(int, const int y, const int color)
+{
+    s_plotted[y] = color;
+}
+
+TEST(TestBifurcationColumns, colorsByLogDensity)
+{
+    BifurcationColumnState state;
+    ValueSaver saved_plot{g_plot, plot_row};
+    ValueSaver saved_delta_x{g_delta_x, 1.0L};
+    ValueSaver saved_image_region{g_image_region, ImageRegion{{3.7, 0.0}, {3.7, 1.0}, {3.7, 0.0}}};
+    g_params[2] = 1.0;
+    ASSERT_TRUE(bifurcation_log_density());
+    s_plotted.assign(g_i_stop_pt.y + 1, -1);
+    std::vector<int> expected;
+    std::vector<int> clamped;
+    {
+        Bifurcation bifurcation;
+        for (const int count : bifurcation.calculate_column(3.7))
+        {
+            expected.push_back(ifs_density_color(count, g_max_iterations, g_colors));
+            clamped.push_back(std::min(count, g_colors - 1));
+        }
+    }
+
+    Bifurcation bifurcation;
+    EXPECT_TRUE(bifurcation.iterate());
+    EXPECT_FALSE(bifurcation.iterate());
+
+    EXPECT_EQ(expected, s_plotted);
+    EXPECT_NE(clamped, s_plotted);
+}
+
 } // namespace id::test
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <fractals/ifs_walkers.h>
+
+#include <engine/random_seed.h>
+#include <fractals/ifs.h>
+#include <misc/ValueSaver.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::misc;
+
+namespace id::test
+{
+
+namespace
+{
+
+constexpr int SIZE{16};
+
+// Maps [-1, 1] x [-1, 1] onto the screen.
+IFSProjection screen_projection()
+{
+    IFSProjection projection;
+    projection.cvt = Affine{SIZE / 2.0, 0.0, SIZE / 2.0, 0.0, -SIZE / 2.0, SIZE / 2.0};
+    projection.width = SIZE;
+    projection.height = SIZE;
+    return projection;
+}
+
+std::size_t pixel(const int col, const int row)
+{
+    return static_cast<std::size_t>(row) * SIZE + col;
+}
+
+} // namespace
+
+class TestIFSWalkers : public testing::Test
+{
+protected:
+    // Two constant maps sending every point to (-0.5, -0.5) or (0.5, 0.5).
+    ValueSaver<std::vector<float>> m_saved_ifs_definition{g_ifs_definition,
+        std::vector<float>{
+            0.0F, 0.0F, 0.0F, 0.0F, -0.5F, -0.5F, 0.25F, //
+            0.0F, 0.0F, 0.0F, 0.0F, 0.5F, 0.5F, 0.75F}};
+    ValueSaver<int> m_saved_num_affine_transforms{g_num_affine_transforms, 2};
+};
+
+TEST_F(TestIFSWalkers, countsEveryPointOnScreen)
+{
+    set_random_seed(1234);
+    IFSWalkers walkers(IFSDimension::TWO, screen_projection());
+
+    const long plotted{walkers.run(10000)};
+
+    const std::vector<std::uint32_t> &hits{walkers.hits()};
+    EXPECT_LE(10000, plotted);
+    EXPECT_EQ(plotted, std::accumulate(hits.begin(), hits.end(), 0L));
+    const std::uint32_t low{hits[pixel(4, 12)]};
+    const std::uint32_t high{hits[pixel(12, 4)]};
+    EXPECT_EQ(plotted, static_cast<long>(low + high));
+    EXPECT_LT(low, high);
+    EXPECT_EQ(high, walkers.max_hits());
+    EXPECT_FALSE(walkers.diverged());
+}
+
+TEST_F(TestIFSWalkers, accumulatesAcrossRuns)
+{
+    set_random_seed(1234);
+    IFSWalkers walkers(IFSDimension::TWO, screen_projection());
+
+    const long plotted{walkers.run(1) + walkers.run(1)};
+
+    const std::vector<std::uint32_t> &hits{walkers.hits()};
+    EXPECT_EQ(plotted, std::accumulate(hits.begin(), hits.end(), 0L));
+}
+
+TEST_F(TestIFSWalkers, sameSeedSameHits)
+{
+    set_random_seed(99);
+    IFSWalkers first(IFSDimension::TWO, screen_projection());
+    first.run(5000);
+    set_random_seed(99);
+    IFSWalkers second(IFSDimension::TWO, screen_projection());
+    second.run(5000);
+
+    EXPECT_EQ(first.hits(), second.hits());
+}
+
+TEST_F(TestIFSWalkers, threeDimensionalUsesViewMatrix)
+{
+    g_ifs_definition = {
+        0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, -0.5F, -0.5F, 0.25F, 0.5F, //
+        0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.5F, 0.5F, -0.25F, 0.5F};
+    IFSProjection projection{screen_projection()};
+    projection.three_d = true;
+    // swap x and y
+    projection.view[0][1] = 1.0;
+    projection.view[1][0] = 1.0;
+    projection.view[2][2] = 1.0;
+    projection.view[3][3] = 1.0;
+    projection.view[3][0] = 0.25;
+    set_random_seed(7);
+    IFSWalkers walkers(IFSDimension::THREE, projection);
+
+    const long plotted{walkers.run(1000)};
+
+    const std::vector<std::uint32_t> &hits{walkers.hits()};
+    EXPECT_EQ(plotted, static_cast<long>(hits[pixel(6, 12)] + hits[pixel(14, 4)]));
+}
+
+TEST_F(TestIFSWalkers, divergentOrbitIsReported)
+{
+    g_ifs_definition = {
+        2.0F, 0.0F, 0.0F, 2.0F, 1.0F, 1.0F, 1.0F};
+    g_num_affine_transforms = 1;
+    set_random_seed(1);
+    IFSWalkers walkers(IFSDimension::TWO, screen_projection());
+
+    walkers.run(1);
+
+    EXPECT_TRUE(walkers.diverged());
+}
+
+TEST(TestIFSDensityColor, logScaleOfDensestPixel)
+{
+    EXPECT_EQ(0, ifs_density_color(0, 1000, 256));
+    EXPECT_EQ(1, ifs_density_color(1, 1, 256));
+    EXPECT_EQ(255, ifs_density_color(1000, 1000, 256));
+    EXPECT_EQ(1, ifs_density_color(1000, 1000, 2));
+    const int mid{ifs_density_color(31, 1000, 256)};
+    EXPECT_LT(1, mid);
+    EXPECT_LT(mid, 255);
+    EXPECT_LT(ifs_density_color(30, 1000, 256), ifs_density_color(300, 1000, 256));
+}
+
+} // namespace id::test
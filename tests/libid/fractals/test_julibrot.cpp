@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include "fractals/julibrot.h"
+
+#include "engine/bailout_formula.h"
+#include "engine/calcfrac.h"
+#include "engine/fractals.h"
+#include "fractals/fractalp.h"
+#include "fractals/hypercomplex_mandelbrot.h"
+#include "fractals/interpreter.h"
+#include "fractals/quaternion_mandelbrot.h"
+#include "math/arg.h"
+#include "misc/ValueSaver.h"
+
+#include <gtest/gtest.h>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::math;
+using namespace id::misc;
+
+namespace id::test
+{
+
+using TrigFunction = void (*)();
+
+constexpr int GRID_COLS{24};
+constexpr int GRID_ROWS{16};
+
+// The default julibrot view of a quaternion Mandelbrot set, as
+// julibrot_per_image() would set it up.
+static JulibrotContext quaternion_context()
+{
+    JulibrotContext ctx;
+    ctx.orbit = JulibrotOrbit::QUATERNION;
+    ctx.mandel_start = true;
+    ctx.max_iterations = 64;
+    ctx.magnitude_limit = 4.0;
+    ctx.mode = Julibrot3DMode::MONOCULAR;
+    ctx.z_dots = 64;
+    ctx.dist = 24.0F;
+    ctx.depth = 8.0F;
+    ctx.x_per_inch = (-2.0 - 2.0) / 10.0;
+    ctx.y_per_inch = 3.0 / 7.0;
+    ctx.init_z = 8.0 - 8.0 / 2;
+    ctx.x_min = -0.83;
+    ctx.y_min = -0.25;
+    ctx.delta_mx = 0.0;
+    ctx.delta_my = 0.5 / ctx.z_dots;
+    ctx.b_base = 128;
+    ctx.br_ratio = 1.0F;
+    return ctx;
+}
+
+// The depth the original z_line() scan finds with the serial orbit function.
+static int serial_depth(const JulibrotContext &ctx, const double x, const double y, const OrbitCalc orbit)
+{
+    DComplex jb_c{};
+    ValueSaver saved_float_param{g_float_param, &jb_c};
+    ValueSaver saved_magnitude_limit{g_magnitude_limit, ctx.magnitude_limit};
+    ValueSaver saved_old_z{g_old_z};
+    ValueSaver saved_new_z{g_new_z};
+    ValueSaver saved_c{g_quaternion_c};
+    ValueSaver saved_ci{g_quaternion_ci};
+    ValueSaver saved_cj{g_quaternion_cj};
+    ValueSaver saved_ck{g_quaternion_ck};
+
+    const DComplex &eye{ctx.left_eye};
+    double jx{((eye.x - x) * ctx.init_z / ctx.dist - x) * ctx.x_per_inch + ctx.x_offset};
+    const double delta_jx{ctx.depth / ctx.dist * (eye.x - x) * ctx.x_per_inch / ctx.z_dots};
+    double jy{((eye.y - y) * ctx.init_z / ctx.dist - y) * ctx.y_per_inch + ctx.y_offset};
+    const double delta_jy{ctx.depth / ctx.dist * (eye.y - y) * ctx.y_per_inch / ctx.z_dots};
+    double mx{ctx.x_min};
+    double my{ctx.y_min};
+    for (int z = 0; z < ctx.z_dots; ++z)
+    {
+        if (ctx.mandel_start)
+        {
+            g_old_z = {};
+            jb_c = {};
+            g_quaternion_c = jx;
+            g_quaternion_ci = jy;
+            g_quaternion_cj = mx;
+            g_quaternion_ck = my;
+        }
+        else
+        {
+            g_old_z = {jx, jy};
+            jb_c = {mx, my};
+            g_quaternion_c = ctx.c[0];
+            g_quaternion_ci = ctx.c[1];
+            g_quaternion_cj = ctx.c[2];
+            g_quaternion_ck = ctx.c[3];
+        }
+        g_temp_sqr_x = g_old_z.x * g_old_z.x;
+        g_temp_sqr_y = g_old_z.y * g_old_z.y;
+        long n{};
+        while (n < ctx.max_iterations && !orbit())
+        {
+            ++n;
+        }
+        if (n == ctx.max_iterations)
+        {
+            return z;
+        }
+        mx += ctx.delta_mx;
+        my += ctx.delta_my;
+        jx += delta_jx;
+        jy += delta_jy;
+    }
+    return ctx.z_dots;
+}
+
+static double grid_x(const int col)
+{
+    return -5.0 + 10.0 * col / GRID_COLS;
+}
+
+static double grid_y(const int row)
+{
+    return -3.5 + 7.0 * row / GRID_ROWS;
+}
+
+static void expect_serial_depths(const JulibrotContext &ctx, const OrbitCalc orbit)
+{
+    int surfaces{};
+    for (int row = 0; row < GRID_ROWS; ++row)
+    {
+        for (int col = 0; col < GRID_COLS; ++col)
+        {
+            const int expected{serial_depth(ctx, grid_x(col), grid_y(row), orbit)};
+            EXPECT_EQ(expected, julibrot_depth(ctx, grid_x(col), grid_y(row), ctx.left_eye))
+                << "col " << col << ", row " << row;
+            surfaces += expected < ctx.z_dots ? 1 : 0;
+        }
+    }
+    EXPECT_GT(surfaces, 0);
+    EXPECT_LT(surfaces, GRID_ROWS * GRID_COLS);
+}
+
+TEST(TestJulibrotDepth, quaternionMatchesSerialOrbit)
+{
+    expect_serial_depths(quaternion_context(), quaternion_orbit);
+}
+
+TEST(TestJulibrotDepth, quaternionJuliaMatchesSerialOrbit)
+{
+    JulibrotContext ctx{quaternion_context()};
+    ctx.mandel_start = false;
+    ctx.c = {-0.745, 0.113, 0.05, 0.05};
+    ctx.x_min = -0.2;
+    ctx.y_min = -0.2;
+    ctx.delta_mx = 0.4 / ctx.z_dots;
+
+    expect_serial_depths(ctx, quaternion_orbit);
+}
+
+TEST(TestJulibrotDepth, hyperComplexMatchesSerialOrbit)
+{
+    Arg stack{};
+    ValueSaver saved_arg1{g_arg1, &stack};
+    ValueSaver<TrigFunction> saved_trig_fn{g_d_trig0, d_stk_sin};
+    JulibrotContext ctx{quaternion_context()};
+    ctx.orbit = JulibrotOrbit::HYPER_COMPLEX;
+    ctx.fn = cmplx_sin;
+    ctx.mandel_start = false;
+    ctx.c = {0.1, 0.1, 0.0, 0.0};
+    ctx.x_min = -0.2;
+    ctx.y_min = -0.2;
+    ctx.delta_mx = 0.4 / ctx.z_dots;
+
+    expect_serial_depths(ctx, hyper_complex_orbit);
+}
+
+TEST(TestJulibrotDepth, juliaMatchesSerialOrbit)
+{
+    ValueSaver saved_bailout_test{g_bailout_test, Bailout::MOD};
+    set_bailout_formula(Bailout::MOD);
+    JulibrotContext ctx{quaternion_context()};
+    ctx.orbit = JulibrotOrbit::JULIA;
+    ctx.mandel_start = false;
+    ctx.x_per_inch = -0.3;
+    ctx.y_per_inch = 0.3;
+
+    expect_serial_depths(ctx, julia_orbit);
+}
+
+TEST(TestJulibrotDepth, coarseStepFindsSurfaceOnlyAtOrBeyondFineStep)
+{
+    JulibrotContext fine{quaternion_context()};
+    JulibrotContext coarse{fine};
+    coarse.coarse_step = 8;
+
+    int same{};
+    for (int row = 0; row < GRID_ROWS; ++row)
+    {
+        for (int col = 0; col < GRID_COLS; ++col)
+        {
+            const int fine_depth{julibrot_depth(fine, grid_x(col), grid_y(row), fine.left_eye)};
+            const int coarse_depth{julibrot_depth(coarse, grid_x(col), grid_y(row), coarse.left_eye)};
+            EXPECT_GE(coarse_depth, fine_depth) << "col " << col << ", row " << row;
+            same += coarse_depth == fine_depth ? 1 : 0;
+        }
+    }
+    EXPECT_GT(same, GRID_ROWS * GRID_COLS * 9 / 10);
+}
+
+TEST(TestJulibrotDepth, pixelColorShadesByDepth)
+{
+    const JulibrotContext ctx{quaternion_context()};
+
+    for (int row = 0; row < GRID_ROWS; ++row)
+    {
+        for (int col = 0; col < GRID_COLS; ++col)
+        {
+            const int depth{julibrot_depth(ctx, grid_x(col), grid_y(row), ctx.left_eye)};
+            const int expected{depth < ctx.z_dots ? static_cast<int>(254L * depth / ctx.z_dots) + 1 : -1};
+            EXPECT_EQ(expected, julibrot_pixel_color(ctx, grid_x(col), grid_y(row), col, row));
+        }
+    }
+}
+
+TEST(TestJulibrotLines, eligibleOrbits)
+{
+    ValueSaver saved_orbit_type{g_new_orbit_type, FractalType::QUAT};
+
+    EXPECT_TRUE(use_julibrot_lines());
+}
+
+TEST(TestJulibrotLines, unsupportedOrbit)
+{
+    ValueSaver saved_orbit_type{g_new_orbit_type, FractalType::LAMBDA};
+
+    EXPECT_FALSE(use_julibrot_lines());
+}
+
+TEST(TestJulibrotLines, unsupportedFunction)
+{
+    ValueSaver saved_orbit_type{g_new_orbit_type, FractalType::HYPER_CMPLX};
+    ValueSaver<TrigFunction> saved_trig_fn{g_d_trig0, d_stk_tan};
+
+    EXPECT_FALSE(use_julibrot_lines());
+}
+
+} // namespace id::test
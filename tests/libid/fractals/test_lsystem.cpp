@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <fractals/lsystem.h>
+
+#include "MockDriver.h"
+#include "test_data.h"
+
+#include <engine/calc_frac_init.h>
+#include <engine/calcfrac.h>
+#include <engine/LogicalScreen.h>
+#include <engine/VideoInfo.h>
+#include <misc/Driver.h>
+#include <misc/ValueSaver.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace id::engine;
+using namespace id::fractals;
+using namespace id::misc;
+using namespace id::misc::test;
+using testing::_;
+using testing::Invoke;
+using testing::Return;
+
+namespace id::test
+{
+
+namespace
+{
+
+struct Line
+{
+    int x1;
+    int y1;
+    int x2;
+    int y2;
+    int color;
+};
+
+} // namespace
+
+class TestLSystem : public testing::Test
+{
+protected:
+    std::vector<Line> draw(const std::string &name, int order);
+
+    MockDriver m_driver;
+    ValueSaver<Driver *> m_saved_driver{g_driver, &m_driver};
+    ValueSaver<LogicalScreen> m_saved_logical_screen{
+        g_logical_screen, LogicalScreen{640, 480, 0, 0, 639.0, 479.0}};
+    ValueSaver<float> m_saved_screen_aspect{g_screen_aspect, 0.75F};
+    ValueSaver<int> m_saved_colors{g_colors, 256};
+    ValueSaver<double> m_saved_order{g_params[0]};
+    ValueSaver<std::filesystem::path> m_saved_filename{
+        g_l_system_filename, std::filesystem::path{data::ID_TEST_LSYSTEM_DIR} / data::ID_TEST_LSYSTEM_FILE};
+    ValueSaver<std::string> m_saved_name{g_l_system_name};
+    std::vector<Line> m_lines;
+};
+
+std::vector<Line> TestLSystem::draw(const std::string &name, const int order)
+{
+    EXPECT_CALL(m_driver, draw_line(_, _, _, _, _))
+        .WillRepeatedly(Invoke([this](const int x1, const int y1, const int x2, const int y2, const int color)
+            { m_lines.push_back({x1, y1, x2, y2, color}); }));
+    // the serial walk shows a thinking message while it sizes the image
+    EXPECT_CALL(m_driver, stack_screen()).WillRepeatedly(Return());
+    EXPECT_CALL(m_driver, set_clear()).WillRepeatedly(Return());
+    EXPECT_CALL(m_driver, put_string(_, _, _, _)).WillRepeatedly(Return());
+    EXPECT_CALL(m_driver, unstack_screen()).WillRepeatedly(Return());
+
+    g_l_system_name = name;
+    g_params[0] = order;
+    m_lines.clear();
+    EXPECT_FALSE(lsystem_load());
+    LSystem l_system;
+    l_system.start();
+    while (!l_system.done() && !l_system.interrupted())
+    {
+        l_system.iterate();
+    }
+    EXPECT_FALSE(l_system.interrupted());
+    return m_lines;
+}
+
+TEST_F(TestLSystem, kochFitsScreen)
+{
+    const std::vector<Line> lines{draw("Koch1", 4)};
+
+    ASSERT_EQ(3U * 256U, lines.size());
+    int x_min{640};
+    int x_max{};
+    int y_min{480};
+    int y_max{};
+    for (const Line &line : lines)
+    {
+        x_min = std::min({x_min, line.x1, line.x2});
+        x_max = std::max({x_max, line.x1, line.x2});
+        y_min = std::min({y_min, line.y1, line.y2});
+        y_max = std::max({y_max, line.y1, line.y2});
+        EXPECT_EQ(15, line.color);
+    }
+    EXPECT_LE(0, x_min);
+    EXPECT_GT(640, x_max);
+    EXPECT_LE(0, y_min);
+    EXPECT_GT(480, y_max);
+    // the longer side is filled up to the margin
+    EXPECT_TRUE(x_max - x_min >= 620 || y_max - y_min >= 465);
+}
+
+TEST_F(TestLSystem, expansionMatchesWalk)
+{
+    for (int order = 0; order <= 6; ++order)
+    {
+        const std::vector<Line> expanded{draw("Plant", order)};
+        const std::vector<Line> walked{draw("PlantTurned", order)};
+
+        ASSERT_EQ(walked.size(), expanded.size()) << "order " << order;
+        for (std::size_t i = 0; i < walked.size(); ++i)
+        {
+            EXPECT_EQ(walked[i].x1, expanded[i].x1) << "order " << order << " line " << i;
+            EXPECT_EQ(walked[i].y1, expanded[i].y1) << "order " << order << " line " << i;
+            EXPECT_EQ(walked[i].x2, expanded[i].x2) << "order " << order << " line " << i;
+            EXPECT_EQ(walked[i].y2, expanded[i].y2) << "order " << order << " line " << i;
+            EXPECT_EQ(walked[i].color, expanded[i].color) << "order " << order << " line " << i;
+        }
+    }
+}
+
+} // namespace id::test
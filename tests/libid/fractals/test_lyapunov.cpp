@@ -3,13 +3,20 @@
 #include <fractals/lyapunov.h>
 
 #include <engine/calcfrac.h>
+#include <engine/Inversion.h>
+#include <engine/pixel_grid.h>
+#include <engine/simd_escape.h>
 #include <engine/UserData.h>
+#include <fractals/fractalp.h>
+#include <fractals/fractype.h>
 #include <misc/debug_flags.h>
 #include <misc/ValueSaver.h>
 #include <misc/version.h>
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 using namespace id::engine;
 using namespace id::fractals;
 using namespace id::misc;
@@ -22,6 +29,99 @@ struct TestLyapunov : testing::Test
     ValueSaver<Version> saved_version{g_version, parse_legacy_version(2000)};
 };
 
+namespace
+{
+
+LyapunovContext test_context()
+{
+    LyapunovContext ctx;
+    ctx.sequence = build_lyapunov_sequence(2);
+    ctx.filter_cycles = 20;
+    ctx.max_iterations = 100;
+    ctx.population = 0.5;
+    ctx.colors = 256;
+    ctx.inside_method = ColorMethod::COLOR;
+    return ctx;
+}
+
+// A single row whose rates sweep from stable through chaotic to overflowing.
+PixelGrid test_grid(const int width)
+{
+    PixelGrid grid;
+    grid.y0 = {2.0};
+    grid.x1 = {0.0};
+    for (int col = 0; col < width; ++col)
+    {
+        grid.x0.push_back(2.0 + 0.25 * col);
+        grid.y1.push_back(1.5 + 0.2 * col);
+    }
+    return grid;
+}
+
+} // namespace
+
+TEST_F(TestLyapunov, rowsNeedIndependentPixels)
+{
+    ValueSaver saved_dispatch{g_dispatch, FractalDispatch{FractalType::LYAPUNOV}};
+    ValueSaver saved_calc_mode{g_std_calc_mode, CalcMode::ONE_PASS};
+    ValueSaver saved_param_1{g_params[1], 0.5};
+    ValueSaver saved_invert{g_inversion.invert, 0};
+    EXPECT_TRUE(use_lyapunov_rows());
+
+    g_params[1] = 0.0; // random population seed
+    EXPECT_FALSE(use_lyapunov_rows());
+
+    g_params[1] = 0.5;
+    g_std_calc_mode = CalcMode::SOLID_GUESS;
+    EXPECT_FALSE(use_lyapunov_rows());
+}
+
+TEST_F(TestLyapunov, rowMatchesPixelColors)
+{
+    constexpr int WIDTH{LYAPUNOV_LANES * 2 + 3};
+    const LyapunovContext ctx{test_context()};
+    const PixelGrid grid{test_grid(WIDTH)};
+    std::vector<int> expected(WIDTH);
+    for (int col = 0; col < WIDTH; ++col)
+    {
+        expected[col] = lyapunov_color(ctx, grid.dy(col, 0), grid.dx(col, 0));
+    }
+    ASSERT_NE(expected.front(), expected.back());
+    ASSERT_EQ(0, expected.back());
+
+    for (SimdMode mode : {SimdMode::FORCE, SimdMode::OFF})
+    {
+        ValueSaver saved_simd_mode{g_simd_mode, mode};
+        std::vector<int> colors(WIDTH, -1);
+
+        lyapunov_row(ctx, grid, 0, 0, WIDTH - 1, colors.data());
+
+        EXPECT_EQ(expected, colors);
+    }
+}
+
+TEST_F(TestLyapunov, rowComputesPartialSpan)
+{
+    constexpr int WIDTH{LYAPUNOV_LANES + 5};
+    const LyapunovContext ctx{test_context()};
+    const PixelGrid grid{test_grid(WIDTH)};
+    std::vector<int> colors(WIDTH, -1);
+
+    lyapunov_row(ctx, grid, 0, 3, WIDTH - 2, colors.data() + 3);
+
+    EXPECT_EQ(-1, colors[2]);
+    for (int col = 3; col <= WIDTH - 2; ++col)
+    {
+        EXPECT_EQ(lyapunov_color(ctx, grid.dy(col, 0), grid.dx(col, 0)), colors[col]) << "col " << col;
+    }
+    EXPECT_EQ(-1, colors[WIDTH - 1]);
+}
+
+TEST_F(TestLyapunov, overflowIsColorZero)
+{
+    EXPECT_EQ(0, lyapunov_color(test_context(), 8.0, 8.0));
+}
+
 TEST_F(TestLyapunov, legacy1731InvertsLyapunovSequence)
 {
     g_version = parse_legacy_version(1731);
@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <geometry/line3d.h>
+
+#include <engine/calcfrac.h>
+#include <engine/LogicalScreen.h>
+#include <engine/pixel_limits.h>
+#include <engine/Potential.h>
+#include <geometry/plot3d.h>
+#include <io/loadfile.h>
+#include <misc/Driver.h>
+#include <misc/ValueSaver.h>
+#include <ui/big_while_loop.h>
+#include <ui/stereo.h>
+#include <ui/video.h>
+
+#include "MockDriver.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+using namespace id::engine;
+using namespace id::geometry;
+using namespace id::io;
+using namespace id::misc;
+using namespace id::misc::test;
+using namespace id::ui;
+using testing::Return;
+
+namespace id::test
+{
+
+namespace
+{
+
+using PlottedPoint = std::tuple<int, int, int>;
+
+constexpr int WIDTH{OLD_MAX_PIXELS + 52};
+constexpr int HEIGHT{200};
+constexpr int WATER_LINE{10};
+
+std::vector<PlottedPoint> s_plotted;
+
+void record_plot(const int x, const int y, const int color)
+{
+    s_plotted.emplace_back(x, y, color);
+}
+
+class TestLine3D : public testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    static std::vector<Byte> source_row(int row);
+    static std::vector<PlottedPoint> expected_points(int row);
+    void expect_rows_match_matrix_transform();
+
+    MockDriver m_driver;
+    ValueSaver<Driver *> m_saved_driver{g_driver, &m_driver};
+    ValueSaver<LogicalScreen> m_saved_logical_screen{
+        g_logical_screen, LogicalScreen{WIDTH, HEIGHT, 0, 0, WIDTH - 1.0, HEIGHT - 1.0}};
+    ValueSaver<int> m_saved_row_count{g_row_count, 0};
+    ValueSaver<int> m_saved_current_row{g_current_row, 0};
+    ValueSaver<int> m_saved_file_colors{g_file_colors, 256};
+    ValueSaver<FillType> m_saved_fill_type{g_fill_type, FillType::POINTS};
+    ValueSaver<bool> m_saved_sphere{g_sphere, false};
+    ValueSaver<RayTraceFormat> m_saved_raytrace_format{g_raytrace_format, RayTraceFormat::NONE};
+    ValueSaver<bool> m_saved_preview{g_preview, false};
+    ValueSaver<int> m_saved_preview_factor{g_preview_factor, 20};
+    ValueSaver<bool> m_saved_targa_out{g_targa_out, false};
+    ValueSaver<bool> m_saved_gray_flag{g_gray_flag, false};
+    ValueSaver<StereoImage> m_saved_which_image{g_which_image, StereoImage::NONE};
+    ValueSaver<Potential> m_saved_potential{g_potential, Potential{}};
+    ValueSaver<int> m_saved_randomize{g_randomize_3d, 0};
+    ValueSaver<int> m_saved_x_rot{g_x_rot, 60};
+    ValueSaver<int> m_saved_y_rot{g_y_rot, 0};
+    ValueSaver<int> m_saved_z_rot{g_z_rot, 0};
+    ValueSaver<int> m_saved_x_scale{g_x_scale, 100};
+    ValueSaver<int> m_saved_y_scale{g_y_scale, 90};
+    ValueSaver<int> m_saved_rough{g_rough, 30};
+    ValueSaver<int> m_saved_water_line{g_water_line, WATER_LINE};
+    ValueSaver<int> m_saved_viewer_z{g_viewer_z, 0};
+    ValueSaver<int> m_saved_x_shift{g_x_shift, 0};
+    ValueSaver<int> m_saved_y_shift{g_y_shift, 0};
+    ValueSaver<int> m_saved_xx_adjust{g_xx_adjust, 3};
+    ValueSaver<int> m_saved_yy_adjust{g_yy_adjust, -2};
+    ValueSaver<CalcStatus> m_saved_calc_status{g_calc_status};
+    ValueSaver<long> m_saved_calc_time{g_calc_time};
+    ValueSaver<void (*)()> m_saved_out_line_cleanup{g_out_line_cleanup};
+    ValueSaver<void (*)(int, int, int)> m_saved_plot{g_plot};
+    ValueSaver<void (*)(int, int, int)> m_saved_standard_plot{g_standard_plot, record_plot};
+};
+
+void TestLine3D::SetUp()
+{
+    g_transparent_color_3d[0] = 0;
+    g_transparent_color_3d[1] = 0;
+    s_plotted.clear();
+    EXPECT_CALL(m_driver, is_disk()).WillRepeatedly(Return(false));
+}
+
+void TestLine3D::TearDown()
+{
+    if (g_out_line_cleanup != nullptr)
+    {
+        g_out_line_cleanup();
+    }
+}
+
+// A ramp of colors with a few pixels below the water line in every run.
+std::vector<Byte> TestLine3D::source_row(const int row)
+{
+    std::vector<Byte> pixels(WIDTH);
+    for (int col = 0; col < WIDTH; ++col)
+    {
+        pixels[col] = static_cast<Byte>((col + 7 * row) % 256);
+    }
+    return pixels;
+}
+
+// The points the original per pixel transform plotted with the matrix and
+// view line3d() set up for the image.
+std::vector<PlottedPoint> TestLine3D::expected_points(const int row)
+{
+    const std::vector<Byte> pixels{source_row(row)};
+    std::vector<PlottedPoint> points;
+    for (int col = 0; col < WIDTH; ++col)
+    {
+        int color{pixels[col]};
+        if (color > 0 && color < WATER_LINE)
+        {
+            color = WATER_LINE; // "lake"
+        }
+        Vector v{static_cast<double>(col), static_cast<double>(row), static_cast<double>(color)};
+        vec_g_mat_mul(v);
+        if (g_viewer_z != 0)
+        {
+            perspective(v);
+        }
+        const int x{static_cast<int>(std::lround(v[0] + g_xx_adjust))};
+        const int y{static_cast<int>(std::lround(v[1] + g_yy_adjust))};
+        if (0 <= x && x < WIDTH && 0 <= y && y < HEIGHT)
+        {
+            points.emplace_back(x, y, color);
+        }
+    }
+    return points;
+}
+
+void TestLine3D::expect_rows_match_matrix_transform()
+{
+    int plotted_beyond_old_limit{};
+    for (int row = 0; row < HEIGHT; ++row)
+    {
+        std::vector<Byte> pixels{source_row(row)};
+        s_plotted.clear();
+
+        ASSERT_EQ(0, line3d(pixels.data(), WIDTH)) << "row " << row;
+
+        const std::vector<PlottedPoint> expected{expected_points(row)};
+        EXPECT_EQ(expected, s_plotted) << "row " << row;
+        for (const PlottedPoint &point : s_plotted)
+        {
+            plotted_beyond_old_limit += std::get<0>(point) >= OLD_MAX_PIXELS ? 1 : 0;
+        }
+    }
+    EXPECT_GT(plotted_beyond_old_limit, 0);
+}
+
+} // namespace
+
+TEST_F(TestLine3D, wideImageMatchesMatrixTransform)
+{
+    expect_rows_match_matrix_transform();
+}
+
+TEST_F(TestLine3D, wideImageMatchesPerspectiveTransform)
+{
+    g_viewer_z = 150;
+
+    expect_rows_match_matrix_transform();
+}
+
+TEST_F(TestLine3D, previewPlotsTransformedColumns)
+{
+    g_preview = true;
+    int plotted{};
+    for (int row = 0; row < HEIGHT; ++row)
+    {
+        std::vector<Byte> pixels{source_row(row)};
+        s_plotted.clear();
+
+        ASSERT_EQ(0, line3d(pixels.data(), WIDTH)) << "row " << row;
+
+        const std::vector<PlottedPoint> expected{expected_points(row)};
+        for (const PlottedPoint &point : s_plotted)
+        {
+            EXPECT_NE(expected.end(), std::find(expected.begin(), expected.end(), point)) << "row " << row;
+        }
+        plotted += static_cast<int>(s_plotted.size());
+    }
+    EXPECT_GT(plotted, 0);
+    EXPECT_LT(plotted, WIDTH * HEIGHT / 4);
+}
+
+} // namespace id::test
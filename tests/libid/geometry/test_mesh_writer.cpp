@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <geometry/mesh_writer.h>
+
+#include <boost/endian/conversion.hpp>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace id::geometry;
+
+namespace fs = std::filesystem;
+
+namespace id::test
+{
+
+namespace
+{
+
+constexpr int WIDTH{3};
+
+class TestMeshWriter : public testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        std::error_code ec;
+        fs::remove(m_path, ec);
+    }
+
+    static MeshCorner corner(const bool previous_row, const int col, const int row)
+    {
+        return MeshCorner{previous_row, col,
+            {{static_cast<float>(col), static_cast<float>(row), 0.0F},
+                {static_cast<Byte>(col), static_cast<Byte>(row), 7}}};
+    }
+
+    // Writes two rows of WIDTH points joined by the triangles line3d() makes.
+    void write_grid(const MeshFormat format, const bool colors)
+    {
+        ASSERT_TRUE(m_writer.open(m_path, format, WIDTH, colors, "test"));
+        m_writer.next_row();
+        for (int col = 0; col < WIDTH; ++col)
+        {
+            if (col > 0)
+            {
+                m_writer.triangle(corner(false, col, 1), corner(false, col - 1, 1), corner(true, col, 0));
+            }
+            if (col < WIDTH - 1)
+            {
+                m_writer.triangle(corner(false, col, 1), corner(true, col, 0), corner(true, col + 1, 0));
+            }
+        }
+        ASSERT_TRUE(m_writer.close());
+    }
+
+    std::vector<Byte> contents() const
+    {
+        std::ifstream file(m_path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    fs::path m_path{fs::temp_directory_path() / "id-test-mesh.bin"};
+    MeshWriter m_writer;
+};
+
+} // namespace
+
+TEST_F(TestMeshWriter, plySharesPointsBetweenTriangles)
+{
+    write_grid(MeshFormat::PLY, true);
+
+    EXPECT_EQ(2U * WIDTH, m_writer.num_vertices());
+    EXPECT_EQ(2U * (WIDTH - 1), m_writer.num_faces());
+    const std::vector<Byte> bytes{contents()};
+    const std::string text(bytes.begin(), bytes.end());
+    EXPECT_EQ(0U, text.find("ply\nformat binary_little_endian 1.0\ncomment test\n"));
+    EXPECT_NE(std::string::npos, text.find("element vertex 0000000006\n"));
+    EXPECT_NE(std::string::npos, text.find("element face 0000000004\n"));
+    EXPECT_NE(std::string::npos, text.find("property uchar red\n"));
+    const std::size_t body{text.find("end_header\n") + 11};
+    ASSERT_EQ(body + 6 * (12 + 3) + 4 * (1 + 12), bytes.size());
+
+    // the first face is made of the first three points written
+    const Byte *face{&bytes[body + 6 * 15]};
+    EXPECT_EQ(3, face[0]);
+    EXPECT_EQ(0U, boost::endian::load_little_u32(face + 1));
+    EXPECT_EQ(1U, boost::endian::load_little_u32(face + 5));
+    EXPECT_EQ(2U, boost::endian::load_little_u32(face + 9));
+    // the second face adds one point and reuses two from the first face
+    face += 13;
+    EXPECT_EQ(3U, boost::endian::load_little_u32(face + 1));
+    EXPECT_EQ(0U, boost::endian::load_little_u32(face + 5));
+    EXPECT_EQ(2U, boost::endian::load_little_u32(face + 9));
+}
+
+TEST_F(TestMeshWriter, plyBriefOmitsColors)
+{
+    write_grid(MeshFormat::PLY, false);
+
+    const std::vector<Byte> bytes{contents()};
+    const std::string text(bytes.begin(), bytes.end());
+    EXPECT_EQ(std::string::npos, text.find("property uchar red\n"));
+    const std::size_t body{text.find("end_header\n") + 11};
+    EXPECT_EQ(body + 6 * 12 + 4 * 13, bytes.size());
+}
+
+TEST_F(TestMeshWriter, stlWritesEveryTriangle)
+{
+    write_grid(MeshFormat::STL, true);
+
+    const std::vector<Byte> bytes{contents()};
+    ASSERT_EQ(84U + 4 * 50, bytes.size());
+    EXPECT_NE(0, std::string(bytes.begin(), bytes.begin() + 5).compare("solid"));
+    EXPECT_EQ(4U, boost::endian::load_little_u32(&bytes[80]));
+}
+
+} // namespace id::test
@@ -3,6 +3,7 @@
 #include <io/encoder.h>
 
 #include <engine/pixel_limits.h>
+#include <fractals/julibrot.h>
 #include <io/gif_extensions.h>
 #include <io/loadfile.h>
 #include <misc/ValueSaver.h>
@@ -15,6 +16,7 @@
 #include <cstdio>
 
 using namespace id::engine;
+using namespace id::fractals;
 using namespace id::io;
 using namespace id::misc;
 
@@ -51,6 +53,16 @@ TEST(TestEncoder, saveInfoPreservesActiveLegacyCompatibilityVersion)
     EXPECT_EQ(parse_legacy_version(1730), fractal_info_version(info));
 }
 
+TEST(TestEncoder, saveInfoStoresJulibrotCoarseStep)
+{
+    ValueSaver saved_coarse_step{g_julibrot_coarse_step, 4};
+    FractalInfo info{};
+
+    setup_save_info(&info);
+
+    EXPECT_EQ(4, info.julibrot_coarse_step);
+}
+
 class TestGifUint16 : public testing::TestWithParam<int>
 {
 };
@@ -211,6 +211,7 @@ std::ostream &operator<<(std::ostream &str, const FractalInfo &value)
                << R"(, "version_minor": )" << value.version_minor                   //
                << R"(, "version_patch": )" << value.version_patch                   //
                << R"(, "version_tweak": )" << value.version_tweak                   //
+               << R"(, "julibrot_coarse_step": )" << value.julibrot_coarse_step     //
                << " }";                                                             //
 }
 
@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <io/gif_lzw.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace id::io;
+
+namespace id::test
+{
+
+// Reads back the sub-blocks written to file, up to the end of the file.
+static std::vector<Byte> read_sub_blocks(std::FILE *file)
+{
+    std::rewind(file);
+    std::vector<Byte> data;
+    for (int len = std::fgetc(file); len > 0; len = std::fgetc(file))
+    {
+        for (int i = 0; i < len; ++i)
+        {
+            data.push_back(static_cast<Byte>(std::fgetc(file)));
+        }
+    }
+    return data;
+}
+
+// A plain GIF LZW decoder, as a reader of the file would decode it.
+static std::vector<Byte> decode(const std::vector<Byte> &data, const int min_code_size)
+{
+    const int clear_code{1 << min_code_size};
+    const int eof_code{clear_code + 1};
+    std::vector<std::vector<Byte>> table;
+    int code_size{};
+    const auto reset = [&]
+    {
+        table.clear();
+        for (int i = 0; i < clear_code + 2; ++i)
+        {
+            table.push_back({static_cast<Byte>(i)});
+        }
+        code_size = min_code_size + 1;
+    };
+    reset();
+
+    std::vector<Byte> pixels;
+    std::uint64_t pos{};
+    int prev{-1};
+    while (pos + code_size <= data.size() * 8U)
+    {
+        int code{};
+        for (int bit = 0; bit < code_size; ++bit, ++pos)
+        {
+            code |= (data[pos / 8] >> pos % 8 & 1) << bit;
+        }
+        if (code == clear_code)
+        {
+            reset();
+            prev = -1;
+            continue;
+        }
+        if (code == eof_code)
+        {
+            break;
+        }
+        std::vector<Byte> entry;
+        if (code < static_cast<int>(table.size()))
+        {
+            entry = table[code];
+        }
+        else
+        {
+            EXPECT_EQ(static_cast<int>(table.size()), code);
+            EXPECT_NE(-1, prev);
+            entry = table[prev];
+            entry.push_back(table[prev][0]);
+        }
+        pixels.insert(pixels.end(), entry.begin(), entry.end());
+        if (prev != -1 && table.size() < 4096)
+        {
+            std::vector<Byte> added{table[prev]};
+            added.push_back(entry[0]);
+            table.push_back(added);
+        }
+        if (static_cast<int>(table.size()) == 1 << code_size && code_size < 12)
+        {
+            ++code_size;
+        }
+        prev = code;
+    }
+    return pixels;
+}
+
+// Noisy stripes, so the string table fills and is cleared within a strip.
+static std::vector<Byte> test_pixels(const std::size_t count, const int colors)
+{
+    std::vector<Byte> pixels(count);
+    std::uint32_t seed{12345};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245U + 12345U;
+        pixels[i] = static_cast<Byte>((i / 37 + (seed >> 16 & 3)) % colors);
+    }
+    return pixels;
+}
+
+static std::vector<Byte> round_trip(const std::vector<Byte> &pixels, const int min_code_size, const int num_strips)
+{
+    std::FILE *file{std::tmpfile()};
+    EXPECT_NE(nullptr, file);
+    {
+        GifStripWriter writer{file, min_code_size};
+        const std::size_t strip_len{(pixels.size() + num_strips - 1) / num_strips};
+        for (std::size_t first = 0; first < pixels.size(); first += strip_len)
+        {
+            LzwStrip strip;
+            lzw_compress_strip(&pixels[first], std::min(strip_len, pixels.size() - first), min_code_size, strip);
+            writer.put_strip(strip);
+        }
+        EXPECT_TRUE(writer.finish());
+    }
+    std::fputc(0, file);
+    const std::vector<Byte> data{read_sub_blocks(file)};
+    std::fclose(file);
+    return decode(data, min_code_size);
+}
+
+TEST(TestGifLzw, singleStripDecodesToPixels)
+{
+    const std::vector<Byte> pixels{test_pixels(100000, 256)};
+
+    EXPECT_EQ(pixels, round_trip(pixels, 8, 1));
+}
+
+TEST(TestGifLzw, stripsDecodeToPixels)
+{
+    const std::vector<Byte> pixels{test_pixels(100000, 256)};
+
+    EXPECT_EQ(pixels, round_trip(pixels, 8, 7));
+}
+
+TEST(TestGifLzw, smallCodeSizeStripsDecodeToPixels)
+{
+    const std::vector<Byte> pixels{test_pixels(50001, 4)};
+
+    EXPECT_EQ(pixels, round_trip(pixels, 2, 5));
+}
+
+TEST(TestGifLzw, stripCodesPackedLeastSignificantBitFirst)
+{
+    const std::vector<Byte> pixels{1, 1, 1};
+    LzwStrip strip;
+
+    lzw_compress_strip(pixels.data(), pixels.size(), 2, strip);
+
+    // codes 1 and 6 (1,1), 3 bits each
+    EXPECT_EQ(6U, strip.num_bits);
+    ASSERT_EQ(1U, strip.bits.size());
+    EXPECT_EQ(0x31, strip.bits[0]);
+    EXPECT_EQ(3, strip.end_code_size);
+}
+
+} // namespace id::test
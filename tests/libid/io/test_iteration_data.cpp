@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <io/iteration_data.h>
+
+#include <engine/tiled_render.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace id::engine;
+using namespace id::io;
+
+namespace id::test
+{
+
+class TestIterationData : public testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    void read_contents();
+    std::uint32_t u32(std::size_t offset) const;
+    float f32(std::size_t offset) const;
+
+    std::FILE *m_file{};
+    std::vector<Byte> m_data;
+};
+
+void TestIterationData::SetUp()
+{
+    m_file = std::tmpfile();
+    ASSERT_NE(nullptr, m_file);
+}
+
+void TestIterationData::TearDown()
+{
+    std::fclose(m_file);
+}
+
+void TestIterationData::read_contents()
+{
+    std::rewind(m_file);
+    m_data.clear();
+    for (int c = std::fgetc(m_file); c != EOF; c = std::fgetc(m_file))
+    {
+        m_data.push_back(static_cast<Byte>(c));
+    }
+}
+
+std::uint32_t TestIterationData::u32(const std::size_t offset) const
+{
+    return m_data[offset] | m_data[offset + 1] << 8 | m_data[offset + 2] << 16 |
+        static_cast<std::uint32_t>(m_data[offset + 3]) << 24;
+}
+
+float TestIterationData::f32(const std::size_t offset) const
+{
+    const std::uint32_t bits{u32(offset)};
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+TEST_F(TestIterationData, headerDescribesImageAndPlanes)
+{
+    ASSERT_TRUE(write_iteration_data_header(m_file, 640, 480, 1000));
+
+    read_contents();
+
+    ASSERT_EQ(8U + 9 * 4, m_data.size());
+    EXPECT_EQ("IDITDATA", std::string(m_data.begin(), m_data.begin() + 8));
+    EXPECT_EQ(ITERATION_DATA_VERSION, u32(8));
+    EXPECT_EQ(640U, u32(12));
+    EXPECT_EQ(480U, u32(16));
+    EXPECT_EQ(1000U, u32(20));
+    EXPECT_EQ(4U, u32(24));
+    EXPECT_EQ(static_cast<std::uint32_t>(IterationPlane::ITERATIONS), u32(28));
+    EXPECT_EQ(static_cast<std::uint32_t>(IterationPlane::SMOOTH), u32(32));
+    EXPECT_EQ(static_cast<std::uint32_t>(IterationPlane::Z_REAL), u32(36));
+    EXPECT_EQ(static_cast<std::uint32_t>(IterationPlane::Z_IMAG), u32(40));
+}
+
+TEST_F(TestIterationData, tileHoldsPlanesInRowOrder)
+{
+    RenderedTile tile{16, 32, 2, 1, {1, 2}, {{7, 6.5F, 2.0F, -1.0F}, {1000, 1000.0F, 0.0F, 0.0F}}};
+
+    ASSERT_TRUE(write_iteration_data_tile(m_file, tile));
+
+    read_contents();
+    ASSERT_EQ(4U + 4 * 4 + 2 * 4 * 4, m_data.size());
+    EXPECT_EQ("TILE", std::string(m_data.begin(), m_data.begin() + 4));
+    EXPECT_EQ(16U, u32(4));
+    EXPECT_EQ(32U, u32(8));
+    EXPECT_EQ(2U, u32(12));
+    EXPECT_EQ(1U, u32(16));
+    EXPECT_EQ(7U, u32(20));
+    EXPECT_EQ(1000U, u32(24));
+    EXPECT_EQ(6.5F, f32(28));
+    EXPECT_EQ(1000.0F, f32(32));
+    EXPECT_EQ(2.0F, f32(36));
+    EXPECT_EQ(0.0F, f32(40));
+    EXPECT_EQ(-1.0F, f32(44));
+    EXPECT_EQ(0.0F, f32(48));
+}
+
+TEST_F(TestIterationData, endMarksLastChunk)
+{
+    ASSERT_TRUE(write_iteration_data_end(m_file));
+
+    read_contents();
+    ASSERT_EQ(4U, m_data.size());
+    EXPECT_EQ(0, std::memcmp("END", m_data.data(), 4));
+}
+
+} // namespace id::test
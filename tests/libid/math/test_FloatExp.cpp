@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <math/FloatExp.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace id::math;
+
+namespace id::test
+{
+
+TEST(TestFloatExp, defaultIsZero)
+{
+    const FloatExp value;
+
+    EXPECT_TRUE(value.is_zero());
+    EXPECT_EQ(0.0, value.to_double());
+}
+
+TEST(TestFloatExp, roundTripsDouble)
+{
+    for (const double value : {1.0, -3.5, 0.1, 1e300, -1e-300, 4.9e-324})
+    {
+        EXPECT_EQ(value, FloatExp{value}.to_double()) << value;
+    }
+}
+
+TEST(TestFloatExp, normalizesMantissa)
+{
+    const FloatExp value{12.0};
+
+    EXPECT_EQ(0.75, value.mantissa());
+    EXPECT_EQ(4, value.exponent());
+}
+
+TEST(TestFloatExp, arithmeticMatchesDouble)
+{
+    const FloatExp a{1.5};
+    const FloatExp b{-0.25};
+
+    EXPECT_EQ(1.25, (a + b).to_double());
+    EXPECT_EQ(1.75, (a - b).to_double());
+    EXPECT_EQ(-0.375, (a * b).to_double());
+    EXPECT_EQ(-6.0, (a / b).to_double());
+    EXPECT_EQ(1.5, (a + FloatExp{}).to_double());
+}
+
+TEST(TestFloatExp, keepsValuesBelowDoubleRange)
+{
+    const FloatExp tiny{1e-300};
+
+    const FloatExp product{tiny * tiny};
+
+    EXPECT_EQ(0.0, product.to_double());
+    EXPECT_FALSE(product.is_zero());
+    EXPECT_NEAR(1.0, (product / tiny / tiny).to_double(), 1e-15);
+}
+
+TEST(TestFloatExp, addsValuesOfVeryDifferentScale)
+{
+    const FloatExp large{FloatExp{1.0, -1000}};
+    const FloatExp small{FloatExp{1.0, -2000}};
+
+    EXPECT_EQ(large, large + small);
+    EXPECT_EQ(large, small + large);
+}
+
+TEST(TestFloatExp, compares)
+{
+    const FloatExp tiny{1.0, -2000};
+    const FloatExp tinier{1.0, -2001};
+
+    EXPECT_LT(tinier, tiny);
+    EXPECT_GT(tiny, tinier);
+    EXPECT_LT(-tiny, tinier);
+    EXPECT_LT(FloatExp{}, tinier);
+    EXPECT_LE(tiny, tiny);
+    EXPECT_GE(tiny, tiny);
+}
+
+TEST(TestFloatExp, absoluteValue)
+{
+    EXPECT_EQ(FloatExp(2.0, -1500), abs(FloatExp(-2.0, -1500)));
+}
+
+TEST(TestFloatExp, squareRootHalvesExponent)
+{
+    const FloatExp value{sqrt(FloatExp{4.0, -2000})};
+
+    EXPECT_EQ(FloatExp(2.0, -1000), value);
+    EXPECT_EQ(FloatExp(std::sqrt(2.0)), sqrt(FloatExp{2.0}));
+}
+
+TEST(TestFloatExp, complexMagnitude)
+{
+    const FloatExpComplex z{FloatExp{3.0, -1100}, FloatExp{4.0, -1100}};
+
+    EXPECT_EQ(FloatExp(25.0, -2200), mag_squared(z));
+}
+
+} // namespace id::test
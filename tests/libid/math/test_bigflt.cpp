@@ -76,6 +76,36 @@ TEST_F(TestBigFloat, parsesExponent)
     EXPECT_EQ(125.0L, bf_to_float(value));
 }
 
+TEST_F(TestBigFloat, convertsToFloatExp)
+{
+    BigFloat value{alloc_stack(g_bf_length + 2)};
+
+    str_to_bf(value, "1.25e-2");
+
+    EXPECT_NEAR(1.25e-2, bf_to_float_exp(value).to_double(), 1e-18);
+}
+
+TEST_F(TestBigFloat, convertsFloatExpBeyondDoubleRange)
+{
+    BigFloat value{alloc_stack(g_bf_length + 2)};
+    const FloatExp tiny{0.75, -2000};
+
+    float_exp_to_bf(value, tiny);
+    const FloatExp result{bf_to_float_exp(value)};
+
+    EXPECT_EQ(tiny.exponent(), result.exponent());
+    EXPECT_NEAR(tiny.mantissa(), result.mantissa(), 1e-15);
+}
+
+TEST_F(TestBigFloat, convertsNegativeFloatExp)
+{
+    BigFloat value{alloc_stack(g_bf_length + 2)};
+
+    float_exp_to_bf(value, FloatExp{-3.0});
+
+    EXPECT_EQ(-3.0L, bf_to_float(value));
+}
+
 TEST_F(TestBigFloat, formatsZero)
 {
     BigFloat value{alloc_stack(g_bf_length + 2)};
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-3.0-only
+//
+#include <math/bigmult.h>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+using namespace id::math;
+
+namespace id::test
+{
+
+using Bytes = std::vector<unsigned char>;
+
+// byte at a time long multiplication, as the original big number code did
+static Bytes long_multiply(const Bytes &n1, const Bytes &n2)
+{
+    Bytes product(n1.size() * 2);
+    for (std::size_t i = 0; i < n1.size(); ++i)
+    {
+        unsigned carry{};
+        for (std::size_t j = 0; j < n2.size(); ++j)
+        {
+            const unsigned sum{product[i + j] + static_cast<unsigned>(n1[i]) * n2[j] + carry};
+            product[i + j] = static_cast<unsigned char>(sum);
+            carry = sum >> 8;
+        }
+        product[i + n2.size()] = static_cast<unsigned char>(carry);
+    }
+    return product;
+}
+
+static Bytes random_bytes(std::mt19937 &gen, const int length)
+{
+    std::uniform_int_distribution<int> byte{0, 255};
+    Bytes result(length);
+    for (unsigned char &value : result)
+    {
+        value = static_cast<unsigned char>(byte(gen));
+    }
+    return result;
+}
+
+class TestBigMult : public testing::TestWithParam<int>
+{
+protected:
+    std::mt19937 m_gen{static_cast<std::mt19937::result_type>(GetParam())};
+};
+
+TEST_P(TestBigMult, multipliesLikeLongMultiplication)
+{
+    const Bytes n1{random_bytes(m_gen, GetParam())};
+    const Bytes n2{random_bytes(m_gen, GetParam())};
+    Bytes product(n1.size() * 2);
+
+    mult_magnitudes(product.data(), n1.data(), n2.data(), GetParam());
+
+    EXPECT_EQ(long_multiply(n1, n2), product);
+}
+
+TEST_P(TestBigMult, squaresLikeLongMultiplication)
+{
+    const Bytes n{random_bytes(m_gen, GetParam())};
+    Bytes product(n.size() * 2);
+
+    square_magnitude(product.data(), n.data(), GetParam());
+
+    EXPECT_EQ(long_multiply(n, n), product);
+}
+
+TEST_P(TestBigMult, multipliesAllOnesWithFullCarries)
+{
+    const Bytes n(GetParam(), 0xFF);
+    Bytes product(n.size() * 2);
+
+    mult_magnitudes(product.data(), n.data(), n.data(), GetParam());
+
+    EXPECT_EQ(long_multiply(n, n), product);
+}
+
+// lengths straddle the limb size and the Karatsuba threshold
+INSTANTIATE_TEST_SUITE_P(Lengths, TestBigMult, testing::Values(1, 2, 4, 7, 8, 12, 40, 191, 192, 200, 777, 2048));
+
+} // namespace id::test
@@ -14,9 +14,11 @@
 
 #include <gtest/gtest.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <limits>
+#include <vector>
 
 using namespace id::engine;
 using namespace id::io;
@@ -107,4 +109,73 @@ TEST(TestDiskVideo, commonStartDiskUsesDiskWhenForced)
     EXPECT_EQ(99, disk_read_pixel(63, 63));
 }
 
+TEST(TestDiskVideo, bytePixelsInMemoryAreAddressedDirectly)
+{
+    MockDriver driver;
+    DiskVideoState state{&driver, DebugFlags::NONE};
+    EXPECT_CALL(driver, is_disk()).WillRepeatedly(Return(false));
+
+    ASSERT_EQ(0, common_start_disk(4096, 16, 256));
+
+    EXPECT_TRUE(disk_video_direct());
+    disk_write_pixel(4095, 15, 201);
+    EXPECT_EQ(201, disk_read_pixel(4095, 15));
+    EXPECT_EQ(0, disk_read_pixel(4095, 14));
+}
+
+TEST(TestDiskVideo, packedPixelsGoThroughCache)
+{
+    MockDriver driver;
+    DiskVideoState state{&driver, DebugFlags::NONE};
+    EXPECT_CALL(driver, is_disk()).WillRepeatedly(Return(false));
+
+    ASSERT_EQ(0, common_start_disk(4096, 16, 16));
+
+    EXPECT_FALSE(disk_video_direct());
+    disk_write_pixel(4095, 15, 11);
+    EXPECT_EQ(11, disk_read_pixel(4095, 15));
+}
+
+TEST(TestDiskVideo, spanRoundTripsAcrossCacheBlocks)
+{
+    MockDriver driver;
+    DiskVideoState state{&driver, DebugFlags::NONE};
+    EXPECT_CALL(driver, is_disk()).WillRepeatedly(Return(false));
+    ASSERT_EQ(0, common_start_disk(3000, 4, 256));
+    std::vector<Byte> written(3000);
+    for (std::size_t i = 0; i < written.size(); ++i)
+    {
+        written[i] = static_cast<Byte>(i * 7 + 1);
+    }
+
+    disk_write_span(1, 0, 2999, written.data());
+    std::vector<Byte> read(3000);
+    disk_read_span(1, 0, 2999, read.data());
+
+    EXPECT_EQ(written, read);
+    EXPECT_EQ(written[2047], disk_read_pixel(2047, 1));
+    EXPECT_EQ(written[2048], disk_read_pixel(2048, 1));
+    EXPECT_EQ(0, disk_read_pixel(0, 2));
+}
+
+TEST(TestDiskVideo, spanOutsideImageReadsZeroAndDropsWrites)
+{
+    MockDriver driver;
+    DiskVideoState state{&driver, DebugFlags::NONE};
+    EXPECT_CALL(driver, is_disk()).WillRepeatedly(Return(false));
+    ASSERT_EQ(0, common_start_disk(16, 16, 256));
+    const std::vector<Byte> written(20, 9);
+
+    disk_write_span(3, -2, 17, written.data());
+    disk_write_span(16, 0, 15, written.data());
+    std::vector<Byte> read(20, 0xff);
+    disk_read_span(3, -2, 17, read.data());
+
+    const std::vector<Byte> expected{0, 0, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 0, 0};
+    EXPECT_EQ(expected, read);
+    std::vector<Byte> outside(4, 0xff);
+    disk_read_span(16, 0, 3, outside.data());
+    EXPECT_EQ(std::vector<Byte>(4, 0), outside);
+}
+
 } // namespace id::test
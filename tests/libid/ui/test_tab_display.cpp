@@ -108,6 +108,11 @@ TEST(TestPerturbationStatusText, pluralReferences)
     EXPECT_EQ("Perturbation (2 references)", perturbation_status_text(2));
 }
 
+TEST(TestPerturbationStatusText, skippedIterations)
+{
+    EXPECT_EQ("Perturbation (1 reference, 1234 iterations skipped)", perturbation_status_text(1, 1234));
+}
+
 TEST_F(TestTabDisplay, displaysMainStatusScreen)
 {
     std::vector<std::string> output;
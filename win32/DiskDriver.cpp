@@ -48,6 +48,8 @@ public:
     void schedule_alarm(int secs) override;
     void write_pixel(int x, int y, int color) override;
     int read_pixel(int x, int y) override;
+    void read_span(int y, int x, int last_x, Byte *pixels) override;
+    void write_span(int y, int x, int last_x, const Byte *pixels) override;
     void draw_line(int x1, int y1, int x2, int y2, int color) override;
     void draw_xor_line(int x1, int y1, int x2, int y2) override;
     void clear_xor_lines() override;
@@ -259,6 +261,16 @@ int DiskDriver::read_pixel(const int x, const int y)
     return get_color(x, y);
 }
 
+void DiskDriver::read_span(const int y, const int x, const int last_x, Byte *pixels)
+{
+    ui::read_span(y, x, last_x, pixels);
+}
+
+void DiskDriver::write_span(const int y, const int x, const int last_x, const Byte *pixels)
+{
+    ui::write_span(y, x, last_x, pixels);
+}
+
 void DiskDriver::draw_line(const int x1, const int y1, const int x2, const int y2, const int color)
 {
     ODS5("DiskDriver::draw_line (%d,%d) (%d,%d) %d", x1, y1, x2, y2, color);
@@ -295,7 +307,6 @@ void DiskDriver::set_video_mode(const VideoInfo &mode)
 
     resize();
     set_disk_dot();
-    set_normal_span();
 }
 
 void DiskDriver::set_clear()
@@ -217,7 +217,6 @@ void Win32BaseDriver::set_video_mode(const VideoInfo &mode)
         end_disk();
     }
     set_normal_dot();
-    set_normal_span();
     set_for_graphics();
     set_clear();
 }
@@ -336,7 +336,6 @@ void WxBaseDriver::set_video_mode(const VideoInfo &mode)
         end_disk();
     }
     set_normal_dot();
-    set_normal_span();
     set_for_graphics();
     set_clear();
 }
@@ -624,6 +624,45 @@ void X11BaseDriver::write_pixel(const int x, const int y, const int color)
     }
 }
 
+void X11BaseDriver::read_span(const int y, const int x, const int last_x, Byte *pixels)
+{
+    read_rect(x, y, last_x - x + 1, 1, pixels);
+}
+
+void X11BaseDriver::write_span(const int y, const int x, const int last_x, const Byte *pixels)
+{
+    write_rect(x, y, last_x - x + 1, 1, pixels);
+}
+
+void X11BaseDriver::read_rect(const int x, const int y, const int width, const int height, Byte *pixels)
+{
+    if (g_screen_x_dots <= 0 || g_screen_y_dots <= 0)
+    {
+        if (width > 0 && height > 0)
+        {
+            std::fill_n(pixels, static_cast<std::size_t>(width) * height, Byte{});
+        }
+        return;
+    }
+    m_plot.read_rect(x, y, width, height, pixels);
+}
+
+void X11BaseDriver::write_rect(const int x, const int y, const int width, const int height, const Byte *pixels)
+{
+    if (g_screen_x_dots <= 0 || g_screen_y_dots <= 0 || width <= 0 || height <= 0)
+    {
+        return;
+    }
+    m_plot.resize(g_screen_x_dots, g_screen_y_dots);
+    m_plot.write_rect(x, y, width, height, pixels);
+    m_output_flush_countdown -= width * height;
+    if (m_output_flush_countdown <= 0)
+    {
+        m_output_flush_countdown = OUTPUT_FLUSH_CHECK_PIXELS;
+        flush_output();
+    }
+}
+
 void X11BaseDriver::draw_line(const int x1, const int y1, const int x2, const int y2, const int color)
 {
     id::geometry::draw_line(x1, y1, x2, y2, color);
@@ -779,7 +818,6 @@ void X11BaseDriver::set_video_mode(const VideoInfo &mode)
         end_disk();
     }
     set_normal_dot();
-    set_normal_span();
     set_for_graphics();
     set_clear();
     m_output_flush_countdown = 0;
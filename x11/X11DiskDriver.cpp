@@ -43,6 +43,10 @@ public:
     void write_palette() override;
     void write_pixel(int x, int y, int color) override;
     int read_pixel(int x, int y) override;
+    void read_span(int y, int x, int last_x, Byte *pixels) override;
+    void write_span(int y, int x, int last_x, const Byte *pixels) override;
+    void read_rect(int x, int y, int width, int height, Byte *pixels) override;
+    void write_rect(int x, int y, int width, int height, const Byte *pixels) override;
     void draw_line(int x1, int y1, int x2, int y2, int color) override;
     void draw_xor_line(int x1, int y1, int x2, int y2) override;
     void clear_xor_lines() override;
@@ -162,6 +166,26 @@ int X11DiskDriver::read_pixel(const int x, const int y)
     return get_color(x, y);
 }
 
+void X11DiskDriver::read_span(const int y, const int x, const int last_x, Byte *pixels)
+{
+    ui::read_span(y, x, last_x, pixels);
+}
+
+void X11DiskDriver::write_span(const int y, const int x, const int last_x, const Byte *pixels)
+{
+    ui::write_span(y, x, last_x, pixels);
+}
+
+void X11DiskDriver::read_rect(const int x, const int y, const int width, const int height, Byte *pixels)
+{
+    Driver::read_rect(x, y, width, height, pixels);
+}
+
+void X11DiskDriver::write_rect(const int x, const int y, const int width, const int height, const Byte *pixels)
+{
+    Driver::write_rect(x, y, width, height, pixels);
+}
+
 void X11DiskDriver::draw_line(const int x1, const int y1, const int x2, const int y2, const int color)
 {
     geometry::draw_line(x1, y1, x2, y2, color);
@@ -205,7 +229,6 @@ void X11DiskDriver::set_video_mode(const VideoInfo &mode)
 
     resize();
     set_disk_dot();
-    set_normal_span();
 }
 
 void X11DiskDriver::set_clear()
@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <limits>
 
 using namespace id::engine;
@@ -332,6 +333,64 @@ int X11Plot::read_pixel(const int x, const int y) const
     return m_pixels[pixel_offset(x, y)];
 }
 
+void X11Plot::write_span(const int y, const int x, const int last_x, const Byte *pixels)
+{
+    write_rect(x, y, last_x - x + 1, 1, pixels);
+}
+
+void X11Plot::read_span(const int y, const int x, const int last_x, Byte *pixels) const
+{
+    read_rect(x, y, last_x - x + 1, 1, pixels);
+}
+
+// Copies the part of the block inside the plot a row at a time and marks
+// it dirty once.
+void X11Plot::write_rect(const int x, const int y, const int width, const int height, const Byte *pixels)
+{
+    if (!has_pixels())
+    {
+        return;
+    }
+    const int left{std::max(x, 0)};
+    const int top{std::max(y, 0)};
+    const int right{std::min(x + width, m_width)};
+    const int bottom{std::min(y + height, m_height)};
+    if (right <= left || bottom <= top)
+    {
+        return;
+    }
+
+    for (int row = top; row < bottom; ++row)
+    {
+        std::memcpy(&m_pixels[pixel_offset(left, row)],
+            pixels + static_cast<std::size_t>(row - y) * width + (left - x), right - left);
+    }
+    mark_dirty(left, top, right, bottom);
+}
+
+// Pixels of the block outside the plot read as 0, as for read_pixel().
+void X11Plot::read_rect(const int x, const int y, const int width, const int height, Byte *pixels) const
+{
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+    std::memset(pixels, 0, static_cast<std::size_t>(width) * height);
+    if (!has_pixels())
+    {
+        return;
+    }
+    const int left{std::max(x, 0)};
+    const int top{std::max(y, 0)};
+    const int right{std::min(x + width, m_width)};
+    const int bottom{std::min(y + height, m_height)};
+    for (int row = top; row < bottom && left < right; ++row)
+    {
+        std::memcpy(pixels + static_cast<std::size_t>(row - y) * width + (left - x),
+            &m_pixels[pixel_offset(left, row)], right - left);
+    }
+}
+
 void X11Plot::save_xor_pixel(const int x, const int y)
 {
     if (!is_valid_position(x, y))
@@ -51,6 +51,10 @@ public:
     void write_palette() override;
     int read_pixel(int x, int y) override;
     void write_pixel(int x, int y, int color) override;
+    void read_span(int y, int x, int last_x, Byte *pixels) override;
+    void write_span(int y, int x, int last_x, const Byte *pixels) override;
+    void read_rect(int x, int y, int width, int height, Byte *pixels) override;
+    void write_rect(int x, int y, int width, int height, const Byte *pixels) override;
     void draw_line(int x1, int y1, int x2, int y2, int color) override;
     void draw_xor_line(int x1, int y1, int x2, int y2) override;
     void clear_xor_lines() override;
@@ -53,6 +53,10 @@ public:
     void clear();
     void write_pixel(int x, int y, int color);
     int read_pixel(int x, int y) const;
+    void write_span(int y, int x, int last_x, const Byte *pixels);
+    void read_span(int y, int x, int last_x, Byte *pixels) const;
+    void write_rect(int x, int y, int width, int height, const Byte *pixels);
+    void read_rect(int x, int y, int width, int height, Byte *pixels) const;
     void draw_xor_line(int x1, int y1, int x2, int y2);
     void clear_xor_lines();
     void display_string(int x, int y, int fg, int bg, const char *text);